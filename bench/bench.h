@@ -0,0 +1,45 @@
+#ifndef DATASTORE_BENCH_H
+#define DATASTORE_BENCH_H
+
+// Benchmarks must be compiled with `_GNU_SOURCE` defined before any include
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/resource.h>
+
+static inline double
+bench_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/** Peak resident set size of the calling process, in KiB */
+static inline long
+bench_peak_rss(void)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+/** Current resident set size of the calling process, in KiB */
+static inline long
+bench_rss(void)
+{
+	long pages = 0, resident = 0;
+	FILE* f = fopen("/proc/self/statm", "r");
+	if (!f)
+		return 0;
+	if (fscanf(f, "%ld %ld", &pages, &resident) != 2)
+		resident = 0;
+	fclose(f);
+	return resident * 4;
+}
+
+/** Prevents the compiler from optimizing `value` away */
+#define BENCH_KEEP(value) __asm__ volatile("" : : "g"(value) : "memory")
+
+#endif // DATASTORE_BENCH_H
@@ -0,0 +1,94 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../bitset/bitset.h"
+
+DATASTORE_BITSET(bits)
+DATASTORE_BITSET_IMPL(bits)
+
+static uint64_t g_state = 88172645463325252ull;
+static uint64_t next(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return g_state;
+}
+
+#define REPORT(label__, elapsed__, bytes__) \
+	printf("%-24s %10.3f ms %8.2f GB/s\n", label__, (elapsed__) * 1e3, \
+	       (double)(bytes__) / (elapsed__) * 1e-9)
+
+/* Reads two inputs and writes one output */
+#define BENCH_OP(label__, call__, bytes__) \
+	do { \
+		double best = 1e30; \
+		for (int rep = 0; rep < 5; ++rep) \
+		{ \
+			const double start = bench_now(); \
+			call__; \
+			const double elapsed = bench_now() - start; \
+			best = elapsed < best ? elapsed : best; \
+		} \
+		REPORT(label__, best, bytes__); \
+	} while (0)
+
+/*
+ * Combines two filter masks over `rows` rows and counts the selected rows, as one byte per row and
+ * as a bitset, then times rank/select over the result.
+ *
+ * Usage: bench-bitset [rows]
+ */
+int main(int argc, char **argv)
+{
+	const size_t rows = argc >= 2 ? (size_t)atoll(argv[1]) : 100000000;
+	unsigned char *ma = malloc(rows), *mb = malloc(rows), *mr = malloc(rows);
+	if (!ma || !mb || !mr)
+		abort();
+	struct bits a = bits_new(rows), b = bits_new(rows), r = bits_new(rows);
+	for (size_t i = 0; i < rows; ++i)
+	{
+		const uint64_t x = next();
+		ma[i] = (x & 3) != 0;
+		mb[i] = (x & 12) != 0;
+		bits_assign(&a, i, ma[i]);
+		bits_assign(&b, i, mb[i]);
+	}
+	printf("%zu rows: %zu MB as bytes, %zu MB as bits\n", rows, rows >> 20,
+	       (a.words.size * sizeof(uint64_t)) >> 20);
+
+	size_t count = 0;
+	BENCH_OP("and bytes", for (size_t i = 0; i < rows; ++i) mr[i] = ma[i] & mb[i], 3 * rows);
+	BENCH_OP("count bytes", count = 0; for (size_t i = 0; i < rows; ++i) count += mr[i], rows);
+	BENCH_KEEP(count);
+	const size_t bytes = a.words.size * sizeof(uint64_t);
+	BENCH_OP("and scalar", datastore_simd_and_u64_scalar(r.words.data, a.words.data, b.words.data, a.words.size),
+		 3 * bytes);
+	BENCH_OP("and", datastore_simd_and_u64(r.words.data, a.words.data, b.words.data, a.words.size), 3 * bytes);
+	BENCH_OP("popcount scalar", count = datastore_simd_popcount_u64_scalar(r.words.data, r.words.size), bytes);
+	BENCH_KEEP(count);
+	BENCH_OP("popcount", count = bits_count(&r), bytes);
+	BENCH_KEEP(count);
+
+	double start = bench_now();
+	bits_build_rank(&r);
+	printf("%-24s %10.3f ms\n", "build_rank", (bench_now() - start) * 1e3);
+	const size_t queries = 10000000;
+	size_t sum = 0;
+	start = bench_now();
+	for (size_t i = 0; i < queries; ++i)
+		sum += bits_rank(&r, next() % rows);
+	printf("%-24s %10.1f ns/op\n", "rank", (bench_now() - start) / (double)queries * 1e9);
+	start = bench_now();
+	for (size_t i = 0; i < queries; ++i)
+		sum += bits_select(&r, next() % count);
+	printf("%-24s %10.1f ns/op\n", "select", (bench_now() - start) / (double)queries * 1e9);
+	BENCH_KEEP(sum);
+
+	bits_free(&a);
+	bits_free(&b);
+	bits_free(&r);
+	free(ma);
+	free(mb);
+	free(mr);
+	return 0;
+}
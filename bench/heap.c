@@ -0,0 +1,104 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../heap/heap.h"
+
+#define U64_TRAIT(X) \
+	X(TYPE, uint64_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+
+DATASTORE_HEAP(uint64_t, h2)
+DATASTORE_HEAP_IMPL_D(U64_TRAIT, h2, DATASTORE_VEC_SETTINGS_DEFAULT, 2)
+DATASTORE_HEAP(uint64_t, h4)
+DATASTORE_HEAP_IMPL_D(U64_TRAIT, h4, DATASTORE_VEC_SETTINGS_DEFAULT, 4)
+DATASTORE_HEAP(uint64_t, h8)
+DATASTORE_HEAP_IMPL_D(U64_TRAIT, h8, DATASTORE_VEC_SETTINGS_DEFAULT, 8)
+DATASTORE_IHEAP(uint64_t, i2)
+DATASTORE_IHEAP_IMPL_D(U64_TRAIT, i2, DATASTORE_VEC_SETTINGS_DEFAULT, 2)
+DATASTORE_IHEAP(uint64_t, i4)
+DATASTORE_IHEAP_IMPL_D(U64_TRAIT, i4, DATASTORE_VEC_SETTINGS_DEFAULT, 4)
+
+static uint64_t g_state = 88172645463325252ull;
+static uint64_t next(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return g_state;
+}
+
+#define REPORT(label__, name__, elapsed__, count__) \
+	printf("%-12s %-8s %10.3f ms %8.1f ns/op\n", label__, #name__, (elapsed__) * 1e3, \
+	       (elapsed__) / (double)(count__) * 1e9)
+
+/* Push then pop every value, heapify then drain, and keep the smallest of a stream with push_pop */
+#define BENCH_HEAP(name__, values__, n__) \
+	do { \
+		struct name__ h = name__##_new(0); \
+		double start = bench_now(); \
+		for (size_t i = 0; i < (n__); ++i) \
+			name__##_push(&h, (values__)[i]); \
+		REPORT("push", name__, bench_now() - start, n__); \
+		uint64_t sum = 0; \
+		start = bench_now(); \
+		while (h.items.size) \
+			sum += name__##_take(&h); \
+		REPORT("pop", name__, bench_now() - start, n__); \
+		name__##_free(&h); \
+		struct name__##_vec v = name__##_vec_new(n__); \
+		memcpy(v.data, values__, (n__) * sizeof(uint64_t)); \
+		v.size = (n__); \
+		start = bench_now(); \
+		h = name__##_from_vec(v); \
+		REPORT("heapify", name__, bench_now() - start, n__); \
+		h.items.size = (n__) / 64; \
+		start = bench_now(); \
+		for (size_t i = 0; i < (n__); ++i) \
+			sum += name__##_push_pop(&h, (values__)[i] >> 1); \
+		REPORT("push_pop", name__, bench_now() - start, n__); \
+		BENCH_KEEP(sum); \
+		name__##_free(&h); \
+	} while (0)
+
+/* Random decrease_key on an indexed heap holding every id, then drain */
+#define BENCH_IHEAP(name__, values__, n__) \
+	do { \
+		struct name__ h = name__##_new(n__); \
+		for (size_t i = 0; i < (n__); ++i) \
+			name__##_push(&h, i, (values__)[i] | (1ull << 63)); \
+		double start = bench_now(); \
+		for (size_t i = 0; i < (n__); ++i) \
+		{ \
+			const size_t id = (values__)[i] % (n__); \
+			const uint64_t value = *name__##_get(&h, id); \
+			name__##_decrease_key(&h, id, value - ((values__)[i] >> 40)); \
+		} \
+		REPORT("decrease", name__, bench_now() - start, n__); \
+		uint64_t sum = 0; \
+		start = bench_now(); \
+		while (h.values.size) \
+			sum += name__##_take(&h, NULL); \
+		REPORT("pop", name__, bench_now() - start, n__); \
+		BENCH_KEEP(sum); \
+		name__##_free(&h); \
+	} while (0)
+
+/* Usage: bench-heap [elements] */
+int main(int argc, char **argv)
+{
+	const size_t n = argc >= 2 ? (size_t)atoll(argv[1]) : 4000000;
+	uint64_t *values = malloc(n * sizeof(uint64_t));
+	if (!values)
+		abort();
+	for (size_t i = 0; i < n; ++i)
+		values[i] = next() >> 1;
+
+	BENCH_HEAP(h2, values, n);
+	BENCH_HEAP(h4, values, n);
+	BENCH_HEAP(h8, values, n);
+	BENCH_IHEAP(i2, values, n);
+	BENCH_IHEAP(i4, values, n);
+	free(values);
+	return 0;
+}
@@ -0,0 +1,103 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../interner/interner.h"
+
+#include <string.h>
+
+DATASTORE_INTERNER(symbols)
+DATASTORE_INTERNER_IMPL(symbols)
+
+#define TOKENS ((size_t)4000000)
+#define DISTINCT ((size_t)5000)
+
+#define TIME(label__, body__) \
+	do { \
+		size_t checksum = 0; \
+		const double start = bench_now(); \
+		body__ \
+		const double elapsed = bench_now() - start; \
+		BENCH_KEEP(checksum); \
+		printf("%-22s %9.3f ms %8.1f ns/token\n", label__, elapsed * 1e3, elapsed * 1e9 / (double)TOKENS); \
+	} while (0)
+
+int main(void)
+{
+	/* Identifiers of 4 to 27 bytes, drawn with a skew towards the first ones */
+	char (*names)[32] = malloc(DISTINCT * sizeof(*names));
+	const char **tokens = malloc(TOKENS * sizeof(*tokens));
+	size_t *sizes = malloc(TOKENS * sizeof(*sizes));
+	char **copies = malloc(TOKENS * sizeof(*copies));
+	uint32_t *ids = malloc(TOKENS * sizeof(*ids));
+	if (!names || !tokens || !sizes || !copies || !ids)
+		abort();
+	uint64_t state = 0x9E3779B97F4A7C15ull;
+	for (size_t i = 0; i < DISTINCT; ++i)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		const size_t size = 4 + state % 24;
+		for (size_t c = 0; c < size; ++c)
+			names[i][c] = (char)('a' + (state >> (c % 48)) % 26);
+		names[i][size - 4] = (char)('0' + i % 10);
+		names[i][size - 3] = (char)('0' + i / 10 % 10);
+		names[i][size - 2] = (char)('0' + i / 100 % 10);
+		names[i][size - 1] = (char)('0' + i / 1000 % 10);
+		names[i][size] = '\0';
+	}
+	for (size_t i = 0; i < TOKENS; ++i)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		const size_t pick = (size_t)(state % DISTINCT) * (size_t)((state >> 32) % DISTINCT) / DISTINCT;
+		tokens[i] = names[pick];
+		sizes[i] = strlen(tokens[i]);
+	}
+
+	TIME("strdup", {
+		for (size_t i = 0; i < TOKENS; ++i)
+		{
+			copies[i] = strdup(tokens[i]);
+			checksum += (unsigned char)copies[i][0];
+		}
+		for (size_t i = 0; i < TOKENS; ++i)
+			free(copies[i]);
+	});
+	TIME("intern", {
+		struct symbols s = symbols_new();
+		for (size_t i = 0; i < TOKENS; ++i)
+			checksum += symbols_intern(&s, tokens[i], sizes[i]);
+		symbols_free(&s);
+	});
+	TIME("intern_many", {
+		struct symbols s = symbols_new();
+		symbols_intern_many(&s, tokens, sizes, TOKENS, ids);
+		checksum += ids[TOKENS - 1] + symbols_size(&s);
+		symbols_free(&s);
+	});
+
+	/* Equality of consecutive tokens */
+	struct symbols s = symbols_new();
+	symbols_intern_many(&s, tokens, sizes, TOKENS, ids);
+	TIME("strcmp", {
+		for (size_t i = 1; i < TOKENS; ++i)
+			checksum += !strcmp(tokens[i - 1], tokens[i]);
+	});
+	TIME("symbol ==", {
+		for (size_t i = 1; i < TOKENS; ++i)
+			checksum += ids[i - 1] == ids[i];
+	});
+	size_t arena = 0;
+	for (size_t i = 0; i < s.chunks.size; ++i)
+		arena += s.chunks.data[i].used;
+	printf("%zu symbols, %zu arena bytes\n", symbols_size(&s), arena);
+	symbols_free(&s);
+
+	free(names);
+	free(tokens);
+	free(sizes);
+	free(copies);
+	free(ids);
+	return 0;
+}
@@ -0,0 +1,176 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../packed/packed.h"
+
+DATASTORE_PACKED(ids)
+DATASTORE_PACKED_IMPL(ids)
+
+static uint64_t g_state = 88172645463325252ull;
+static uint64_t next(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return g_state;
+}
+
+/* Gap to the next identifier */
+enum distribution
+{
+	DENSE, // Uniform in [1, 8]
+	UNIFORM, // Random subset of 32-bit identifiers, covering 90% of the range
+	CLUSTERED, // Runs of consecutive identifiers, separated by jumps of up to 2^16
+};
+
+static uint32_t gap(enum distribution distribution, size_t n)
+{
+	switch (distribution)
+	{
+		case DENSE:
+			return 1 + (uint32_t)(next() % 8);
+		case UNIFORM:
+			return 1 + (uint32_t)(next() % (UINT32_MAX / n / 10 * 18));
+		case CLUSTERED:
+			return next() % 256 ? 1 : 1 + (uint32_t)(next() % 65536);
+	}
+	return 1;
+}
+
+static uint32_t *make_values(enum distribution distribution, size_t n)
+{
+	uint32_t *values = malloc(n * sizeof(uint32_t));
+	if (!values)
+		abort();
+	uint32_t value = 0;
+	for (size_t i = 0; i < n; ++i)
+		values[i] = value += gap(distribution, n);
+	return values;
+}
+
+static size_t array_lower_bound(const uint32_t *values, size_t n, uint32_t value)
+{
+	size_t first = 0;
+	while (n)
+	{
+		const size_t half = n / 2;
+		if (values[first + half] < value)
+		{
+			first += half + 1;
+			n -= half + 1;
+		}
+		else
+			n = half;
+	}
+	return first;
+}
+
+static size_t merge_count(const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+	size_t i = 0, j = 0, count = 0;
+	while (i < na && j < nb)
+	{
+		if (a[i] < b[j])
+			++i;
+		else if (b[j] < a[i])
+			++j;
+		else
+		{
+			++count;
+			++i;
+			++j;
+		}
+	}
+	return count;
+}
+
+static void bench(const char *label, enum distribution distribution, size_t n)
+{
+	uint32_t *values = make_values(distribution, n);
+	struct ids seq = ids_new();
+	for (size_t i = 0; i < n; ++i)
+		ids_push(&seq, values[i]);
+	const size_t bytes = seq.words.size * sizeof(uint32_t) + seq.blocks.size * sizeof(struct datastore_packed_block)
+		+ seq.tail.size * sizeof(uint32_t);
+	printf("%s: %.2f bits/value, %.1fx smaller than uint32_t\n", label, (double)bytes * 8 / (double)n,
+	       (double)(n * sizeof(uint32_t)) / (double)bytes);
+
+	uint32_t *out = malloc((n + DATASTORE_PACKED_BLOCK) * sizeof(uint32_t));
+	if (!out)
+		abort();
+	double start = bench_now();
+	for (size_t k = 0; k < seq.blocks.size; ++k)
+	{
+		const struct datastore_packed_block *block = &seq.blocks.data[k];
+		datastore_packed_unpack_scalar(out + k * DATASTORE_PACKED_BLOCK, seq.words.data + block->offset, block->bits,
+		                               k ? seq.blocks.data[k - 1].last : 0);
+	}
+	double elapsed = bench_now() - start;
+	BENCH_KEEP(out[n / 2]);
+	printf("  %-18s %8.1f Mvalues/s\n", "decode scalar", (double)n / elapsed * 1e-6);
+	start = bench_now();
+	for (size_t k = 0; k <= seq.blocks.size; ++k)
+		ids_decode(&seq, k, out + k * DATASTORE_PACKED_BLOCK);
+	elapsed = bench_now() - start;
+	BENCH_KEEP(out[n / 2]);
+	printf("  %-18s %8.1f Mvalues/s\n", "decode", (double)n / elapsed * 1e-6);
+
+	const size_t queries = 1000000;
+	uint64_t sum = 0;
+	start = bench_now();
+	for (size_t i = 0; i < queries; ++i)
+		sum += ids_get(&seq, next() % n);
+	printf("  %-18s %8.1f ns/op\n", "get", (bench_now() - start) / (double)queries * 1e9);
+	start = bench_now();
+	for (size_t i = 0; i < queries; ++i)
+		sum += ids_lower_bound(&seq, values[next() % n]);
+	printf("  %-18s %8.1f ns/op\n", "lower_bound", (bench_now() - start) / (double)queries * 1e9);
+	start = bench_now();
+	for (size_t i = 0; i < queries; ++i)
+		sum += array_lower_bound(values, n, values[next() % n]);
+	printf("  %-18s %8.1f ns/op\n", "lower_bound array", (bench_now() - start) / (double)queries * 1e9);
+	BENCH_KEEP(sum);
+
+	/* Intersect with every 1000th value plus noise, then with a list as long */
+	for (int sparse = 1; sparse >= 0; --sparse)
+	{
+		const size_t nb = sparse ? n / 1000 : n;
+		uint32_t *other = malloc(nb * sizeof(uint32_t));
+		if (!other)
+			abort();
+		struct ids seq_other = ids_new();
+		for (size_t i = 0; i < nb; ++i)
+		{
+			other[i] = values[sparse ? i * 1000 : i] + (uint32_t)(next() % 2);
+			if (i && other[i] < other[i - 1])
+				other[i] = other[i - 1];
+			ids_push(&seq_other, other[i]);
+		}
+		start = bench_now();
+		const size_t expected = merge_count(values, n, other, nb);
+		const double merge = bench_now() - start;
+		start = bench_now();
+		struct ids both = ids_intersect(&seq, &seq_other);
+		const double packed = bench_now() - start;
+		if (both.size != expected)
+			abort();
+		printf("  %-18s %8.2f ms packed, %8.2f ms merging arrays (1/%zu)\n", "intersect", packed * 1e3,
+		       merge * 1e3, n / nb);
+		ids_free(&both);
+		ids_free(&seq_other);
+		free(other);
+	}
+
+	ids_free(&seq);
+	free(out);
+	free(values);
+}
+
+/* Usage: bench-packed [values] */
+int main(int argc, char **argv)
+{
+	const size_t n = argc >= 2 ? (size_t)atoll(argv[1]) : 10000000;
+	bench("dense", DENSE, n);
+	bench("uniform", UNIFORM, n);
+	bench("clustered", CLUSTERED, n);
+	return 0;
+}
@@ -0,0 +1,158 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../queue/queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define U64_TRAIT(X) \
+	X(TYPE, uint64_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+DATASTORE_SPSC(uint64_t, spsc)
+DATASTORE_SPSC_IMPL(U64_TRAIT, spsc)
+DATASTORE_MPMC(uint64_t, mpmc)
+DATASTORE_MPMC_IMPL(U64_TRAIT, mpmc)
+
+#define BATCH 32
+
+// {{{ Ping-pong
+/* A token bounces between two threads over a pair of queues, measuring the round trip */
+#define PING_PONG(queue__) \
+	struct queue__##_pair \
+	{ \
+		struct queue__ there; \
+		struct queue__ back; \
+		size_t rounds; \
+	}; \
+	static void *queue__##_pong(void *arg) \
+	{ \
+		struct queue__##_pair *pair = arg; \
+		uint64_t token; \
+		for (size_t i = 0; i < pair->rounds; ++i) \
+		{ \
+			while (!queue__##_pop(&pair->there, &token)) \
+				sched_yield(); \
+			while (!queue__##_push(&pair->back, token + 1)) \
+				sched_yield(); \
+		} \
+		return NULL; \
+	} \
+	static double queue__##_ping_pong(size_t rounds) \
+	{ \
+		struct queue__##_pair pair = { queue__##_new(16), queue__##_new(16), rounds }; \
+		pthread_t thread; \
+		const double start = bench_now(); \
+		if (pthread_create(&thread, NULL, queue__##_pong, &pair)) \
+			abort(); \
+		uint64_t token = 0; \
+		for (size_t i = 0; i < rounds; ++i) \
+		{ \
+			while (!queue__##_push(&pair.there, token)) \
+				sched_yield(); \
+			while (!queue__##_pop(&pair.back, &token)) \
+				sched_yield(); \
+		} \
+		pthread_join(thread, NULL); \
+		const double elapsed = bench_now() - start; \
+		BENCH_KEEP(token); \
+		queue__##_free(&pair.there); \
+		queue__##_free(&pair.back); \
+		return elapsed; \
+	}
+PING_PONG(spsc)
+PING_PONG(mpmc)
+// }}}
+
+// {{{ Fan-in
+struct producer
+{
+	struct mpmc *queue;
+	size_t count;
+	int batch;
+};
+
+static void *produce(void *arg)
+{
+	struct producer *producer = arg;
+	uint64_t values[BATCH];
+	for (size_t i = 0; i < producer->count;)
+	{
+		size_t pushed;
+		if (producer->batch)
+		{
+			const size_t count = producer->count - i < BATCH ? producer->count - i : BATCH;
+			for (size_t j = 0; j < count; ++j)
+				values[j] = i + j;
+			pushed = mpmc_push_n(producer->queue, values, count);
+		}
+		else
+			pushed = mpmc_push(producer->queue, i);
+		if (!pushed)
+			sched_yield();
+		i += pushed;
+	}
+	return NULL;
+}
+
+/* `producers` threads push into one queue, the calling thread consumes */
+static double fan_in(size_t producers, size_t total, int batch)
+{
+	struct mpmc queue = mpmc_new(1024);
+	struct producer args[64];
+	pthread_t threads[64];
+	const double start = bench_now();
+	for (size_t i = 0; i < producers; ++i)
+	{
+		args[i] = (struct producer){ &queue, total / producers, batch };
+		if (pthread_create(&threads[i], NULL, produce, &args[i]))
+			abort();
+	}
+	uint64_t values[BATCH];
+	uint64_t sum = 0;
+	for (size_t received = 0; received < total / producers * producers;)
+	{
+		const size_t count = batch ? mpmc_pop_n(&queue, values, BATCH) : (size_t)mpmc_pop(&queue, values);
+		if (!count)
+			sched_yield();
+		for (size_t i = 0; i < count; ++i)
+			sum += values[i];
+		received += count;
+	}
+	for (size_t i = 0; i < producers; ++i)
+		pthread_join(threads[i], NULL);
+	const double elapsed = bench_now() - start;
+	BENCH_KEEP(sum);
+	mpmc_free(&queue);
+	return elapsed;
+}
+// }}}
+
+/* Usage: bench-queue [max producers], defaults to the number of online processors */
+int main(int argc, char **argv)
+{
+	const long online = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t max_threads = argc >= 2 ? (size_t)atoi(argv[1]) : (online > 0 ? (size_t)online : 1);
+	if (max_threads > 64)
+		max_threads = 64;
+
+	const size_t rounds = 200000;
+	double elapsed = spsc_ping_pong(rounds);
+	printf("%-16s %10.3f ms %8.1f ns/round trip\n", "ping-pong spsc", elapsed * 1e3, elapsed / (double)rounds * 1e9);
+	elapsed = mpmc_ping_pong(rounds);
+	printf("%-16s %10.3f ms %8.1f ns/round trip\n", "ping-pong mpmc", elapsed * 1e3, elapsed / (double)rounds * 1e9);
+
+	const size_t total = 1 << 23;
+	for (size_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		elapsed = fan_in(threads, total, 0);
+		printf("%-16s %3zu %10.3f ms %8.2f Melem/s\n", "fan-in", threads, elapsed * 1e3,
+		       (double)total / elapsed * 1e-6);
+		elapsed = fan_in(threads, total, 1);
+		printf("%-16s %3zu %10.3f ms %8.2f Melem/s\n", "fan-in x32", threads, elapsed * 1e3,
+		       (double)total / elapsed * 1e-6);
+	}
+	return 0;
+}
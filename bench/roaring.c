@@ -0,0 +1,172 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../roaring/roaring.h"
+
+DATASTORE_ROARING(idset)
+DATASTORE_ROARING_IMPL(idset)
+
+static uint64_t g_state = 88172645463325252ull;
+static uint64_t next(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return g_state;
+}
+
+static int compare_u32(const void *lhs, const void *rhs)
+{
+	const uint32_t a = *(const uint32_t *)lhs, b = *(const uint32_t *)rhs;
+	return (a > b) - (a < b);
+}
+
+/* Bytes allocated by a set */
+static size_t memory(const struct idset *set)
+{
+	size_t bytes = set->containers.capacity * sizeof(struct datastore_roaring_container);
+	for (size_t i = 0; i < set->containers.size; ++i)
+		bytes += set->containers.data[i].capacity;
+	return bytes;
+}
+
+/* Sorted, deduplicated values in `[0, range)`; `run` consecutive values start at each draw */
+static size_t make_values(uint32_t *values, size_t n, uint64_t range, size_t run)
+{
+	for (size_t i = 0; i < n; i += run)
+	{
+		const uint32_t start = (uint32_t)(next() % range);
+		for (size_t k = 0; k < run && i + k < n; ++k)
+			values[i + k] = start + (uint32_t)k < start ? start : start + (uint32_t)k;
+	}
+	qsort(values, n, sizeof(uint32_t), compare_u32);
+	size_t size = n != 0;
+	for (size_t i = 1; i < n; ++i)
+		if (values[i] != values[size - 1])
+			values[size++] = values[i];
+	return size;
+}
+
+static size_t merge(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out, bool intersect)
+{
+	size_t i = 0, j = 0, count = 0;
+	while (i < na && j < nb)
+	{
+		if (a[i] < b[j])
+		{
+			if (!intersect)
+				out[count++] = a[i];
+			++i;
+		}
+		else if (b[j] < a[i])
+		{
+			if (!intersect)
+				out[count++] = b[j];
+			++j;
+		}
+		else
+		{
+			out[count++] = a[i];
+			++i;
+			++j;
+		}
+	}
+	if (!intersect)
+	{
+		while (i < na)
+			out[count++] = a[i++];
+		while (j < nb)
+			out[count++] = b[j++];
+	}
+	return count;
+}
+
+static void bench(const char *label, size_t n, uint64_t range, size_t run)
+{
+	uint32_t *a = malloc(n * sizeof(uint32_t)), *b = malloc(n * sizeof(uint32_t));
+	uint32_t *out = malloc(2 * n * sizeof(uint32_t));
+	if (!a || !b || !out)
+		abort();
+	const size_t na = make_values(a, n, range, run), nb = make_values(b, n, range, run);
+	/* Insert in random order */
+	uint32_t *shuffled = malloc(na * sizeof(uint32_t));
+	if (!shuffled)
+		abort();
+	memcpy(shuffled, a, na * sizeof(uint32_t));
+	for (size_t i = na; i > 1; --i)
+	{
+		const size_t j = next() % i;
+		const uint32_t t = shuffled[i - 1];
+		shuffled[i - 1] = shuffled[j];
+		shuffled[j] = t;
+	}
+	struct idset sa = idset_new(), sb = idset_new();
+	double start = bench_now();
+	for (size_t i = 0; i < na; ++i)
+		idset_insert(&sa, shuffled[i]);
+	const double insert = bench_now() - start;
+	for (size_t i = 0; i < nb; ++i)
+		idset_insert(&sb, b[i]);
+	idset_optimize(&sa);
+	idset_optimize(&sb);
+	printf("%s: %zu values, %.2f bytes/value (sorted array: 4), %zu containers\n", label, na,
+	       (double)memory(&sa) / (double)na, sa.containers.size);
+	printf("  %-12s %8.1f ns/op\n", "insert", insert / (double)na * 1e9);
+
+	const size_t queries = 1000000;
+	size_t found = 0;
+	start = bench_now();
+	for (size_t i = 0; i < queries; ++i)
+		found += idset_contains(&sa, (uint32_t)(next() % range));
+	printf("  %-12s %8.1f ns/op\n", "contains", (bench_now() - start) / (double)queries * 1e9);
+	BENCH_KEEP(found);
+
+	for (int intersect = 1; intersect >= 0; --intersect)
+	{
+		start = bench_now();
+		struct idset r = intersect ? idset_intersect(&sa, &sb) : idset_union(&sa, &sb);
+		const double roaring = bench_now() - start;
+		start = bench_now();
+		const size_t count = merge(a, na, b, nb, out, intersect);
+		const double arrays = bench_now() - start;
+		if (count != idset_cardinality(&r))
+			abort();
+		printf("  %-12s %8.2f ms, %8.2f ms merging sorted arrays\n", intersect ? "intersect" : "union",
+		       roaring * 1e3, arrays * 1e3);
+		idset_free(&r);
+	}
+	struct idset r = idset_difference(&sa, &sb);
+	BENCH_KEEP(r.containers.size);
+	idset_free(&r);
+
+	struct idset_bytes bytes = idset_bytes_new(0);
+	start = bench_now();
+	idset_serialize(&sa, &bytes);
+	const double write = bench_now() - start;
+	struct idset copy;
+	start = bench_now();
+	if (!idset_deserialize(&copy, bytes.data, bytes.size))
+		abort();
+	const double read = bench_now() - start;
+	printf("  %-12s %8.2f MB, %.2f ms write, %.2f ms read\n", "serialized", (double)bytes.size / 1e6, write * 1e3,
+	       read * 1e3);
+	idset_free(&copy);
+	idset_bytes_free(&bytes);
+
+	idset_free(&sa);
+	idset_free(&sb);
+	free(shuffled);
+	free(a);
+	free(b);
+	free(out);
+}
+
+/* Usage: bench-roaring [values] */
+int main(int argc, char **argv)
+{
+	const size_t n = argc >= 2 ? (size_t)atoll(argv[1]) : 4000000;
+	bench("uniform 2^32", n, (uint64_t)1 << 32, 1);
+	bench("uniform 2^26", n, (uint64_t)1 << 26, 1);
+	bench("dense 2^23", n, (uint64_t)1 << 23, 1);
+	bench("runs of 500", n, (uint64_t)1 << 30, 500);
+	return 0;
+}
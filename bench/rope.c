@@ -0,0 +1,102 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../rope/rope.h"
+
+DATASTORE_ROPE(text)
+DATASTORE_ROPE_IMPL(text)
+
+#define SIZE ((size_t)16 * 1024 * 1024)
+#define EDITS ((size_t)100000)
+/* Each vector edit moves half of the text */
+#define VECTOR_EDITS ((size_t)1000)
+
+static uint64_t next(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+#define TIME(label__, count__, body__) \
+	do { \
+		size_t checksum = 0; \
+		uint64_t state = 0x2545F4914F6CDD1Dull; \
+		const double start = bench_now(); \
+		body__ \
+		const double elapsed = bench_now() - start; \
+		BENCH_KEEP(checksum); \
+		BENCH_KEEP(state); \
+		printf("%-22s %9.3f ms %10.1f ns/op\n", label__, elapsed * 1e3, elapsed * 1e9 / (double)(count__)); \
+	} while (0)
+
+int main(void)
+{
+	/* Lines of 20 to 99 bytes */
+	struct text_chars doc = text_chars_new(SIZE + 100);
+	uint64_t seed = 0x9E3779B97F4A7C15ull;
+	while (doc.size < SIZE)
+	{
+		const size_t line = 20 + next(&seed) % 80;
+		for (size_t i = 0; i + 1 < line; ++i)
+			text_chars_push(&doc, (char)('a' + next(&seed) % 26));
+		text_chars_push(&doc, '\n');
+	}
+	const char word[8] = { 'i', 'n', 's', 'e', 'r', 't', 'e', 'd' };
+
+	/* Inserts 8 bytes then erases 4 bytes at random offsets */
+	TIME("vector edits", VECTOR_EDITS, {
+		struct text_chars v = text_chars_clone(&doc);
+		text_chars_reserve(&v, doc.size + VECTOR_EDITS * 4);
+		for (size_t i = 0; i < VECTOR_EDITS; ++i)
+		{
+			size_t at = next(&state) % (v.size + 1);
+			memmove(v.data + at + 8, v.data + at, v.size - at);
+			memcpy(v.data + at, word, 8);
+			v.size += 8;
+			at = next(&state) % (v.size - 4);
+			memmove(v.data + at, v.data + at + 4, v.size - at - 4);
+			v.size -= 4;
+		}
+		checksum += v.size;
+		text_chars_free(&v);
+	});
+	TIME("rope edits", EDITS, {
+		struct text t = text_from_vec(&doc);
+		for (size_t i = 0; i < EDITS; ++i)
+		{
+			text_insert(&t, next(&state) % (text_length(&t) + 1), word, 8);
+			text_erase(&t, next(&state) % (text_length(&t) - 4), 4);
+		}
+		checksum += text_length(&t);
+		text_free(&t);
+	});
+
+	struct text t = text_from_vec(&doc);
+	const size_t lines = text_lines(&t);
+	TIME("from_vec (16 MiB)", 1, {
+		struct text copy = text_from_vec(&doc);
+		checksum += text_length(&copy);
+		text_free(&copy);
+	});
+	TIME("to_vec (16 MiB)", 1, {
+		struct text_chars copy = text_to_vec(&t);
+		checksum += copy.size;
+		text_chars_free(&copy);
+	});
+	TIME("line_start", EDITS, {
+		for (size_t i = 0; i < EDITS; ++i)
+			checksum += text_line_start(&t, next(&state) % lines);
+	});
+	TIME("line_of", EDITS, {
+		for (size_t i = 0; i < EDITS; ++i)
+			checksum += text_line_of(&t, next(&state) % SIZE);
+	});
+	TIME("byte_at", EDITS, {
+		for (size_t i = 0; i < EDITS; ++i)
+			checksum += (unsigned char)text_byte_at(&t, next(&state) % SIZE);
+	});
+	text_free(&t);
+	text_chars_free(&doc);
+	return 0;
+}
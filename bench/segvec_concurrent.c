@@ -0,0 +1,118 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../segmented/segmented_concurrent.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define U64_TRAIT(X) \
+	X(TYPE, uint64_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+DATASTORE_VEC(uint64_t, vu)
+DATASTORE_VEC_IMPL(U64_TRAIT, vu)
+DATASTORE_SEGVEC_CONCURRENT(uint64_t, cu)
+DATASTORE_SEGVEC_CONCURRENT_IMPL(U64_TRAIT, cu)
+
+#define BATCH 64
+
+/* The baseline: a vector behind a mutex */
+struct locked
+{
+	pthread_mutex_t lock;
+	struct vu vec;
+};
+
+struct producer
+{
+	struct locked *locked;
+	struct cu *concurrent;
+	size_t count;
+	uint64_t id;
+};
+
+static void *push_locked(void *arg)
+{
+	struct producer *producer = arg;
+	for (size_t i = 0; i < producer->count; ++i)
+	{
+		pthread_mutex_lock(&producer->locked->lock);
+		vu_push(&producer->locked->vec, producer->id << 32 | i);
+		pthread_mutex_unlock(&producer->locked->lock);
+	}
+	return NULL;
+}
+
+static void *push_concurrent(void *arg)
+{
+	struct producer *producer = arg;
+	for (size_t i = 0; i < producer->count; ++i)
+		cu_push(producer->concurrent, producer->id << 32 | i);
+	return NULL;
+}
+
+static void *push_batched(void *arg)
+{
+	struct producer *producer = arg;
+	uint64_t values[BATCH];
+	for (size_t i = 0; i < producer->count; i += BATCH)
+	{
+		for (size_t j = 0; j < BATCH; ++j)
+			values[j] = producer->id << 32 | (i + j);
+		cu_push_many(producer->concurrent, values, BATCH);
+	}
+	return NULL;
+}
+
+static double run(void *(*fn)(void *), struct locked *locked, struct cu *concurrent, size_t threads, size_t total)
+{
+	pthread_t handles[64];
+	struct producer producers[64];
+	const double start = bench_now();
+	for (size_t i = 0; i < threads; ++i)
+	{
+		producers[i] = (struct producer){ locked, concurrent, total / threads, i };
+		if (pthread_create(&handles[i], NULL, fn, &producers[i]))
+			abort();
+	}
+	for (size_t i = 0; i < threads; ++i)
+		pthread_join(handles[i], NULL);
+	return bench_now() - start;
+}
+
+/* Usage: bench-segvec-concurrent [max producers], defaults to the number of online processors */
+int main(int argc, char **argv)
+{
+	const long online = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t max_threads = argc >= 2 ? (size_t)atoi(argv[1]) : (online > 0 ? (size_t)online : 1);
+	if (max_threads > 64)
+		max_threads = 64;
+	const size_t total = 1 << 23;
+
+	printf("%-16s %3s %10s    %8s\n", "push", "thr", "time", "rate");
+	for (size_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		struct locked locked = { PTHREAD_MUTEX_INITIALIZER, vu_new(0) };
+		double elapsed = run(push_locked, &locked, NULL, threads, total);
+		BENCH_KEEP(locked.vec.data[locked.vec.size - 1]);
+		printf("%-16s %3zu %10.3f ms %8.2f Mpush/s\n", "mutex vec", threads, elapsed * 1e3,
+		       (double)total / elapsed * 1e-6);
+		vu_free(&locked.vec);
+
+		struct cu concurrent = cu_new(0);
+		elapsed = run(push_concurrent, NULL, &concurrent, threads, total);
+		BENCH_KEEP(*cu_get(&concurrent, cu_size(&concurrent) - 1));
+		printf("%-16s %3zu %10.3f ms %8.2f Mpush/s\n", "concurrent", threads, elapsed * 1e3,
+		       (double)total / elapsed * 1e-6);
+		cu_free(&concurrent);
+
+		concurrent = cu_new(0);
+		elapsed = run(push_batched, NULL, &concurrent, threads, total);
+		BENCH_KEEP(*cu_get(&concurrent, cu_size(&concurrent) - 1));
+		printf("%-16s %3zu %10.3f ms %8.2f Mpush/s\n", "concurrent x64", threads, elapsed * 1e3,
+		       (double)total / elapsed * 1e-6);
+		cu_free(&concurrent);
+	}
+	return 0;
+}
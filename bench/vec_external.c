@@ -0,0 +1,101 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../vector/vector_external.h"
+
+struct record
+{
+	uint64_t key;
+	uint64_t payload;
+};
+#define RECORD_TRAIT(X) \
+	X(TYPE, struct record) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (lhs->key > rhs->key) - (lhs->key < rhs->key); })
+
+DATASTORE_VEC(struct record, vr)
+DATASTORE_VEC_EXTERNAL_SORT(RECORD_TRAIT, vr)
+DATASTORE_VEC_IMPL(RECORD_TRAIT, vr)
+DATASTORE_VEC_EXTERNAL_SORT_IMPL(RECORD_TRAIT, vr)
+
+static uint64_t g_state = 88172645463325252ull;
+static uint64_t next(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return g_state;
+}
+
+static void report(const char *label, size_t bytes, double elapsed)
+{
+	printf("%-28s %10.3f s %8.1f MB/s\n", label, elapsed, (double)bytes / elapsed * 1e-6);
+}
+
+/* Usage: bench-vec-external [MiB of records] [MiB of budget] */
+int main(int argc, char **argv)
+{
+	const size_t total = (argc >= 2 ? (size_t)atoi(argv[1]) : 1024) << 20;
+	const size_t budget = (argc >= 3 ? (size_t)atoi(argv[2]) : 64) << 20;
+	const size_t n = total / sizeof(struct record);
+	const size_t batch = 1 << 16;
+	struct record *records = malloc(batch * sizeof(*records));
+	if (!records)
+		abort();
+	memset(records, 0, batch * sizeof(*records));
+	printf("%zu records, %zu MiB, budget %zu MiB\n", n, total >> 20, budget >> 20);
+
+	// Disk bandwidth: writes the input once and reads it back
+	int fd = datastore_external_tmpfile(NULL);
+	double start = bench_now();
+	for (size_t i = 0; i < n; i += batch)
+	{
+		const size_t count = n - i < batch ? n - i : batch;
+		if (!datastore_external_write(fd, records, count * sizeof(*records)))
+			abort();
+	}
+	for (size_t i = 0; i < n; i += batch)
+	{
+		const size_t count = n - i < batch ? n - i : batch;
+		if (!datastore_external_pread(fd, records, count * sizeof(*records), i * sizeof(*records)))
+			abort();
+	}
+	report("write + read", total, bench_now() - start);
+	close(fd);
+
+	struct vr_external sorter = vr_external_new(budget, NULL);
+	start = bench_now();
+	for (size_t i = 0; i < n; i += batch)
+	{
+		const size_t count = n - i < batch ? n - i : batch;
+		for (size_t j = 0; j < count; ++j)
+			records[j] = (struct record){ next(), i + j };
+		if (!vr_external_push_many(&sorter, records, count))
+			abort();
+	}
+	const double pushed = bench_now() - start;
+	if (!vr_external_finish(&sorter))
+		abort();
+	const double finished = bench_now() - start;
+	struct record record;
+	uint64_t previous = 0;
+	size_t count = 0;
+	while (vr_external_next(&sorter, &record))
+	{
+		if (record.key < previous)
+			abort();
+		previous = record.key;
+		++count;
+	}
+	const double elapsed = bench_now() - start;
+	if (count != n || sorter.error)
+		abort();
+	printf("%zu runs, peak RSS %ld MiB\n", sorter.runs.size, bench_peak_rss() >> 10);
+	report("push (sort + spill runs)", total, pushed);
+	report("finish (merge passes)", total, finished - pushed);
+	report("next (final merge)", total, elapsed - finished);
+	report("external sort", total, elapsed);
+	vr_external_free(&sorter);
+	free(records);
+	return 0;
+}
@@ -0,0 +1,92 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../vector/vector.h"
+
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static size_t g_reallocs = 0;
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+#define SETTINGS_COUNTED(X) \
+	X(NEW, { ptr = malloc(size); if (!ptr) abort(); }) \
+	X(REALLOC, { ++g_reallocs; ptr = realloc(ptr, size); if (!ptr) abort(); }) \
+	X(FREE, { free(ptr); }) \
+	X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+#define SETTINGS_USABLE_COUNTED(X) \
+	X(NEW, { ptr = malloc(size); if (!ptr) abort(); usable = DATASTORE_VEC_USABLE_SIZE(ptr, size); }) \
+	X(REALLOC, { ++g_reallocs; ptr = realloc(ptr, size); if (!ptr) abort(); usable = DATASTORE_VEC_USABLE_SIZE(ptr, size); }) \
+	X(FREE, { free(ptr); }) \
+	X(GROW, { new_capacity = datastore_vec_grow_policy(capacity, elem_size); })
+
+DATASTORE_VEC(int, vi_default)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vi_default, SETTINGS_COUNTED)
+DATASTORE_VEC(int, vi_usable)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vi_usable, SETTINGS_USABLE_COUNTED)
+
+#define RUN(name__, count__, nvecs__) \
+	do { \
+		struct name__ *vecs = malloc(sizeof(*vecs) * (nvecs__)); \
+		if (!vecs) abort(); \
+		g_reallocs = 0; \
+		const long rss_before = bench_rss(); \
+		const double start = bench_now(); \
+		for (size_t v = 0; v < (nvecs__); ++v) \
+		{ \
+			vecs[v] = name__##_new(0); \
+			for (size_t i = 0; i < (count__); ++i) \
+				name__##_push(&vecs[v], (int)i); \
+		} \
+		const double elapsed = bench_now() - start; \
+		size_t slack = 0; \
+		for (size_t v = 0; v < (nvecs__); ++v) \
+			slack += vecs[v].capacity - vecs[v].size; \
+		printf("%-10s %10zu x %-6zu %9.3f ms %10zu reallocs %10ld KiB rss %10ld KiB peak %10zu slack\n", \
+		       #name__, (size_t)(count__), (size_t)(nvecs__), elapsed * 1e3, g_reallocs, \
+		       bench_rss() - rss_before, bench_peak_rss(), slack); \
+		for (size_t v = 0; v < (nvecs__); ++v) \
+			name__##_free(&vecs[v]); \
+		free(vecs); \
+	} while (0)
+
+/* Runs every case in a child process, so peak RSS is not shared between cases */
+static void run_case(int usable, size_t count, size_t nvecs)
+{
+	fflush(stdout);
+	const pid_t pid = fork();
+	if (pid < 0)
+		abort();
+	if (pid == 0)
+	{
+		if (usable)
+			RUN(vi_usable, count, nvecs);
+		else
+			RUN(vi_default, count, nvecs);
+		fflush(stdout);
+		_exit(0);
+	}
+	waitpid(pid, NULL, 0);
+}
+
+int main(void)
+{
+	static const size_t cases[][2] = {
+		{ 10, 100000 },
+		{ 100, 10000 },
+		{ 1000, 1000 },
+		{ 100000, 10 },
+		{ 10000000, 1 },
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+	{
+		run_case(0, cases[i][0], cases[i][1]);
+		run_case(1, cases[i][0], cases[i][1]);
+	}
+	return 0;
+}
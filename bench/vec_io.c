@@ -0,0 +1,91 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../vector/vector_io.h"
+
+#include <stdio.h>
+
+#define FLOAT_TRAIT(X) \
+	X(TYPE, float) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+DATASTORE_VEC(float, vf)
+DATASTORE_VEC_IO(FLOAT_TRAIT, vf)
+DATASTORE_VEC_IMPL(FLOAT_TRAIT, vf)
+DATASTORE_VEC_IO_IMPL(FLOAT_TRAIT, vf)
+DATASTORE_VEC(float, vf_view)
+DATASTORE_VEC_MAP(FLOAT_TRAIT, vf_view)
+DATASTORE_VEC_IMPL_S(FLOAT_TRAIT, vf_view, DATASTORE_VEC_SETTINGS_MAPPED)
+DATASTORE_VEC_MAP_IMPL(FLOAT_TRAIT, vf_view)
+
+static void report(const char *label, size_t bytes, double elapsed)
+{
+	printf("%-26s %12.3f ms %10.1f MB/s\n", label, elapsed * 1e3, (double)bytes / elapsed * 1e-6);
+}
+
+/* Usage: bench-vec-io [MiB], the file is read back from the page cache */
+int main(int argc, char **argv)
+{
+	const size_t bytes = (argc >= 2 ? (size_t)atoi(argv[1]) : 1024) << 20;
+	const size_t n = bytes / sizeof(float);
+	char path[] = "/tmp/datastore-bench-io-XXXXXX";
+	const int fd = mkstemp(path);
+	if (fd < 0)
+		abort();
+
+	struct vf v = vf_new(n);
+	for (size_t i = 0; i < n; ++i)
+		vf_push(&v, (float)i);
+	double start = bench_now();
+	if (vf_write_fd(&v, fd) != DATASTORE_VEC_IO_OK)
+		abort();
+	report("write_fd", bytes, bench_now() - start);
+
+	// What callers did before: raw elements pushed one by one from a FILE
+	FILE *file = fopen(path, "rb");
+	if (!file)
+		abort();
+	start = bench_now();
+	fseek(file, DATASTORE_VEC_FILE_HEADER, SEEK_SET);
+	struct vf pushed = vf_new(0);
+	float value;
+	while (fread(&value, sizeof(value), 1, file) == 1)
+		vf_push(&pushed, value);
+	report("fread + push", bytes, bench_now() - start);
+	fclose(file);
+	BENCH_KEEP(pushed.data[n / 2]);
+	vf_free(&pushed);
+
+	lseek(fd, 0, SEEK_SET);
+	start = bench_now();
+	struct vf read = vf_new(0);
+	if (vf_read_fd(&read, fd) != DATASTORE_VEC_IO_OK)
+		abort();
+	report("read_fd", bytes, bench_now() - start);
+	BENCH_KEEP(read.data[n / 2]);
+	vf_free(&read);
+
+	struct vf_view view;
+	start = bench_now();
+	if (vf_view_map_file(&view, path, false) != DATASTORE_VEC_IO_OK)
+		abort();
+	report("map_file", bytes, bench_now() - start);
+	start = bench_now();
+	float sum = 0;
+	for (size_t i = 0; i < view.size; i += 1024)
+		sum += view.data[i];
+	BENCH_KEEP(sum);
+	report("map_file first touch", bytes, bench_now() - start);
+	vf_view_free(&view);
+
+	start = bench_now();
+	if (vf_view_map_file(&view, path, true) != DATASTORE_VEC_IO_OK)
+		abort();
+	report("map_file (verify)", bytes, bench_now() - start);
+	vf_view_free(&view);
+
+	vf_free(&v);
+	close(fd);
+	unlink(path);
+	return 0;
+}
@@ -0,0 +1,107 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../parallel/parallel.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+#define STR_TRAIT(X) \
+	X(TYPE, char *) \
+	X(FREE, { free(*val); }) \
+	X(CLONE, { *new = strdup(*val); if (!*new) abort(); })
+
+DATASTORE_VEC(int, vi)
+DATASTORE_VEC_PARALLEL(INT_TRAIT, vi)
+DATASTORE_VEC_PAR_SORT(INT_TRAIT, vi)
+DATASTORE_VEC_IMPL(INT_TRAIT, vi)
+DATASTORE_VEC_PARALLEL_IMPL(INT_TRAIT, vi)
+DATASTORE_VEC_PAR_SORT_IMPL(INT_TRAIT, vi)
+DATASTORE_VEC(char *, vs)
+DATASTORE_VEC_PARALLEL(STR_TRAIT, vs)
+DATASTORE_VEC_IMPL(STR_TRAIT, vs)
+DATASTORE_VEC_PARALLEL_IMPL(STR_TRAIT, vs)
+
+static uint64_t g_state = 88172645463325252ull;
+static uint64_t next(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return g_state;
+}
+
+static int sum(int lhs, int rhs)
+{
+	return lhs + rhs;
+}
+
+// A few hundred cycles per element, so that the loop is compute bound
+static void churn(int *value, void *ctx)
+{
+	(void)ctx;
+	uint32_t x = (uint32_t)*value;
+	for (int i = 0; i < 64; ++i)
+		x = x * 1664525u + 1013904223u;
+	*value = (int)x;
+}
+
+#define TIME(label__, threads__, size__, setup__, expr__, base__) \
+	do { \
+		setup__; \
+		const double start = bench_now(); \
+		expr__; \
+		const double elapsed = bench_now() - start; \
+		if ((threads__) == 1) \
+			base__ = elapsed; \
+		printf("%-16s %3zu %10.3f ms %8.2f Melem/s %6.2fx\n", label__, (size_t)(threads__), elapsed * 1e3, \
+		       (double)(size__) / elapsed * 1e-6, base__ / elapsed); \
+	} while (0)
+
+/* Usage: bench-vec-parallel [max threads], defaults to the number of online processors */
+int main(int argc, char **argv)
+{
+	const long online = sysconf(_SC_NPROCESSORS_ONLN);
+	const size_t max_threads = argc >= 2 ? (size_t)atoi(argv[1]) : (online > 0 ? (size_t)online : 1);
+	const size_t n = 10000000;
+	int *source = malloc(n * sizeof(int));
+	if (!source)
+		abort();
+	for (size_t i = 0; i < n; ++i)
+		source[i] = (int)next();
+	struct vi v = vi_new(n);
+	v.size = n;
+	const size_t strings = 1000000;
+	struct vs s = vs_new(strings);
+	char buf[32];
+	for (size_t i = 0; i < strings; ++i)
+	{
+		snprintf(buf, sizeof(buf), "string-%llu", (unsigned long long)next());
+		vs_push(&s, strdup(buf));
+	}
+
+	double base_each = 0, base_reduce = 0, base_sort = 0, base_clone = 0;
+	printf("%-16s %3s\n", "", "thr");
+	for (size_t threads = 1; threads <= max_threads; ++threads)
+	{
+		struct datastore_pool *pool = datastore_pool_new(threads);
+		if (!pool)
+			abort();
+#define RESET_INTS memcpy(v.data, source, n * sizeof(int))
+		TIME("par_for_each", threads, n, RESET_INTS, vi_par_for_each(&v, pool, churn, NULL), base_each);
+		TIME("par_reduce", threads, n, RESET_INTS, BENCH_KEEP(vi_par_reduce(&v, pool, 0, sum)), base_reduce);
+		TIME("par_sort", threads, n, RESET_INTS, vi_par_sort(&v, pool), base_sort);
+		BENCH_KEEP(v.data[n / 2]);
+		struct vs copy;
+		TIME("par_clone str", threads, strings, , copy = vs_par_clone(&s, pool), base_clone);
+		BENCH_KEEP(copy.data[strings / 2]);
+		vs_free(&copy);
+		datastore_pool_free(pool);
+		putchar('\n');
+	}
+	vs_free(&s);
+	vi_free(&v);
+	free(source);
+	return 0;
+}
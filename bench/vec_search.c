@@ -0,0 +1,102 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../vector/vector_search.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+DATASTORE_VEC(int, vi)
+DATASTORE_VEC_SEARCH(INT_TRAIT, vi)
+DATASTORE_VEC_IMPL(INT_TRAIT, vi)
+DATASTORE_VEC_SEARCH_IMPL(INT_TRAIT, vi)
+
+#define QUERIES ((size_t)2000000)
+
+/* Classic binary search, branching on every comparison */
+static size_t branchy_lower_bound(const int *data, size_t size, int value)
+{
+	size_t lo = 0, hi = size;
+	while (lo < hi)
+	{
+		const size_t mid = lo + (hi - lo) / 2;
+		if (data[mid] < value)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static int cmp_int(const void *a, const void *b)
+{
+	const int x = *(const int *)a, y = *(const int *)b;
+	return (x > y) - (x < y);
+}
+
+#define TIME(label__, size__, body__) \
+	do { \
+		size_t checksum = 0; \
+		const double start = bench_now(); \
+		body__ \
+		const double elapsed = bench_now() - start; \
+		BENCH_KEEP(checksum); \
+		printf("%-20s %10zu %9.3f ms %8.1f ns/query\n", label__, (size_t)(size__), elapsed * 1e3, \
+		       elapsed * 1e9 / (double)QUERIES); \
+	} while (0)
+
+int main(void)
+{
+	static const size_t sizes[] = { 1000, 100000, 1000000, 10000000, 50000000 };
+	int *queries = malloc(QUERIES * sizeof(int));
+	size_t *out = malloc(QUERIES * sizeof(size_t));
+	if (!queries || !out)
+		abort();
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+	{
+		const size_t n = sizes[s];
+		struct vi v = vi_new(n);
+		for (size_t i = 0; i < n; ++i)
+			vi_push(&v, (int)(i * 3));
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (size_t i = 0; i < QUERIES; ++i)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			queries[i] = (int)(state % (n * 3));
+		}
+		struct vi_eytzinger e = vi_eytzinger_build(&v);
+		if (!e.data)
+			abort();
+
+		TIME("branchy", n, {
+			for (size_t i = 0; i < QUERIES; ++i)
+				checksum += branchy_lower_bound(v.data, n, queries[i]);
+		});
+		TIME("lower_bound", n, {
+			for (size_t i = 0; i < QUERIES; ++i)
+				checksum += vi_lower_bound(&v, queries[i]);
+		});
+		TIME("eytzinger", n, {
+			for (size_t i = 0; i < QUERIES; ++i)
+				checksum += vi_eytzinger_lower_bound(&e, queries[i]);
+		});
+		qsort(queries, QUERIES, sizeof(int), cmp_int);
+		TIME("lower_bound sorted", n, {
+			for (size_t i = 0; i < QUERIES; ++i)
+				checksum += vi_lower_bound(&v, queries[i]);
+		});
+		TIME("lower_bound_many", n, {
+			vi_lower_bound_many(&v, queries, QUERIES, out);
+			checksum += out[QUERIES / 2];
+		});
+		putchar('\n');
+		vi_eytzinger_free(&e);
+		vi_free(&v);
+	}
+	free(out);
+	free(queries);
+	return 0;
+}
@@ -0,0 +1,77 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../vector/vector_simd.h"
+
+/* Every case scans about this many elements in total, whatever the vector size */
+#define BENCH_ELEMENTS ((size_t)400000000)
+
+#define TIME(label__, n__, expr__) \
+	do { \
+		const size_t reps = BENCH_ELEMENTS / (n__) ? BENCH_ELEMENTS / (n__) : 1; \
+		const double start = bench_now(); \
+		for (size_t r = 0; r < reps; ++r) \
+		{ \
+			BENCH_KEEP(data); \
+			BENCH_KEEP(expr__); \
+		} \
+		const double elapsed = bench_now() - start; \
+		printf("%-12s %10zu %9.3f ms %8.2f Gelem/s\n", label__, (size_t)(n__), \
+		       elapsed * 1e3, (double)reps * (double)(n__) / elapsed * 1e-9); \
+	} while (0)
+
+#if DATASTORE_SIMD_X86
+	#define CASES(op__, suffix__, n__, ...) \
+		do { \
+			TIME(#op__ "_" #suffix__ " scalar", n__, datastore_simd_##op__##_##suffix__##_scalar(__VA_ARGS__)); \
+			TIME(#op__ "_" #suffix__ " sse2", n__, datastore_simd_##op__##_##suffix__##_SSE2(__VA_ARGS__)); \
+			if (datastore_simd_has_avx2()) \
+				TIME(#op__ "_" #suffix__ " avx2", n__, datastore_simd_##op__##_##suffix__##_AVX2(__VA_ARGS__)); \
+		} while (0)
+#else
+	#define CASES(op__, suffix__, n__, ...) \
+		TIME(#op__ "_" #suffix__ " scalar", n__, datastore_simd_##op__##_##suffix__##_scalar(__VA_ARGS__))
+#endif
+
+int main(void)
+{
+	static const size_t sizes[] = { 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+	{
+		const size_t n = sizes[s];
+		{
+			int *data = malloc(n * sizeof(int));
+			if (!data)
+				abort();
+			for (size_t i = 0; i < n; ++i)
+				data[i] = (int)(i * 2654435761u % 1000000);
+			// Searches for an absent value, so that the whole vector is scanned
+			CASES(find, i32, n, data, n, -1);
+			CASES(count, i32, n, data, n, 7);
+			CASES(min, i32, n, data, n);
+			CASES(sum, i32, n, data, n);
+			free(data);
+		}
+		{
+			float *data = malloc(n * sizeof(float));
+			if (!data)
+				abort();
+			for (size_t i = 0; i < n; ++i)
+				data[i] = (float)(i % 1000);
+			CASES(max, f32, n, data, n);
+			CASES(sum, f32, n, data, n);
+			free(data);
+		}
+		{
+			char *data = malloc(n);
+			if (!data)
+				abort();
+			for (size_t i = 0; i < n; ++i)
+				data[i] = (char)('a' + i % 26);
+			CASES(find, i8, n, data, n, '\n');
+			CASES(sum, i8, n, data, n);
+			free(data);
+		}
+		putchar('\n');
+	}
+	return 0;
+}
@@ -0,0 +1,110 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../vector/vector_sort.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(KIND, INT) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+struct record
+{
+	int64_t key;
+	char payload[24];
+};
+#define RECORD_TRAIT(X) \
+	X(TYPE, struct record) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (lhs->key > rhs->key) - (lhs->key < rhs->key); })
+
+DATASTORE_VEC(int, vi)
+DATASTORE_VEC_SORT(INT_TRAIT, vi)
+DATASTORE_VEC_RADIX_SORT(INT_TRAIT, vi)
+DATASTORE_VEC_IMPL(INT_TRAIT, vi)
+DATASTORE_VEC_SORT_IMPL(INT_TRAIT, vi)
+DATASTORE_VEC_RADIX_SORT_IMPL(INT_TRAIT, vi)
+DATASTORE_VEC(struct record, vr)
+DATASTORE_VEC_SORT(RECORD_TRAIT, vr)
+DATASTORE_VEC_IMPL(RECORD_TRAIT, vr)
+DATASTORE_VEC_SORT_IMPL(RECORD_TRAIT, vr)
+
+static int cmp_int(const void *a, const void *b)
+{
+	const int x = *(const int *)a, y = *(const int *)b;
+	return (x > y) - (x < y);
+}
+
+static int cmp_record(const void *a, const void *b)
+{
+	const int64_t x = ((const struct record *)a)->key, y = ((const struct record *)b)->key;
+	return (x > y) - (x < y);
+}
+
+static uint64_t record_key(const struct record *value)
+{
+	return datastore_sort_key_i64(value->key);
+}
+
+static uint64_t g_state = 88172645463325252ull;
+static uint64_t next(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return g_state;
+}
+
+#define TIME(label__, size__, setup__, expr__) \
+	do { \
+		setup__; \
+		const double start = bench_now(); \
+		expr__; \
+		const double elapsed = bench_now() - start; \
+		printf("%-22s %10zu %10.3f ms %8.2f Melem/s\n", label__, (size_t)(size__), elapsed * 1e3, \
+		       (double)(size__) / elapsed * 1e-6); \
+	} while (0)
+
+int main(void)
+{
+	static const size_t sizes[] = { 1000, 100000, 1000000, 10000000 };
+	struct datastore_sort_scratch scratch = { NULL, 0 };
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+	{
+		const size_t n = sizes[s];
+		int *source = malloc(n * sizeof(int));
+		if (!source)
+			abort();
+		for (size_t i = 0; i < n; ++i)
+			source[i] = (int)next();
+		struct vi v = vi_new(n);
+		v.size = n;
+#define RESET_INTS memcpy(v.data, source, n * sizeof(int))
+		TIME("int qsort", n, RESET_INTS, qsort(v.data, n, sizeof(int), cmp_int));
+		TIME("int pdqsort", n, RESET_INTS, vi_sort(&v));
+		TIME("int radix_sort", n, RESET_INTS, vi_radix_sort(&v, &scratch));
+		TIME("int pdqsort (sorted)", n, , vi_sort(&v));
+		BENCH_KEEP(v.data[n / 2]);
+		vi_free(&v);
+		free(source);
+
+		struct vr r = vr_new(n);
+		r.size = n;
+		struct record *records = malloc(n * sizeof(struct record));
+		if (!records)
+			abort();
+		for (size_t i = 0; i < n; ++i)
+			records[i] = (struct record){ .key = (int64_t)next(), .payload = { 0 } };
+#define RESET_RECORDS memcpy(r.data, records, n * sizeof(struct record))
+		TIME("record qsort", n, RESET_RECORDS, qsort(r.data, n, sizeof(struct record), cmp_record));
+		TIME("record pdqsort", n, RESET_RECORDS, vr_sort(&r));
+		TIME("record sort_by_key", n, RESET_RECORDS, vr_sort_by_key(&r, record_key, &scratch));
+		BENCH_KEEP(r.data[n / 2]);
+		vr_free(&r);
+		free(records);
+		putchar('\n');
+	}
+	datastore_sort_scratch_free(&scratch);
+	return 0;
+}
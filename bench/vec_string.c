@@ -0,0 +1,112 @@
+#define _GNU_SOURCE
+#include "bench.h"
+#include "../vector/vector_string.h"
+
+DATASTORE_VEC(char, sbuf)
+DATASTORE_VEC_STRING(sbuf)
+DATASTORE_VEC_IMPL(DATASTORE_VEC_STRING_TRAIT, sbuf)
+DATASTORE_VEC_STRING_IMPL(sbuf)
+DATASTORE_STR(str)
+DATASTORE_STR_IMPL(str)
+
+#define LINES ((size_t)1000000)
+
+static const char *const keys[] = { "request", "latency_ms", "bytes_sent", "status", "upstream_host" };
+
+static uint64_t next(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/* Appends one character at a time, like the `concat` example of vector.h */
+static void push_cstr(struct sbuf *sb, const char *cstr)
+{
+	for (size_t i = 0; cstr[i]; ++i)
+		sbuf_push(sb, cstr[i]);
+}
+
+#define TIME(label__, body__) \
+	do { \
+		size_t checksum = 0; \
+		uint64_t state = 0x9E3779B97F4A7C15ull; \
+		const double start = bench_now(); \
+		body__ \
+		const double elapsed = bench_now() - start; \
+		BENCH_KEEP(checksum); \
+		printf("%-24s %9.3f ms %8.1f ns/line\n", label__, elapsed * 1e3, elapsed * 1e9 / (double)LINES); \
+	} while (0)
+
+int main(void)
+{
+	char tmp[64];
+
+	/* A log line: `key=<u64> key=<f64> ...`, formatted into a reused buffer */
+	TIME("push + snprintf", {
+		struct sbuf sb = sbuf_new(0);
+		for (size_t line = 0; line < LINES; ++line)
+		{
+			sb.size = 0;
+			for (size_t k = 0; k < 5; ++k)
+			{
+				push_cstr(&sb, keys[k]);
+				sbuf_push(&sb, '=');
+				const uint64_t value = next(&state) >> (next(&state) % 48);
+				if (k & 1)
+					snprintf(tmp, sizeof(tmp), "%.3f", (double)value * 1e-3);
+				else
+					snprintf(tmp, sizeof(tmp), "%llu", (unsigned long long)value);
+				push_cstr(&sb, tmp);
+				sbuf_push(&sb, ' ');
+			}
+			checksum += sb.size;
+		}
+		sbuf_free(&sb);
+	});
+	TIME("append", {
+		struct sbuf sb = sbuf_new(0);
+		for (size_t line = 0; line < LINES; ++line)
+		{
+			sb.size = 0;
+			for (size_t k = 0; k < 5; ++k)
+			{
+				sbuf_append_cstr(&sb, keys[k]);
+				sbuf_append_char(&sb, '=');
+				const uint64_t value = next(&state) >> (next(&state) % 48);
+				if (k & 1)
+					sbuf_append_f64(&sb, (double)value * 1e-3, 3);
+				else
+					sbuf_append_u64(&sb, value);
+				sbuf_append_char(&sb, ' ');
+			}
+			checksum += sb.size;
+		}
+		sbuf_free(&sb);
+	});
+
+	/* Short keys built from scratch, then released */
+	TIME("short heap strings", {
+		for (size_t line = 0; line < LINES; ++line)
+		{
+			struct sbuf sb = sbuf_new(0);
+			sbuf_append_cstr(&sb, keys[line % 5]);
+			sbuf_append_u64(&sb, next(&state) % 100000);
+			char *cstr = sbuf_into_cstr(&sb);
+			checksum += (unsigned char)cstr[0];
+			free(cstr);
+		}
+	});
+	TIME("short inline strings", {
+		for (size_t line = 0; line < LINES; ++line)
+		{
+			struct str s = str_new();
+			str_append_cstr(&s, keys[line % 5]);
+			str_append_u64(&s, next(&state) % 100000);
+			checksum += (unsigned char)str_cstr(&s)[0] + str_is_inline(&s);
+			str_free(&s);
+		}
+	});
+	return 0;
+}
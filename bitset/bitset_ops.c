@@ -0,0 +1,160 @@
+#include "test.h"
+
+DATASTORE_BITSET_IMPL_S(bits, SETTINGS)
+
+static uint64_t g_state = 0x9E3779B97F4A7C15ull;
+static uint64_t next_u64(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return g_state;
+}
+
+// Bitset with each bit set with probability 1/`sparsity`, mirrored in `flags`
+static bits random_bits(size_t size, unsigned sparsity, unsigned char *flags)
+{
+	bits b = bits_new(size);
+	for (size_t i = 0; i < size; ++i)
+	{
+		flags[i] = next_u64() % sparsity == 0;
+		bits_assign(&b, i, flags[i]);
+	}
+	return b;
+}
+
+// Compares a bitset to its mirror
+static int matches(const bits *b, const unsigned char *flags)
+{
+	int ok = 1;
+	for (size_t i = 0; i < b->size; ++i)
+		ok &= bits_test(b, i) == flags[i];
+	return ok;
+}
+
+TESTS(bitset_ops, {
+	TEST("set clear test", {
+		bits b = bits_new(130);
+		ASSERT(b.words.size == 3)
+		bits_set(&b, 0);
+		bits_set(&b, 64);
+		bits_set(&b, 129);
+		ASSERT(bits_test(&b, 0) && bits_test(&b, 64) && bits_test(&b, 129))
+		ASSERT(!bits_test(&b, 1) && !bits_test(&b, 128))
+		bits_clear(&b, 64);
+		ASSERT(!bits_test(&b, 64))
+		bits_assign(&b, 5, true);
+		bits_assign(&b, 0, false);
+		ASSERT(bits_test(&b, 5) && !bits_test(&b, 0))
+		ASSERT(bits_count(&b) == 2)
+		bits_fill(&b, true);
+		ASSERT(bits_count(&b) == 130)
+		// Bits past the size stay clear
+		ASSERT(b.words.data[2] == 3)
+		bits_free(&b);
+	})
+	TEST("resize", {
+		bits b = bits_new(0);
+		ASSERT(bits_count(&b) == 0)
+		bits_resize(&b, 100);
+		bits_fill(&b, true);
+		bits_resize(&b, 70);
+		ASSERT(bits_count(&b) == 70)
+		bits_resize(&b, 200);
+		ASSERT(bits_count(&b) == 70)
+		ASSERT(!bits_test(&b, 70) && !bits_test(&b, 199))
+		bits c = bits_clone(&b);
+		bits_free(&b);
+		ASSERT(bits_count(&c) == 70)
+		bits_free(&c);
+	})
+	TEST("bulk", {
+		int ok = 1;
+		// Sizes around the vector widths and the unrolled loop
+		for (size_t size = 0; size < 1100; size += 37)
+		{
+			unsigned char *fa = malloc(size + 1), *fb = malloc(size + 1), *expected = malloc(size + 1);
+			if (!fa || !fb || !expected)
+				abort();
+			bits a = random_bits(size, 2, fa);
+			bits b = random_bits(size, 3, fb);
+			bits r = bits_clone(&a);
+			bits_and(&r, &b);
+			for (size_t i = 0; i < size; ++i)
+				expected[i] = fa[i] & fb[i];
+			ok &= matches(&r, expected);
+			bits_free(&r);
+			r = bits_clone(&a);
+			bits_or(&r, &b);
+			for (size_t i = 0; i < size; ++i)
+				expected[i] = fa[i] | fb[i];
+			ok &= matches(&r, expected);
+			bits_free(&r);
+			r = bits_clone(&a);
+			bits_xor(&r, &b);
+			for (size_t i = 0; i < size; ++i)
+				expected[i] = fa[i] ^ fb[i];
+			ok &= matches(&r, expected);
+			bits_free(&r);
+			r = bits_clone(&a);
+			bits_andnot(&r, &b);
+			size_t count = 0;
+			for (size_t i = 0; i < size; ++i)
+			{
+				expected[i] = fa[i] & !fb[i];
+				count += expected[i];
+			}
+			ok &= matches(&r, expected);
+			ok &= bits_count(&r) == count;
+			bits_free(&r);
+			bits_free(&a);
+			bits_free(&b);
+			free(fa);
+			free(fb);
+			free(expected);
+		}
+		ASSERT(ok)
+	})
+	TEST("kernels", {
+		uint64_t a[67], b[67], scalar[67], dispatched[67];
+		for (size_t i = 0; i < 67; ++i)
+		{
+			a[i] = next_u64();
+			b[i] = next_u64();
+		}
+		int ok = 1;
+		for (size_t n = 0; n <= 67; ++n)
+		{
+			datastore_simd_andnot_u64_scalar(scalar, a, b, n);
+			datastore_simd_andnot_u64(dispatched, a, b, n);
+			ok &= memcmp(scalar, dispatched, n * sizeof(uint64_t)) == 0;
+			datastore_simd_xor_u64_scalar(scalar, a, b, n);
+			datastore_simd_xor_u64(dispatched, a, b, n);
+			ok &= memcmp(scalar, dispatched, n * sizeof(uint64_t)) == 0;
+			ok &= datastore_simd_popcount_u64(a, n) == datastore_simd_popcount_u64_scalar(a, n);
+		}
+		ASSERT(ok)
+	})
+	TEST("next set", {
+		unsigned char flags[1000];
+		bits b = random_bits(1000, 50, flags);
+		size_t expected = 0;
+		int ok = 1;
+		for (size_t i = bits_next_set(&b, 0); i < b.size; i = bits_next_set(&b, i + 1))
+		{
+			while (!flags[expected])
+				++expected;
+			ok &= i == expected++;
+		}
+		while (expected < 1000)
+			ok &= !flags[expected++];
+		ASSERT(ok)
+		ASSERT(bits_next_set(&b, 1000) == 1000)
+		bits_free(&b);
+		b = bits_new(300);
+		ASSERT(bits_next_set(&b, 0) == 300)
+		bits_set(&b, 299);
+		ASSERT(bits_next_set(&b, 3) == 299)
+		bits_free(&b);
+	})
+})
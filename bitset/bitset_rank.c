@@ -0,0 +1,73 @@
+#include "test.h"
+
+static uint32_t g_seed = 4242;
+static uint32_t next_u32(void)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return g_seed >> 8;
+}
+
+// Checks rank and select against a linear scan
+static int check_rank_select(bits *b)
+{
+	bits_build_rank(b);
+	int ok = 1;
+	size_t rank = 0;
+	for (size_t i = 0; i < b->size; ++i)
+	{
+		ok &= bits_rank(b, i) == rank;
+		if (bits_test(b, i))
+			ok &= bits_select(b, rank++) == i;
+	}
+	ok &= bits_rank(b, b->size) == rank;
+	ok &= bits_select(b, rank) == b->size;
+	return ok;
+}
+
+TESTS(bitset_rank, {
+	TEST("empty", {
+		bits b = bits_new(0);
+		ASSERT(check_rank_select(&b))
+		bits_free(&b);
+		b = bits_new(1024);
+		ASSERT(check_rank_select(&b))
+		bits_free(&b);
+	})
+	TEST("dense", {
+		bits b = bits_new(1000);
+		bits_fill(&b, true);
+		ASSERT(check_rank_select(&b))
+		bits_free(&b);
+	})
+	TEST("random", {
+		int ok = 1;
+		const size_t sizes[] = { 1, 63, 64, 65, 511, 512, 513, 4096, 5000 };
+		for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+		{
+			for (unsigned sparsity = 1; sparsity < 200; sparsity *= 7)
+			{
+				bits b = bits_new(sizes[s]);
+				for (size_t i = 0; i < sizes[s]; ++i)
+					if (next_u32() % sparsity == 0)
+						bits_set(&b, i);
+				ok &= check_rank_select(&b);
+				bits_free(&b);
+			}
+		}
+		ASSERT(ok)
+	})
+	TEST("rebuild", {
+		bits b = bits_new(2000);
+		bits_set(&b, 10);
+		bits_build_rank(&b);
+		ASSERT(bits_rank(&b, 2000) == 1)
+		bits_set(&b, 1500);
+		bits_build_rank(&b);
+		ASSERT(bits_rank(&b, 2000) == 2)
+		ASSERT(bits_select(&b, 1) == 1500)
+		bits c = bits_clone(&b);
+		bits_free(&b);
+		ASSERT(bits_select(&c, 0) == 10)
+		bits_free(&c);
+	})
+})
@@ -0,0 +1,19 @@
+#ifndef DATASTORE_BITSET_TEST_H
+#define DATASTORE_BITSET_TEST_H
+
+#include "../tests/tests.h"
+#include "bitset.h"
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+DATASTORE_BITSET(bits)
+typedef struct bits bits;
+
+extern const unit_test test_bitset_ops;
+extern const unit_test test_bitset_rank;
+
+#endif // DATASTORE_BITSET_TEST_H
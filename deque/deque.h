@@ -0,0 +1,334 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_DEQUE_H
+#define DATASTORE_DEQUE_H
+
+#include "../vector/vector.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file deque.h
+ * @defgroup Deque DATASTORE_DEQUE: Double-ended queue
+ *
+ * @brief Double-ended queue on a circular buffer
+ *
+ * The deque stores its elements in a circular buffer whose capacity is a power of two, so the
+ * position of an element is `(head + index) & (capacity - 1)`. Pushing and popping at either
+ * end is O(1), removing from the front does not move the other elements.
+ *
+ * When the buffer is full, it grows with the `GROW` and `REALLOC` settings (see
+ * @ref advanced_usage "Advanced Usage"), the new capacity being rounded up to a power of two.
+ * If the elements wrapped around the end of the old buffer, the shorter of the two parts is then
+ * moved with a single `memcpy`: growing copies the elements at most twice, once in `REALLOC` and
+ * once to unwrap.
+ *
+ * The elements are in at most two contiguous spans, returned by `spans` for loops that work on
+ * arrays (e.g. the kernels of @ref VectorSimd "vector_simd.h").
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define INT_TRAIT(X) \
+ * 	X(TYPE, int) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; })
+ *
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_DEQUE(int, ints)
+ * // Methods definition (in the .c)
+ * DATASTORE_DEQUE_IMPL(INT_TRAIT, ints)
+ *
+ * struct ints work = ints_new(0);
+ * ints_push_back(&work, 1);
+ * ints_push_front(&work, 0);
+ * while (work.size)
+ * 	process(ints_take_front(&work));
+ *
+ * struct ints_span spans[2];
+ * const size_t count = ints_spans(&work, spans);
+ * for (size_t i = 0; i < count; ++i)
+ * 	process_array(spans[i].data, spans[i].size);
+ * ints_free(&work);
+ * @endcode
+ *
+ * **Macro `DATASTORE_DEQUE(type, name)`**: Define a new deque type
+ *
+ * **Macro `DATASTORE_DEQUE_IMPL(trait, name)`** and
+ * **`DATASTORE_DEQUE_IMPL_S(trait, name, settings)`**: Implements methods for a deque type
+ *
+ * The resulting types will look like this:
+ * @code{.c}
+ * struct name {
+ *     type *data;
+ *     size_t capacity; // Zero or a power of two
+ *     size_t head; // Position of the first element
+ *     size_t size;
+ * };
+ * struct name_span {
+ *     type *data;
+ *     size_t size;
+ * };
+ * @endcode
+ *
+ * ## Exposed methods
+ *
+ * - `deque new(size_t capacity)`: Create a new deque with room for `capacity` elements
+ * - `void free(struct deque *self)`: Free the deque and its elements
+ * - `deque clone(const struct deque *self)`: Deep copy of the deque, its elements are contiguous
+ * - `void reserve(struct deque *self, size_t capacity)`: Make room for at least `capacity` elements
+ * - `void clear(struct deque *self)`: Free every element, the buffer is kept
+ * - `void push_back(struct deque *self, type value)`: Append an element
+ * - `void push_front(struct deque *self, type value)`: Prepend an element
+ * - `void pop_back(struct deque *self)`, `void pop_front(struct deque *self)`: Remove and free
+ *   the element at one end
+ * - `type take_back(struct deque *self)`, `type take_front(struct deque *self)`: Remove the
+ *   element at one end, and return it to the caller who now owns it
+ * - `type *at(const struct deque *self, size_t index)`: Pointer to element `index`, `0` being the
+ *   front
+ * - `type *front(const struct deque *self)`, `type *back(const struct deque *self)`: Pointer to
+ *   the element at one end
+ * - `size_t spans(const struct deque *self, struct span spans[2])`: Store the elements as at most
+ *   two contiguous spans, in order, and return their number
+ */
+
+/**
+ * @brief Smallest power of two at least `capacity` (and 1)
+ */
+static inline size_t datastore_deque_capacity(size_t capacity)
+{
+	size_t rounded = 1;
+	while (rounded < capacity)
+		rounded <<= 1;
+	return rounded;
+}
+
+/**
+ * @brief Deque type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the deque type
+ */
+#define DATASTORE_DEQUE(type__, name__) \
+struct name__ \
+{ \
+	type__ *data; \
+	size_t capacity; \
+	size_t head; \
+	size_t size; \
+}; \
+struct DATASTORE_IDENT(name__, span) \
+{ \
+	type__ *data; \
+	size_t size; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t capacity); \
+void DATASTORE_IDENT(name__, clear)(struct name__ *self); \
+void DATASTORE_IDENT(name__, push_back)(struct name__ *self, type__ value); \
+void DATASTORE_IDENT(name__, push_front)(struct name__ *self, type__ value); \
+void DATASTORE_IDENT(name__, pop_back)(struct name__ *self); \
+void DATASTORE_IDENT(name__, pop_front)(struct name__ *self); \
+type__ DATASTORE_IDENT(name__, take_back)(struct name__ *self); \
+type__ DATASTORE_IDENT(name__, take_front)(struct name__ *self); \
+type__ *DATASTORE_IDENT(name__, at)(const struct name__ *self, size_t index); \
+type__ *DATASTORE_IDENT(name__, front)(const struct name__ *self); \
+type__ *DATASTORE_IDENT(name__, back)(const struct name__ *self); \
+size_t DATASTORE_IDENT(name__, spans)(const struct name__ *self, struct DATASTORE_IDENT(name__, span) spans[2]);
+
+/**
+ * @brief Deque methods implementation
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the deque, must match the name passed to @ref DATASTORE_DEQUE
+ * @param settings__ Custom settings for the buffer, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_DEQUE_IMPL_S(trait__, name__, settings__) \
+/* Reallocates the buffer to `new_capacity` (a power of two), then unwraps the elements */ \
+static void DATASTORE_IDENT(name__, impl_resize)(struct name__ *self, size_t new_capacity) \
+{ \
+	assert(new_capacity > self->capacity); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->data; \
+	const size_t old_size = self->capacity * sizeof(*ptr); \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(new_capacity * sizeof(*ptr), align); \
+	size_t usable = size; \
+	DATASTORE_MAYBE_UNUSED(old_size); \
+	settings__(DATASTORE_VEC_SETTINGS_REALLOC) \
+	assert(usable >= size); \
+	assert(!align || ((uintptr_t)ptr & (align - 1)) == 0); \
+	DATASTORE_MAYBE_UNUSED(usable); \
+	const size_t old_capacity = self->capacity; \
+	self->data = ptr; \
+	self->capacity = new_capacity; \
+	if (self->head + self->size <= old_capacity) \
+		return; \
+	/* The capacity at least doubled: either part fits in the new space without overlapping */ \
+	const size_t front = old_capacity - self->head; \
+	const size_t wrapped = self->size - front; \
+	if (wrapped <= front) \
+		memcpy(ptr + old_capacity, ptr, wrapped * sizeof(*ptr)); \
+	else \
+	{ \
+		memcpy(ptr + new_capacity - front, ptr + self->head, front * sizeof(*ptr)); \
+		self->head = new_capacity - front; \
+	} \
+} \
+static void DATASTORE_IDENT(name__, impl_grow)(struct name__ *self) \
+{ \
+	const size_t capacity = self->capacity; \
+	const size_t elem_size = sizeof(*self->data); \
+	size_t new_capacity; \
+	DATASTORE_MAYBE_UNUSED(elem_size); \
+	settings__(DATASTORE_VEC_SETTINGS_GROW) \
+	assert(new_capacity > self->size); \
+	DATASTORE_IDENT(name__, impl_resize)(self, datastore_deque_capacity(new_capacity)); \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity) \
+{ \
+	struct name__ self = { .data = NULL }; \
+	DATASTORE_IDENT(name__, reserve)(&self, capacity); \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(name__, clear)(self); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->data; \
+	const size_t size = self->capacity * sizeof(*ptr); \
+	DATASTORE_MAYBE_UNUSED(size); \
+	if (ptr) \
+	{ \
+		settings__(DATASTORE_VEC_SETTINGS_FREE) \
+	} \
+	self->data = NULL; \
+	self->capacity = 0; \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	struct name__ clone = DATASTORE_IDENT(name__, new)(self->size); \
+	for (size_t i = 0; i < self->size; ++i) \
+	{ \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *val = DATASTORE_IDENT(name__, at)(self, i); \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *new = &clone.data[i]; \
+		trait__(DATASTORE_VEC_TRAIT_CLONE) \
+	} \
+	clone.size = self->size; \
+	return clone; \
+} \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t capacity) \
+{ \
+	if (capacity > self->capacity) \
+		DATASTORE_IDENT(name__, impl_resize)(self, datastore_deque_capacity(capacity)); \
+} \
+void DATASTORE_IDENT(name__, clear)(struct name__ *self) \
+{ \
+	for (size_t i = 0; i < self->size; ++i) \
+	{ \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *val = DATASTORE_IDENT(name__, at)(self, i); \
+		DATASTORE_MAYBE_UNUSED(val); \
+		trait__(DATASTORE_VEC_TRAIT_FREE) \
+	} \
+	self->head = 0; \
+	self->size = 0; \
+} \
+void DATASTORE_IDENT(name__, push_back)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	if (self->size == self->capacity) \
+		DATASTORE_IDENT(name__, impl_grow)(self); \
+	self->data[(self->head + self->size++) & (self->capacity - 1)] = value; \
+} \
+void DATASTORE_IDENT(name__, push_front)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	if (self->size == self->capacity) \
+		DATASTORE_IDENT(name__, impl_grow)(self); \
+	self->head = (self->head - 1) & (self->capacity - 1); \
+	self->data[self->head] = value; \
+	++self->size; \
+} \
+void DATASTORE_IDENT(name__, pop_back)(struct name__ *self) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value = DATASTORE_IDENT(name__, take_back)(self); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *val = &value; \
+	DATASTORE_MAYBE_UNUSED(val); \
+	trait__(DATASTORE_VEC_TRAIT_FREE) \
+} \
+void DATASTORE_IDENT(name__, pop_front)(struct name__ *self) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value = DATASTORE_IDENT(name__, take_front)(self); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *val = &value; \
+	DATASTORE_MAYBE_UNUSED(val); \
+	trait__(DATASTORE_VEC_TRAIT_FREE) \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, take_back)(struct name__ *self) \
+{ \
+	assert(self->size != 0); \
+	--self->size; \
+	return self->data[(self->head + self->size) & (self->capacity - 1)]; \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, take_front)(struct name__ *self) \
+{ \
+	assert(self->size != 0); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value = self->data[self->head]; \
+	self->head = (self->head + 1) & (self->capacity - 1); \
+	--self->size; \
+	return value; \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, at)(const struct name__ *self, size_t index) \
+{ \
+	assert(index < self->size); \
+	return &self->data[(self->head + index) & (self->capacity - 1)]; \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, front)(const struct name__ *self) \
+{ \
+	return DATASTORE_IDENT(name__, at)(self, 0); \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, back)(const struct name__ *self) \
+{ \
+	return DATASTORE_IDENT(name__, at)(self, self->size - 1); \
+} \
+size_t DATASTORE_IDENT(name__, spans)(const struct name__ *self, struct DATASTORE_IDENT(name__, span) spans[2]) \
+{ \
+	if (self->size == 0) \
+		return 0; \
+	const size_t front = self->capacity - self->head; \
+	spans[0].data = self->data + self->head; \
+	spans[0].size = self->size < front ? self->size : front; \
+	if (self->size <= front) \
+		return 1; \
+	spans[1].data = self->data; \
+	spans[1].size = self->size - front; \
+	return 2; \
+}
+
+/**
+ * @brief Deque methods implementation
+ *
+ * This macro will call @ref DATASTORE_DEQUE_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the deque, must match the name passed to @ref DATASTORE_DEQUE
+ */
+#define DATASTORE_DEQUE_IMPL(trait__, name__) \
+	DATASTORE_DEQUE_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup Deque */
+
+#endif // DATASTORE_DEQUE_H
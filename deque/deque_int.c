@@ -0,0 +1,112 @@
+#include "test.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_DEQUE(int, dqi)
+typedef struct dqi dqi;
+DATASTORE_DEQUE_IMPL_S(INT_TRAIT, dqi, SETTINGS)
+
+// Checks that the deque holds `first`, `first + 1`, ..., `first + size - 1`
+static int holds_range(const dqi *d, int first, size_t size)
+{
+	int ok = d->size == size;
+	for (size_t i = 0; ok && i < size; ++i)
+		ok &= *dqi_at(d, i) == first + (int)i;
+	return ok;
+}
+
+// Fills a deque of capacity 8 with 0 to 7, starting at position `head`
+static dqi wrapped_deque(size_t head)
+{
+	dqi d = dqi_new(8);
+	for (size_t i = 0; i < head; ++i)
+		dqi_push_back(&d, -1);
+	for (size_t i = 0; i < head; ++i)
+		dqi_pop_front(&d);
+	for (int i = 0; i < 8; ++i)
+		dqi_push_back(&d, i);
+	return d;
+}
+
+TESTS(deque_int, {
+	TEST("both ends", {
+		dqi d = dqi_new(0);
+		ASSERT(d.capacity == 0)
+		for (int i = 0; i < 100; ++i)
+		{
+			dqi_push_back(&d, i);
+			dqi_push_front(&d, -i - 1);
+		}
+		ASSERT(holds_range(&d, -100, 200))
+		ASSERT((d.capacity & (d.capacity - 1)) == 0)
+		ASSERT(*dqi_front(&d) == -100)
+		ASSERT(*dqi_back(&d) == 99)
+		ASSERT(dqi_take_front(&d) == -100)
+		ASSERT(dqi_take_back(&d) == 99)
+		dqi_pop_front(&d);
+		dqi_pop_back(&d);
+		ASSERT(holds_range(&d, -98, 196))
+		dqi_free(&d);
+	})
+	TEST("fifo", {
+		dqi d = dqi_new(4);
+		int ok = 1;
+		int next = 0;
+		// The window slides around the ring many times without growing
+		for (int i = 0; i < 1000; ++i)
+		{
+			dqi_push_back(&d, i);
+			if (d.size == 4)
+				ok &= dqi_take_front(&d) == next++;
+		}
+		ASSERT(ok)
+		ASSERT(d.capacity == 4)
+		ASSERT(holds_range(&d, next, 3))
+		dqi_free(&d);
+	})
+	TEST("grow unwraps", {
+		// Short front part: moved to the new end
+		dqi d = wrapped_deque(6);
+		dqi_push_back(&d, 8);
+		ASSERT(d.capacity == 16)
+		ASSERT(d.head == 14)
+		ASSERT(holds_range(&d, 0, 9))
+		dqi_free(&d);
+		// Short wrapped part: moved after the old end
+		d = wrapped_deque(2);
+		dqi_push_front(&d, -1);
+		ASSERT(d.capacity == 16)
+		ASSERT(d.head == 1)
+		ASSERT(holds_range(&d, -1, 9))
+		dqi_free(&d);
+	})
+	TEST("spans", {
+		dqi d = dqi_new(0);
+		struct dqi_span spans[2];
+		ASSERT(dqi_spans(&d, spans) == 0)
+		dqi_free(&d);
+		d = wrapped_deque(3);
+		ASSERT(dqi_spans(&d, spans) == 2)
+		ASSERT(spans[0].size == 5 && spans[0].data[0] == 0)
+		ASSERT(spans[1].size == 3 && spans[1].data[0] == 5)
+		dqi_pop_back(&d);
+		dqi_pop_back(&d);
+		dqi_pop_back(&d);
+		ASSERT(dqi_spans(&d, spans) == 1)
+		ASSERT(spans[0].size == 5)
+		dqi_free(&d);
+	})
+	TEST("reserve", {
+		dqi d = wrapped_deque(4);
+		dqi_reserve(&d, 20);
+		ASSERT(d.capacity == 32)
+		ASSERT(holds_range(&d, 0, 8))
+		dqi_reserve(&d, 3);
+		ASSERT(d.capacity == 32)
+		dqi_clear(&d);
+		ASSERT(d.size == 0)
+		dqi_free(&d);
+	})
+})
@@ -0,0 +1,52 @@
+#include "test.h"
+
+static char *dup(const char *s)
+{
+	const size_t len = strlen(s) + 1;
+	char *copy = iso_malloc(len);
+	if (!copy)
+		abort();
+	memcpy(copy, s, len);
+	return copy;
+}
+
+#define STR_TRAIT(X) \
+	X(TYPE, char *) \
+	X(FREE, { iso_free(*val); }) \
+	X(CLONE, { *new = dup(*val); })
+DATASTORE_DEQUE(char *, dqs)
+typedef struct dqs dqs;
+DATASTORE_DEQUE_IMPL_S(STR_TRAIT, dqs, SETTINGS)
+
+TESTS(deque_str, {
+	TEST("owned", {
+		dqs d = dqs_new(2);
+		dqs_push_back(&d, dup("b"));
+		dqs_push_front(&d, dup("a"));
+		dqs_push_back(&d, dup("c"));
+		dqs_push_front(&d, dup("z"));
+		dqs_pop_front(&d);
+		char *taken = dqs_take_back(&d);
+		ASSERT(strcmp(taken, "c") == 0)
+		iso_free(taken);
+		ASSERT(strcmp(*dqs_front(&d), "a") == 0)
+		ASSERT(strcmp(*dqs_back(&d), "b") == 0)
+		dqs_free(&d);
+	})
+	TEST("clone", {
+		dqs d = dqs_new(4);
+		dqs_push_back(&d, dup("x"));
+		dqs_push_back(&d, dup("y"));
+		dqs_pop_front(&d);
+		dqs_push_back(&d, dup("z"));
+		dqs_push_back(&d, dup("w"));
+		dqs_push_back(&d, dup("v"));
+		dqs c = dqs_clone(&d);
+		dqs_free(&d);
+		ASSERT(c.size == 4)
+		ASSERT(c.head == 0)
+		ASSERT(strcmp(c.data[0], "y") == 0)
+		ASSERT(strcmp(c.data[3], "v") == 0)
+		dqs_free(&c);
+	})
+})
@@ -0,0 +1,13 @@
+#include "test.h"
+
+int
+main(int argc, char** argv)
+{
+	const char* filter = NULL;
+	int id_filter = -1;
+	if (argc >= 2)
+		filter = argv[1];
+	if (argc >= 3)
+		id_filter = atoi(argv[2]);
+	run_tests(filter, id_filter, (unit_test[]){ test_deque_int, test_deque_str }, 2);
+}
@@ -0,0 +1,409 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_FLAT_MAP_H
+#define DATASTORE_FLAT_MAP_H
+
+#include "../vector/vector.h"
+#include "../vector/vector_sort.h"
+
+#include <stdbool.h>
+
+/**
+ * @file flat_map.h
+ * @defgroup FlatMap DATASTORE_FLAT_MAP: Ordered map on sorted arrays
+ *
+ * @brief Ordered map on sorted arrays
+ *
+ * An ordered map for read-mostly workloads. Keys and values are kept in two sorted
+ * @ref DATASTORE_VEC buffers: lookups are binary searches over contiguous keys, and iterating
+ * in key order walks two arrays, where a tree allocates a node per element and chases pointers.
+ *
+ * Single inserts go to a small unsorted buffer of at most @ref DATASTORE_FLAT_MAP_PENDING
+ * entries, which lookups scan linearly. When it is full, or on `flush`,
+ * it is sorted and merged into the sorted arrays in `O(n + m)`. Batches are inserted the same way
+ * with `insert_many`, so inserting `m` keys costs `O(m log m + n)` instead of `m` shifts of the
+ * arrays.
+ *
+ * The map owns its keys and values: they are released with the `FREE` entries of their traits,
+ * and copied with the `CLONE` entries. The key trait must also declare a `CMP` (see
+ * @ref trait_type "Trait Type").
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define STR_TRAIT(X) \
+ * 	X(TYPE, char *) \
+ * 	X(FREE, { free(*val); }) \
+ * 	X(CLONE, { *new = strdup(*val); }) \
+ * 	X(CMP, { cmp = strcmp(*lhs, *rhs); })
+ * #define INT_TRAIT(X) \
+ * 	X(TYPE, int) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; })
+ *
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_FLAT_MAP(char *, int, ages)
+ * // Methods definition (in the .c)
+ * DATASTORE_FLAT_MAP_IMPL(STR_TRAIT, INT_TRAIT, ages)
+ *
+ * struct ages m = ages_new(0);
+ * ages_insert(&m, strdup("bob"), 42);
+ * ages_insert(&m, strdup("alice"), 37);
+ * int *age = ages_get(&m, "bob"); // *age == 42
+ * ages_flush(&m);
+ * for (size_t i = 0; i < m.keys.size; ++i)
+ * 	printf("%s: %d\n", m.keys.data[i], m.values.data[i]); // alice, then bob
+ * ages_free(&m);
+ * @endcode
+ *
+ * **Macro `DATASTORE_FLAT_MAP(key_type, value_type, name)`**: Define a new flat map type
+ *
+ * **Macro `DATASTORE_FLAT_MAP_IMPL(key_trait, value_trait, name)`** and
+ * **`DATASTORE_FLAT_MAP_IMPL_S(key_trait, value_trait, name, settings)`**: Implements methods for
+ * a flat map type, see @ref trait_type "Trait Type" and @ref advanced_usage "Advanced Usage"
+ *
+ * The resulting type will look like this:
+ * @code{.c}
+ * struct name {
+ *     struct name_keys keys; // DATASTORE_VEC(key_type, name_keys), sorted
+ *     struct name_values values; // DATASTORE_VEC(value_type, name_values)
+ *     struct name_keys pending_keys; // Unsorted insert buffer
+ *     struct name_values pending_values;
+ *     struct name_order order; // Merge scratch
+ * };
+ * @endcode
+ * Once flushed, `keys.data[i]` and `values.data[i]` are the `i`-th entry in key order.
+ *
+ * ## Exposed methods
+ *
+ * - `map new(size_t capacity)`: Create a new map with room for `capacity` entries
+ * - `void free(struct map *self)`: Free the map, its keys and its values
+ * - `map clone(const struct map *self)`: Deep copy of the map
+ * - `size_t size(const struct map *self)`: Number of entries
+ * - `value_type *get(const struct map *self, key_type key)`: Value of `key`, `NULL` if there is
+ *   none. The pointer is valid until the map is modified
+ * - `bool contains(const struct map *self, key_type key)`: Whether the map holds `key`
+ * - `void insert(struct map *self, key_type key, value_type value)`: Insert or replace an entry,
+ *   the map takes ownership of `key` and `value`. When `key` is already present, the old value
+ *   and the new key are freed
+ * - `void insert_many(struct map *self, key_type const *keys, value_type const *values, size_t
+ *   count)`: Insert or replace `count` entries with a single sort and merge, the map takes
+ *   ownership of the elements. Among equal keys of the batch, the last one wins
+ * - `bool remove(struct map *self, key_type key)`: Remove and free an entry, returns whether it
+ *   was present
+ * - `void flush(struct map *self)`: Merge the insert buffer into the sorted arrays
+ * - `size_t lower_bound(const struct map *self, key_type key)`: Index in the sorted arrays of
+ *   the first key not lower than `key`, the map must be flushed
+ */
+
+/**
+ * @brief Number of entries the insert buffer holds before being merged
+ */
+#ifndef DATASTORE_FLAT_MAP_PENDING
+	#define DATASTORE_FLAT_MAP_PENDING 32
+#endif
+
+/* Merges sort pointers to the pending keys */
+#define DATASTORE_FLAT_MAP_ORDER_TRAIT(X) \
+	X(TYPE, void *) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+/**
+ * @brief Flat map type definition and methods declaration
+ *
+ * @param key_type__ Type of the keys
+ * @param value_type__ Type of the values
+ * @param name__ Name of the map type
+ */
+#define DATASTORE_FLAT_MAP(key_type__, value_type__, name__) \
+DATASTORE_VEC(key_type__, DATASTORE_IDENT(name__, keys)) \
+DATASTORE_VEC(value_type__, DATASTORE_IDENT(name__, values)) \
+DATASTORE_VEC(void *, DATASTORE_IDENT(name__, order)) \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, keys) keys; \
+	struct DATASTORE_IDENT(name__, values) values; \
+	struct DATASTORE_IDENT(name__, keys) pending_keys; \
+	struct DATASTORE_IDENT(name__, values) pending_values; \
+	struct DATASTORE_IDENT(name__, order) order; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self); \
+value_type__ *DATASTORE_IDENT(name__, get)(const struct name__ *self, key_type__ key); \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, key_type__ key); \
+void DATASTORE_IDENT(name__, insert)(struct name__ *self, key_type__ key, value_type__ value); \
+void DATASTORE_IDENT(name__, insert_many)(struct name__ *self, key_type__ const *keys, \
+	value_type__ const *values, size_t count); \
+bool DATASTORE_IDENT(name__, remove)(struct name__ *self, key_type__ key); \
+void DATASTORE_IDENT(name__, flush)(struct name__ *self); \
+size_t DATASTORE_IDENT(name__, lower_bound)(const struct name__ *self, key_type__ key);
+
+/**
+ * @brief Flat map methods implementation
+ *
+ * @param key_trait__ Type-trait for the keys, must declare a `CMP`
+ * @param value_trait__ Type-trait for the values, see @ref trait_type "Trait Type"
+ * @param name__ Name of the map, must match the name passed to @ref DATASTORE_FLAT_MAP
+ * @param settings__ Vector settings for all buffers, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_FLAT_MAP_IMPL_S(key_trait__, value_trait__, name__, settings__) \
+DATASTORE_VEC_IMPL_S(key_trait__, DATASTORE_IDENT(name__, keys), settings__) \
+DATASTORE_VEC_IMPL_S(value_trait__, DATASTORE_IDENT(name__, values), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_FLAT_MAP_ORDER_TRAIT, DATASTORE_IDENT(name__, order), settings__) \
+static inline int DATASTORE_IDENT(name__, impl_cmp)(key_trait__(DATASTORE_VEC_TRAIT_TYPE) const *lhs, \
+	key_trait__(DATASTORE_VEC_TRAIT_TYPE) const *rhs) \
+{ \
+	int cmp = 0; \
+	key_trait__(DATASTORE_VEC_TRAIT_CMP) \
+	return cmp; \
+} \
+static inline void DATASTORE_IDENT(name__, impl_free_key)(key_trait__(DATASTORE_VEC_TRAIT_TYPE) *val) \
+{ \
+	DATASTORE_MAYBE_UNUSED(val); \
+	key_trait__(DATASTORE_VEC_TRAIT_FREE) \
+} \
+static inline void DATASTORE_IDENT(name__, impl_free_value)(value_trait__(DATASTORE_VEC_TRAIT_TYPE) *val) \
+{ \
+	DATASTORE_MAYBE_UNUSED(val); \
+	value_trait__(DATASTORE_VEC_TRAIT_FREE) \
+} \
+/* Pending keys sort by key, then by insertion order */ \
+static inline bool DATASTORE_IDENT(name__, impl_order_less)(void *const *lhs, void *const *rhs) \
+{ \
+	const int cmp = DATASTORE_IDENT(name__, impl_cmp)(*lhs, *rhs); \
+	return cmp < 0 || (cmp == 0 && (char *)*lhs < (char *)*rhs); \
+} \
+DATASTORE_PDQSORT(DATASTORE_IDENT(name__, impl_order_sort), void *, DATASTORE_IDENT(name__, impl_order_less)) \
+/* Index of the first sorted key not lower than `key` */ \
+static inline size_t DATASTORE_IDENT(name__, impl_search)(const struct name__ *self, \
+	key_trait__(DATASTORE_VEC_TRAIT_TYPE) const *key) \
+{ \
+	key_trait__(DATASTORE_VEC_TRAIT_TYPE) const *data = self->keys.data; \
+	size_t base = 0; \
+	size_t size = self->keys.size; \
+	while (size > 1) \
+	{ \
+		const size_t half = size / 2; \
+		base = DATASTORE_IDENT(name__, impl_cmp)(data + base + half - 1, key) < 0 ? base + half : base; \
+		size -= half; \
+	} \
+	return base + (size == 1 && DATASTORE_IDENT(name__, impl_cmp)(data + base, key) < 0); \
+} \
+/* Position of `key` in the pending buffer, its size if absent */ \
+static inline size_t DATASTORE_IDENT(name__, impl_find_pending)(const struct name__ *self, \
+	key_trait__(DATASTORE_VEC_TRAIT_TYPE) const *key) \
+{ \
+	size_t i = 0; \
+	while (i < self->pending_keys.size && DATASTORE_IDENT(name__, impl_cmp)(self->pending_keys.data + i, key) != 0) \
+		++i; \
+	return i; \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity) \
+{ \
+	return (struct name__){ \
+		.keys = DATASTORE_IDENT(DATASTORE_IDENT(name__, keys), new)(capacity), \
+		.values = DATASTORE_IDENT(DATASTORE_IDENT(name__, values), new)(capacity), \
+		.pending_keys = DATASTORE_IDENT(DATASTORE_IDENT(name__, keys), new)(0), \
+		.pending_values = DATASTORE_IDENT(DATASTORE_IDENT(name__, values), new)(0), \
+		.order = DATASTORE_IDENT(DATASTORE_IDENT(name__, order), new)(0), \
+	}; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, keys), free)(&self->keys); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), free)(&self->values); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, keys), free)(&self->pending_keys); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), free)(&self->pending_values); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, order), free)(&self->order); \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	return (struct name__){ \
+		.keys = DATASTORE_IDENT(DATASTORE_IDENT(name__, keys), clone)(&self->keys), \
+		.values = DATASTORE_IDENT(DATASTORE_IDENT(name__, values), clone)(&self->values), \
+		.pending_keys = DATASTORE_IDENT(DATASTORE_IDENT(name__, keys), clone)(&self->pending_keys), \
+		.pending_values = DATASTORE_IDENT(DATASTORE_IDENT(name__, values), clone)(&self->pending_values), \
+		.order = DATASTORE_IDENT(DATASTORE_IDENT(name__, order), new)(0), \
+	}; \
+} \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self) \
+{ \
+	return self->keys.size + self->pending_keys.size; \
+} \
+value_trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, get)(const struct name__ *self, \
+	key_trait__(DATASTORE_VEC_TRAIT_TYPE) key) \
+{ \
+	const size_t index = DATASTORE_IDENT(name__, impl_search)(self, &key); \
+	if (index < self->keys.size && DATASTORE_IDENT(name__, impl_cmp)(self->keys.data + index, &key) == 0) \
+		return self->values.data + index; \
+	const size_t pending = DATASTORE_IDENT(name__, impl_find_pending)(self, &key); \
+	return pending < self->pending_keys.size ? self->pending_values.data + pending : NULL; \
+} \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, key_trait__(DATASTORE_VEC_TRAIT_TYPE) key) \
+{ \
+	return DATASTORE_IDENT(name__, get)(self, key) != NULL; \
+} \
+void DATASTORE_IDENT(name__, flush)(struct name__ *self) \
+{ \
+	size_t count = self->pending_keys.size; \
+	if (!count) \
+		return; \
+	key_trait__(DATASTORE_VEC_TRAIT_TYPE) *const batch_keys = self->pending_keys.data; \
+	value_trait__(DATASTORE_VEC_TRAIT_TYPE) *const batch_values = self->pending_values.data; \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, order), reserve)(&self->order, count); \
+	void **order = self->order.data; \
+	for (size_t i = 0; i < count; ++i) \
+		order[i] = batch_keys + i; \
+	DATASTORE_IDENT(name__, impl_order_sort)(order, count); \
+	/* Among equal keys of the batch, keep the last inserted */ \
+	size_t kept = 0; \
+	for (size_t i = 0; i < count; ++i) \
+	{ \
+		if (i + 1 < count && DATASTORE_IDENT(name__, impl_cmp)(order[i], order[i + 1]) == 0) \
+		{ \
+			key_trait__(DATASTORE_VEC_TRAIT_TYPE) *key = order[i]; \
+			DATASTORE_IDENT(name__, impl_free_key)(key); \
+			DATASTORE_IDENT(name__, impl_free_value)(batch_values + (key - batch_keys)); \
+			continue; \
+		} \
+		order[kept++] = order[i]; \
+	} \
+	count = kept; \
+	/* Merges from the back, so sorted entries are moved at most once */ \
+	const size_t size = self->keys.size; \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, keys), reserve)(&self->keys, size + count); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), reserve)(&self->values, size + count); \
+	key_trait__(DATASTORE_VEC_TRAIT_TYPE) *const keys = self->keys.data; \
+	value_trait__(DATASTORE_VEC_TRAIT_TYPE) *const values = self->values.data; \
+	size_t left = size; \
+	size_t out = size + count; \
+	for (size_t right = count; right > 0;) \
+	{ \
+		key_trait__(DATASTORE_VEC_TRAIT_TYPE) *key = order[right - 1]; \
+		if (left > 0) \
+		{ \
+			const int cmp = DATASTORE_IDENT(name__, impl_cmp)(keys + left - 1, key); \
+			if (cmp > 0) \
+			{ \
+				--left; \
+				--out; \
+				keys[out] = keys[left]; \
+				values[out] = values[left]; \
+				continue; \
+			} \
+			if (cmp == 0) \
+			{ \
+				--left; \
+				DATASTORE_IDENT(name__, impl_free_key)(keys + left); \
+				DATASTORE_IDENT(name__, impl_free_value)(values + left); \
+			} \
+		} \
+		--out; \
+		--right; \
+		keys[out] = *key; \
+		values[out] = batch_values[key - batch_keys]; \
+	} \
+	/* Replaced keys leave a gap between the untouched head and the merged tail */ \
+	if (out != left) \
+	{ \
+		memmove(keys + left, keys + out, (size + count - out) * sizeof(*keys)); \
+		memmove(values + left, values + out, (size + count - out) * sizeof(*values)); \
+	} \
+	self->keys.size = self->values.size = left + (size + count - out); \
+	/* Entries were moved out of the buffer */ \
+	self->pending_keys.size = 0; \
+	self->pending_values.size = 0; \
+} \
+void DATASTORE_IDENT(name__, insert)(struct name__ *self, key_trait__(DATASTORE_VEC_TRAIT_TYPE) key, \
+	value_trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	value_trait__(DATASTORE_VEC_TRAIT_TYPE) *existing = DATASTORE_IDENT(name__, get)(self, key); \
+	if (existing) \
+	{ \
+		DATASTORE_IDENT(name__, impl_free_value)(existing); \
+		*existing = value; \
+		DATASTORE_IDENT(name__, impl_free_key)(&key); \
+		return; \
+	} \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, keys), push)(&self->pending_keys, key); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), push)(&self->pending_values, value); \
+	if (self->pending_keys.size >= DATASTORE_FLAT_MAP_PENDING) \
+		DATASTORE_IDENT(name__, flush)(self); \
+} \
+void DATASTORE_IDENT(name__, insert_many)(struct name__ *self, key_trait__(DATASTORE_VEC_TRAIT_TYPE) const *keys, \
+	value_trait__(DATASTORE_VEC_TRAIT_TYPE) const *values, size_t count) \
+{ \
+	if (!count) \
+		return; \
+	const size_t pending = self->pending_keys.size; \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, keys), reserve)(&self->pending_keys, pending + count); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), reserve)(&self->pending_values, pending + count); \
+	memcpy(self->pending_keys.data + pending, keys, count * sizeof(*keys)); \
+	memcpy(self->pending_values.data + pending, values, count * sizeof(*values)); \
+	self->pending_keys.size = self->pending_values.size = pending + count; \
+	DATASTORE_IDENT(name__, flush)(self); \
+} \
+bool DATASTORE_IDENT(name__, remove)(struct name__ *self, key_trait__(DATASTORE_VEC_TRAIT_TYPE) key) \
+{ \
+	const size_t index = DATASTORE_IDENT(name__, impl_search)(self, &key); \
+	if (index < self->keys.size && DATASTORE_IDENT(name__, impl_cmp)(self->keys.data + index, &key) == 0) \
+	{ \
+		DATASTORE_IDENT(name__, impl_free_key)(self->keys.data + index); \
+		DATASTORE_IDENT(name__, impl_free_value)(self->values.data + index); \
+		const size_t tail = self->keys.size - index - 1; \
+		memmove(self->keys.data + index, self->keys.data + index + 1, tail * sizeof(*self->keys.data)); \
+		memmove(self->values.data + index, self->values.data + index + 1, tail * sizeof(*self->values.data)); \
+		--self->keys.size; \
+		--self->values.size; \
+		return true; \
+	} \
+	const size_t pending = DATASTORE_IDENT(name__, impl_find_pending)(self, &key); \
+	if (pending == self->pending_keys.size) \
+		return false; \
+	/* The buffer is unsorted: move its last entry into the hole */ \
+	const size_t last = self->pending_keys.size - 1; \
+	DATASTORE_IDENT(name__, impl_free_key)(self->pending_keys.data + pending); \
+	DATASTORE_IDENT(name__, impl_free_value)(self->pending_values.data + pending); \
+	self->pending_keys.data[pending] = self->pending_keys.data[last]; \
+	self->pending_values.data[pending] = self->pending_values.data[last]; \
+	self->pending_keys.size = self->pending_values.size = last; \
+	return true; \
+} \
+size_t DATASTORE_IDENT(name__, lower_bound)(const struct name__ *self, key_trait__(DATASTORE_VEC_TRAIT_TYPE) key) \
+{ \
+	assert(self->pending_keys.size == 0); \
+	return DATASTORE_IDENT(name__, impl_search)(self, &key); \
+}
+
+/**
+ * @brief Flat map methods implementation
+ *
+ * It will call @ref DATASTORE_FLAT_MAP_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param key_trait__ Type-trait for the keys, must declare a `CMP`
+ * @param value_trait__ Type-trait for the values, see @ref trait_type "Trait Type"
+ * @param name__ Name of the map, must match the name passed to @ref DATASTORE_FLAT_MAP
+ */
+#define DATASTORE_FLAT_MAP_IMPL(key_trait__, value_trait__, name__) \
+	DATASTORE_FLAT_MAP_IMPL_S(key_trait__, value_trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup FlatMap */
+
+#endif // DATASTORE_FLAT_MAP_H
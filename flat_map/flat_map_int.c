@@ -0,0 +1,147 @@
+#include "test.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+DATASTORE_FLAT_MAP(int, int, fmi)
+typedef struct fmi fmi;
+DATASTORE_FLAT_MAP_IMPL_S(INT_TRAIT, INT_TRAIT, fmi, SETTINGS)
+
+static unsigned next(unsigned *state)
+{
+	*state = *state * 1103515245u + 12345u;
+	return *state >> 16;
+}
+
+TESTS(flat_map_int, {
+	TEST("new", {
+		fmi m = fmi_new(0);
+		ASSERT(fmi_size(&m) == 0)
+		ASSERT(fmi_get(&m, 1) == NULL)
+		ASSERT(!fmi_remove(&m, 1))
+		fmi_flush(&m);
+		ASSERT(fmi_lower_bound(&m, 1) == 0)
+		fmi_free(&m);
+
+		fmi n = fmi_new(16);
+		ASSERT(n.keys.capacity == 16)
+		ASSERT(n.values.capacity == 16)
+		fmi_free(&n);
+	})
+	TEST("insert_get", {
+		fmi m = fmi_new(0);
+		for (int i = 0; i < 10; ++i)
+			fmi_insert(&m, i * 7 % 10, i);
+		// Still in the insert buffer
+		ASSERT(m.keys.size == 0)
+		ASSERT(fmi_size(&m) == 10)
+		ASSERT(*fmi_get(&m, 7) == 1)
+		ASSERT(fmi_contains(&m, 0))
+		ASSERT(!fmi_contains(&m, 10))
+		fmi_insert(&m, 7, 100);
+		ASSERT(fmi_size(&m) == 10)
+		ASSERT(*fmi_get(&m, 7) == 100)
+
+		fmi_flush(&m);
+		ASSERT(m.pending_keys.size == 0)
+		ASSERT(m.keys.size == 10)
+		int ok = 1;
+		for (size_t i = 0; i < 10; ++i)
+			ok &= m.keys.data[i] == (int)i;
+		ASSERT(ok)
+		ASSERT(*fmi_get(&m, 7) == 100)
+		fmi_insert(&m, 7, 5);
+		ASSERT(m.pending_keys.size == 0)
+		ASSERT(*fmi_get(&m, 7) == 5)
+		fmi_free(&m);
+	})
+	TEST("pending_merge", {
+		fmi m = fmi_new(0);
+		for (int i = 0; i < DATASTORE_FLAT_MAP_PENDING; ++i)
+			fmi_insert(&m, -i, i);
+		// A full buffer is merged
+		ASSERT(m.pending_keys.size == 0)
+		ASSERT(m.keys.size == DATASTORE_FLAT_MAP_PENDING)
+		ASSERT(m.keys.data[0] == 1 - DATASTORE_FLAT_MAP_PENDING)
+		fmi_insert(&m, 1000, 1);
+		ASSERT(m.pending_keys.size == 1)
+		ASSERT(fmi_remove(&m, 1000))
+		ASSERT(fmi_remove(&m, 0))
+		ASSERT(!fmi_contains(&m, 0))
+		ASSERT(fmi_size(&m) == DATASTORE_FLAT_MAP_PENDING - 1)
+		fmi_free(&m);
+	})
+	TEST("insert_many", {
+		fmi m = fmi_new(0);
+		int keys[6] = { 5, 1, 3, 1, 9, 5 };
+		int values[6] = { 50, 10, 30, 11, 90, 51 };
+		fmi_insert(&m, 3, 0);
+		fmi_insert(&m, 4, 40);
+		fmi_flush(&m);
+		fmi_insert(&m, 2, 20);
+		fmi_insert_many(&m, keys, values, 6);
+		ASSERT(fmi_size(&m) == 6)
+		ASSERT(m.pending_keys.size == 0)
+		static const int expected_keys[] = { 1, 2, 3, 4, 5, 9 };
+		static const int expected_values[] = { 11, 20, 30, 40, 51, 90 };
+		int ok = 1;
+		for (size_t i = 0; i < 6; ++i)
+			ok &= m.keys.data[i] == expected_keys[i] && m.values.data[i] == expected_values[i];
+		ASSERT(ok)
+		ASSERT(fmi_lower_bound(&m, 6) == 5)
+		fmi_free(&m);
+	})
+	TEST("random", {
+		// Checks against a direct-mapped reference
+		enum { RANGE = 2000 };
+		int reference[RANGE];
+		for (size_t i = 0; i < RANGE; ++i)
+			reference[i] = -1;
+		fmi m = fmi_new(0);
+		unsigned state = 7;
+		int batch_keys[64], batch_values[64];
+		for (int round = 0; round < 3000; ++round)
+		{
+			const unsigned op = next(&state) % 10;
+			const int key = (int)(next(&state) % RANGE);
+			if (op < 5)
+			{
+				fmi_insert(&m, key, round);
+				reference[key] = round;
+			}
+			else if (op < 7)
+			{
+				fmi_remove(&m, key);
+				reference[key] = -1;
+			}
+			else if (op == 7)
+			{
+				const size_t count = next(&state) % 64;
+				for (size_t i = 0; i < count; ++i)
+				{
+					batch_keys[i] = (int)(next(&state) % RANGE);
+					batch_values[i] = round * 64 + (int)i;
+					reference[batch_keys[i]] = batch_values[i];
+				}
+				fmi_insert_many(&m, batch_keys, batch_values, count);
+			}
+		}
+		int ok = 1;
+		size_t size = 0;
+		for (int key = 0; key < RANGE; ++key)
+		{
+			const int *value = fmi_get(&m, key);
+			size += reference[key] != -1;
+			ok &= reference[key] == -1 ? value == NULL : value != NULL && *value == reference[key];
+		}
+		ASSERT(ok)
+		ASSERT(fmi_size(&m) == size)
+		fmi_flush(&m);
+		for (size_t i = 1; i < m.keys.size; ++i)
+			ok &= m.keys.data[i - 1] < m.keys.data[i];
+		ASSERT(ok)
+		fmi_free(&m);
+	})
+})
@@ -0,0 +1,56 @@
+#include "test.h"
+
+static char *dup(const char *s)
+{
+	const size_t len = strlen(s) + 1;
+	char *copy = iso_malloc(len);
+	if (!copy)
+		abort();
+	memcpy(copy, s, len);
+	return copy;
+}
+
+#define STR_TRAIT(X) \
+	X(TYPE, char *) \
+	X(FREE, { iso_free(*val); }) \
+	X(CLONE, { *new = dup(*val); }) \
+	X(CMP, { cmp = strcmp(*lhs, *rhs); })
+DATASTORE_FLAT_MAP(char *, char *, fms)
+typedef struct fms fms;
+DATASTORE_FLAT_MAP_IMPL_S(STR_TRAIT, STR_TRAIT, fms, SETTINGS)
+
+TESTS(flat_map_str, {
+	TEST("owned", {
+		fms m = fms_new(0);
+		fms_insert(&m, dup("pear"), dup("green"));
+		fms_insert(&m, dup("apple"), dup("red"));
+		fms_insert(&m, dup("pear"), dup("yellow"));
+		ASSERT(fms_size(&m) == 2)
+		ASSERT(strcmp(*fms_get(&m, "pear"), "yellow") == 0)
+
+		char *keys[3] = { dup("fig"), dup("apple"), dup("fig") };
+		char *values[3] = { dup("purple"), dup("green"), dup("brown") };
+		fms_insert_many(&m, keys, values, 3);
+		ASSERT(fms_size(&m) == 3)
+		ASSERT(strcmp(m.keys.data[0], "apple") == 0)
+		ASSERT(strcmp(m.values.data[0], "green") == 0)
+		ASSERT(strcmp(m.keys.data[1], "fig") == 0)
+		ASSERT(strcmp(m.values.data[1], "brown") == 0)
+		ASSERT(strcmp(m.keys.data[2], "pear") == 0)
+		ASSERT(fms_remove(&m, "fig"))
+		ASSERT(!fms_contains(&m, "fig"))
+		fms_free(&m);
+	})
+	TEST("clone", {
+		fms m = fms_new(0);
+		fms_insert(&m, dup("b"), dup("2"));
+		fms_flush(&m);
+		fms_insert(&m, dup("a"), dup("1"));
+		fms c = fms_clone(&m);
+		fms_free(&m);
+		ASSERT(fms_size(&c) == 2)
+		ASSERT(strcmp(*fms_get(&c, "a"), "1") == 0)
+		ASSERT(strcmp(*fms_get(&c, "b"), "2") == 0)
+		fms_free(&c);
+	})
+})
@@ -0,0 +1,16 @@
+#ifndef DATASTORE_FLAT_MAP_TEST_H
+#define DATASTORE_FLAT_MAP_TEST_H
+
+#include "../tests/tests.h"
+#include "flat_map.h"
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+extern const unit_test test_flat_map_int;
+extern const unit_test test_flat_map_str;
+
+#endif // DATASTORE_FLAT_MAP_TEST_H
@@ -0,0 +1,543 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_HEAP_H
+#define DATASTORE_HEAP_H
+
+#include "../vector/vector.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file heap.h
+ * @defgroup Heap DATASTORE_HEAP, DATASTORE_IHEAP: d-ary heaps
+ *
+ * @brief Priority queues on an implicit d-ary heap
+ *
+ * The heap keeps the smallest element, according to the trait's `CMP`, on top: use a reversed
+ * `CMP` for a max-heap. It is stored in a @ref DATASTORE_VEC, the children of element `i` being
+ * `i * d + 1` to `i * d + d`. With the default arity of 4 (@ref DATASTORE_HEAP_ARITY), the
+ * children of an element share a cache line and the heap is half as deep as a binary heap: `pop`
+ * does more comparisons per level but touches half as many lines.
+ *
+ * Sifts move a hole instead of swapping, each element being copied once per level.
+ *
+ * - @ref DATASTORE_HEAP "DATASTORE_HEAP": a heap of elements. `from_vec` builds a heap from an
+ *   existing vector in O(n).
+ * - @ref DATASTORE_IHEAP "DATASTORE_IHEAP": an indexed heap, where each element has an id in
+ *   `[0, n)`, for instance a graph vertex. It tracks the position of each id, so that the
+ *   priority of an element can be lowered in place with `decrease_key`, as in Dijkstra's
+ *   algorithm.
+ *
+ * Elements are owned by the heap: `pop` releases the top with the trait `FREE`, while `take`,
+ * `push_pop` and `replace_top` hand elements back to the caller. See @ref trait_type "Trait Type",
+ * the trait must declare a `CMP`.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define TIMER_TRAIT(X) \
+ * 	X(TYPE, struct timer) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; }) \
+ * 	X(CMP, { cmp = (lhs->deadline > rhs->deadline) - (lhs->deadline < rhs->deadline); })
+ *
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_HEAP(struct timer, timers)
+ * DATASTORE_IHEAP(double, distances)
+ * // Methods definition (in the .c)
+ * DATASTORE_HEAP_IMPL(TIMER_TRAIT, timers)
+ * DATASTORE_IHEAP_IMPL(DOUBLE_TRAIT, distances)
+ *
+ * struct timers t = timers_new(0);
+ * timers_push(&t, timer);
+ * while (t.items.size && timers_top(&t)->deadline <= now)
+ * 	fire(timers_take(&t));
+ *
+ * struct distances queue = distances_new(vertices);
+ * distances_push(&queue, source, 0.0);
+ * while (queue.values.size)
+ * {
+ * 	size_t vertex;
+ * 	const double distance = distances_take(&queue, &vertex);
+ * 	for (each edge of vertex)
+ * 		if (!distances_contains(&queue, edge.to))
+ * 			distances_push(&queue, edge.to, distance + edge.weight); // (if not visited)
+ * 		else if (distance + edge.weight < *distances_get(&queue, edge.to))
+ * 			distances_decrease_key(&queue, edge.to, distance + edge.weight);
+ * }
+ * @endcode
+ *
+ * **Macro `DATASTORE_HEAP(type, name)`**: Define a new heap type, and its vector type `name_vec`
+ *
+ * **Macro `DATASTORE_HEAP_IMPL(trait, name)`**, **`DATASTORE_HEAP_IMPL_S(trait, name, settings)`**
+ * and **`DATASTORE_HEAP_IMPL_D(trait, name, settings, arity)`**: Implements methods for a heap
+ * type, and for `name_vec`
+ *
+ * **Macro `DATASTORE_IHEAP(type, name)`**: Define a new indexed heap type, its vector type
+ * `name_vec`, and the vector of ids `name_ids`
+ *
+ * **Macro `DATASTORE_IHEAP_IMPL(trait, name)`**,
+ * **`DATASTORE_IHEAP_IMPL_S(trait, name, settings)`** and
+ * **`DATASTORE_IHEAP_IMPL_D(trait, name, settings, arity)`**: Implements methods for an indexed
+ * heap type, and for its vectors
+ *
+ * The resulting types will look like this:
+ * @code{.c}
+ * struct heap {
+ *     struct heap_vec items; // In heap order
+ * };
+ * struct iheap {
+ *     struct iheap_vec values; // In heap order
+ *     struct iheap_ids ids; // Id of each value
+ *     struct iheap_ids positions; // Position of each id in `values`, or DATASTORE_HEAP_ABSENT
+ * };
+ * @endcode
+ *
+ * ## Exposed methods
+ *
+ * Heap:
+ * - `heap new(size_t capacity)`: Create a new heap
+ * - `heap from_vec(struct heap_vec vec)`: Build a heap from the elements of `vec` in O(n), the heap
+ *   takes ownership of the vector
+ * - `void free(struct heap *self)`: Free the heap and its elements
+ * - `heap clone(const struct heap *self)`: Deep copy of the heap
+ * - `void push(struct heap *self, type value)`: Insert an element
+ * - `type *top(const struct heap *self)`: Smallest element, the heap must not be empty
+ * - `type take(struct heap *self)`: Remove the smallest element and return it
+ * - `void pop(struct heap *self)`: Remove and free the smallest element
+ * - `type push_pop(struct heap *self, type value)`: Insert `value` then take the smallest element,
+ *   in a single sift
+ * - `type replace_top(struct heap *self, type value)`: Take the smallest element then insert
+ *   `value`, in a single sift. The heap must not be empty
+ *
+ * Indexed heap:
+ * - `iheap new(size_t ids)`: Create a new heap, with room for ids below `ids`
+ * - `void free(struct iheap *self)`: Free the heap and its elements
+ * - `iheap clone(const struct iheap *self)`: Deep copy of the heap
+ * - `bool contains(const struct iheap *self, size_t id)`: Whether `id` is in the heap
+ * - `type *get(const struct iheap *self, size_t id)`: Element of `id`, which must be in the heap
+ * - `void push(struct iheap *self, size_t id, type value)`: Insert `value` for `id`, which must
+ *   not be in the heap
+ * - `type *top(const struct iheap *self, size_t *id)`: Smallest element, and its id in `id` (if
+ *   not NULL)
+ * - `type take(struct iheap *self, size_t *id)`: Remove the smallest element and return it, and
+ *   its id in `id` (if not NULL)
+ * - `void pop(struct iheap *self)`: Remove and free the smallest element
+ * - `void decrease_key(struct iheap *self, size_t id, type value)`: Replace the element of `id` by
+ *   a smaller or equal `value`, the previous one is freed
+ * - `void update(struct iheap *self, size_t id, type value)`: Replace the element of `id` by any
+ *   `value`, the previous one is freed
+ */
+
+/**
+ * @brief Default number of children per node
+ */
+#ifndef DATASTORE_HEAP_ARITY
+	#define DATASTORE_HEAP_ARITY 4
+#endif
+
+/**
+ * @brief Position of ids that are not in an indexed heap
+ */
+#define DATASTORE_HEAP_ABSENT SIZE_MAX
+
+/**
+ * @brief Trait for the vectors of ids of indexed heaps
+ */
+#define DATASTORE_HEAP_ID_TRAIT(X) \
+	X(TYPE, size_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+// {{{ Heap
+/**
+ * @brief Heap type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the heap type
+ */
+#define DATASTORE_HEAP(type__, name__) \
+DATASTORE_VEC(type__, DATASTORE_IDENT(name__, vec)) \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, vec) items; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity); \
+struct name__ DATASTORE_IDENT(name__, from_vec)(struct DATASTORE_IDENT(name__, vec) vec); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, type__ value); \
+type__ *DATASTORE_IDENT(name__, top)(const struct name__ *self); \
+type__ DATASTORE_IDENT(name__, take)(struct name__ *self); \
+void DATASTORE_IDENT(name__, pop)(struct name__ *self); \
+type__ DATASTORE_IDENT(name__, push_pop)(struct name__ *self, type__ value); \
+type__ DATASTORE_IDENT(name__, replace_top)(struct name__ *self, type__ value);
+
+/**
+ * @brief Heap methods implementation, with a custom arity
+ *
+ * @param trait__ Type-trait for the elements, must declare a `CMP`
+ * @param name__ Name of the heap, must match the name passed to @ref DATASTORE_HEAP
+ * @param settings__ Custom settings for the vector, see @ref advanced_usage "Advanced Usage"
+ * @param arity__ Number of children per node, at least 2
+ */
+#define DATASTORE_HEAP_IMPL_D(trait__, name__, settings__, arity__) \
+DATASTORE_VEC_IMPL_S(trait__, DATASTORE_IDENT(name__, vec), settings__) \
+static inline bool DATASTORE_IDENT(name__, impl_less)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *lhs, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *rhs) \
+{ \
+	int cmp = 0; \
+	trait__(DATASTORE_VEC_TRAIT_CMP) \
+	return cmp < 0; \
+} \
+static void DATASTORE_IDENT(name__, impl_sift_up)(trait__(DATASTORE_VEC_TRAIT_TYPE) *data, size_t index) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value = data[index]; \
+	while (index) \
+	{ \
+		const size_t parent = (index - 1) / (arity__); \
+		if (!DATASTORE_IDENT(name__, impl_less)(&value, &data[parent])) \
+			break; \
+		data[index] = data[parent]; \
+		index = parent; \
+	} \
+	data[index] = value; \
+} \
+static void DATASTORE_IDENT(name__, impl_sift_down)(trait__(DATASTORE_VEC_TRAIT_TYPE) *data, size_t size, \
+	size_t index) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value = data[index]; \
+	for (;;) \
+	{ \
+		const size_t first = index * (arity__) + 1; \
+		if (first >= size) \
+			break; \
+		const size_t end = size - first < (arity__) ? size : first + (arity__); \
+		size_t best = first; \
+		for (size_t child = first + 1; child < end; ++child) \
+			if (DATASTORE_IDENT(name__, impl_less)(&data[child], &data[best])) \
+				best = child; \
+		if (!DATASTORE_IDENT(name__, impl_less)(&data[best], &value)) \
+			break; \
+		data[index] = data[best]; \
+		index = best; \
+	} \
+	data[index] = value; \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity) \
+{ \
+	return (struct name__){ .items = DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), new)(capacity) }; \
+} \
+struct name__ DATASTORE_IDENT(name__, from_vec)(struct DATASTORE_IDENT(name__, vec) vec) \
+{ \
+	/* Floyd's heapify: sift down every parent, the last one first */ \
+	for (size_t i = vec.size < 2 ? 0 : (vec.size - 2) / (arity__) + 1; i-- > 0;) \
+		DATASTORE_IDENT(name__, impl_sift_down)(vec.data, vec.size, i); \
+	return (struct name__){ .items = vec }; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), free)(&self->items); \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	return (struct name__){ .items = DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), clone)(&self->items) }; \
+} \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), push)(&self->items, value); \
+	DATASTORE_IDENT(name__, impl_sift_up)(self->items.data, self->items.size - 1); \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, top)(const struct name__ *self) \
+{ \
+	assert(self->items.size != 0); \
+	return self->items.data; \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, take)(struct name__ *self) \
+{ \
+	assert(self->items.size != 0); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) top = self->items.data[0]; \
+	if (--self->items.size) \
+	{ \
+		self->items.data[0] = self->items.data[self->items.size]; \
+		DATASTORE_IDENT(name__, impl_sift_down)(self->items.data, self->items.size, 0); \
+	} \
+	return top; \
+} \
+void DATASTORE_IDENT(name__, pop)(struct name__ *self) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value = DATASTORE_IDENT(name__, take)(self); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *val = &value; \
+	DATASTORE_MAYBE_UNUSED(val); \
+	trait__(DATASTORE_VEC_TRAIT_FREE) \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, push_pop)(struct name__ *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	if (!self->items.size || !DATASTORE_IDENT(name__, impl_less)(self->items.data, &value)) \
+		return value; \
+	return DATASTORE_IDENT(name__, replace_top)(self, value); \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, replace_top)(struct name__ *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	assert(self->items.size != 0); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) top = self->items.data[0]; \
+	self->items.data[0] = value; \
+	DATASTORE_IDENT(name__, impl_sift_down)(self->items.data, self->items.size, 0); \
+	return top; \
+}
+
+/**
+ * @brief Heap methods implementation
+ *
+ * This macro will call @ref DATASTORE_HEAP_IMPL_D, with @ref DATASTORE_HEAP_ARITY.
+ *
+ * @param trait__ Type-trait for the elements, must declare a `CMP`
+ * @param name__ Name of the heap, must match the name passed to @ref DATASTORE_HEAP
+ * @param settings__ Custom settings for the vector, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_HEAP_IMPL_S(trait__, name__, settings__) \
+	DATASTORE_HEAP_IMPL_D(trait__, name__, settings__, DATASTORE_HEAP_ARITY)
+
+/**
+ * @brief Heap methods implementation
+ *
+ * This macro will call @ref DATASTORE_HEAP_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, must declare a `CMP`
+ * @param name__ Name of the heap, must match the name passed to @ref DATASTORE_HEAP
+ */
+#define DATASTORE_HEAP_IMPL(trait__, name__) \
+	DATASTORE_HEAP_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+// }}}
+
+// {{{ Indexed heap
+/**
+ * @brief Indexed heap type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the indexed heap type
+ */
+#define DATASTORE_IHEAP(type__, name__) \
+DATASTORE_VEC(type__, DATASTORE_IDENT(name__, vec)) \
+DATASTORE_VEC(size_t, DATASTORE_IDENT(name__, ids)) \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, vec) values; \
+	struct DATASTORE_IDENT(name__, ids) ids; \
+	struct DATASTORE_IDENT(name__, ids) positions; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t ids); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, size_t id); \
+type__ *DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t id); \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, size_t id, type__ value); \
+type__ *DATASTORE_IDENT(name__, top)(const struct name__ *self, size_t *id); \
+type__ DATASTORE_IDENT(name__, take)(struct name__ *self, size_t *id); \
+void DATASTORE_IDENT(name__, pop)(struct name__ *self); \
+void DATASTORE_IDENT(name__, decrease_key)(struct name__ *self, size_t id, type__ value); \
+void DATASTORE_IDENT(name__, update)(struct name__ *self, size_t id, type__ value);
+
+/**
+ * @brief Indexed heap methods implementation, with a custom arity
+ *
+ * @param trait__ Type-trait for the elements, must declare a `CMP`
+ * @param name__ Name of the heap, must match the name passed to @ref DATASTORE_IHEAP
+ * @param settings__ Custom settings for the vectors, see @ref advanced_usage "Advanced Usage"
+ * @param arity__ Number of children per node, at least 2
+ */
+#define DATASTORE_IHEAP_IMPL_D(trait__, name__, settings__, arity__) \
+DATASTORE_VEC_IMPL_S(trait__, DATASTORE_IDENT(name__, vec), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_HEAP_ID_TRAIT, DATASTORE_IDENT(name__, ids), settings__) \
+static inline bool DATASTORE_IDENT(name__, impl_less)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *lhs, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *rhs) \
+{ \
+	int cmp = 0; \
+	trait__(DATASTORE_VEC_TRAIT_CMP) \
+	return cmp < 0; \
+} \
+static inline void DATASTORE_IDENT(name__, impl_place)(struct name__ *self, size_t index, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value, size_t id) \
+{ \
+	self->values.data[index] = value; \
+	self->ids.data[index] = id; \
+	self->positions.data[id] = index; \
+} \
+static void DATASTORE_IDENT(name__, impl_sift_up)(struct name__ *self, size_t index) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value = self->values.data[index]; \
+	const size_t id = self->ids.data[index]; \
+	while (index) \
+	{ \
+		const size_t parent = (index - 1) / (arity__); \
+		if (!DATASTORE_IDENT(name__, impl_less)(&value, &self->values.data[parent])) \
+			break; \
+		DATASTORE_IDENT(name__, impl_place)(self, index, self->values.data[parent], self->ids.data[parent]); \
+		index = parent; \
+	} \
+	DATASTORE_IDENT(name__, impl_place)(self, index, value, id); \
+} \
+static void DATASTORE_IDENT(name__, impl_sift_down)(struct name__ *self, size_t index) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *data = self->values.data; \
+	const size_t size = self->values.size; \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value = data[index]; \
+	const size_t id = self->ids.data[index]; \
+	for (;;) \
+	{ \
+		const size_t first = index * (arity__) + 1; \
+		if (first >= size) \
+			break; \
+		const size_t end = size - first < (arity__) ? size : first + (arity__); \
+		size_t best = first; \
+		for (size_t child = first + 1; child < end; ++child) \
+			if (DATASTORE_IDENT(name__, impl_less)(&data[child], &data[best])) \
+				best = child; \
+		if (!DATASTORE_IDENT(name__, impl_less)(&data[best], &value)) \
+			break; \
+		DATASTORE_IDENT(name__, impl_place)(self, index, data[best], self->ids.data[best]); \
+		index = best; \
+	} \
+	DATASTORE_IDENT(name__, impl_place)(self, index, value, id); \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(size_t ids) \
+{ \
+	struct name__ self = { \
+		.values = DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), new)(0), \
+		.ids = DATASTORE_IDENT(DATASTORE_IDENT(name__, ids), new)(0), \
+		.positions = DATASTORE_IDENT(DATASTORE_IDENT(name__, ids), new)(ids), \
+	}; \
+	for (size_t i = 0; i < ids; ++i) \
+		self.positions.data[i] = DATASTORE_HEAP_ABSENT; \
+	self.positions.size = ids; \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), free)(&self->values); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, ids), free)(&self->ids); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, ids), free)(&self->positions); \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	return (struct name__){ \
+		.values = DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), clone)(&self->values), \
+		.ids = DATASTORE_IDENT(DATASTORE_IDENT(name__, ids), clone)(&self->ids), \
+		.positions = DATASTORE_IDENT(DATASTORE_IDENT(name__, ids), clone)(&self->positions), \
+	}; \
+} \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, size_t id) \
+{ \
+	return id < self->positions.size && self->positions.data[id] != DATASTORE_HEAP_ABSENT; \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t id) \
+{ \
+	assert(DATASTORE_IDENT(name__, contains)(self, id)); \
+	return &self->values.data[self->positions.data[id]]; \
+} \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, size_t id, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	assert(id != DATASTORE_HEAP_ABSENT); \
+	assert(!DATASTORE_IDENT(name__, contains)(self, id)); \
+	while (self->positions.size <= id) \
+		DATASTORE_IDENT(DATASTORE_IDENT(name__, ids), push)(&self->positions, DATASTORE_HEAP_ABSENT); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), push)(&self->values, value); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, ids), push)(&self->ids, id); \
+	DATASTORE_IDENT(name__, impl_sift_up)(self, self->values.size - 1); \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, top)(const struct name__ *self, size_t *id) \
+{ \
+	assert(self->values.size != 0); \
+	if (id) \
+		*id = self->ids.data[0]; \
+	return self->values.data; \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, take)(struct name__ *self, size_t *id) \
+{ \
+	assert(self->values.size != 0); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) top = self->values.data[0]; \
+	if (id) \
+		*id = self->ids.data[0]; \
+	self->positions.data[self->ids.data[0]] = DATASTORE_HEAP_ABSENT; \
+	--self->ids.size; \
+	if (--self->values.size) \
+	{ \
+		DATASTORE_IDENT(name__, impl_place)(self, 0, self->values.data[self->values.size], \
+			self->ids.data[self->ids.size]); \
+		DATASTORE_IDENT(name__, impl_sift_down)(self, 0); \
+	} \
+	return top; \
+} \
+void DATASTORE_IDENT(name__, pop)(struct name__ *self) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value = DATASTORE_IDENT(name__, take)(self, NULL); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *val = &value; \
+	DATASTORE_MAYBE_UNUSED(val); \
+	trait__(DATASTORE_VEC_TRAIT_FREE) \
+} \
+void DATASTORE_IDENT(name__, decrease_key)(struct name__ *self, size_t id, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *val = DATASTORE_IDENT(name__, get)(self, id); \
+	assert(!DATASTORE_IDENT(name__, impl_less)(val, &value)); \
+	trait__(DATASTORE_VEC_TRAIT_FREE) \
+	*val = value; \
+	DATASTORE_IDENT(name__, impl_sift_up)(self, self->positions.data[id]); \
+} \
+void DATASTORE_IDENT(name__, update)(struct name__ *self, size_t id, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *val = DATASTORE_IDENT(name__, get)(self, id); \
+	const bool smaller = DATASTORE_IDENT(name__, impl_less)(&value, val); \
+	trait__(DATASTORE_VEC_TRAIT_FREE) \
+	*val = value; \
+	if (smaller) \
+		DATASTORE_IDENT(name__, impl_sift_up)(self, self->positions.data[id]); \
+	else \
+		DATASTORE_IDENT(name__, impl_sift_down)(self, self->positions.data[id]); \
+}
+
+/**
+ * @brief Indexed heap methods implementation
+ *
+ * This macro will call @ref DATASTORE_IHEAP_IMPL_D, with @ref DATASTORE_HEAP_ARITY.
+ *
+ * @param trait__ Type-trait for the elements, must declare a `CMP`
+ * @param name__ Name of the heap, must match the name passed to @ref DATASTORE_IHEAP
+ * @param settings__ Custom settings for the vectors, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_IHEAP_IMPL_S(trait__, name__, settings__) \
+	DATASTORE_IHEAP_IMPL_D(trait__, name__, settings__, DATASTORE_HEAP_ARITY)
+
+/**
+ * @brief Indexed heap methods implementation
+ *
+ * This macro will call @ref DATASTORE_IHEAP_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, must declare a `CMP`
+ * @param name__ Name of the heap, must match the name passed to @ref DATASTORE_IHEAP
+ */
+#define DATASTORE_IHEAP_IMPL(trait__, name__) \
+	DATASTORE_IHEAP_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+// }}}
+
+/** @endgroup Heap */
+
+#endif // DATASTORE_HEAP_H
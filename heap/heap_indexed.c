@@ -0,0 +1,150 @@
+#include "test.h"
+
+#define U64_TRAIT(X) \
+	X(TYPE, uint64_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+DATASTORE_IHEAP(uint64_t, ih)
+typedef struct ih ih;
+DATASTORE_IHEAP_IMPL_S(U64_TRAIT, ih, SETTINGS)
+
+#define VERTICES 60
+#define EDGES 400
+
+struct edge
+{
+	size_t from;
+	size_t to;
+	uint64_t weight;
+};
+
+static uint32_t g_seed = 777;
+static uint32_t next_u32(void)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return g_seed >> 8;
+}
+
+static void random_graph(struct edge *edges)
+{
+	for (size_t i = 0; i < EDGES; ++i)
+	{
+		edges[i].from = next_u32() % VERTICES;
+		edges[i].to = next_u32() % VERTICES;
+		edges[i].weight = next_u32() % 100;
+	}
+}
+
+static void dijkstra(const struct edge *edges, uint64_t *distances)
+{
+	int done[VERTICES] = { 0 };
+	for (size_t i = 0; i < VERTICES; ++i)
+		distances[i] = UINT64_MAX;
+	ih queue = ih_new(VERTICES);
+	ih_push(&queue, 0, 0);
+	while (queue.values.size)
+	{
+		size_t vertex;
+		const uint64_t distance = ih_take(&queue, &vertex);
+		distances[vertex] = distance;
+		done[vertex] = 1;
+		for (size_t i = 0; i < EDGES; ++i)
+		{
+			if (edges[i].from != vertex || done[edges[i].to])
+				continue;
+			const uint64_t candidate = distance + edges[i].weight;
+			if (!ih_contains(&queue, edges[i].to))
+				ih_push(&queue, edges[i].to, candidate);
+			else if (candidate < *ih_get(&queue, edges[i].to))
+				ih_decrease_key(&queue, edges[i].to, candidate);
+		}
+	}
+	ih_free(&queue);
+}
+
+static void bellman_ford(const struct edge *edges, uint64_t *distances)
+{
+	for (size_t i = 0; i < VERTICES; ++i)
+		distances[i] = UINT64_MAX;
+	distances[0] = 0;
+	for (size_t round = 0; round < VERTICES; ++round)
+		for (size_t i = 0; i < EDGES; ++i)
+			if (distances[edges[i].from] != UINT64_MAX
+				&& distances[edges[i].from] + edges[i].weight < distances[edges[i].to])
+				distances[edges[i].to] = distances[edges[i].from] + edges[i].weight;
+}
+
+TESTS(heap_indexed, {
+	TEST("push take", {
+		ih h = ih_new(0);
+		ih_push(&h, 3, 30);
+		ih_push(&h, 1, 10);
+		ih_push(&h, 7, 70);
+		ih_push(&h, 2, 20);
+		ASSERT(ih_contains(&h, 7))
+		ASSERT(!ih_contains(&h, 4))
+		ASSERT(!ih_contains(&h, 100))
+		size_t id;
+		ASSERT(*ih_top(&h, &id) == 10 && id == 1)
+		ASSERT(ih_take(&h, &id) == 10 && id == 1)
+		ASSERT(!ih_contains(&h, 1))
+		ih_pop(&h);
+		ASSERT(ih_take(&h, &id) == 30 && id == 3)
+		ASSERT(*ih_get(&h, 7) == 70)
+		ih_free(&h);
+	})
+	TEST("decrease key", {
+		ih h = ih_new(16);
+		for (size_t i = 0; i < 16; ++i)
+			ih_push(&h, i, 100 + i);
+		ih_decrease_key(&h, 9, 5);
+		ih_decrease_key(&h, 4, 50);
+		size_t id;
+		ASSERT(ih_take(&h, &id) == 5 && id == 9)
+		ASSERT(ih_take(&h, &id) == 50 && id == 4)
+		ih_update(&h, 0, 1000);
+		ih_update(&h, 15, 1);
+		ASSERT(ih_take(&h, &id) == 1 && id == 15)
+		int ok = 1;
+		uint64_t last = 0;
+		while (h.values.size)
+		{
+			const uint64_t value = ih_take(&h, &id);
+			ok &= value >= last;
+			last = value;
+		}
+		ASSERT(ok)
+		ASSERT(last == 1000 && id == 0)
+		ih_free(&h);
+	})
+	TEST("positions", {
+		ih h = ih_new(0);
+		for (size_t i = 0; i < 200; ++i)
+			ih_push(&h, (i * 37) % 200, next_u32() % 1000);
+		for (size_t i = 0; i < 50; ++i)
+			ih_update(&h, next_u32() % 200, next_u32() % 1000);
+		int ok = 1;
+		for (size_t i = 0; i < h.values.size; ++i)
+			ok &= h.positions.data[h.ids.data[i]] == i;
+		ih c = ih_clone(&h);
+		ih_free(&h);
+		ok &= c.values.size == 200;
+		ih_free(&c);
+		ASSERT(ok)
+	})
+	TEST("dijkstra", {
+		struct edge edges[EDGES];
+		uint64_t expected[VERTICES], distances[VERTICES];
+		int ok = 1;
+		for (int graph = 0; graph < 5; ++graph)
+		{
+			random_graph(edges);
+			dijkstra(edges, distances);
+			bellman_ford(edges, expected);
+			for (size_t i = 0; i < VERTICES; ++i)
+				ok &= distances[i] == expected[i];
+		}
+		ASSERT(ok)
+	})
+})
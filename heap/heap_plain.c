@@ -0,0 +1,148 @@
+#include "test.h"
+
+static char *dup(const char *s)
+{
+	const size_t len = strlen(s) + 1;
+	char *copy = iso_malloc(len);
+	if (!copy)
+		abort();
+	memcpy(copy, s, len);
+	return copy;
+}
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+#define STR_TRAIT(X) \
+	X(TYPE, char *) \
+	X(FREE, { iso_free(*val); }) \
+	X(CLONE, { *new = dup(*val); }) \
+	X(CMP, { cmp = strcmp(*lhs, *rhs); })
+
+DATASTORE_HEAP(int, hi)
+typedef struct hi hi;
+DATASTORE_HEAP_IMPL_S(INT_TRAIT, hi, SETTINGS)
+DATASTORE_HEAP(int, hi2)
+typedef struct hi2 hi2;
+DATASTORE_HEAP_IMPL_D(INT_TRAIT, hi2, SETTINGS, 2)
+DATASTORE_HEAP(int, hi3)
+typedef struct hi3 hi3;
+DATASTORE_HEAP_IMPL_D(INT_TRAIT, hi3, SETTINGS, 3)
+DATASTORE_HEAP(char *, hs)
+typedef struct hs hs;
+DATASTORE_HEAP_IMPL_S(STR_TRAIT, hs, SETTINGS)
+
+static uint32_t g_seed = 12345;
+static int next_int(void)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return (int)(g_seed >> 20);
+}
+
+// Generates a heap check for each arity: elements come out in non-decreasing order
+#define DRAIN(name__) \
+	static int name__##_drain(name__ *h, size_t expected) \
+	{ \
+		int ok = h->items.size == expected; \
+		int last = INT32_MIN; \
+		while (h->items.size) \
+		{ \
+			const int value = name__##_take(h); \
+			ok &= value >= last; \
+			last = value; \
+			--expected; \
+		} \
+		return ok && expected == 0; \
+	} \
+	static int name__##_random(size_t count) \
+	{ \
+		name__ h = name__##_new(0); \
+		for (size_t i = 0; i < count; ++i) \
+			name__##_push(&h, next_int()); \
+		const int ok = name__##_drain(&h, count); \
+		name__##_free(&h); \
+		return ok; \
+	}
+DRAIN(hi)
+DRAIN(hi2)
+DRAIN(hi3)
+
+TESTS(heap_plain, {
+	TEST("push take", {
+		ASSERT(hi_random(0))
+		ASSERT(hi_random(1))
+		ASSERT(hi_random(1000))
+		ASSERT(hi2_random(1000))
+		ASSERT(hi3_random(1000))
+		hi h = hi_new(0);
+		hi_push(&h, 5);
+		hi_push(&h, 1);
+		hi_push(&h, 3);
+		ASSERT(*hi_top(&h) == 1)
+		hi_pop(&h);
+		ASSERT(*hi_top(&h) == 3)
+		hi_free(&h);
+	})
+	TEST("from vec", {
+		int ok = 1;
+		for (size_t size = 0; size < 40; ++size)
+		{
+			struct hi_vec v = hi_vec_new(size);
+			for (size_t i = 0; i < size; ++i)
+				hi_vec_push(&v, next_int() % 10);
+			hi h = hi_from_vec(v);
+			ok &= hi_drain(&h, size);
+			hi_free(&h);
+		}
+		ASSERT(ok)
+	})
+	TEST("push pop", {
+		hi h = hi_new(0);
+		ASSERT(hi_push_pop(&h, 4) == 4)
+		hi_push(&h, 2);
+		hi_push(&h, 6);
+		// Smaller than the top: returned right away
+		ASSERT(hi_push_pop(&h, 1) == 1)
+		ASSERT(hi_push_pop(&h, 2) == 2)
+		ASSERT(hi_push_pop(&h, 5) == 2)
+		ASSERT(*hi_top(&h) == 5)
+		ASSERT(hi_replace_top(&h, 9) == 5)
+		ASSERT(hi_replace_top(&h, 0) == 6)
+		ASSERT(hi_drain(&h, 2))
+		hi_free(&h);
+	})
+	TEST("top k", {
+		// Keep the 10 largest of a stream with a min-heap
+		hi h = hi_new(10);
+		int values[500];
+		for (int i = 0; i < 500; ++i)
+		{
+			values[i] = (i * 7919) % 500;
+			if (h.items.size < 10)
+				hi_push(&h, values[i]);
+			else
+				hi_push_pop(&h, values[i]);
+		}
+		ASSERT(*hi_top(&h) == 490)
+		hi_free(&h);
+	})
+	TEST("owned", {
+		hs h = hs_new(0);
+		hs_push(&h, dup("pear"));
+		hs_push(&h, dup("apple"));
+		hs_push(&h, dup("fig"));
+		hs c = hs_clone(&h);
+		hs_pop(&h);
+		char *top = hs_take(&h);
+		ASSERT(strcmp(top, "fig") == 0)
+		iso_free(top);
+		char *old = hs_replace_top(&h, dup("kiwi"));
+		ASSERT(strcmp(old, "pear") == 0)
+		iso_free(old);
+		hs_free(&h);
+		ASSERT(strcmp(*hs_top(&c), "apple") == 0)
+		hs_free(&c);
+	})
+})
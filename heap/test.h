@@ -0,0 +1,16 @@
+#ifndef DATASTORE_HEAP_TEST_H
+#define DATASTORE_HEAP_TEST_H
+
+#include "../tests/tests.h"
+#include "heap.h"
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+extern const unit_test test_heap_plain;
+extern const unit_test test_heap_indexed;
+
+#endif // DATASTORE_HEAP_TEST_H
@@ -0,0 +1,422 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef DATASTORE_INTERNER_H
+#define DATASTORE_INTERNER_H
+
+#include "../vector/vector.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @file interner.h
+ * @defgroup Interner DATASTORE_INTERNER: String interner
+ *
+ * @brief Stores each distinct string once, and names it with a 32-bit symbol
+ *
+ * Interning a string returns its symbol, the index of the string in the interner: symbols are
+ * numbered from `0` in order of first appearance. Interning the same bytes again returns the
+ * same symbol, so interned strings are compared by comparing their symbols.
+ *
+ * - The bytes are copied, null-terminated, into an arena of chunks. Chunks double in size from
+ *   @ref DATASTORE_INTERNER_CHUNK_MIN up to @ref DATASTORE_INTERNER_CHUNK_MAX bytes, and are
+ *   never moved or freed before the interner: the `const char *` of a symbol stays valid, and
+ *   equal strings share the same pointer.
+ * - Each symbol has an entry holding its hash, its chunk, its offset in the chunk and its
+ *   length, so `str` and `length` are a single lookup.
+ * - Distinct strings are found through an open-addressing table of (hash, symbol) pairs with
+ *   linear probing, kept at most 3/4 full. The full 32-bit hash is compared before the bytes,
+ *   so probing rarely touches the arena.
+ * - `intern_many` hashes strings ahead of their probes, by blocks of
+ *   @ref DATASTORE_INTERNER_BATCH, and prefetches their slots, so that the table misses of a
+ *   block overlap.
+ *
+ * Strings may contain null bytes, and are at most `UINT32_MAX - 1` bytes long. The arena, the
+ * entries and the table are allocated with the settings of @ref advanced_usage "Advanced Usage".
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_INTERNER(symbols)
+ * // Methods definition (in the .c)
+ * DATASTORE_INTERNER_IMPL(symbols)
+ *
+ * struct symbols names = symbols_new();
+ * const uint32_t a = symbols_intern_cstr(&names, "count");
+ * const uint32_t b = symbols_intern(&names, token, token_size);
+ * if (a == b)
+ * 	printf("%s\n", symbols_str(&names, b));
+ * symbols_free(&names);
+ * @endcode
+ *
+ * **Macro `DATASTORE_INTERNER(name)`**: Define a new interner type, and its vectors
+ * `name_chunks`, `name_entries` and `name_slots`
+ *
+ * **Macro `DATASTORE_INTERNER_IMPL(name)`** and **`DATASTORE_INTERNER_IMPL_S(name, settings)`**:
+ * Implements methods for an interner type
+ *
+ * The resulting type will look like this:
+ * @code{.c}
+ * struct name {
+ *     struct name_chunks chunks; // Arena
+ *     struct name_entries entries; // Entry of each symbol
+ *     struct name_slots slots; // Hash table, a power of two of slots
+ * };
+ * @endcode
+ *
+ * ## Exposed methods
+ *
+ * - `struct interner new(void)`: Create an empty interner
+ * - `void free(struct interner *self)`: Free the interner, and every interned string
+ * - `uint32_t intern(struct interner *self, const char *bytes, size_t size)`: Symbol of `size`
+ *   bytes, interned if they are new
+ * - `uint32_t intern_cstr(struct interner *self, const char *cstr)`: Symbol of a null-terminated
+ *   string
+ * - `void intern_many(struct interner *self, const char *const *strings, const size_t *sizes,
+ *   size_t count, uint32_t *symbols)`: Stores the symbols of `count` strings in `symbols`. The
+ *   sizes of the strings are given in `sizes`, or computed with `strlen` when it is `NULL`
+ * - `uint32_t find(const struct interner *self, const char *bytes, size_t size)`: Symbol of
+ *   `size` bytes, @ref DATASTORE_INTERNER_NONE if they were never interned
+ * - `const char *str(const struct interner *self, uint32_t symbol)`: Null-terminated string of a
+ *   symbol
+ * - `size_t length(const struct interner *self, uint32_t symbol)`: Length of the string of a
+ *   symbol
+ * - `size_t size(const struct interner *self)`: Number of symbols
+ */
+
+/**
+ * @brief Symbol returned by `find` for strings that were never interned
+ */
+#define DATASTORE_INTERNER_NONE UINT32_MAX
+
+/**
+ * @brief Size (in bytes) of the first chunk of the arena
+ */
+#ifndef DATASTORE_INTERNER_CHUNK_MIN
+	#define DATASTORE_INTERNER_CHUNK_MIN ((size_t)4096)
+#endif
+
+/**
+ * @brief Size (in bytes) above which chunks stop doubling, longer strings get their own chunk
+ */
+#ifndef DATASTORE_INTERNER_CHUNK_MAX
+	#define DATASTORE_INTERNER_CHUNK_MAX ((size_t)1024 * 1024)
+#endif
+
+/**
+ * @brief Number of strings hashed ahead by `intern_many`
+ */
+#define DATASTORE_INTERNER_BATCH 16
+
+#if defined(__GNUC__)
+	#define DATASTORE_INTERNER_PREFETCH(ptr) __builtin_prefetch(ptr)
+#else
+	#define DATASTORE_INTERNER_PREFETCH(ptr) ((void)(ptr))
+#endif
+
+/**
+ * @brief Chunk of the arena
+ */
+struct datastore_interner_chunk
+{
+	char *data;
+	/* Bytes allocated */
+	size_t capacity;
+	/* Bytes in use */
+	size_t used;
+};
+
+/**
+ * @brief Entry of a symbol
+ */
+struct datastore_interner_entry
+{
+	uint32_t hash;
+	uint32_t size;
+	/* Chunk holding the string, and offset of the string in the chunk */
+	uint32_t chunk;
+	uint32_t offset;
+};
+
+/**
+ * @brief Slot of the hash table, empty when `symbol` is @ref DATASTORE_INTERNER_NONE
+ */
+struct datastore_interner_slot
+{
+	uint32_t hash;
+	uint32_t symbol;
+};
+
+#define DATASTORE_INTERNER_CHUNK_TRAIT(X) \
+	X(TYPE, struct datastore_interner_chunk) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+#define DATASTORE_INTERNER_ENTRY_TRAIT(X) \
+	X(TYPE, struct datastore_interner_entry) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+#define DATASTORE_INTERNER_SLOT_TRAIT(X) \
+	X(TYPE, struct datastore_interner_slot) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+/**
+ * @brief Hash of `size` bytes, read 8 bytes at a time
+ */
+static inline uint32_t datastore_interner_hash(const char *bytes, size_t size)
+{
+	const uint64_t k = 0xFF51AFD7ED558CCDull;
+	uint64_t h = 0x9E3779B97F4A7C15ull ^ ((uint64_t)size * 0xC2B2AE3D27D4EB4Full);
+	uint64_t word;
+	for (; size >= 8; size -= 8, bytes += 8)
+	{
+		memcpy(&word, bytes, 8);
+		h = (h ^ word) * k;
+		h ^= h >> 32;
+	}
+	word = 0;
+	// Empty strings may come with a null pointer
+	if (size)
+		memcpy(&word, bytes, size);
+	h = (h ^ word) * k;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ull;
+	h ^= h >> 33;
+	return (uint32_t)h;
+}
+
+/**
+ * @brief Interner type definition and methods declaration
+ *
+ * @param name__ Name of the interner type
+ */
+#define DATASTORE_INTERNER(name__) \
+DATASTORE_VEC(struct datastore_interner_chunk, DATASTORE_IDENT(name__, chunks)) \
+DATASTORE_VEC(struct datastore_interner_entry, DATASTORE_IDENT(name__, entries)) \
+DATASTORE_VEC(struct datastore_interner_slot, DATASTORE_IDENT(name__, slots)) \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, chunks) chunks; \
+	struct DATASTORE_IDENT(name__, entries) entries; \
+	struct DATASTORE_IDENT(name__, slots) slots; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(void); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+uint32_t DATASTORE_IDENT(name__, intern)(struct name__ *self, const char *bytes, size_t size); \
+uint32_t DATASTORE_IDENT(name__, intern_cstr)(struct name__ *self, const char *cstr); \
+void DATASTORE_IDENT(name__, intern_many)(struct name__ *self, const char *const *strings, const size_t *sizes, \
+	size_t count, uint32_t *symbols); \
+uint32_t DATASTORE_IDENT(name__, find)(const struct name__ *self, const char *bytes, size_t size); \
+const char *DATASTORE_IDENT(name__, str)(const struct name__ *self, uint32_t symbol); \
+size_t DATASTORE_IDENT(name__, length)(const struct name__ *self, uint32_t symbol); \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self);
+
+/**
+ * @brief Interner methods implementation
+ *
+ * @param name__ Name of the interner, must match the name passed to @ref DATASTORE_INTERNER
+ * @param settings__ Custom settings for the allocations, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_INTERNER_IMPL_S(name__, settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_INTERNER_CHUNK_TRAIT, DATASTORE_IDENT(name__, chunks), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_INTERNER_ENTRY_TRAIT, DATASTORE_IDENT(name__, entries), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_INTERNER_SLOT_TRAIT, DATASTORE_IDENT(name__, slots), settings__) \
+/* Whether the bytes of an entry are `size` bytes equal to `bytes` */ \
+static inline bool DATASTORE_IDENT(name__, impl_equals)(const struct name__ *self, \
+	const struct datastore_interner_entry *entry, const char *bytes, size_t size) \
+{ \
+	return entry->size == size \
+		&& (!size || !memcmp(self->chunks.data[entry->chunk].data + entry->offset, bytes, size)); \
+} \
+/* Slot holding the bytes, or the empty slot where they would be inserted */ \
+static inline struct datastore_interner_slot *DATASTORE_IDENT(name__, impl_probe)(const struct name__ *self, \
+	uint32_t hash, const char *bytes, size_t size) \
+{ \
+	const size_t mask = self->slots.size - 1; \
+	for (size_t pos = hash & mask;; pos = (pos + 1) & mask) \
+	{ \
+		struct datastore_interner_slot *slot = &self->slots.data[pos]; \
+		if (slot->symbol == DATASTORE_INTERNER_NONE \
+			|| (slot->hash == hash \
+				&& DATASTORE_IDENT(name__, impl_equals)(self, &self->entries.data[slot->symbol], bytes, size))) \
+			return slot; \
+	} \
+} \
+/* Doubles the table, and places the symbols in it again */ \
+static inline void DATASTORE_IDENT(name__, impl_rehash)(struct name__ *self) \
+{ \
+	const size_t capacity = self->slots.size ? 2 * self->slots.size : 16; \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, slots), free)(&self->slots); \
+	self->slots = DATASTORE_IDENT(DATASTORE_IDENT(name__, slots), new)(capacity); \
+	const struct datastore_interner_slot empty = { .hash = 0, .symbol = DATASTORE_INTERNER_NONE }; \
+	for (size_t i = 0; i < capacity; ++i) \
+		DATASTORE_IDENT(DATASTORE_IDENT(name__, slots), push)(&self->slots, empty); \
+	const size_t mask = capacity - 1; \
+	for (size_t i = 0; i < self->entries.size; ++i) \
+	{ \
+		const uint32_t hash = self->entries.data[i].hash; \
+		size_t pos = hash & mask; \
+		while (self->slots.data[pos].symbol != DATASTORE_INTERNER_NONE) \
+			pos = (pos + 1) & mask; \
+		self->slots.data[pos].hash = hash; \
+		self->slots.data[pos].symbol = (uint32_t)i; \
+	} \
+} \
+/* Copies `length` bytes and a terminator into the arena, and records their entry */ \
+static inline uint32_t DATASTORE_IDENT(name__, impl_store)(struct name__ *self, uint32_t hash, \
+	const char *bytes, size_t length) \
+{ \
+	assert(length < UINT32_MAX && self->entries.size < DATASTORE_INTERNER_NONE); \
+	struct datastore_interner_chunk *chunk = self->chunks.size ? &self->chunks.data[self->chunks.size - 1] : NULL; \
+	if (!chunk || chunk->capacity - chunk->used < length + 1) \
+	{ \
+		size_t capacity = DATASTORE_INTERNER_CHUNK_MIN; \
+		if (chunk) \
+			capacity = chunk->capacity < DATASTORE_INTERNER_CHUNK_MAX / 2 ? 2 * chunk->capacity \
+				: DATASTORE_INTERNER_CHUNK_MAX; \
+		if (capacity < length + 1) \
+			capacity = length + 1; \
+		char *ptr; \
+		const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+		const size_t size = datastore_vec_pad(capacity, align); \
+		size_t usable = size; \
+		settings__(DATASTORE_VEC_SETTINGS_NEW) \
+		assert(usable >= size); \
+		const struct datastore_interner_chunk fresh = { .data = ptr, .capacity = usable, .used = 0 }; \
+		DATASTORE_IDENT(DATASTORE_IDENT(name__, chunks), push)(&self->chunks, fresh); \
+		chunk = &self->chunks.data[self->chunks.size - 1]; \
+	} \
+	if (length) \
+		memcpy(chunk->data + chunk->used, bytes, length); \
+	chunk->data[chunk->used + length] = '\0'; \
+	const struct datastore_interner_entry entry = { \
+		.hash = hash, \
+		.size = (uint32_t)length, \
+		.chunk = (uint32_t)(self->chunks.size - 1), \
+		.offset = (uint32_t)chunk->used, \
+	}; \
+	chunk->used += length + 1; \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, entries), push)(&self->entries, entry); \
+	return (uint32_t)(self->entries.size - 1); \
+} \
+/* Symbol of bytes whose hash is known */ \
+static inline uint32_t DATASTORE_IDENT(name__, impl_intern)(struct name__ *self, uint32_t hash, \
+	const char *bytes, size_t size) \
+{ \
+	if ((self->entries.size + 1) * 4 > self->slots.size * 3) \
+		DATASTORE_IDENT(name__, impl_rehash)(self); \
+	struct datastore_interner_slot *slot = DATASTORE_IDENT(name__, impl_probe)(self, hash, bytes, size); \
+	if (slot->symbol == DATASTORE_INTERNER_NONE) \
+	{ \
+		slot->symbol = DATASTORE_IDENT(name__, impl_store)(self, hash, bytes, size); \
+		slot->hash = hash; \
+	} \
+	return slot->symbol; \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(void) \
+{ \
+	return (struct name__){ \
+		.chunks = DATASTORE_IDENT(DATASTORE_IDENT(name__, chunks), new)(0), \
+		.entries = DATASTORE_IDENT(DATASTORE_IDENT(name__, entries), new)(0), \
+		.slots = DATASTORE_IDENT(DATASTORE_IDENT(name__, slots), new)(0), \
+	}; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	for (size_t i = 0; i < self->chunks.size; ++i) \
+	{ \
+		char *ptr = self->chunks.data[i].data; \
+		const size_t size = self->chunks.data[i].capacity; \
+		DATASTORE_MAYBE_UNUSED(size); \
+		settings__(DATASTORE_VEC_SETTINGS_FREE) \
+	} \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, chunks), free)(&self->chunks); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, entries), free)(&self->entries); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, slots), free)(&self->slots); \
+} \
+uint32_t DATASTORE_IDENT(name__, intern)(struct name__ *self, const char *bytes, size_t size) \
+{ \
+	return DATASTORE_IDENT(name__, impl_intern)(self, datastore_interner_hash(bytes, size), bytes, size); \
+} \
+uint32_t DATASTORE_IDENT(name__, intern_cstr)(struct name__ *self, const char *cstr) \
+{ \
+	return DATASTORE_IDENT(name__, intern)(self, cstr, strlen(cstr)); \
+} \
+void DATASTORE_IDENT(name__, intern_many)(struct name__ *self, const char *const *strings, const size_t *sizes, \
+	size_t count, uint32_t *symbols) \
+{ \
+	size_t lengths[DATASTORE_INTERNER_BATCH]; \
+	uint32_t hashes[DATASTORE_INTERNER_BATCH]; \
+	for (size_t begin = 0; begin < count; begin += DATASTORE_INTERNER_BATCH) \
+	{ \
+		const size_t n = count - begin < DATASTORE_INTERNER_BATCH ? count - begin : DATASTORE_INTERNER_BATCH; \
+		/* Grows the table before prefetching, so the prefetched slots stay in place */ \
+		while ((self->entries.size + n) * 4 > self->slots.size * 3) \
+			DATASTORE_IDENT(name__, impl_rehash)(self); \
+		const size_t mask = self->slots.size - 1; \
+		for (size_t i = 0; i < n; ++i) \
+		{ \
+			lengths[i] = sizes ? sizes[begin + i] : strlen(strings[begin + i]); \
+			hashes[i] = datastore_interner_hash(strings[begin + i], lengths[i]); \
+			DATASTORE_INTERNER_PREFETCH(&self->slots.data[hashes[i] & mask]); \
+		} \
+		for (size_t i = 0; i < n; ++i) \
+			symbols[begin + i] = DATASTORE_IDENT(name__, impl_intern)(self, hashes[i], strings[begin + i], lengths[i]); \
+	} \
+} \
+uint32_t DATASTORE_IDENT(name__, find)(const struct name__ *self, const char *bytes, size_t size) \
+{ \
+	if (!self->slots.size) \
+		return DATASTORE_INTERNER_NONE; \
+	return DATASTORE_IDENT(name__, impl_probe)(self, datastore_interner_hash(bytes, size), bytes, size)->symbol; \
+} \
+const char *DATASTORE_IDENT(name__, str)(const struct name__ *self, uint32_t symbol) \
+{ \
+	assert(symbol < self->entries.size); \
+	const struct datastore_interner_entry *entry = &self->entries.data[symbol]; \
+	return self->chunks.data[entry->chunk].data + entry->offset; \
+} \
+size_t DATASTORE_IDENT(name__, length)(const struct name__ *self, uint32_t symbol) \
+{ \
+	assert(symbol < self->entries.size); \
+	return self->entries.data[symbol].size; \
+} \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self) \
+{ \
+	return self->entries.size; \
+}
+
+/**
+ * @brief Interner methods implementation
+ *
+ * This macro will call @ref DATASTORE_INTERNER_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param name__ Name of the interner, must match the name passed to @ref DATASTORE_INTERNER
+ */
+#define DATASTORE_INTERNER_IMPL(name__) \
+	DATASTORE_INTERNER_IMPL_S(name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup Interner */
+
+#endif // DATASTORE_INTERNER_H
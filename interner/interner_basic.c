@@ -0,0 +1,86 @@
+#include "test.h"
+
+#include <stdio.h>
+
+DATASTORE_INTERNER_IMPL_S(symtab, SETTINGS)
+
+TESTS(interner_basic, {
+	TEST("intern", {
+		symtab t = symtab_new();
+		ASSERT(symtab_size(&t) == 0)
+		ASSERT(symtab_find(&t, "x", 1) == DATASTORE_INTERNER_NONE)
+		const uint32_t a = symtab_intern_cstr(&t, "alpha");
+		const uint32_t b = symtab_intern_cstr(&t, "beta");
+		const uint32_t empty = symtab_intern(&t, "", 0);
+		ASSERT(a == 0 && b == 1 && empty == 2)
+		ASSERT(symtab_intern(&t, "alphabet", 5) == a)
+		ASSERT(symtab_intern_cstr(&t, "beta") == b)
+		ASSERT(symtab_intern_cstr(&t, "") == empty)
+		ASSERT(symtab_intern(&t, NULL, 0) == empty)
+		ASSERT(symtab_find(&t, NULL, 0) == empty)
+		ASSERT(symtab_size(&t) == 3)
+		ASSERT(!strcmp(symtab_str(&t, a), "alpha") && symtab_length(&t, a) == 5)
+		ASSERT(!strcmp(symtab_str(&t, empty), "") && symtab_length(&t, empty) == 0)
+		ASSERT(symtab_find(&t, "beta", 4) == b)
+		ASSERT(symtab_find(&t, "bet", 3) == DATASTORE_INTERNER_NONE)
+		ASSERT(symtab_size(&t) == 3)
+		symtab_free(&t);
+	})
+	TEST("embedded_null", {
+		symtab t = symtab_new();
+		const uint32_t a = symtab_intern(&t, "a\0b", 3);
+		const uint32_t b = symtab_intern(&t, "a\0c", 3);
+		const uint32_t c = symtab_intern(&t, "a", 1);
+		ASSERT(a != b && a != c && b != c)
+		ASSERT(symtab_length(&t, a) == 3 && !memcmp(symtab_str(&t, b), "a\0c", 4))
+		ASSERT(symtab_intern(&t, "a\0b", 3) == a)
+		symtab_free(&t);
+	})
+	TEST("many", {
+		symtab t = symtab_new();
+		char buf[32];
+		int ok = 1;
+		// Enough symbols to rehash the table and fill several chunks
+		for (int round = 0; round < 2; ++round)
+			for (uint32_t i = 0; i < 50000; ++i)
+			{
+				const int size = snprintf(buf, sizeof(buf), "identifier_%u", i);
+				ok &= symtab_intern(&t, buf, (size_t)size) == i;
+			}
+		ok &= symtab_size(&t) == 50000;
+		ok &= t.chunks.size > 1;
+		for (uint32_t i = 0; i < 50000; ++i)
+		{
+			const int size = snprintf(buf, sizeof(buf), "identifier_%u", i);
+			ok &= !strcmp(symtab_str(&t, i), buf) && symtab_length(&t, i) == (size_t)size;
+			ok &= symtab_find(&t, buf, (size_t)size) == i;
+		}
+		ASSERT(ok)
+		symtab_free(&t);
+	})
+	TEST("stable", {
+		symtab t = symtab_new();
+		const uint32_t first = symtab_intern_cstr(&t, "first");
+		const char *str = symtab_str(&t, first);
+		char buf[32];
+		for (uint32_t i = 0; i < 20000; ++i)
+		{
+			const int size = snprintf(buf, sizeof(buf), "%u", i * 7919);
+			symtab_intern(&t, buf, (size_t)size);
+		}
+		// Strings longer than a chunk get a chunk of their own
+		char *big = malloc(3 * DATASTORE_INTERNER_CHUNK_MAX);
+		if (!big)
+			abort();
+		memset(big, 'x', 3 * DATASTORE_INTERNER_CHUNK_MAX);
+		const uint32_t large = symtab_intern(&t, big, 3 * DATASTORE_INTERNER_CHUNK_MAX);
+		ASSERT(symtab_length(&t, large) == 3 * DATASTORE_INTERNER_CHUNK_MAX)
+		ASSERT(!memcmp(symtab_str(&t, large), big, 3 * DATASTORE_INTERNER_CHUNK_MAX))
+		ASSERT(symtab_str(&t, large)[3 * DATASTORE_INTERNER_CHUNK_MAX] == '\0')
+		free(big);
+		const uint32_t after = symtab_intern_cstr(&t, "after");
+		ASSERT(!strcmp(symtab_str(&t, after), "after"))
+		ASSERT(symtab_str(&t, first) == str && symtab_str(&t, symtab_intern_cstr(&t, "first")) == str)
+		symtab_free(&t);
+	})
+})
@@ -0,0 +1,72 @@
+#include "test.h"
+
+#include <stdio.h>
+
+TESTS(interner_batch, {
+	TEST("intern_many", {
+		enum { COUNT = 10007, DISTINCT = 700 };
+		static char storage[DISTINCT][16];
+		static const char *strings[COUNT];
+		static size_t sizes[COUNT];
+		static uint32_t batch[COUNT];
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (size_t i = 0; i < DISTINCT; ++i)
+			snprintf(storage[i], sizeof(storage[i]), "tok%zu", i * 31);
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			strings[i] = storage[state % DISTINCT];
+			sizes[i] = strlen(strings[i]);
+		}
+
+		symtab a = symtab_new();
+		symtab b = symtab_new();
+		symtab_intern_many(&a, strings, sizes, COUNT, batch);
+		int ok = symtab_size(&a) <= DISTINCT;
+		for (size_t i = 0; i < COUNT; ++i)
+			ok &= symtab_intern(&b, strings[i], sizes[i]) == batch[i];
+		ok &= symtab_size(&a) == symtab_size(&b);
+		for (size_t i = 0; i < COUNT; ++i)
+			ok &= !strcmp(symtab_str(&a, batch[i]), strings[i]);
+		ASSERT(ok)
+
+		// Interning again only finds the symbols, the sizes being computed
+		static uint32_t again[COUNT];
+		const size_t size = symtab_size(&a);
+		symtab_intern_many(&a, strings, NULL, COUNT, again);
+		ok = symtab_size(&a) == size;
+		for (size_t i = 0; i < COUNT; ++i)
+			ok &= again[i] == batch[i];
+		ASSERT(ok)
+		symtab_free(&a);
+		symtab_free(&b);
+	})
+	TEST("partial_batches", {
+		const char *strings[] = { "x", "y", "x", "z", "y", "x", "w" };
+		uint32_t symbols[7];
+		symtab t = symtab_new();
+		symtab_intern_many(&t, strings, NULL, 0, symbols);
+		ASSERT(symtab_size(&t) == 0)
+		symtab_intern_many(&t, strings, NULL, 3, symbols);
+		ASSERT(symtab_size(&t) == 2 && symbols[0] == 0 && symbols[1] == 1 && symbols[2] == 0)
+		symtab_intern_many(&t, strings + 3, NULL, 4, symbols + 3);
+		ASSERT(symbols[3] == 2 && symbols[4] == 1 && symbols[5] == 0 && symbols[6] == 3)
+		ASSERT(symtab_size(&t) == 4 && !strcmp(symtab_str(&t, 3), "w"))
+		symtab_free(&t);
+	})
+	TEST("duplicates_within_batch", {
+		const char *strings[DATASTORE_INTERNER_BATCH + 3];
+		uint32_t symbols[DATASTORE_INTERNER_BATCH + 3];
+		for (size_t i = 0; i < DATASTORE_INTERNER_BATCH + 3; ++i)
+			strings[i] = "same";
+		symtab t = symtab_new();
+		symtab_intern_many(&t, strings, NULL, DATASTORE_INTERNER_BATCH + 3, symbols);
+		int ok = symtab_size(&t) == 1;
+		for (size_t i = 0; i < DATASTORE_INTERNER_BATCH + 3; ++i)
+			ok &= symbols[i] == 0;
+		ASSERT(ok)
+		symtab_free(&t);
+	})
+})
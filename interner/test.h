@@ -0,0 +1,19 @@
+#ifndef DATASTORE_INTERNER_TEST_H
+#define DATASTORE_INTERNER_TEST_H
+
+#include "../tests/tests.h"
+#include "interner.h"
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+DATASTORE_INTERNER(symtab)
+typedef struct symtab symtab;
+
+extern const unit_test test_interner_basic;
+extern const unit_test test_interner_batch;
+
+#endif // DATASTORE_INTERNER_TEST_H
@@ -0,0 +1,516 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_PACKED_H
+#define DATASTORE_PACKED_H
+
+#include "../vector/vector.h"
+#include "../vector/vector_simd.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @file packed.h
+ * @defgroup Packed DATASTORE_PACKED: Compressed sorted integers
+ *
+ * @brief Non-decreasing sequence of `uint32_t`, stored as bit-packed deltas
+ *
+ * Values are grouped in blocks of @ref DATASTORE_PACKED_BLOCK. Each block stores the difference
+ * between every value and the value 4 positions before it (the values before the block being
+ * the last value of the previous block), packed with the fewest bits that fit the largest
+ * difference. The values are interleaved in 4 lanes, value `i` going to lane `i % 4`, so that
+ * SSE2 unpacks the 4 lanes at once and restores the values with a single vector addition per
+ * step. Sorted identifiers with small gaps then take a few bits per value instead of 4 bytes.
+ *
+ * A table of blocks holds the offset, bit width and last value of every block: `get` only
+ * decodes the lane of one block, `lower_bound` binary searches the last values before decoding
+ * a single block, and `intersect` skips the blocks that end before the current value of the
+ * other list. The values of the last, incomplete, block are kept uncompressed.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_PACKED(postings)
+ * // Methods definition (in the .c)
+ * DATASTORE_PACKED_IMPL(postings)
+ *
+ * struct postings red = postings_new();
+ * for (size_t i = 0; i < count; ++i)
+ * 	postings_push(&red, ids[i]); // Must not decrease
+ * struct postings both = postings_intersect(&red, &blue);
+ * const size_t first = postings_lower_bound(&both, 1000);
+ * for (size_t i = first; i < both.size; ++i)
+ * 	process(postings_get(&both, i));
+ * @endcode
+ *
+ * **Macro `DATASTORE_PACKED(name)`**: Define a new compressed sequence type, with the vectors
+ * `name_words` (of `uint32_t`) and `name_blocks` (of @ref datastore_packed_block)
+ *
+ * **Macro `DATASTORE_PACKED_IMPL(name)`** and **`DATASTORE_PACKED_IMPL_S(name, settings)`**:
+ * Implements methods for a compressed sequence type
+ *
+ * The resulting type will look like this:
+ * @code{.c}
+ * struct name {
+ *     struct name_blocks blocks; // One entry per compressed block
+ *     struct name_words words; // Packed blocks
+ *     struct name_words tail; // Values of the incomplete last block
+ *     size_t size; // Number of values
+ * };
+ * @endcode
+ *
+ * ## Exposed methods
+ *
+ * - `packed new()`: Create an empty sequence
+ * - `void free(struct packed *self)`: Free the sequence
+ * - `packed clone(const struct packed *self)`: Copy of the sequence
+ * - `void push(struct packed *self, uint32_t value)`: Append a value, not smaller than the last
+ * - `uint32_t get(const struct packed *self, size_t index)`: Value at `index`
+ * - `size_t decode(const struct packed *self, size_t block, uint32_t out[DATASTORE_PACKED_BLOCK])`:
+ *   Decode the values of a block in `out` and return their count. The block after the last
+ *   compressed block (`block == blocks.size`) is the tail.
+ * - `size_t lower_bound(const struct packed *self, uint32_t value)`: Index of the first value not
+ *   smaller than `value`, `size` if there is none
+ * - `packed intersect(const struct packed *a, const struct packed *b)`: Values present in both
+ *   sequences
+ * - `struct packed_words flatten(const struct packed *self)`: Decode the whole sequence
+ */
+
+/**
+ * @brief Number of values per compressed block
+ */
+#define DATASTORE_PACKED_BLOCK 128
+
+/**
+ * @brief Entry of the block table
+ */
+struct datastore_packed_block
+{
+	/**
+	 * @brief Largest value of the block
+	 */
+	uint32_t last;
+	/**
+	 * @brief Bits per value, the block takes `4 * bits` words
+	 */
+	uint32_t bits;
+	/**
+	 * @brief Position of the block in the words
+	 */
+	size_t offset;
+};
+
+#define DATASTORE_PACKED_WORD_TRAIT(X) \
+	X(TYPE, uint32_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+#define DATASTORE_PACKED_BLOCK_TRAIT(X) \
+	X(TYPE, struct datastore_packed_block) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+// {{{ Kernels
+/**
+ * @brief Packs a block of differences on `bits` bits into `4 * bits` words
+ */
+static inline void datastore_packed_pack(uint32_t *out, const uint32_t *in, unsigned bits)
+{
+	if (!bits)
+		return;
+	memset(out, 0, 4 * bits * sizeof(uint32_t));
+	for (unsigned lane = 0; lane < 4; ++lane)
+		for (unsigned j = 0; j < DATASTORE_PACKED_BLOCK / 4; ++j)
+		{
+			const uint32_t value = in[j * 4 + lane];
+			const unsigned bit = j * bits, shift = bit % 32;
+			out[bit / 32 * 4 + lane] |= value << shift;
+			if (shift + bits > 32)
+				out[(bit / 32 + 1) * 4 + lane] |= value >> (32 - shift);
+		}
+}
+
+/**
+ * @brief Value `index` of a packed block whose values before the block are `base`
+ *
+ * Only decodes the lane of `index`, up to `index`.
+ */
+static inline uint32_t datastore_packed_extract(const uint32_t *in, unsigned bits, uint32_t base, size_t index)
+{
+	const unsigned lane = (unsigned)(index % 4);
+	const uint32_t mask = bits == 32 ? UINT32_MAX : ((uint32_t)1 << bits) - 1;
+	uint32_t value = base;
+	if (!bits)
+		return value;
+	for (unsigned j = 0; j <= index / 4; ++j)
+	{
+		const unsigned bit = j * bits, shift = bit % 32;
+		uint32_t delta = in[bit / 32 * 4 + lane] >> shift;
+		if (shift + bits > 32)
+			delta |= in[(bit / 32 + 1) * 4 + lane] << (32 - shift);
+		value += delta & mask;
+	}
+	return value;
+}
+
+static inline void datastore_packed_unpack_scalar(uint32_t *out, const uint32_t *in, unsigned bits, uint32_t base)
+{
+	const uint32_t mask = bits == 32 ? UINT32_MAX : ((uint32_t)1 << bits) - 1;
+	for (unsigned lane = 0; lane < 4; ++lane)
+	{
+		uint32_t value = base;
+		for (unsigned j = 0; j < DATASTORE_PACKED_BLOCK / 4; ++j)
+		{
+			if (bits)
+			{
+				const unsigned bit = j * bits, shift = bit % 32;
+				uint32_t delta = in[bit / 32 * 4 + lane] >> shift;
+				if (shift + bits > 32)
+					delta |= in[(bit / 32 + 1) * 4 + lane] << (32 - shift);
+				value += delta & mask;
+			}
+			out[j * 4 + lane] = value;
+		}
+	}
+}
+
+#if DATASTORE_SIMD_X86
+/*
+ * One function per bit width, so that the shifts and the word of every step are constants once
+ * the loop is unrolled.
+ */
+#define DATASTORE_PACKED_UNPACK_SSE2(bits__) \
+static inline void datastore_packed_unpack_##bits__##_SSE2(uint32_t *out, const uint32_t *in, __m128i value) \
+{ \
+	const __m128i mask = _mm_set1_epi32((int)((bits__) == 32 ? UINT32_MAX : ((uint32_t)1 << ((bits__) % 32)) - 1)); \
+	_Pragma("GCC unroll 32") \
+	for (unsigned j = 0; j < DATASTORE_PACKED_BLOCK / 4; ++j) \
+	{ \
+		const unsigned bit = j * (bits__), shift = bit % 32; \
+		__m128i delta = _mm_srli_epi32(DATASTORE_SIMD_LOAD_SSE2(in + bit / 32 * 4), (int)shift); \
+		if (shift + (bits__) > 32) \
+			delta = _mm_or_si128(delta, \
+				_mm_slli_epi32(DATASTORE_SIMD_LOAD_SSE2(in + (bit / 32 + 1) * 4), (int)(32 - shift))); \
+		value = _mm_add_epi32(value, _mm_and_si128(delta, mask)); \
+		DATASTORE_SIMD_STORE_SSE2(out + j * 4, value); \
+	} \
+}
+DATASTORE_PACKED_UNPACK_SSE2(1)
+DATASTORE_PACKED_UNPACK_SSE2(2)
+DATASTORE_PACKED_UNPACK_SSE2(3)
+DATASTORE_PACKED_UNPACK_SSE2(4)
+DATASTORE_PACKED_UNPACK_SSE2(5)
+DATASTORE_PACKED_UNPACK_SSE2(6)
+DATASTORE_PACKED_UNPACK_SSE2(7)
+DATASTORE_PACKED_UNPACK_SSE2(8)
+DATASTORE_PACKED_UNPACK_SSE2(9)
+DATASTORE_PACKED_UNPACK_SSE2(10)
+DATASTORE_PACKED_UNPACK_SSE2(11)
+DATASTORE_PACKED_UNPACK_SSE2(12)
+DATASTORE_PACKED_UNPACK_SSE2(13)
+DATASTORE_PACKED_UNPACK_SSE2(14)
+DATASTORE_PACKED_UNPACK_SSE2(15)
+DATASTORE_PACKED_UNPACK_SSE2(16)
+DATASTORE_PACKED_UNPACK_SSE2(17)
+DATASTORE_PACKED_UNPACK_SSE2(18)
+DATASTORE_PACKED_UNPACK_SSE2(19)
+DATASTORE_PACKED_UNPACK_SSE2(20)
+DATASTORE_PACKED_UNPACK_SSE2(21)
+DATASTORE_PACKED_UNPACK_SSE2(22)
+DATASTORE_PACKED_UNPACK_SSE2(23)
+DATASTORE_PACKED_UNPACK_SSE2(24)
+DATASTORE_PACKED_UNPACK_SSE2(25)
+DATASTORE_PACKED_UNPACK_SSE2(26)
+DATASTORE_PACKED_UNPACK_SSE2(27)
+DATASTORE_PACKED_UNPACK_SSE2(28)
+DATASTORE_PACKED_UNPACK_SSE2(29)
+DATASTORE_PACKED_UNPACK_SSE2(30)
+DATASTORE_PACKED_UNPACK_SSE2(31)
+DATASTORE_PACKED_UNPACK_SSE2(32)
+
+#define DATASTORE_PACKED_UNPACK_CASE(bits__) \
+	case bits__: \
+		datastore_packed_unpack_##bits__##_SSE2(out, in, value); \
+		break;
+
+/* SSE2 is part of x86-64, there is no runtime dispatch */
+static inline void datastore_packed_unpack_SSE2(uint32_t *out, const uint32_t *in, unsigned bits, uint32_t base)
+{
+	const __m128i value = _mm_set1_epi32((int)base);
+	switch (bits)
+	{
+		case 0:
+			for (unsigned j = 0; j < DATASTORE_PACKED_BLOCK / 4; ++j)
+				DATASTORE_SIMD_STORE_SSE2(out + j * 4, value);
+			break;
+		DATASTORE_PACKED_UNPACK_CASE(1) DATASTORE_PACKED_UNPACK_CASE(2) DATASTORE_PACKED_UNPACK_CASE(3)
+		DATASTORE_PACKED_UNPACK_CASE(4) DATASTORE_PACKED_UNPACK_CASE(5) DATASTORE_PACKED_UNPACK_CASE(6)
+		DATASTORE_PACKED_UNPACK_CASE(7) DATASTORE_PACKED_UNPACK_CASE(8) DATASTORE_PACKED_UNPACK_CASE(9)
+		DATASTORE_PACKED_UNPACK_CASE(10) DATASTORE_PACKED_UNPACK_CASE(11) DATASTORE_PACKED_UNPACK_CASE(12)
+		DATASTORE_PACKED_UNPACK_CASE(13) DATASTORE_PACKED_UNPACK_CASE(14) DATASTORE_PACKED_UNPACK_CASE(15)
+		DATASTORE_PACKED_UNPACK_CASE(16) DATASTORE_PACKED_UNPACK_CASE(17) DATASTORE_PACKED_UNPACK_CASE(18)
+		DATASTORE_PACKED_UNPACK_CASE(19) DATASTORE_PACKED_UNPACK_CASE(20) DATASTORE_PACKED_UNPACK_CASE(21)
+		DATASTORE_PACKED_UNPACK_CASE(22) DATASTORE_PACKED_UNPACK_CASE(23) DATASTORE_PACKED_UNPACK_CASE(24)
+		DATASTORE_PACKED_UNPACK_CASE(25) DATASTORE_PACKED_UNPACK_CASE(26) DATASTORE_PACKED_UNPACK_CASE(27)
+		DATASTORE_PACKED_UNPACK_CASE(28) DATASTORE_PACKED_UNPACK_CASE(29) DATASTORE_PACKED_UNPACK_CASE(30)
+		DATASTORE_PACKED_UNPACK_CASE(31) DATASTORE_PACKED_UNPACK_CASE(32)
+		default:
+			assert(0);
+	}
+}
+
+/**
+ * @brief Decodes a packed block of `bits` bits per value, whose values before the block are `base`
+ */
+static inline void datastore_packed_unpack(uint32_t *out, const uint32_t *in, unsigned bits, uint32_t base)
+{
+	datastore_packed_unpack_SSE2(out, in, bits, base);
+}
+#else
+static inline void datastore_packed_unpack(uint32_t *out, const uint32_t *in, unsigned bits, uint32_t base)
+{
+	datastore_packed_unpack_scalar(out, in, bits, base);
+}
+#endif // DATASTORE_SIMD_X86
+// }}}
+
+/**
+ * @brief Compressed sequence type definition and methods declaration
+ *
+ * @param name__ Name of the sequence type
+ */
+#define DATASTORE_PACKED(name__) \
+DATASTORE_VEC(uint32_t, DATASTORE_IDENT(name__, words)) \
+DATASTORE_VEC(struct datastore_packed_block, DATASTORE_IDENT(name__, blocks)) \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, blocks) blocks; \
+	struct DATASTORE_IDENT(name__, words) words; \
+	struct DATASTORE_IDENT(name__, words) tail; \
+	size_t size; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(void); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, uint32_t value); \
+uint32_t DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t index); \
+size_t DATASTORE_IDENT(name__, decode)(const struct name__ *self, size_t block, uint32_t *out); \
+size_t DATASTORE_IDENT(name__, lower_bound)(const struct name__ *self, uint32_t value); \
+struct name__ DATASTORE_IDENT(name__, intersect)(const struct name__ *a, const struct name__ *b); \
+struct DATASTORE_IDENT(name__, words) DATASTORE_IDENT(name__, flatten)(const struct name__ *self);
+
+/**
+ * @brief Compressed sequence methods implementation
+ *
+ * @param name__ Name of the sequence, must match the name passed to @ref DATASTORE_PACKED
+ * @param settings__ Custom settings for the vectors, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_PACKED_IMPL_S(name__, settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_PACKED_WORD_TRAIT, DATASTORE_IDENT(name__, words), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_PACKED_BLOCK_TRAIT, DATASTORE_IDENT(name__, blocks), settings__) \
+/* Values before block `block` */ \
+static inline uint32_t DATASTORE_IDENT(name__, impl_base)(const struct name__ *self, size_t block) \
+{ \
+	return block ? self->blocks.data[block - 1].last : 0; \
+} \
+/* Compresses the full tail into a new block */ \
+static inline void DATASTORE_IDENT(name__, impl_flush)(struct name__ *self) \
+{ \
+	assert(self->tail.size == DATASTORE_PACKED_BLOCK); \
+	const uint32_t base = DATASTORE_IDENT(name__, impl_base)(self, self->blocks.size); \
+	const uint32_t *values = self->tail.data; \
+	uint32_t deltas[DATASTORE_PACKED_BLOCK]; \
+	uint32_t used = 0; \
+	for (size_t i = 0; i < DATASTORE_PACKED_BLOCK; ++i) \
+	{ \
+		deltas[i] = values[i] - (i < 4 ? base : values[i - 4]); \
+		used |= deltas[i]; \
+	} \
+	const unsigned bits = used ? 32 - (unsigned)__builtin_clz(used) : 0; \
+	const size_t needed = self->words.size + 4 * bits; \
+	if (needed > self->words.capacity) \
+		DATASTORE_IDENT(DATASTORE_IDENT(name__, words), reserve)(&self->words, \
+			needed > 2 * self->words.capacity ? needed : 2 * self->words.capacity); \
+	datastore_packed_pack(self->words.data + self->words.size, deltas, bits); \
+	const struct datastore_packed_block block = { \
+		.last = values[DATASTORE_PACKED_BLOCK - 1], \
+		.bits = bits, \
+		.offset = self->words.size, \
+	}; \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, blocks), push)(&self->blocks, block); \
+	self->words.size = needed; \
+	self->tail.size = 0; \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(void) \
+{ \
+	return (struct name__){ \
+		.blocks = DATASTORE_IDENT(DATASTORE_IDENT(name__, blocks), new)(0), \
+		.words = DATASTORE_IDENT(DATASTORE_IDENT(name__, words), new)(0), \
+		.tail = DATASTORE_IDENT(DATASTORE_IDENT(name__, words), new)(0), \
+		.size = 0, \
+	}; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, blocks), free)(&self->blocks); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, words), free)(&self->words); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, words), free)(&self->tail); \
+	self->size = 0; \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	return (struct name__){ \
+		.blocks = DATASTORE_IDENT(DATASTORE_IDENT(name__, blocks), clone)(&self->blocks), \
+		.words = DATASTORE_IDENT(DATASTORE_IDENT(name__, words), clone)(&self->words), \
+		.tail = DATASTORE_IDENT(DATASTORE_IDENT(name__, words), clone)(&self->tail), \
+		.size = self->size, \
+	}; \
+} \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, uint32_t value) \
+{ \
+	assert(self->tail.size ? self->tail.data[self->tail.size - 1] <= value \
+		: DATASTORE_IDENT(name__, impl_base)(self, self->blocks.size) <= value); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, words), push)(&self->tail, value); \
+	++self->size; \
+	if (self->tail.size == DATASTORE_PACKED_BLOCK) \
+		DATASTORE_IDENT(name__, impl_flush)(self); \
+} \
+uint32_t DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t index) \
+{ \
+	assert(index < self->size); \
+	const size_t block = index / DATASTORE_PACKED_BLOCK; \
+	if (block == self->blocks.size) \
+		return self->tail.data[index % DATASTORE_PACKED_BLOCK]; \
+	const struct datastore_packed_block *entry = &self->blocks.data[block]; \
+	return datastore_packed_extract(self->words.data + entry->offset, entry->bits, \
+		DATASTORE_IDENT(name__, impl_base)(self, block), index % DATASTORE_PACKED_BLOCK); \
+} \
+size_t DATASTORE_IDENT(name__, decode)(const struct name__ *self, size_t block, uint32_t *out) \
+{ \
+	assert(block <= self->blocks.size); \
+	if (block == self->blocks.size) \
+	{ \
+		if (self->tail.size) \
+			memcpy(out, self->tail.data, self->tail.size * sizeof(uint32_t)); \
+		return self->tail.size; \
+	} \
+	const struct datastore_packed_block *entry = &self->blocks.data[block]; \
+	datastore_packed_unpack(out, self->words.data + entry->offset, entry->bits, \
+		DATASTORE_IDENT(name__, impl_base)(self, block)); \
+	return DATASTORE_PACKED_BLOCK; \
+} \
+size_t DATASTORE_IDENT(name__, lower_bound)(const struct name__ *self, uint32_t value) \
+{ \
+	/* First block whose last value is not smaller than `value`, the tail if there is none */ \
+	size_t low = 0, high = self->blocks.size; \
+	while (low < high) \
+	{ \
+		const size_t middle = low + (high - low) / 2; \
+		if (self->blocks.data[middle].last < value) \
+			low = middle + 1; \
+		else \
+			high = middle; \
+	} \
+	uint32_t values[DATASTORE_PACKED_BLOCK]; \
+	const size_t count = DATASTORE_IDENT(name__, decode)(self, low, values); \
+	size_t first = 0, size = count; \
+	while (size) \
+	{ \
+		const size_t half = size / 2; \
+		if (values[first + half] < value) \
+		{ \
+			first += half + 1; \
+			size -= half + 1; \
+		} \
+		else \
+			size = half; \
+	} \
+	return low * DATASTORE_PACKED_BLOCK + first; \
+} \
+struct name__ DATASTORE_IDENT(name__, intersect)(const struct name__ *a, const struct name__ *b) \
+{ \
+	struct name__ result = DATASTORE_IDENT(name__, new)(); \
+	uint32_t va[DATASTORE_PACKED_BLOCK], vb[DATASTORE_PACKED_BLOCK]; \
+	size_t ka = 0, kb = 0; \
+	size_t ca = DATASTORE_IDENT(name__, decode)(a, 0, va), cb = DATASTORE_IDENT(name__, decode)(b, 0, vb); \
+	size_t ia = 0, ib = 0; \
+	for (;;) \
+	{ \
+		if (ia == ca) \
+		{ \
+			if (ka == a->blocks.size) \
+				break; \
+			/* Skip the blocks that end before the current value of `b` */ \
+			++ka; \
+			while (ib < cb && ka < a->blocks.size && a->blocks.data[ka].last < vb[ib]) \
+				++ka; \
+			ca = DATASTORE_IDENT(name__, decode)(a, ka, va); \
+			ia = 0; \
+			continue; \
+		} \
+		if (ib == cb) \
+		{ \
+			if (kb == b->blocks.size) \
+				break; \
+			++kb; \
+			while (kb < b->blocks.size && b->blocks.data[kb].last < va[ia]) \
+				++kb; \
+			cb = DATASTORE_IDENT(name__, decode)(b, kb, vb); \
+			ib = 0; \
+			continue; \
+		} \
+		if (va[ia] < vb[ib]) \
+			ia = va[ca - 1] < vb[ib] ? ca : ia + 1; \
+		else if (vb[ib] < va[ia]) \
+			ib = vb[cb - 1] < va[ia] ? cb : ib + 1; \
+		else \
+		{ \
+			DATASTORE_IDENT(name__, push)(&result, va[ia]); \
+			++ia; \
+			++ib; \
+		} \
+	} \
+	return result; \
+} \
+struct DATASTORE_IDENT(name__, words) DATASTORE_IDENT(name__, flatten)(const struct name__ *self) \
+{ \
+	/* Every block but the tail decodes a full block in place */ \
+	struct DATASTORE_IDENT(name__, words) values = DATASTORE_IDENT(DATASTORE_IDENT(name__, words), new)(self->size); \
+	if (!self->size) \
+		return values; \
+	for (size_t block = 0; block <= self->blocks.size; ++block) \
+		DATASTORE_IDENT(name__, decode)(self, block, values.data + block * DATASTORE_PACKED_BLOCK); \
+	values.size = self->size; \
+	return values; \
+}
+
+/**
+ * @brief Compressed sequence methods implementation
+ *
+ * This macro will call @ref DATASTORE_PACKED_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param name__ Name of the sequence, must match the name passed to @ref DATASTORE_PACKED
+ */
+#define DATASTORE_PACKED_IMPL(name__) \
+	DATASTORE_PACKED_IMPL_S(name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup Packed */
+
+#endif // DATASTORE_PACKED_H
@@ -0,0 +1,113 @@
+#include "test.h"
+
+DATASTORE_PACKED_IMPL_S(ids, SETTINGS)
+
+static uint64_t g_state = 0x2545F4914F6CDD1Dull;
+static uint32_t next_u32(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return (uint32_t)(g_state >> 32);
+}
+
+// Sequence of `count` values whose gaps are random on `bits` bits
+static ids random_ids(size_t count, unsigned bits, uint32_t *values)
+{
+	ids seq = ids_new();
+	uint32_t value = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint32_t gap = bits ? next_u32() >> (32 - bits) : 0;
+		value = gap > UINT32_MAX - value ? UINT32_MAX : value + gap;
+		values[i] = value;
+		ids_push(&seq, value);
+	}
+	return seq;
+}
+
+// Compares every way to read a sequence to the values pushed
+static int matches(const ids *seq, const uint32_t *values, size_t count)
+{
+	int ok = seq->size == count;
+	for (size_t i = 0; i < count; ++i)
+		ok &= ids_get(seq, i) == values[i];
+	uint32_t block[DATASTORE_PACKED_BLOCK];
+	for (size_t k = 0; k <= seq->blocks.size; ++k)
+	{
+		const size_t decoded = ids_decode(seq, k, block);
+		for (size_t i = 0; i < decoded; ++i)
+			ok &= block[i] == values[k * DATASTORE_PACKED_BLOCK + i];
+	}
+	struct ids_words flat = ids_flatten(seq);
+	ok &= flat.size == count;
+	for (size_t i = 0; i < count && i < flat.size; ++i)
+		ok &= flat.data[i] == values[i];
+	ids_words_free(&flat);
+	return ok;
+}
+
+TESTS(packed_codec, {
+	TEST("empty", {
+		ids seq = ids_new();
+		ASSERT(seq.size == 0)
+		ASSERT(matches(&seq, NULL, 0))
+		ids_push(&seq, 7);
+		ASSERT(ids_get(&seq, 0) == 7)
+		ids_free(&seq);
+	})
+	TEST("kernels", {
+		uint32_t deltas[DATASTORE_PACKED_BLOCK], packed[4 * 32], simd[DATASTORE_PACKED_BLOCK],
+			scalar[DATASTORE_PACKED_BLOCK];
+		int ok = 1;
+		for (unsigned bits = 0; bits <= 32; ++bits)
+		{
+			for (size_t i = 0; i < DATASTORE_PACKED_BLOCK; ++i)
+				deltas[i] = bits ? next_u32() >> (32 - bits) : 0;
+			datastore_packed_pack(packed, deltas, bits);
+			datastore_packed_unpack(simd, packed, bits, 1000);
+			datastore_packed_unpack_scalar(scalar, packed, bits, 1000);
+			uint32_t lanes[4] = { 1000, 1000, 1000, 1000 };
+			for (size_t i = 0; i < DATASTORE_PACKED_BLOCK; ++i)
+			{
+				lanes[i % 4] += deltas[i];
+				ok &= simd[i] == lanes[i % 4];
+				ok &= scalar[i] == lanes[i % 4];
+				ok &= datastore_packed_extract(packed, bits, 1000, i) == lanes[i % 4];
+			}
+		}
+		ASSERT(ok)
+	})
+	TEST("gaps", {
+		const size_t count = 3 * DATASTORE_PACKED_BLOCK + 17;
+		uint32_t *values = malloc(count * sizeof(uint32_t));
+		if (!values)
+			abort();
+		int ok = 1;
+		for (unsigned bits = 0; bits <= 32; ++bits)
+		{
+			ids seq = random_ids(count, bits, values);
+			ok &= seq.blocks.size == 3 && seq.tail.size == 17;
+			ok &= matches(&seq, values, count);
+			ids_free(&seq);
+		}
+		free(values);
+		ASSERT(ok)
+	})
+	TEST("compression", {
+		uint32_t values[4 * DATASTORE_PACKED_BLOCK];
+		ids seq = random_ids(4 * DATASTORE_PACKED_BLOCK, 4, values);
+		// Four gaps below 16 fit in 6 bits
+		ASSERT(seq.words.size <= 4 * 4 * 6)
+		ASSERT(seq.tail.size == 0)
+		ids_free(&seq);
+	})
+	TEST("clone", {
+		uint32_t values[500];
+		ids seq = random_ids(500, 10, values);
+		ids copy = ids_clone(&seq);
+		ids_free(&seq);
+		ASSERT(matches(&copy, values, 500))
+		ids_free(&copy);
+	})
+})
@@ -0,0 +1,102 @@
+#include "test.h"
+
+static uint32_t g_seed = 777;
+static uint32_t next_u32(void)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return g_seed >> 8;
+}
+
+// Sequence of `count` values with gaps below `spread`
+static ids random_ids(size_t count, uint32_t spread, uint32_t *values)
+{
+	ids seq = ids_new();
+	uint32_t value = next_u32() % spread;
+	for (size_t i = 0; i < count; ++i)
+	{
+		value += next_u32() % spread;
+		values[i] = value;
+		ids_push(&seq, value);
+	}
+	return seq;
+}
+
+static size_t brute_lower_bound(const uint32_t *values, size_t count, uint32_t value)
+{
+	size_t i = 0;
+	while (i < count && values[i] < value)
+		++i;
+	return i;
+}
+
+// Checks an intersection against a merge of the plain arrays
+static int check_intersect(size_t na, uint32_t sa, size_t nb, uint32_t sb)
+{
+	uint32_t *a = malloc((na + 1) * sizeof(uint32_t)), *b = malloc((nb + 1) * sizeof(uint32_t));
+	if (!a || !b)
+		abort();
+	ids x = random_ids(na, sa, a), y = random_ids(nb, sb, b);
+	ids both = ids_intersect(&x, &y);
+	int ok = 1;
+	size_t i = 0, j = 0, k = 0;
+	while (i < na && j < nb)
+	{
+		if (a[i] < b[j])
+			++i;
+		else if (b[j] < a[i])
+			++j;
+		else
+		{
+			ok &= k < both.size && ids_get(&both, k) == a[i];
+			++k;
+			++i;
+			++j;
+		}
+	}
+	ok &= both.size == k;
+	ids both_swapped = ids_intersect(&y, &x);
+	ok &= both_swapped.size == k;
+	ids_free(&both_swapped);
+	ids_free(&both);
+	ids_free(&x);
+	ids_free(&y);
+	free(a);
+	free(b);
+	return ok;
+}
+
+TESTS(packed_search, {
+	TEST("lower bound", {
+		int ok = 1;
+		const size_t counts[] = { 0, 1, 127, 128, 129, 1000 };
+		for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+		{
+			uint32_t values[1000];
+			// Gaps below 3 leave duplicates
+			ids seq = random_ids(counts[c], 3, values);
+			const uint32_t end = counts[c] ? values[counts[c] - 1] + 2 : 2;
+			for (uint32_t v = 0; v <= end; ++v)
+				ok &= ids_lower_bound(&seq, v) == brute_lower_bound(values, counts[c], v);
+			ids_free(&seq);
+		}
+		ASSERT(ok)
+	})
+	TEST("intersect", {
+		ASSERT(check_intersect(0, 4, 300, 4))
+		ASSERT(check_intersect(1000, 4, 1000, 4))
+		ASSERT(check_intersect(5000, 2, 300, 100))
+		ASSERT(check_intersect(130, 1000, 4000, 3))
+		ASSERT(check_intersect(2000, 1, 2000, 2))
+	})
+	TEST("intersect self", {
+		uint32_t values[700];
+		ids seq = random_ids(700, 50, values);
+		ids both = ids_intersect(&seq, &seq);
+		int ok = both.size == 700;
+		for (size_t i = 0; i < 700 && i < both.size; ++i)
+			ok &= ids_get(&both, i) == values[i];
+		ASSERT(ok)
+		ids_free(&both);
+		ids_free(&seq);
+	})
+})
@@ -0,0 +1,19 @@
+#ifndef DATASTORE_PACKED_TEST_H
+#define DATASTORE_PACKED_TEST_H
+
+#include "../tests/tests.h"
+#include "packed.h"
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+DATASTORE_PACKED(ids)
+typedef struct ids ids;
+
+extern const unit_test test_packed_codec;
+extern const unit_test test_packed_search;
+
+#endif // DATASTORE_PACKED_TEST_H
@@ -0,0 +1,663 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_PARALLEL_H
+#define DATASTORE_PARALLEL_H
+
+#include "../vector/vector.h"
+#include "../vector/vector_sort.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+/**
+ * @file parallel.h
+ * @defgroup Parallel DATASTORE_PARALLEL: Work-stealing thread pool and parallel vector algorithms
+ *
+ * @brief Work-stealing thread pool and parallel vector algorithms
+ *
+ * A @ref datastore_pool runs parallel loops over index ranges. The calling thread and every
+ * worker own a Chase-Lev deque: a range is split in halves, one half pushed to the bottom of the
+ * owner's deque and the other processed, until it is no larger than the grain. Idle threads steal
+ * from the top of the other deques, so the largest pending ranges move to idle threads and load
+ * balances itself. Workers sleep on a condition variable between loops.
+ *
+ * Vectors get parallel methods on top of it with @ref DATASTORE_VEC_PARALLEL, and
+ * @ref DATASTORE_VEC_PAR_SORT for vectors with a `CMP` trait entry. Every method accepts a
+ * `NULL` pool, in which case it runs on the calling thread.
+ *
+ * The pool uses pthreads: compile with `-pthread`, and define `_POSIX_C_SOURCE` (at least
+ * `200809L`) or `_GNU_SOURCE` before any include.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define STR_TRAIT(X) \
+ * 	X(TYPE, char*) \
+ * 	X(FREE, { free(*val); }) \
+ * 	X(CLONE, { *new = strdup(*val); })
+ * // In the .h
+ * DATASTORE_VEC(char*, vs)
+ * DATASTORE_VEC_PARALLEL(STR_TRAIT, vs)
+ * // In the .c
+ * DATASTORE_VEC_IMPL(STR_TRAIT, vs)
+ * DATASTORE_VEC_PARALLEL_IMPL(STR_TRAIT, vs)
+ *
+ * struct datastore_pool *pool = datastore_pool_new(0); // One thread per core
+ * struct vs copy = vs_par_clone(&strings, pool);
+ * datastore_pool_free(pool);
+ * @endcode
+ *
+ * # Exposed methods
+ *
+ * With @ref DATASTORE_VEC_PARALLEL:
+ * - `void par_for_each(struct vec *self, struct datastore_pool *pool, void (*fn)(type *value,
+ *   void *ctx), void *ctx)`: Calls `fn` on every element
+ * - `struct vec par_transform(const struct vec *self, struct datastore_pool *pool, void
+ *   (*fn)(type *out, const type *value, void *ctx), void *ctx)`: New vector whose elements are
+ *   written by `fn` from the elements of `self`
+ * - `type par_reduce(const struct vec *self, struct datastore_pool *pool, type identity, type
+ *   (*op)(type lhs, type rhs))`: Folds the elements with the associative `op`. Elements are
+ *   folded by chunks, then the chunk results in order, so the result does not depend on the
+ *   number of threads
+ * - `struct vec par_clone(const struct vec *self, struct datastore_pool *pool)`: Copy of the
+ *   vector, elements are copied with the `CLONE` trait entry in parallel
+ *
+ * With @ref DATASTORE_VEC_PAR_SORT:
+ * - `void par_sort(struct vec *self, struct datastore_pool *pool)`: Sorts the vector according
+ *   to `CMP`. Chunks are sorted with the quicksort of @ref VectorSort "vector_sort.h", then merged
+ *   pairwise; every merge is split between threads by binary search of the output positions
+ *
+ * Each method must be prefixed by the name of the vector type + `_`.
+ *
+ * Functions passed to the methods run concurrently on different elements.
+ */
+
+/**
+ * @brief Capacity of each deque, ranges are not split further while a deque is full
+ */
+#ifndef DATASTORE_POOL_DEQUE
+	#define DATASTORE_POOL_DEQUE 1024
+#endif
+
+/**
+ * @brief Minimum number of elements processed by a task of the vector methods
+ */
+#ifndef DATASTORE_POOL_MIN_GRAIN
+	#define DATASTORE_POOL_MIN_GRAIN 1024
+#endif
+
+/* Deque indices are kept on separate cache lines, so the owner and thieves do not share them */
+#define DATASTORE_POOL_CACHE_LINE 64
+
+struct datastore_pool_job
+{
+	void (*fn)(void *ctx, size_t begin, size_t end);
+	void *ctx;
+	size_t grain;
+	/* Tasks not yet completed, the job is over when it drops to zero */
+	size_t pending;
+};
+
+struct datastore_pool_task
+{
+	struct datastore_pool_job *job;
+	size_t begin;
+	size_t end;
+};
+
+struct datastore_pool_deque
+{
+	int64_t top;
+	unsigned char pad_top[DATASTORE_POOL_CACHE_LINE - sizeof(int64_t)];
+	int64_t bottom;
+	unsigned char pad_bottom[DATASTORE_POOL_CACHE_LINE - sizeof(int64_t)];
+	struct datastore_pool_task tasks[DATASTORE_POOL_DEQUE];
+};
+
+struct datastore_pool_worker
+{
+	struct datastore_pool *pool;
+	size_t index;
+	uint32_t seed;
+};
+
+/**
+ * @brief Work-stealing thread pool
+ *
+ * Index `0` is the thread submitting loops, workers are indices `1` to `threads - 1`.
+ */
+struct datastore_pool
+{
+	size_t threads;
+	struct datastore_pool_deque *deques;
+	struct datastore_pool_worker *workers;
+	pthread_t *handles;
+	/* Guards `active` and `stop` for sleeping workers */
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	/* Serializes loops submitted from different threads */
+	pthread_mutex_t submit;
+	int active;
+	int stop;
+};
+
+// {{{ Chase-Lev deque
+/*
+ * Task fields are accessed atomically, since a thief may read a slot the owner is reusing; such
+ * a thief then fails its compare-and-swap and discards what it read.
+ */
+static inline void datastore_pool_slot_store(struct datastore_pool_task *slot, struct datastore_pool_task task)
+{
+	__atomic_store_n(&slot->job, task.job, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->begin, task.begin, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->end, task.end, __ATOMIC_RELAXED);
+}
+
+static inline struct datastore_pool_task datastore_pool_slot_load(struct datastore_pool_task *slot)
+{
+	struct datastore_pool_task task;
+	task.job = __atomic_load_n(&slot->job, __ATOMIC_RELAXED);
+	task.begin = __atomic_load_n(&slot->begin, __ATOMIC_RELAXED);
+	task.end = __atomic_load_n(&slot->end, __ATOMIC_RELAXED);
+	return task;
+}
+
+/* Owner only: pushes to the bottom, returns false when the deque is full */
+static inline bool datastore_pool_push(struct datastore_pool_deque *deque, struct datastore_pool_task task)
+{
+	const int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+	const int64_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+	if (bottom - top >= DATASTORE_POOL_DEQUE)
+		return false;
+	datastore_pool_slot_store(&deque->tasks[(uint64_t)bottom % DATASTORE_POOL_DEQUE], task);
+	__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/* Owner only: pops from the bottom */
+static inline bool datastore_pool_take(struct datastore_pool_deque *deque, struct datastore_pool_task *task)
+{
+	const int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+	__atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	int64_t top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+	if (top > bottom)
+	{
+		__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+		return false;
+	}
+	*task = datastore_pool_slot_load(&deque->tasks[(uint64_t)bottom % DATASTORE_POOL_DEQUE]);
+	if (top != bottom)
+		return true;
+	// Last task: race against thieves for it
+	const bool won = __atomic_compare_exchange_n(&deque->top, &top, top + 1, false,
+		__ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+	__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+	return won;
+}
+
+/* Any thread: pops from the top */
+static inline bool datastore_pool_steal(struct datastore_pool_deque *deque, struct datastore_pool_task *task)
+{
+	int64_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	const int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+	if (top >= bottom)
+		return false;
+	*task = datastore_pool_slot_load(&deque->tasks[(uint64_t)top % DATASTORE_POOL_DEQUE]);
+	return __atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+// }}}
+
+/* Runs a task on thread `self`, pushing the right halves of its range for other threads */
+static inline void datastore_pool_run(struct datastore_pool *pool, size_t self, struct datastore_pool_task task)
+{
+	struct datastore_pool_job *job = task.job;
+	while (task.end - task.begin > job->grain)
+	{
+		// Splits on a multiple of the grain, so leaves are aligned on it
+		const size_t chunks = (task.end - task.begin + job->grain - 1) / job->grain;
+		const size_t mid = task.begin + chunks / 2 * job->grain;
+		__atomic_add_fetch(&job->pending, 1, __ATOMIC_RELAXED);
+		if (!datastore_pool_push(&pool->deques[self], (struct datastore_pool_task){ job, mid, task.end }))
+		{
+			__atomic_sub_fetch(&job->pending, 1, __ATOMIC_RELAXED);
+			break;
+		}
+		task.end = mid;
+	}
+	job->fn(job->ctx, task.begin, task.end);
+	__atomic_sub_fetch(&job->pending, 1, __ATOMIC_RELEASE);
+}
+
+/* Takes from the own deque first, then tries every other deque from a random one */
+static inline bool datastore_pool_find(struct datastore_pool *pool, size_t self, uint32_t *seed,
+		struct datastore_pool_task *task)
+{
+	if (datastore_pool_take(&pool->deques[self], task))
+		return true;
+	*seed = *seed * 1664525u + 1013904223u;
+	const size_t start = (size_t)(*seed >> 8) % pool->threads;
+	for (size_t i = 0; i < pool->threads; ++i)
+	{
+		const size_t victim = (start + i) % pool->threads;
+		if (victim != self && datastore_pool_steal(&pool->deques[victim], task))
+			return true;
+	}
+	return false;
+}
+
+static inline void *datastore_pool_worker_main(void *arg)
+{
+	struct datastore_pool_worker *worker = arg;
+	struct datastore_pool *pool = worker->pool;
+	for (;;)
+	{
+		struct datastore_pool_task task;
+		if (datastore_pool_find(pool, worker->index, &worker->seed, &task))
+		{
+			datastore_pool_run(pool, worker->index, task);
+			continue;
+		}
+		if (__atomic_load_n(&pool->active, __ATOMIC_ACQUIRE))
+		{
+			sched_yield();
+			continue;
+		}
+		pthread_mutex_lock(&pool->lock);
+		while (!pool->active && !pool->stop)
+			pthread_cond_wait(&pool->wake, &pool->lock);
+		const int stop = pool->stop;
+		pthread_mutex_unlock(&pool->lock);
+		if (stop)
+			return NULL;
+	}
+}
+
+/**
+ * @brief Releases the pool, after joining its workers
+ *
+ * No loop may be running.
+ */
+static inline void datastore_pool_free(struct datastore_pool *pool)
+{
+	if (!pool)
+		return;
+	pthread_mutex_lock(&pool->lock);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	for (size_t i = 1; i < pool->threads; ++i)
+		if (pool->workers[i].pool)
+			pthread_join(pool->handles[i], NULL);
+	pthread_cond_destroy(&pool->wake);
+	pthread_mutex_destroy(&pool->lock);
+	pthread_mutex_destroy(&pool->submit);
+	datastore_vec_aligned_free(pool->deques);
+	free(pool->workers);
+	free(pool->handles);
+	free(pool);
+}
+
+/**
+ * @brief Creates a pool
+ *
+ * @param threads Number of threads running loops, including the calling thread. `0` uses one
+ * thread per online processor
+ *
+ * @returns The pool, `NULL` on failure
+ */
+static inline struct datastore_pool *datastore_pool_new(size_t threads)
+{
+	if (threads == 0)
+	{
+		const long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = online > 0 ? (size_t)online : 1;
+	}
+	struct datastore_pool *pool = calloc(1, sizeof(*pool));
+	if (!pool)
+		return NULL;
+	pool->threads = threads;
+	pool->deques = datastore_vec_aligned_alloc(DATASTORE_POOL_CACHE_LINE, threads * sizeof(*pool->deques));
+	pool->workers = calloc(threads, sizeof(*pool->workers));
+	pool->handles = calloc(threads, sizeof(*pool->handles));
+	if (!pool->deques || !pool->workers || !pool->handles)
+	{
+		datastore_vec_aligned_free(pool->deques);
+		free(pool->workers);
+		free(pool->handles);
+		free(pool);
+		return NULL;
+	}
+	memset(pool->deques, 0, threads * sizeof(*pool->deques));
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_mutex_init(&pool->submit, NULL);
+	pthread_cond_init(&pool->wake, NULL);
+	// Worker 0 is the submitting thread, it only needs a seed
+	pool->workers[0].seed = 1;
+	for (size_t i = 1; i < threads; ++i)
+	{
+		pool->workers[i] = (struct datastore_pool_worker){ .pool = pool, .index = i, .seed = (uint32_t)i * 2654435761u };
+		if (pthread_create(&pool->handles[i], NULL, datastore_pool_worker_main, &pool->workers[i]) != 0)
+		{
+			pool->workers[i].pool = NULL;
+			datastore_pool_free(pool);
+			return NULL;
+		}
+	}
+	return pool;
+}
+
+/**
+ * @brief Number of threads of the pool, `1` for a `NULL` pool
+ */
+static inline size_t datastore_pool_threads(const struct datastore_pool *pool)
+{
+	return pool ? pool->threads : 1;
+}
+
+/**
+ * @brief Grain giving each thread several tasks to balance, but not less than `min`
+ */
+static inline size_t datastore_pool_grain(const struct datastore_pool *pool, size_t size, size_t min)
+{
+	const size_t grain = size / (datastore_pool_threads(pool) * 8);
+	return grain > min ? grain : (min ? min : 1);
+}
+
+/**
+ * @brief Calls `fn` on ranges covering `[0, size)`, in parallel
+ *
+ * Ranges are at most `grain` long, except when a deque is full, and start on a multiple of
+ * `grain`. Returns once every range is processed. With a `NULL` pool, calls `fn` once on the
+ * whole range.
+ *
+ * Loops must not be started from inside `fn`.
+ */
+static inline void datastore_pool_for(struct datastore_pool *pool, size_t size, size_t grain,
+		void (*fn)(void *ctx, size_t begin, size_t end), void *ctx)
+{
+	if (size == 0)
+		return;
+	if (!pool || pool->threads == 1 || size <= grain)
+	{
+		fn(ctx, 0, size);
+		return;
+	}
+	pthread_mutex_lock(&pool->submit);
+	struct datastore_pool_job job = { .fn = fn, .ctx = ctx, .grain = grain ? grain : 1, .pending = 1 };
+	datastore_pool_push(&pool->deques[0], (struct datastore_pool_task){ &job, 0, size });
+	pthread_mutex_lock(&pool->lock);
+	__atomic_store_n(&pool->active, 1, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	while (__atomic_load_n(&job.pending, __ATOMIC_ACQUIRE))
+	{
+		struct datastore_pool_task task;
+		if (datastore_pool_find(pool, 0, &pool->workers[0].seed, &task))
+			datastore_pool_run(pool, 0, task);
+		else
+			sched_yield();
+	}
+	pthread_mutex_lock(&pool->lock);
+	__atomic_store_n(&pool->active, 0, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&pool->lock);
+	pthread_mutex_unlock(&pool->submit);
+}
+
+/**
+ * @brief Parallel methods declaration
+ *
+ * @param trait__ Vector type-trait, see @ref trait_type "Trait Type"
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_PARALLEL(trait__, name__) \
+void DATASTORE_IDENT(name__, par_for_each)(struct name__ *self, struct datastore_pool *pool, \
+	void (*fn)(trait__(DATASTORE_VEC_TRAIT_TYPE) *value, void *ctx), void *ctx); \
+struct name__ DATASTORE_IDENT(name__, par_transform)(const struct name__ *self, struct datastore_pool *pool, \
+	void (*fn)(trait__(DATASTORE_VEC_TRAIT_TYPE) *out, trait__(DATASTORE_VEC_TRAIT_TYPE) const *value, void *ctx), \
+	void *ctx); \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, par_reduce)(const struct name__ *self, \
+	struct datastore_pool *pool, trait__(DATASTORE_VEC_TRAIT_TYPE) identity, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) (*op)(trait__(DATASTORE_VEC_TRAIT_TYPE) lhs, trait__(DATASTORE_VEC_TRAIT_TYPE) rhs)); \
+struct name__ DATASTORE_IDENT(name__, par_clone)(const struct name__ *self, struct datastore_pool *pool);
+
+/**
+ * @brief Parallel methods implementation
+ *
+ * @param trait__ Vector type-trait, see @ref trait_type "Trait Type"
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_PARALLEL_IMPL(trait__, name__) \
+struct DATASTORE_IDENT(name__, impl_par) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *data; \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *out; \
+	void (*for_each)(trait__(DATASTORE_VEC_TRAIT_TYPE) *value, void *ctx); \
+	void (*transform)(trait__(DATASTORE_VEC_TRAIT_TYPE) *out, trait__(DATASTORE_VEC_TRAIT_TYPE) const *value, void *ctx); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) (*op)(trait__(DATASTORE_VEC_TRAIT_TYPE) lhs, trait__(DATASTORE_VEC_TRAIT_TYPE) rhs); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) identity; \
+	size_t grain; \
+	void *ctx; \
+}; \
+static void DATASTORE_IDENT(name__, impl_par_for_each)(void *ctx, size_t begin, size_t end) \
+{ \
+	struct DATASTORE_IDENT(name__, impl_par) *par = ctx; \
+	for (size_t i = begin; i < end; ++i) \
+		par->for_each(par->data + i, par->ctx); \
+} \
+void DATASTORE_IDENT(name__, par_for_each)(struct name__ *self, struct datastore_pool *pool, \
+	void (*fn)(trait__(DATASTORE_VEC_TRAIT_TYPE) *value, void *ctx), void *ctx) \
+{ \
+	struct DATASTORE_IDENT(name__, impl_par) par = { .data = self->data, .for_each = fn, .ctx = ctx }; \
+	datastore_pool_for(pool, self->size, datastore_pool_grain(pool, self->size, DATASTORE_POOL_MIN_GRAIN), \
+		DATASTORE_IDENT(name__, impl_par_for_each), &par); \
+} \
+static void DATASTORE_IDENT(name__, impl_par_transform)(void *ctx, size_t begin, size_t end) \
+{ \
+	struct DATASTORE_IDENT(name__, impl_par) *par = ctx; \
+	for (size_t i = begin; i < end; ++i) \
+		par->transform(par->out + i, par->data + i, par->ctx); \
+} \
+struct name__ DATASTORE_IDENT(name__, par_transform)(const struct name__ *self, struct datastore_pool *pool, \
+	void (*fn)(trait__(DATASTORE_VEC_TRAIT_TYPE) *out, trait__(DATASTORE_VEC_TRAIT_TYPE) const *value, void *ctx), \
+	void *ctx) \
+{ \
+	struct name__ result = DATASTORE_IDENT(name__, new)(self->size); \
+	struct DATASTORE_IDENT(name__, impl_par) par = { .data = self->data, .out = result.data, .transform = fn, .ctx = ctx }; \
+	datastore_pool_for(pool, self->size, datastore_pool_grain(pool, self->size, DATASTORE_POOL_MIN_GRAIN), \
+		DATASTORE_IDENT(name__, impl_par_transform), &par); \
+	result.size = self->size; \
+	return result; \
+} \
+/* Folds every grain-sized chunk of the range into its slot of `out` */ \
+static void DATASTORE_IDENT(name__, impl_par_reduce)(void *ctx, size_t begin, size_t end) \
+{ \
+	struct DATASTORE_IDENT(name__, impl_par) *par = ctx; \
+	for (size_t chunk = begin; chunk < end; chunk += par->grain) \
+	{ \
+		const size_t chunk_end = end - chunk > par->grain ? chunk + par->grain : end; \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) acc = par->identity; \
+		for (size_t i = chunk; i < chunk_end; ++i) \
+			acc = par->op(acc, par->data[i]); \
+		par->out[chunk / par->grain] = acc; \
+	} \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, par_reduce)(const struct name__ *self, \
+	struct datastore_pool *pool, trait__(DATASTORE_VEC_TRAIT_TYPE) identity, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) (*op)(trait__(DATASTORE_VEC_TRAIT_TYPE) lhs, trait__(DATASTORE_VEC_TRAIT_TYPE) rhs)) \
+{ \
+	if (!self->size) \
+		return identity; \
+	const size_t grain = datastore_pool_grain(pool, self->size, DATASTORE_POOL_MIN_GRAIN); \
+	const size_t chunks = (self->size + grain - 1) / grain; \
+	/* Chunk results are plain copies, they are not freed */ \
+	struct name__ partials = DATASTORE_IDENT(name__, new)(chunks); \
+	struct DATASTORE_IDENT(name__, impl_par) par = { \
+		.data = self->data, .out = partials.data, .op = op, .identity = identity, .grain = grain, \
+	}; \
+	datastore_pool_for(pool, self->size, grain, DATASTORE_IDENT(name__, impl_par_reduce), &par); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) acc = identity; \
+	for (size_t i = 0; i < chunks; ++i) \
+		acc = op(acc, partials.data[i]); \
+	DATASTORE_IDENT(name__, free)(&partials); \
+	return acc; \
+} \
+static void DATASTORE_IDENT(name__, impl_par_clone)(void *ctx, size_t begin, size_t end) \
+{ \
+	struct DATASTORE_IDENT(name__, impl_par) *par = ctx; \
+	for (size_t i = begin; i < end; ++i) \
+	{ \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *val = par->data + i; \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *new = par->out + i; \
+		trait__(DATASTORE_VEC_TRAIT_CLONE) \
+	} \
+} \
+struct name__ DATASTORE_IDENT(name__, par_clone)(const struct name__ *self, struct datastore_pool *pool) \
+{ \
+	struct name__ clone = DATASTORE_IDENT(name__, new)(self->size); \
+	struct DATASTORE_IDENT(name__, impl_par) par = { .data = self->data, .out = clone.data }; \
+	datastore_pool_for(pool, self->size, datastore_pool_grain(pool, self->size, DATASTORE_POOL_MIN_GRAIN), \
+		DATASTORE_IDENT(name__, impl_par_clone), &par); \
+	clone.size = self->size; \
+	return clone; \
+}
+
+/**
+ * @brief Parallel sort method declaration
+ *
+ * @param trait__ Vector type-trait, must declare a `CMP`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_PAR_SORT(trait__, name__) \
+void DATASTORE_IDENT(name__, par_sort)(struct name__ *self, struct datastore_pool *pool);
+
+/**
+ * @brief Parallel sort method implementation
+ *
+ * @param trait__ Vector type-trait, must declare a `CMP`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_PAR_SORT_IMPL(trait__, name__) \
+static inline bool DATASTORE_IDENT(name__, impl_par_less)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *lhs, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *rhs) \
+{ \
+	int cmp = 0; \
+	trait__(DATASTORE_VEC_TRAIT_CMP) \
+	return cmp < 0; \
+} \
+DATASTORE_PDQSORT(DATASTORE_IDENT(name__, impl_par_pdqsort), trait__(DATASTORE_VEC_TRAIT_TYPE), \
+	DATASTORE_IDENT(name__, impl_par_less)) \
+struct DATASTORE_IDENT(name__, impl_par_sort) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *src; \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *dst; \
+	size_t size; \
+	/* Length of the sorted runs */ \
+	size_t width; \
+}; \
+static void DATASTORE_IDENT(name__, impl_par_sort_runs)(void *ctx, size_t begin, size_t end) \
+{ \
+	struct DATASTORE_IDENT(name__, impl_par_sort) *sort = ctx; \
+	for (size_t run = begin; run < end; ++run) \
+	{ \
+		const size_t lo = run * sort->width; \
+		const size_t hi = sort->size - lo > sort->width ? lo + sort->width : sort->size; \
+		DATASTORE_IDENT(name__, impl_par_pdqsort)(sort->src + lo, hi - lo); \
+	} \
+} \
+/* Number of elements of `a` among the first `k` elements of the stable merge of `a` and `b` */ \
+static inline size_t DATASTORE_IDENT(name__, impl_par_corank)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *a, size_t na, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *b, size_t nb, size_t k) \
+{ \
+	size_t lo = k > nb ? k - nb : 0; \
+	size_t hi = k < na ? k : na; \
+	while (lo < hi) \
+	{ \
+		const size_t i = lo + (hi - lo) / 2; \
+		const size_t j = k - i; \
+		if (j > 0 && !DATASTORE_IDENT(name__, impl_par_less)(b + j - 1, a + i)) \
+			lo = i + 1; \
+		else \
+			hi = i; \
+	} \
+	return lo; \
+} \
+/* Writes output positions [begin, end) of the merge of every pair of runs */ \
+static void DATASTORE_IDENT(name__, impl_par_sort_merge)(void *ctx, size_t begin, size_t end) \
+{ \
+	struct DATASTORE_IDENT(name__, impl_par_sort) *sort = ctx; \
+	const size_t pair = 2 * sort->width; \
+	for (size_t lo = begin / pair * pair; lo < end; lo += pair) \
+	{ \
+		const size_t mid = sort->size - lo > sort->width ? lo + sort->width : sort->size; \
+		const size_t hi = sort->size - lo > pair ? lo + pair : sort->size; \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) const *a = sort->src + lo; \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) const *b = sort->src + mid; \
+		const size_t na = mid - lo; \
+		const size_t nb = hi - mid; \
+		const size_t from = (begin > lo ? begin : lo) - lo; \
+		const size_t to = (end < hi ? end : hi) - lo; \
+		size_t i = DATASTORE_IDENT(name__, impl_par_corank)(a, na, b, nb, from); \
+		size_t j = from - i; \
+		const size_t i_end = DATASTORE_IDENT(name__, impl_par_corank)(a, na, b, nb, to); \
+		const size_t j_end = to - i_end; \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *out = sort->dst + lo + from; \
+		while (i < i_end && j < j_end) \
+			*out++ = DATASTORE_IDENT(name__, impl_par_less)(b + j, a + i) ? b[j++] : a[i++]; \
+		while (i < i_end) \
+			*out++ = a[i++]; \
+		while (j < j_end) \
+			*out++ = b[j++]; \
+	} \
+} \
+void DATASTORE_IDENT(name__, par_sort)(struct name__ *self, struct datastore_pool *pool) \
+{ \
+	const size_t threads = datastore_pool_threads(pool); \
+	if (threads == 1 || self->size <= DATASTORE_POOL_MIN_GRAIN) \
+	{ \
+		DATASTORE_IDENT(name__, impl_par_pdqsort)(self->data, self->size); \
+		return; \
+	} \
+	/* Two runs per thread, so that stealing can balance uneven runs */ \
+	size_t runs = 2 * threads; \
+	struct DATASTORE_IDENT(name__, impl_par_sort) sort = { \
+		.src = self->data, .size = self->size, .width = (self->size + runs - 1) / runs, \
+	}; \
+	runs = (self->size + sort.width - 1) / sort.width; \
+	datastore_pool_for(pool, runs, 1, DATASTORE_IDENT(name__, impl_par_sort_runs), &sort); \
+	/* Elements are moved bitwise between the buffers, the scratch vector never owns them */ \
+	struct name__ scratch = DATASTORE_IDENT(name__, new)(self->size); \
+	sort.dst = scratch.data; \
+	const size_t grain = datastore_pool_grain(pool, self->size, DATASTORE_POOL_MIN_GRAIN); \
+	for (; sort.width < sort.size; sort.width *= 2) \
+	{ \
+		datastore_pool_for(pool, sort.size, grain, DATASTORE_IDENT(name__, impl_par_sort_merge), &sort); \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *const swap = sort.src; \
+		sort.src = sort.dst; \
+		sort.dst = swap; \
+	} \
+	if (sort.src != self->data) \
+		memcpy(self->data, sort.src, self->size * sizeof(*self->data)); \
+	DATASTORE_IDENT(name__, free)(&scratch); \
+}
+
+/** @endgroup Parallel */
+
+#endif // DATASTORE_PARALLEL_H
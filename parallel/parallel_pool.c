@@ -0,0 +1,85 @@
+#include "test.h"
+
+struct visits
+{
+	unsigned char *counts;
+	size_t grain;
+	// Set when a range is misaligned or too long
+	int bad;
+};
+
+static void visit(void *ctx, size_t begin, size_t end)
+{
+	struct visits *visits = ctx;
+	if (begin % visits->grain != 0 || end - begin > visits->grain)
+		__atomic_store_n(&visits->bad, 1, __ATOMIC_RELAXED);
+	for (size_t i = begin; i < end; ++i)
+		__atomic_add_fetch(&visits->counts[i], 1, __ATOMIC_RELAXED);
+}
+
+static int visit_all(struct datastore_pool *pool, size_t size, size_t grain)
+{
+	struct visits visits = { calloc(size ? size : 1, 1), grain, 0 };
+	if (!visits.counts)
+		abort();
+	datastore_pool_for(pool, size, grain, visit, &visits);
+	int ok = !visits.bad;
+	for (size_t i = 0; i < size; ++i)
+		ok &= visits.counts[i] == 1;
+	free(visits.counts);
+	return ok;
+}
+
+TESTS(parallel_pool, {
+	TEST("new", {
+		struct datastore_pool *pool = datastore_pool_new(3);
+		ASSERT(pool != NULL)
+		ASSERT(datastore_pool_threads(pool) == 3)
+		datastore_pool_free(pool);
+
+		pool = datastore_pool_new(0);
+		ASSERT(pool != NULL)
+		ASSERT(datastore_pool_threads(pool) >= 1)
+		datastore_pool_free(pool);
+
+		ASSERT(datastore_pool_threads(NULL) == 1)
+		datastore_pool_free(NULL);
+	})
+	TEST("for", {
+		struct datastore_pool *pool = datastore_pool_new(4);
+		ASSERT(visit_all(pool, 0, 1))
+		ASSERT(visit_all(pool, 1, 1))
+		ASSERT(visit_all(pool, 1000, 1))
+		ASSERT(visit_all(pool, 100000, 64))
+		ASSERT(visit_all(pool, 12345, 100))
+		// Many loops in a row, workers go back to sleep in between
+		int ok = 1;
+		for (size_t i = 0; i < 200; ++i)
+			ok &= visit_all(pool, 1000 + i, 7);
+		ASSERT(ok)
+		datastore_pool_free(pool);
+	})
+	TEST("serial", {
+		ASSERT(visit_all(NULL, 5000, 5000))
+		struct datastore_pool *pool = datastore_pool_new(1);
+		ASSERT(visit_all(pool, 5000, 5000))
+		datastore_pool_free(pool);
+	})
+	TEST("fine_grain", {
+		// One element per range, ranges are split twenty times
+		struct datastore_pool *pool = datastore_pool_new(2);
+		struct visits visits = { calloc(1 << 20, 1), 1, 0 };
+		datastore_pool_for(pool, 1 << 20, 1, visit, &visits);
+		int ok = 1;
+		for (size_t i = 0; i < 1 << 20; ++i)
+			ok &= visits.counts[i] == 1;
+		free(visits.counts);
+		ASSERT(ok)
+		datastore_pool_free(pool);
+	})
+	TEST("grain", {
+		ASSERT(datastore_pool_grain(NULL, 100, 1024) == 1024)
+		ASSERT(datastore_pool_grain(NULL, 80000, 1024) == 10000)
+		ASSERT(datastore_pool_grain(NULL, 0, 0) == 1)
+	})
+})
@@ -0,0 +1,175 @@
+#include "test.h"
+
+#include <string.h>
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+DATASTORE_VEC(int, vi)
+typedef struct vi vi;
+DATASTORE_VEC_PARALLEL(INT_TRAIT, vi)
+DATASTORE_VEC_PAR_SORT(INT_TRAIT, vi)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vi, SETTINGS)
+DATASTORE_VEC_PARALLEL_IMPL(INT_TRAIT, vi)
+DATASTORE_VEC_PAR_SORT_IMPL(INT_TRAIT, vi)
+
+static char *strdup_(const char *s)
+{
+	const size_t len = strlen(s) + 1;
+	char *copy = malloc(len);
+	if (copy)
+		memcpy(copy, s, len);
+	return copy;
+}
+
+#define STR_TRAIT(X) \
+	X(TYPE, char *) \
+	X(FREE, { free(*val); }) \
+	X(CLONE, { *new = strdup_(*val); if (!*new) abort(); }) \
+	X(CMP, { cmp = strcmp(*lhs, *rhs); })
+DATASTORE_VEC(char *, vs)
+typedef struct vs vs;
+DATASTORE_VEC_PARALLEL(STR_TRAIT, vs)
+DATASTORE_VEC_PAR_SORT(STR_TRAIT, vs)
+DATASTORE_VEC_IMPL_S(STR_TRAIT, vs, SETTINGS)
+DATASTORE_VEC_PARALLEL_IMPL(STR_TRAIT, vs)
+DATASTORE_VEC_PAR_SORT_IMPL(STR_TRAIT, vs)
+
+static unsigned next(unsigned *state)
+{
+	*state = *state * 1103515245u + 12345u;
+	return *state >> 16;
+}
+
+static vi random_ints(size_t size, unsigned seed, unsigned range)
+{
+	vi v = vi_new(size);
+	for (size_t i = 0; i < size; ++i)
+		vi_push(&v, (int)(next(&seed) % range) - (int)(range / 2));
+	return v;
+}
+
+static void twice(int *value, void *ctx)
+{
+	DATASTORE_MAYBE_UNUSED(ctx);
+	*value *= 2;
+}
+
+static void add(int *out, int const *value, void *ctx)
+{
+	*out = *value + *(const int *)ctx;
+}
+
+static int sum(int lhs, int rhs)
+{
+	return lhs + rhs;
+}
+
+static int is_sorted(const vi *v)
+{
+	int ok = 1;
+	for (size_t i = 1; i < v->size; ++i)
+		ok &= v->data[i - 1] <= v->data[i];
+	return ok;
+}
+
+TESTS(parallel_vec, {
+	TEST("for_each", {
+		struct datastore_pool *pool = datastore_pool_new(4);
+		vi v = random_ints(100000, 1, 1000);
+		vi_par_for_each(&v, pool, twice, NULL);
+		vi expected = random_ints(100000, 1, 1000);
+		int ok = v.size == expected.size;
+		for (size_t i = 0; ok && i < v.size; ++i)
+			ok &= v.data[i] == expected.data[i] * 2;
+		ASSERT(ok)
+		vi_free(&expected);
+		vi_free(&v);
+		datastore_pool_free(pool);
+	})
+	TEST("transform", {
+		struct datastore_pool *pool = datastore_pool_new(3);
+		vi v = random_ints(50000, 2, 1000);
+		int offset = 7;
+		vi out = vi_par_transform(&v, pool, add, &offset);
+		ASSERT(out.size == v.size)
+		int ok = 1;
+		for (size_t i = 0; i < v.size; ++i)
+			ok &= out.data[i] == v.data[i] + 7;
+		ASSERT(ok)
+		vi_free(&out);
+		vi empty = vi_new(0);
+		out = vi_par_transform(&empty, pool, add, &offset);
+		ASSERT(out.size == 0)
+		vi_free(&out);
+		vi_free(&empty);
+		vi_free(&v);
+		datastore_pool_free(pool);
+	})
+	TEST("reduce", {
+		vi v = random_ints(123457, 3, 1000);
+		int expected = 0;
+		for (size_t i = 0; i < v.size; ++i)
+			expected += v.data[i];
+		int ok = 1;
+		for (size_t threads = 1; threads <= 4; ++threads)
+		{
+			struct datastore_pool *pool = datastore_pool_new(threads);
+			ok &= vi_par_reduce(&v, pool, 0, sum) == expected;
+			datastore_pool_free(pool);
+		}
+		ASSERT(ok)
+		ASSERT(vi_par_reduce(&v, NULL, 0, sum) == expected)
+		vi empty = vi_new(0);
+		ASSERT(vi_par_reduce(&empty, NULL, 42, sum) == 42)
+		vi_free(&empty);
+		vi_free(&v);
+	})
+	TEST("sort", {
+		struct datastore_pool *pool = datastore_pool_new(4);
+		const size_t sizes[] = { 0, 1, 1000, 1025, 4099, 100000, 262144 };
+		int ok = 1;
+		for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+		{
+			vi v = random_ints(sizes[i], (unsigned)i + 4, 1u << 15);
+			const int total = vi_par_reduce(&v, NULL, 0, sum);
+			vi_par_sort(&v, pool);
+			ok &= v.size == sizes[i] && is_sorted(&v) && vi_par_reduce(&v, NULL, 0, sum) == total;
+			vi_free(&v);
+		}
+		ASSERT(ok)
+		// Few distinct keys
+		vi v = random_ints(50000, 11, 4);
+		vi_par_sort(&v, pool);
+		ASSERT(is_sorted(&v))
+		vi_free(&v);
+		datastore_pool_free(pool);
+	})
+	TEST("strings", {
+		struct datastore_pool *pool = datastore_pool_new(4);
+		vs v = vs_new(0);
+		unsigned state = 5;
+		char buf[16];
+		for (size_t i = 0; i < 20000; ++i)
+		{
+			snprintf(buf, sizeof(buf), "%u", next(&state));
+			vs_push(&v, strdup_(buf));
+		}
+		vs clone = vs_par_clone(&v, pool);
+		ASSERT(clone.size == v.size)
+		int ok = 1;
+		for (size_t i = 0; i < v.size; ++i)
+			ok &= clone.data[i] != v.data[i] && !strcmp(clone.data[i], v.data[i]);
+		ASSERT(ok)
+
+		vs_par_sort(&clone, pool);
+		for (size_t i = 1; i < clone.size; ++i)
+			ok &= strcmp(clone.data[i - 1], clone.data[i]) <= 0;
+		ASSERT(ok)
+		vs_free(&clone);
+		vs_free(&v);
+		datastore_pool_free(pool);
+	})
+})
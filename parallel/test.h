@@ -0,0 +1,18 @@
+#ifndef DATASTORE_PARALLEL_TEST_H
+#define DATASTORE_PARALLEL_TEST_H
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../tests/tests.h"
+#include "parallel.h"
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+extern const unit_test test_parallel_pool;
+extern const unit_test test_parallel_vec;
+
+#endif // DATASTORE_PARALLEL_TEST_H
@@ -0,0 +1,470 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_QUEUE_H
+#define DATASTORE_QUEUE_H
+
+#include "../vector/vector.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file queue.h
+ * @defgroup Queue DATASTORE_SPSC, DATASTORE_MPMC: Bounded concurrent queues
+ *
+ * @brief Bounded ring-buffer queues to pass elements between threads
+ *
+ * Two queues are provided, both with a fixed power-of-two capacity and without any lock:
+ * - @ref DATASTORE_SPSC "DATASTORE_SPSC": single producer, single consumer. `push` and `pop` are
+ *   wait-free. The producer owns `tail` and the consumer owns `head`, each on its own cache line
+ *   with a cached copy of the other index, so the other line is only read when the cached copy
+ *   says the queue looks full (or empty).
+ * - @ref DATASTORE_MPMC "DATASTORE_MPMC": any number of producers and consumers. Each slot has a
+ *   sequence number telling which lap of the ring may write or read it next (Dmitry Vyukov's
+ *   bounded queue), so producers and consumers only contend on their own position counter.
+ *
+ * `push_n` and `pop_n` move up to `count` elements with one update of the shared indices, to
+ * amortize the atomics when passing elements in batches. They move as many elements as possible
+ * and return how many were moved.
+ *
+ * Elements are moved in and out of the queue with a plain copy: a pushed element belongs to the
+ * queue, a popped one to the caller. `free` releases the elements left in the queue with the trait
+ * `FREE`, see @ref trait_type "Trait Type". The ring is allocated with the `NEW` and `FREE`
+ * settings (and `ALIGN`) of @ref advanced_usage "Advanced Usage".
+ *
+ * Atomics use the GCC `__atomic` builtins. `new` and `free` are not thread-safe.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define JOB_TRAIT(X) \
+ * 	X(TYPE, struct job *) \
+ * 	X(FREE, { job_free(*val); }) \
+ * 	X(CLONE, { *new = job_clone(*val); })
+ *
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_SPSC(struct job *, stage)
+ * DATASTORE_MPMC(struct job *, jobs)
+ * // Methods definition (in the .c)
+ * DATASTORE_SPSC_IMPL(JOB_TRAIT, stage)
+ * DATASTORE_MPMC_IMPL(JOB_TRAIT, jobs)
+ *
+ * struct jobs queue = jobs_new(1024);
+ * // Producers
+ * while (!jobs_push(&queue, job))
+ * 	sched_yield();
+ * // Consumers
+ * struct job *batch[32];
+ * const size_t count = jobs_pop_n(&queue, batch, 32);
+ * @endcode
+ *
+ * **Macro `DATASTORE_SPSC(type, name)`** and **`DATASTORE_MPMC(type, name)`**: Define a new queue
+ * type
+ *
+ * **Macro `DATASTORE_SPSC_IMPL(trait, name)`**, **`DATASTORE_SPSC_IMPL_S(trait, name, settings)`**,
+ * **`DATASTORE_MPMC_IMPL(trait, name)`** and **`DATASTORE_MPMC_IMPL_S(trait, name, settings)`**:
+ * Implements methods for a queue type
+ *
+ * ## Exposed methods
+ *
+ * Both queues expose:
+ * - `queue new(size_t capacity)`: Create a queue holding at least `capacity` elements, rounded up
+ *   to a power of two
+ * - `void free(struct queue *self)`: Free the queue and the elements left in it
+ * - `bool push(struct queue *self, type value)`: Push an element, returns false when the queue is
+ *   full
+ * - `bool pop(struct queue *self, type *out)`: Pop an element into `out`, returns false when the
+ *   queue is empty
+ * - `size_t push_n(struct queue *self, const type *values, size_t count)`: Push up to `count`
+ *   elements, returns the number pushed
+ * - `size_t pop_n(struct queue *self, type *out, size_t count)`: Pop up to `count` elements, returns
+ *   the number popped
+ * - `size_t size(const struct queue *self)`: Number of elements, only a snapshot when other threads
+ *   use the queue
+ * - `size_t capacity(const struct queue *self)`: Number of slots
+ */
+
+/* Indices owned by different threads are kept on separate cache lines */
+#define DATASTORE_QUEUE_CACHE_LINE 64
+
+/**
+ * @brief Smallest power of two at least `capacity` and `min`
+ */
+static inline size_t datastore_queue_capacity(size_t capacity, size_t min)
+{
+	size_t rounded = min;
+	while (rounded < capacity)
+		rounded <<= 1;
+	return rounded;
+}
+
+// {{{ SPSC
+/**
+ * @brief Single-producer single-consumer queue type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the queue type
+ */
+#define DATASTORE_SPSC(type__, name__) \
+struct name__ \
+{ \
+	type__ *data; \
+	size_t mask; \
+	unsigned char pad_data[DATASTORE_QUEUE_CACHE_LINE - sizeof(type__ *) - sizeof(size_t)]; \
+	/* Written by the consumer */ \
+	size_t head; \
+	size_t cached_tail; \
+	unsigned char pad_head[DATASTORE_QUEUE_CACHE_LINE - 2 * sizeof(size_t)]; \
+	/* Written by the producer */ \
+	size_t tail; \
+	size_t cached_head; \
+	unsigned char pad_tail[DATASTORE_QUEUE_CACHE_LINE - 2 * sizeof(size_t)]; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+bool DATASTORE_IDENT(name__, push)(struct name__ *self, type__ value); \
+bool DATASTORE_IDENT(name__, pop)(struct name__ *self, type__ *out); \
+size_t DATASTORE_IDENT(name__, push_n)(struct name__ *self, type__ const *values, size_t count); \
+size_t DATASTORE_IDENT(name__, pop_n)(struct name__ *self, type__ *out, size_t count); \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self); \
+size_t DATASTORE_IDENT(name__, capacity)(const struct name__ *self);
+
+/**
+ * @brief Single-producer single-consumer queue methods implementation
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the queue, must match the name passed to @ref DATASTORE_SPSC
+ * @param settings__ Allocation settings for the ring, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_SPSC_IMPL_S(trait__, name__, settings__) \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity) \
+{ \
+	struct name__ self = { .mask = datastore_queue_capacity(capacity, 1) - 1 }; \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(sizeof(*ptr) * (self.mask + 1), align); \
+	size_t usable = size; \
+	settings__(DATASTORE_VEC_SETTINGS_NEW) \
+	DATASTORE_MAYBE_UNUSED(usable); \
+	self.data = ptr; \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	for (size_t i = self->head; i != self->tail; ++i) \
+	{ \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *val = &self->data[i & self->mask]; \
+		DATASTORE_MAYBE_UNUSED(val); \
+		trait__(DATASTORE_VEC_TRAIT_FREE) \
+	} \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->data; \
+	const size_t size = (self->mask + 1) * sizeof(*ptr); \
+	DATASTORE_MAYBE_UNUSED(size); \
+	settings__(DATASTORE_VEC_SETTINGS_FREE) \
+	self->data = NULL; \
+	self->head = self->tail = self->cached_head = self->cached_tail = 0; \
+} \
+bool DATASTORE_IDENT(name__, push)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	return DATASTORE_IDENT(name__, push_n)(self, &value, 1) == 1; \
+} \
+bool DATASTORE_IDENT(name__, pop)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) *out) \
+{ \
+	return DATASTORE_IDENT(name__, pop_n)(self, out, 1) == 1; \
+} \
+size_t DATASTORE_IDENT(name__, push_n)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) const *values, \
+	size_t count) \
+{ \
+	const size_t tail = __atomic_load_n(&self->tail, __ATOMIC_RELAXED); \
+	size_t room = self->mask + 1 - (tail - self->cached_head); \
+	if (room < count) \
+	{ \
+		self->cached_head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE); \
+		room = self->mask + 1 - (tail - self->cached_head); \
+		count = count < room ? count : room; \
+	} \
+	/* The slots wrap at most once */ \
+	const size_t start = tail & self->mask; \
+	const size_t first = count < self->mask + 1 - start ? count : self->mask + 1 - start; \
+	memcpy(self->data + start, values, first * sizeof(*values)); \
+	memcpy(self->data, values + first, (count - first) * sizeof(*values)); \
+	__atomic_store_n(&self->tail, tail + count, __ATOMIC_RELEASE); \
+	return count; \
+} \
+size_t DATASTORE_IDENT(name__, pop_n)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) *out, size_t count) \
+{ \
+	const size_t head = __atomic_load_n(&self->head, __ATOMIC_RELAXED); \
+	size_t available = self->cached_tail - head; \
+	if (available < count) \
+	{ \
+		self->cached_tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE); \
+		available = self->cached_tail - head; \
+		count = count < available ? count : available; \
+	} \
+	const size_t start = head & self->mask; \
+	const size_t first = count < self->mask + 1 - start ? count : self->mask + 1 - start; \
+	memcpy(out, self->data + start, first * sizeof(*out)); \
+	memcpy(out + first, self->data, (count - first) * sizeof(*out)); \
+	__atomic_store_n(&self->head, head + count, __ATOMIC_RELEASE); \
+	return count; \
+} \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self) \
+{ \
+	const size_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE); \
+	const size_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE); \
+	/* A concurrent pop may move `head` past the `tail` loaded before it */ \
+	return tail - head <= self->mask + 1 ? tail - head : 0; \
+} \
+size_t DATASTORE_IDENT(name__, capacity)(const struct name__ *self) \
+{ \
+	return self->mask + 1; \
+}
+
+/**
+ * @brief Single-producer single-consumer queue methods implementation
+ *
+ * This macro will call @ref DATASTORE_SPSC_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the queue, must match the name passed to @ref DATASTORE_SPSC
+ */
+#define DATASTORE_SPSC_IMPL(trait__, name__) \
+	DATASTORE_SPSC_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+// }}}
+
+// {{{ MPMC
+/**
+ * @brief Multi-producer multi-consumer queue type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the queue type
+ */
+#define DATASTORE_MPMC(type__, name__) \
+struct DATASTORE_IDENT(name__, cell) \
+{ \
+	/* Position that may use the cell next: `pos` to push, `pos + 1` to pop */ \
+	size_t sequence; \
+	type__ value; \
+}; \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, cell) *cells; \
+	size_t mask; \
+	unsigned char pad_cells[DATASTORE_QUEUE_CACHE_LINE - sizeof(void *) - sizeof(size_t)]; \
+	size_t enqueue; \
+	unsigned char pad_enqueue[DATASTORE_QUEUE_CACHE_LINE - sizeof(size_t)]; \
+	size_t dequeue; \
+	unsigned char pad_dequeue[DATASTORE_QUEUE_CACHE_LINE - sizeof(size_t)]; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+bool DATASTORE_IDENT(name__, push)(struct name__ *self, type__ value); \
+bool DATASTORE_IDENT(name__, pop)(struct name__ *self, type__ *out); \
+size_t DATASTORE_IDENT(name__, push_n)(struct name__ *self, type__ const *values, size_t count); \
+size_t DATASTORE_IDENT(name__, pop_n)(struct name__ *self, type__ *out, size_t count); \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self); \
+size_t DATASTORE_IDENT(name__, capacity)(const struct name__ *self);
+
+/**
+ * @brief Multi-producer multi-consumer queue methods implementation
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the queue, must match the name passed to @ref DATASTORE_MPMC
+ * @param settings__ Allocation settings for the ring, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_MPMC_IMPL_S(trait__, name__, settings__) \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity) \
+{ \
+	/* A single cell cannot tell a full queue from an empty one */ \
+	struct name__ self = { .mask = datastore_queue_capacity(capacity, 2) - 1 }; \
+	struct DATASTORE_IDENT(name__, cell) *ptr; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(sizeof(*ptr) * (self.mask + 1), align); \
+	size_t usable = size; \
+	settings__(DATASTORE_VEC_SETTINGS_NEW) \
+	DATASTORE_MAYBE_UNUSED(usable); \
+	for (size_t i = 0; i <= self.mask; ++i) \
+		ptr[i].sequence = i; \
+	self.cells = ptr; \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	for (size_t i = self->dequeue; i != self->enqueue; ++i) \
+	{ \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *val = &self->cells[i & self->mask].value; \
+		DATASTORE_MAYBE_UNUSED(val); \
+		trait__(DATASTORE_VEC_TRAIT_FREE) \
+	} \
+	struct DATASTORE_IDENT(name__, cell) *ptr = self->cells; \
+	const size_t size = (self->mask + 1) * sizeof(*ptr); \
+	DATASTORE_MAYBE_UNUSED(size); \
+	settings__(DATASTORE_VEC_SETTINGS_FREE) \
+	self->cells = NULL; \
+	self->enqueue = self->dequeue = 0; \
+} \
+bool DATASTORE_IDENT(name__, push)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	size_t pos = __atomic_load_n(&self->enqueue, __ATOMIC_RELAXED); \
+	struct DATASTORE_IDENT(name__, cell) *cell; \
+	for (;;) \
+	{ \
+		cell = &self->cells[pos & self->mask]; \
+		const size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE); \
+		const intptr_t diff = (intptr_t)(sequence - pos); \
+		if (diff == 0) \
+		{ \
+			if (__atomic_compare_exchange_n(&self->enqueue, &pos, pos + 1, true, __ATOMIC_RELAXED, \
+				__ATOMIC_RELAXED)) \
+				break; \
+		} \
+		else if (diff < 0) \
+			return false; \
+		else \
+			pos = __atomic_load_n(&self->enqueue, __ATOMIC_RELAXED); \
+	} \
+	cell->value = value; \
+	__atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE); \
+	return true; \
+} \
+bool DATASTORE_IDENT(name__, pop)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) *out) \
+{ \
+	size_t pos = __atomic_load_n(&self->dequeue, __ATOMIC_RELAXED); \
+	struct DATASTORE_IDENT(name__, cell) *cell; \
+	for (;;) \
+	{ \
+		cell = &self->cells[pos & self->mask]; \
+		const size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE); \
+		const intptr_t diff = (intptr_t)(sequence - (pos + 1)); \
+		if (diff == 0) \
+		{ \
+			if (__atomic_compare_exchange_n(&self->dequeue, &pos, pos + 1, true, __ATOMIC_RELAXED, \
+				__ATOMIC_RELAXED)) \
+				break; \
+		} \
+		else if (diff < 0) \
+			return false; \
+		else \
+			pos = __atomic_load_n(&self->dequeue, __ATOMIC_RELAXED); \
+	} \
+	*out = cell->value; \
+	__atomic_store_n(&cell->sequence, pos + self->mask + 1, __ATOMIC_RELEASE); \
+	return true; \
+} \
+/* \
+ * Batches claim the run of consecutive cells ready at `pos` with a single compare-and-swap, then \
+ * release each cell with its own sequence number. \
+ */ \
+size_t DATASTORE_IDENT(name__, push_n)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) const *values, \
+	size_t count) \
+{ \
+	size_t pos = __atomic_load_n(&self->enqueue, __ATOMIC_RELAXED); \
+	size_t claimed; \
+	for (;;) \
+	{ \
+		claimed = 0; \
+		while (claimed < count && claimed <= self->mask) \
+		{ \
+			const size_t sequence = __atomic_load_n(&self->cells[(pos + claimed) & self->mask].sequence, \
+				__ATOMIC_ACQUIRE); \
+			if (sequence != pos + claimed) \
+				break; \
+			++claimed; \
+		} \
+		if (claimed == 0) \
+		{ \
+			const size_t sequence = __atomic_load_n(&self->cells[pos & self->mask].sequence, __ATOMIC_ACQUIRE); \
+			if (count == 0 || (intptr_t)(sequence - pos) < 0) \
+				return 0; \
+			pos = __atomic_load_n(&self->enqueue, __ATOMIC_RELAXED); \
+			continue; \
+		} \
+		if (__atomic_compare_exchange_n(&self->enqueue, &pos, pos + claimed, true, __ATOMIC_RELAXED, \
+			__ATOMIC_RELAXED)) \
+			break; \
+	} \
+	for (size_t i = 0; i < claimed; ++i) \
+	{ \
+		struct DATASTORE_IDENT(name__, cell) *cell = &self->cells[(pos + i) & self->mask]; \
+		cell->value = values[i]; \
+		__atomic_store_n(&cell->sequence, pos + i + 1, __ATOMIC_RELEASE); \
+	} \
+	return claimed; \
+} \
+size_t DATASTORE_IDENT(name__, pop_n)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) *out, size_t count) \
+{ \
+	size_t pos = __atomic_load_n(&self->dequeue, __ATOMIC_RELAXED); \
+	size_t claimed; \
+	for (;;) \
+	{ \
+		claimed = 0; \
+		while (claimed < count && claimed <= self->mask) \
+		{ \
+			const size_t sequence = __atomic_load_n(&self->cells[(pos + claimed) & self->mask].sequence, \
+				__ATOMIC_ACQUIRE); \
+			if (sequence != pos + claimed + 1) \
+				break; \
+			++claimed; \
+		} \
+		if (claimed == 0) \
+		{ \
+			const size_t sequence = __atomic_load_n(&self->cells[pos & self->mask].sequence, __ATOMIC_ACQUIRE); \
+			if (count == 0 || (intptr_t)(sequence - (pos + 1)) < 0) \
+				return 0; \
+			pos = __atomic_load_n(&self->dequeue, __ATOMIC_RELAXED); \
+			continue; \
+		} \
+		if (__atomic_compare_exchange_n(&self->dequeue, &pos, pos + claimed, true, __ATOMIC_RELAXED, \
+			__ATOMIC_RELAXED)) \
+			break; \
+	} \
+	for (size_t i = 0; i < claimed; ++i) \
+	{ \
+		struct DATASTORE_IDENT(name__, cell) *cell = &self->cells[(pos + i) & self->mask]; \
+		out[i] = cell->value; \
+		__atomic_store_n(&cell->sequence, pos + i + self->mask + 1, __ATOMIC_RELEASE); \
+	} \
+	return claimed; \
+} \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self) \
+{ \
+	const size_t dequeue = __atomic_load_n(&self->dequeue, __ATOMIC_RELAXED); \
+	const size_t enqueue = __atomic_load_n(&self->enqueue, __ATOMIC_RELAXED); \
+	return enqueue - dequeue <= self->mask + 1 ? enqueue - dequeue : 0; \
+} \
+size_t DATASTORE_IDENT(name__, capacity)(const struct name__ *self) \
+{ \
+	return self->mask + 1; \
+}
+
+/**
+ * @brief Multi-producer multi-consumer queue methods implementation
+ *
+ * This macro will call @ref DATASTORE_MPMC_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the queue, must match the name passed to @ref DATASTORE_MPMC
+ */
+#define DATASTORE_MPMC_IMPL(trait__, name__) \
+	DATASTORE_MPMC_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+// }}}
+
+/** @endgroup Queue */
+
+#endif // DATASTORE_QUEUE_H
@@ -0,0 +1,156 @@
+#include "test.h"
+
+DATASTORE_MPMC(uint64_t, mpmcu)
+typedef struct mpmcu mpmcu;
+DATASTORE_MPMC_IMPL_S(U64_TRAIT, mpmcu, SETTINGS)
+DATASTORE_MPMC(char *, mpmcs)
+typedef struct mpmcs mpmcs;
+DATASTORE_MPMC_IMPL_S(STR_TRAIT, mpmcs, SETTINGS)
+
+#define THREADS 3
+#define PER_PRODUCER 50000
+
+struct worker
+{
+	mpmcu *queue;
+	uint64_t id;
+	// Consumers count the values they received, and check each producer's values are in order
+	unsigned char *seen;
+	uint64_t last[THREADS];
+	size_t *remaining;
+	int bad;
+};
+
+static void *produce(void *arg)
+{
+	struct worker *worker = arg;
+	uint64_t values[4];
+	for (uint64_t i = 0; i < PER_PRODUCER;)
+	{
+		const size_t count = worker->id % 2 ? 1 : (PER_PRODUCER - i < 4 ? (size_t)(PER_PRODUCER - i) : 4);
+		for (size_t j = 0; j < count; ++j)
+			values[j] = worker->id * PER_PRODUCER + i + j;
+		const size_t pushed = count == 1 ? (size_t)mpmcu_push(worker->queue, values[0])
+			: mpmcu_push_n(worker->queue, values, count);
+		if (!pushed)
+			sched_yield();
+		i += pushed;
+	}
+	return NULL;
+}
+
+static void *consume(void *arg)
+{
+	struct worker *worker = arg;
+	uint64_t out[5];
+	while (__atomic_load_n(worker->remaining, __ATOMIC_RELAXED))
+	{
+		size_t count = worker->id % 2 ? mpmcu_pop_n(worker->queue, out, 5) : (size_t)mpmcu_pop(worker->queue, out);
+		if (!count)
+			sched_yield();
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint64_t producer = out[i] / PER_PRODUCER;
+			if (producer >= THREADS || (worker->last[producer] && out[i] <= worker->last[producer] - 1))
+				worker->bad = 1;
+			else
+			{
+				worker->last[producer] = out[i] + 1;
+				__atomic_add_fetch(&worker->seen[out[i]], 1, __ATOMIC_RELAXED);
+			}
+		}
+		__atomic_sub_fetch(worker->remaining, count, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+static int run_threads(void)
+{
+	mpmcu q = mpmcu_new(32);
+	unsigned char *seen = calloc(THREADS * PER_PRODUCER, 1);
+	if (!seen)
+		abort();
+	size_t remaining = THREADS * PER_PRODUCER;
+	struct worker producers[THREADS], consumers[THREADS];
+	pthread_t threads[2 * THREADS];
+	for (size_t i = 0; i < THREADS; ++i)
+	{
+		memset(&producers[i], 0, sizeof(producers[i]));
+		producers[i].queue = &q;
+		producers[i].id = i;
+		consumers[i] = producers[i];
+		consumers[i].seen = seen;
+		consumers[i].remaining = &remaining;
+		if (pthread_create(&threads[i], NULL, produce, &producers[i])
+			|| pthread_create(&threads[THREADS + i], NULL, consume, &consumers[i]))
+			abort();
+	}
+	for (size_t i = 0; i < 2 * THREADS; ++i)
+		pthread_join(threads[i], NULL);
+	int ok = mpmcu_size(&q) == 0;
+	for (size_t i = 0; i < THREADS; ++i)
+		ok &= !consumers[i].bad;
+	for (size_t i = 0; i < THREADS * PER_PRODUCER; ++i)
+		ok &= seen[i] == 1;
+	free(seen);
+	mpmcu_free(&q);
+	return ok;
+}
+
+TESTS(queue_mpmc, {
+	TEST("fifo", {
+		mpmcu q = mpmcu_new(1);
+		ASSERT(mpmcu_capacity(&q) == 2)
+		mpmcu_free(&q);
+		q = mpmcu_new(4);
+		uint64_t out;
+		ASSERT(!mpmcu_pop(&q, &out))
+		int ok = 1;
+		// Several laps around the ring
+		for (uint64_t lap = 0; lap < 3; ++lap)
+		{
+			for (uint64_t i = 0; i < 4; ++i)
+				ok &= mpmcu_push(&q, lap * 4 + i);
+			ok &= !mpmcu_push(&q, 0);
+			ok &= mpmcu_size(&q) == 4;
+			for (uint64_t i = 0; i < 4; ++i)
+				ok &= mpmcu_pop(&q, &out) && out == lap * 4 + i;
+			ok &= !mpmcu_pop(&q, &out);
+		}
+		ASSERT(ok)
+		mpmcu_free(&q);
+	})
+	TEST("batches", {
+		mpmcu q = mpmcu_new(8);
+		uint64_t in[16], out[16];
+		for (uint64_t i = 0; i < 16; ++i)
+			in[i] = i;
+		ASSERT(mpmcu_push_n(&q, in, 6) == 6)
+		ASSERT(mpmcu_pop_n(&q, out, 4) == 4)
+		ASSERT(mpmcu_push_n(&q, in + 6, 10) == 6)
+		ASSERT(!mpmcu_push(&q, 0))
+		ASSERT(mpmcu_pop_n(&q, out, 16) == 8)
+		int ok = 1;
+		for (uint64_t i = 0; i < 8; ++i)
+			ok &= out[i] == i + 4;
+		ASSERT(ok)
+		ASSERT(mpmcu_pop_n(&q, out, 16) == 0)
+		ASSERT(mpmcu_push_n(&q, in, 0) == 0)
+		ASSERT(mpmcu_pop_n(&q, out, 0) == 0)
+		mpmcu_free(&q);
+	})
+	TEST("owned", {
+		mpmcs q = mpmcs_new(4);
+		mpmcs_push(&q, queue_test_dup("a"));
+		mpmcs_push(&q, queue_test_dup("b"));
+		char *out;
+		ASSERT(mpmcs_pop(&q, &out))
+		ASSERT(strcmp(out, "a") == 0)
+		iso_free(out);
+		mpmcs_push(&q, queue_test_dup("c"));
+		mpmcs_free(&q);
+	})
+	TEST("threads", {
+		ASSERT(run_threads())
+	})
+})
@@ -0,0 +1,107 @@
+#include "test.h"
+
+DATASTORE_SPSC(uint64_t, spscu)
+typedef struct spscu spscu;
+DATASTORE_SPSC_IMPL_S(U64_TRAIT, spscu, SETTINGS)
+DATASTORE_SPSC(char *, spscs)
+typedef struct spscs spscs;
+DATASTORE_SPSC_IMPL_S(STR_TRAIT, spscs, SETTINGS)
+
+#define MESSAGES 200000
+
+static void *produce(void *arg)
+{
+	spscu *queue = arg;
+	uint64_t values[5];
+	for (uint64_t i = 0; i < MESSAGES;)
+	{
+		// Alternate single pushes and batches
+		if (i % 3)
+		{
+			if (spscu_push(queue, i))
+				++i;
+			else
+				sched_yield();
+			continue;
+		}
+		const size_t count = MESSAGES - i < 5 ? (size_t)(MESSAGES - i) : 5;
+		for (size_t j = 0; j < count; ++j)
+			values[j] = i + j;
+		const size_t pushed = spscu_push_n(queue, values, count);
+		if (!pushed)
+			sched_yield();
+		i += pushed;
+	}
+	return NULL;
+}
+
+TESTS(queue_spsc, {
+	TEST("fifo", {
+		spscu q = spscu_new(5);
+		ASSERT(spscu_capacity(&q) == 8)
+		uint64_t out;
+		ASSERT(!spscu_pop(&q, &out))
+		int ok = 1;
+		for (uint64_t i = 0; i < 8; ++i)
+			ok &= spscu_push(&q, i);
+		ASSERT(ok)
+		ASSERT(!spscu_push(&q, 8))
+		ASSERT(spscu_size(&q) == 8)
+		for (uint64_t i = 0; i < 8; ++i)
+			ok &= spscu_pop(&q, &out) && out == i;
+		ASSERT(ok)
+		ASSERT(spscu_size(&q) == 0)
+		spscu_free(&q);
+	})
+	TEST("batches", {
+		spscu q = spscu_new(8);
+		uint64_t in[16], out[16];
+		for (uint64_t i = 0; i < 16; ++i)
+			in[i] = i;
+		ASSERT(spscu_push_n(&q, in, 6) == 6)
+		ASSERT(spscu_pop_n(&q, out, 4) == 4)
+		// Wraps around the end of the ring, and only 6 slots are free
+		ASSERT(spscu_push_n(&q, in + 6, 10) == 6)
+		ASSERT(spscu_pop_n(&q, out, 16) == 8)
+		int ok = 1;
+		for (uint64_t i = 0; i < 8; ++i)
+			ok &= out[i] == i + 4;
+		ASSERT(ok)
+		ASSERT(spscu_pop_n(&q, out, 16) == 0)
+		ASSERT(spscu_push_n(&q, in, 0) == 0)
+		spscu_free(&q);
+	})
+	TEST("owned", {
+		spscs q = spscs_new(4);
+		spscs_push(&q, queue_test_dup("a"));
+		spscs_push(&q, queue_test_dup("b"));
+		spscs_push(&q, queue_test_dup("c"));
+		char *out;
+		ASSERT(spscs_pop(&q, &out))
+		ASSERT(strcmp(out, "a") == 0)
+		iso_free(out);
+		// The elements left are freed with the queue
+		spscs_free(&q);
+	})
+	TEST("threads", {
+		spscu q = spscu_new(64);
+		pthread_t producer;
+		if (pthread_create(&producer, NULL, produce, &q))
+			abort();
+		uint64_t expected = 0;
+		uint64_t out[7];
+		int ok = 1;
+		while (expected < MESSAGES)
+		{
+			const size_t count = spscu_pop_n(&q, out, expected % 2 ? 7 : 1);
+			if (!count)
+				sched_yield();
+			for (size_t i = 0; i < count; ++i)
+				ok &= out[i] == expected++;
+		}
+		pthread_join(producer, NULL);
+		ASSERT(ok)
+		ASSERT(spscu_size(&q) == 0)
+		spscu_free(&q);
+	})
+})
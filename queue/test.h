@@ -0,0 +1,40 @@
+#ifndef DATASTORE_QUEUE_TEST_H
+#define DATASTORE_QUEUE_TEST_H
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../tests/tests.h"
+#include "queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+static inline char *queue_test_dup(const char *s)
+{
+	const size_t len = strlen(s) + 1;
+	char *copy = iso_malloc(len);
+	if (!copy)
+		abort();
+	memcpy(copy, s, len);
+	return copy;
+}
+
+#define STR_TRAIT(X) \
+	X(TYPE, char *) \
+	X(FREE, { iso_free(*val); }) \
+	X(CLONE, { *new = queue_test_dup(*val); })
+#define U64_TRAIT(X) \
+	X(TYPE, uint64_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+extern const unit_test test_queue_spsc;
+extern const unit_test test_queue_mpmc;
+
+#endif // DATASTORE_QUEUE_TEST_H
@@ -0,0 +1,350 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_RAGGED_H
+#define DATASTORE_RAGGED_H
+
+#include "../vector/vector.h"
+
+/**
+ * @file ragged.h
+ * @defgroup Ragged DATASTORE_RAGGED: Contiguous ragged and dense 2D arrays
+ *
+ * @brief Contiguous ragged and dense 2D arrays
+ *
+ * A vector of vectors allocates every row separately, and `clone`/`free` recurse row by row.
+ * `DATASTORE_RAGGED` stores all rows back to back in a single values buffer, with a second
+ * buffer holding the end offset of each row (CSR layout). `DATASTORE_DENSE` is the fixed-stride
+ * variant, where every row has the same number of elements.
+ *
+ * Both are built on two @ref DATASTORE_VEC buffers, and elements are copied bitwise: the `FREE`
+ * and `CLONE` entries of the trait must be no-ops and plain copies.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define FLT_TRAIT(X) \
+ * 	X(TYPE, float) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; })
+ *
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_RAGGED(float, features)
+ * // Methods definition (in the .c)
+ * DATASTORE_RAGGED_IMPL(FLT_TRAIT, features)
+ *
+ * struct features f = features_new(0, 0);
+ * features_append_row(&f, (float[]){ 1.f, 2.f }, 2);
+ * features_append_row(&f, NULL, 0);
+ * features_append_row(&f, (float[]){ 3.f }, 1);
+ * struct features_row r = features_row(&f, 2); // r.data[0] == 3.f, r.size == 1
+ * features_free(&f);
+ * @endcode
+ *
+ * **Macro `DATASTORE_RAGGED(type, name)`**: Define a new ragged array type
+ *
+ * **Macro `DATASTORE_RAGGED_IMPL(trait, name)`** and
+ * **`DATASTORE_RAGGED_IMPL_S(trait, name, settings)`**: Implements methods for a ragged array
+ * type, see @ref trait_type "Trait Type" and @ref advanced_usage "Advanced Usage"
+ *
+ * The resulting types will look like this:
+ * @code{.c}
+ * struct name_row {
+ *     type *data;
+ *     size_t size;
+ * };
+ * struct name {
+ *     struct name_values values; // DATASTORE_VEC(type, name_values)
+ *     struct name_offsets ends; // DATASTORE_VEC(size_t, name_offsets)
+ * };
+ * @endcode
+ * Row `i` spans `[i ? ends.data[i - 1] : 0, ends.data[i])` in `values`, the number of rows is
+ * `ends.size`.
+ *
+ * ## Exposed methods
+ *
+ * - `ragged new(size_t rows_capacity, size_t values_capacity)`: Create a new ragged array
+ * - `void free(struct ragged *self)`: Free both buffers
+ * - `ragged clone(const struct ragged *self)`: Copy the array with one `memcpy` per buffer
+ * - `void reserve(struct ragged *self, size_t rows, size_t values)`: Reserve capacity for at
+ *   least `rows` rows and `values` elements in total
+ * - `void append_row(struct ragged *self, const type *data, size_t size)`: Append a row of
+ *   `size` elements
+ * - `void push(struct ragged *self, type value)`: Append an element to the last row, there must
+ *   be at least one row
+ * - `struct ragged_row row(const struct ragged *self, size_t index)`: View of a row, valid until
+ *   the array is modified
+ * - `size_t rows(const struct ragged *self)`: Number of rows
+ *
+ * **Macro `DATASTORE_RAGGED_FROM(name, rows_name)`** and
+ * **`DATASTORE_RAGGED_FROM_IMPL(name, rows_name)`** declare and define
+ * `ragged name_from_rows_name(const struct rows_name *rows)`, which builds a ragged array from
+ * any vector whose elements have `data` and `size` members (e.g a @ref DATASTORE_VEC of
+ * @ref DATASTORE_VEC), with a single allocation per buffer.
+ *
+ * # Dense arrays
+ *
+ * **Macro `DATASTORE_DENSE(type, name)`**, **`DATASTORE_DENSE_IMPL(trait, name)`** and
+ * **`DATASTORE_DENSE_IMPL_S(trait, name, settings)`** define a row-major 2D array with a fixed
+ * number of columns (`stride`):
+ * @code{.c}
+ * struct name {
+ *     struct name_values values; // DATASTORE_VEC(type, name_values)
+ *     size_t stride;
+ *     size_t rows;
+ * };
+ * @endcode
+ *
+ * - `dense new(size_t stride, size_t rows_capacity)`: Create a new dense array
+ * - `void free(struct dense *self)`: Free the values buffer
+ * - `dense clone(const struct dense *self)`: Copy the array with a single `memcpy`
+ * - `void reserve(struct dense *self, size_t rows)`: Reserve capacity for at least `rows` rows
+ * - `void append_row(struct dense *self, const type *data)`: Append a row of `stride` elements
+ * - `type *row(const struct dense *self, size_t index)`: Pointer to the first element of a row
+ */
+
+#define DATASTORE_RAGGED_OFFSET_TRAIT(X) \
+	X(TYPE, size_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+/**
+ * @brief Ragged array type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the ragged array type
+ */
+#define DATASTORE_RAGGED(type__, name__) \
+DATASTORE_VEC(type__, DATASTORE_IDENT(name__, values)) \
+DATASTORE_VEC(size_t, DATASTORE_IDENT(name__, offsets)) \
+struct DATASTORE_IDENT(name__, row) \
+{ \
+	type__ *data; \
+	size_t size; \
+}; \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, values) values; \
+	struct DATASTORE_IDENT(name__, offsets) ends; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t rows_capacity, size_t values_capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t rows, size_t values); \
+void DATASTORE_IDENT(name__, append_row)(struct name__ *self, const type__ *data, size_t size); \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, type__ value); \
+struct DATASTORE_IDENT(name__, row) DATASTORE_IDENT(name__, row)(const struct name__ *self, size_t index); \
+size_t DATASTORE_IDENT(name__, rows)(const struct name__ *self);
+
+/**
+ * @brief Ragged array methods implementation
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the ragged array, must match the name passed to @ref DATASTORE_RAGGED
+ * @param settings__ Vector settings for both buffers, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_RAGGED_IMPL_S(trait__, name__, settings__) \
+DATASTORE_VEC_IMPL_S(trait__, DATASTORE_IDENT(name__, values), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_RAGGED_OFFSET_TRAIT, DATASTORE_IDENT(name__, offsets), settings__) \
+struct name__ DATASTORE_IDENT(name__, new)(size_t rows_capacity, size_t values_capacity) \
+{ \
+	return (struct name__){ \
+		.values = DATASTORE_IDENT(DATASTORE_IDENT(name__, values), new)(values_capacity), \
+		.ends = DATASTORE_IDENT(DATASTORE_IDENT(name__, offsets), new)(rows_capacity), \
+	}; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), free)(&self->values); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, offsets), free)(&self->ends); \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	struct name__ clone = DATASTORE_IDENT(name__, new)(self->ends.size, self->values.size); \
+	if (self->values.size) \
+		memcpy(clone.values.data, self->values.data, self->values.size * sizeof(*self->values.data)); \
+	if (self->ends.size) \
+		memcpy(clone.ends.data, self->ends.data, self->ends.size * sizeof(*self->ends.data)); \
+	clone.values.size = self->values.size; \
+	clone.ends.size = self->ends.size; \
+	return clone; \
+} \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t rows, size_t values) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), reserve)(&self->values, values); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, offsets), reserve)(&self->ends, rows); \
+} \
+void DATASTORE_IDENT(name__, append_row)(struct name__ *self, const trait__(DATASTORE_VEC_TRAIT_TYPE) *data, size_t size) \
+{ \
+	assert(self->values.size == (self->ends.size ? self->ends.data[self->ends.size - 1] : 0)); \
+	if (self->values.capacity - self->values.size < size) \
+	{ \
+		size_t capacity = self->values.capacity ? self->values.capacity : 1; \
+		while (capacity - self->values.size < size) \
+			capacity *= 2; \
+		DATASTORE_IDENT(DATASTORE_IDENT(name__, values), reserve)(&self->values, capacity); \
+	} \
+	if (size) \
+		memcpy(self->values.data + self->values.size, data, size * sizeof(*data)); \
+	self->values.size += size; \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, offsets), push)(&self->ends, self->values.size); \
+} \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	assert(self->ends.size != 0); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), push)(&self->values, value); \
+	++self->ends.data[self->ends.size - 1]; \
+} \
+struct DATASTORE_IDENT(name__, row) DATASTORE_IDENT(name__, row)(const struct name__ *self, size_t index) \
+{ \
+	assert(index < self->ends.size); \
+	const size_t begin = index ? self->ends.data[index - 1] : 0; \
+	return (struct DATASTORE_IDENT(name__, row)){ \
+		.data = self->values.data + begin, \
+		.size = self->ends.data[index] - begin, \
+	}; \
+} \
+size_t DATASTORE_IDENT(name__, rows)(const struct name__ *self) \
+{ \
+	return self->ends.size; \
+}
+
+/**
+ * @brief Ragged array methods implementation
+ *
+ * It will call @ref DATASTORE_RAGGED_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the ragged array, must match the name passed to @ref DATASTORE_RAGGED
+ */
+#define DATASTORE_RAGGED_IMPL(trait__, name__) \
+	DATASTORE_RAGGED_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/**
+ * @brief Declares the bulk constructor of a ragged array from a vector of rows
+ *
+ * @param name__ Name of the ragged array
+ * @param rows_name__ Name of the vector of rows, its elements must have `data` and `size`
+ */
+#define DATASTORE_RAGGED_FROM(name__, rows_name__) \
+struct name__ DATASTORE_IDENT(name__, DATASTORE_IDENT(from, rows_name__))(const struct rows_name__ *rows);
+
+/**
+ * @brief Defines the bulk constructor of a ragged array from a vector of rows
+ *
+ * Row lengths are summed first, so each buffer is allocated exactly once.
+ *
+ * @param name__ Name of the ragged array
+ * @param rows_name__ Name of the vector of rows, its elements must have `data` and `size`
+ */
+#define DATASTORE_RAGGED_FROM_IMPL(name__, rows_name__) \
+struct name__ DATASTORE_IDENT(name__, DATASTORE_IDENT(from, rows_name__))(const struct rows_name__ *rows) \
+{ \
+	size_t total = 0; \
+	for (size_t i = 0; i < rows->size; ++i) \
+		total += rows->data[i].size; \
+	struct name__ self = DATASTORE_IDENT(name__, new)(rows->size, total); \
+	for (size_t i = 0; i < rows->size; ++i) \
+		DATASTORE_IDENT(name__, append_row)(&self, rows->data[i].data, rows->data[i].size); \
+	return self; \
+}
+
+/**
+ * @brief Dense array type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the dense array type
+ */
+#define DATASTORE_DENSE(type__, name__) \
+DATASTORE_VEC(type__, DATASTORE_IDENT(name__, values)) \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, values) values; \
+	size_t stride; \
+	size_t rows; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t stride, size_t rows_capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t rows); \
+void DATASTORE_IDENT(name__, append_row)(struct name__ *self, const type__ *data); \
+type__ *DATASTORE_IDENT(name__, row)(const struct name__ *self, size_t index);
+
+/**
+ * @brief Dense array methods implementation
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the dense array, must match the name passed to @ref DATASTORE_DENSE
+ * @param settings__ Vector settings for the buffer, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_DENSE_IMPL_S(trait__, name__, settings__) \
+DATASTORE_VEC_IMPL_S(trait__, DATASTORE_IDENT(name__, values), settings__) \
+struct name__ DATASTORE_IDENT(name__, new)(size_t stride, size_t rows_capacity) \
+{ \
+	assert(stride != 0); \
+	return (struct name__){ \
+		.values = DATASTORE_IDENT(DATASTORE_IDENT(name__, values), new)(stride * rows_capacity), \
+		.stride = stride, \
+		.rows = 0, \
+	}; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), free)(&self->values); \
+	self->rows = 0; \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	struct name__ clone = DATASTORE_IDENT(name__, new)(self->stride, self->rows); \
+	if (self->values.size) \
+		memcpy(clone.values.data, self->values.data, self->values.size * sizeof(*self->values.data)); \
+	clone.values.size = self->values.size; \
+	clone.rows = self->rows; \
+	return clone; \
+} \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t rows) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, values), reserve)(&self->values, rows * self->stride); \
+} \
+void DATASTORE_IDENT(name__, append_row)(struct name__ *self, const trait__(DATASTORE_VEC_TRAIT_TYPE) *data) \
+{ \
+	assert(self->values.size == self->rows * self->stride); \
+	if (self->values.capacity - self->values.size < self->stride) \
+		DATASTORE_IDENT(name__, reserve)(self, self->rows ? self->rows * 2 : 1); \
+	memcpy(self->values.data + self->values.size, data, self->stride * sizeof(*data)); \
+	self->values.size += self->stride; \
+	++self->rows; \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, row)(const struct name__ *self, size_t index) \
+{ \
+	assert(index < self->rows); \
+	return self->values.data + index * self->stride; \
+}
+
+/**
+ * @brief Dense array methods implementation
+ *
+ * It will call @ref DATASTORE_DENSE_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the dense array, must match the name passed to @ref DATASTORE_DENSE
+ */
+#define DATASTORE_DENSE_IMPL(trait__, name__) \
+	DATASTORE_DENSE_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup Ragged */
+
+#endif // DATASTORE_RAGGED_H
@@ -0,0 +1,186 @@
+#include "test.h"
+
+#define FLT_TRAIT(X) \
+	X(TYPE, float) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_RAGGED(float, rf)
+typedef struct rf rf;
+DATASTORE_RAGGED_IMPL_S(FLT_TRAIT, rf, SETTINGS)
+
+DATASTORE_DENSE(float, df)
+typedef struct df df;
+DATASTORE_DENSE_IMPL_S(FLT_TRAIT, df, SETTINGS)
+
+// Vector of vectors, as in the matrix example of vector.h
+DATASTORE_VEC(float, vec)
+DATASTORE_VEC_IMPL_S(FLT_TRAIT, vec, SETTINGS)
+#define MAT_TRAIT(X) \
+	X(TYPE, struct vec) \
+	X(FREE, { vec_free(val); }) \
+	X(CLONE, { *new = vec_clone(val); })
+DATASTORE_VEC(struct vec, mat)
+DATASTORE_VEC_IMPL_S(MAT_TRAIT, mat, SETTINGS)
+
+DATASTORE_RAGGED_FROM(rf, mat)
+DATASTORE_RAGGED_FROM_IMPL(rf, mat)
+
+TESTS(ragged_float, {
+	TEST("new", {
+		rf a = rf_new(0, 0);
+		ASSERT(rf_rows(&a) == 0)
+		ASSERT(a.values.data == NULL)
+		ASSERT(a.ends.data == NULL)
+		rf_free(&a);
+
+		rf b = rf_new(4, 16);
+		ASSERT(b.ends.capacity == 4)
+		ASSERT(b.values.capacity == 16)
+		ASSERT(rf_rows(&b) == 0)
+		rf_free(&b);
+		ASSERT(b.values.data == NULL)
+		ASSERT(b.ends.data == NULL)
+	})
+	TEST("append_row", {
+		rf a = rf_new(0, 0);
+		rf_append_row(&a, (float[]){ 1.f, 2.f, 3.f }, 3);
+		rf_append_row(&a, NULL, 0);
+		rf_append_row(&a, (float[]){ 4.f }, 1);
+		ASSERT(rf_rows(&a) == 3)
+		ASSERT(a.values.size == 4)
+
+		struct rf_row r = rf_row(&a, 0);
+		ASSERT(r.size == 3)
+		ASSERT(r.data[0] == 1.f)
+		ASSERT(r.data[2] == 3.f)
+		r = rf_row(&a, 1);
+		ASSERT(r.size == 0)
+		r = rf_row(&a, 2);
+		ASSERT(r.size == 1)
+		ASSERT(r.data[0] == 4.f)
+
+		rf_push(&a, 5.f);
+		r = rf_row(&a, 2);
+		ASSERT(r.size == 2)
+		ASSERT(r.data[1] == 5.f)
+		rf_free(&a);
+	})
+	TEST("many rows", {
+		rf a = rf_new(0, 0);
+		float row[64];
+		for (int i = 0; i < 64; ++i)
+			row[i] = (float)i;
+		for (size_t i = 0; i < 1000; ++i)
+			rf_append_row(&a, row, i % 64);
+		ASSERT(rf_rows(&a) == 1000)
+		int ok = 1;
+		for (size_t i = 0; i < 1000; ++i)
+		{
+			const struct rf_row r = rf_row(&a, i);
+			ok &= r.size == i % 64;
+			for (size_t j = 0; j < r.size; ++j)
+				ok &= r.data[j] == (float)j;
+		}
+		ASSERT(ok)
+		rf_free(&a);
+	})
+	TEST("reserve", {
+		rf a = rf_new(0, 0);
+		rf_reserve(&a, 10, 100);
+		ASSERT(a.ends.capacity >= 10)
+		ASSERT(a.values.capacity >= 100)
+		float *const values = a.values.data;
+		for (int i = 0; i < 10; ++i)
+			rf_append_row(&a, (float[]){ 0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f }, 10);
+		ASSERT(a.values.data == values)
+		rf_free(&a);
+	})
+	TEST("clone", {
+		rf a = rf_new(0, 0);
+		rf_append_row(&a, (float[]){ 1.f, 2.f }, 2);
+		rf_append_row(&a, (float[]){ 3.f }, 1);
+		rf b = rf_clone(&a);
+		ASSERT(b.values.data != a.values.data)
+		ASSERT(rf_rows(&b) == 2)
+		ASSERT(rf_row(&b, 0).size == 2)
+		ASSERT(rf_row(&b, 1).data[0] == 3.f)
+		rf_free(&a);
+		rf_free(&b);
+
+		rf c = rf_new(0, 0);
+		rf d = rf_clone(&c);
+		ASSERT(rf_rows(&d) == 0)
+		rf_free(&d);
+	})
+	TEST("from rows", {
+		struct mat m = mat_new(0);
+		for (int i = 0; i < 5; ++i)
+		{
+			struct vec v = vec_new(0);
+			for (int j = 0; j < i; ++j)
+				vec_push(&v, (float)(i * 10 + j));
+			mat_push(&m, v);
+		}
+		rf a = rf_from_mat(&m);
+		ASSERT(rf_rows(&a) == 5)
+		ASSERT(a.values.size == 10)
+		ASSERT(a.values.capacity == 10)
+		ASSERT(a.ends.capacity == 5)
+		int ok = 1;
+		for (size_t i = 0; i < 5; ++i)
+		{
+			const struct rf_row r = rf_row(&a, i);
+			ok &= r.size == i;
+			for (size_t j = 0; j < r.size; ++j)
+				ok &= r.data[j] == m.data[i].data[j];
+		}
+		ASSERT(ok)
+		mat_free(&m);
+		rf_free(&a);
+	})
+})
+
+TESTS(dense_float, {
+	TEST("new", {
+		df a = df_new(4, 0);
+		ASSERT(a.stride == 4)
+		ASSERT(a.rows == 0)
+		ASSERT(a.values.data == NULL)
+		df_free(&a);
+
+		df b = df_new(3, 10);
+		ASSERT(b.values.capacity == 30)
+		df_free(&b);
+	})
+	TEST("append_row", {
+		df a = df_new(3, 0);
+		for (int i = 0; i < 100; ++i)
+			df_append_row(&a, (float[]){ (float)i, (float)i + .5f, -(float)i });
+		ASSERT(a.rows == 100)
+		ASSERT(a.values.size == 300)
+		int ok = 1;
+		for (size_t i = 0; i < 100; ++i)
+		{
+			const float *r = df_row(&a, i);
+			ok &= r[0] == (float)i && r[1] == (float)i + .5f && r[2] == -(float)i;
+		}
+		ASSERT(ok)
+
+		df b = df_clone(&a);
+		ASSERT(b.rows == 100)
+		ASSERT(b.stride == 3)
+		ASSERT(df_row(&b, 99)[1] == 99.5f)
+		df_free(&a);
+		df_free(&b);
+	})
+	TEST("reserve", {
+		df a = df_new(2, 0);
+		df_reserve(&a, 50);
+		ASSERT(a.values.capacity >= 100)
+		float *const values = a.values.data;
+		for (int i = 0; i < 50; ++i)
+			df_append_row(&a, (float[]){ 0.f, 1.f });
+		ASSERT(a.values.data == values)
+		df_free(&a);
+	})
+})
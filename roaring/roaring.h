@@ -0,0 +1,1242 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_ROARING_H
+#define DATASTORE_ROARING_H
+
+#include "../vector/vector.h"
+#include "../bitset/bitset.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @file roaring.h
+ * @defgroup Roaring DATASTORE_ROARING: Compressed set of 32-bit integers
+ *
+ * @brief Roaring bitmap: set of `uint32_t` split in containers of 65536 values
+ *
+ * Values are grouped by their 16 high bits (the key). Each non-empty group is a container
+ * holding the 16 low bits of its values in one of three forms:
+ * - array: sorted `uint16_t`, for at most @ref DATASTORE_ROARING_ARRAY_MAX values
+ * - bitmap: 65536 bits (8 KiB), for larger containers
+ * - run: sorted `(start, length - 1)` pairs of `uint16_t`, only created by `optimize` when it
+ *   is smaller than both other forms
+ *
+ * Containers are sorted by key, a lookup is a binary search on the keys followed by a search in
+ * one container. Sparse sets cost about 2 bytes per value, dense sets 1 bit per value, and
+ * ranges 4 bytes per run.
+ *
+ * Set operations combine the containers of equal keys:
+ * - bitmaps with bitmaps use the word kernels of @ref Bitset "bitset.h" (AVX2 when available)
+ *   followed by a popcount
+ * - arrays with arrays intersect 8 values against 8 values with SSE2 comparisons, or gallop
+ *   through the larger array when one is much smaller, and merge for union and difference
+ * - arrays with bitmaps test or set the bits of the array's values
+ * - run containers are expanded to an array or a bitmap first
+ *
+ * Results are kept in canonical form: bitmaps holding at most
+ * @ref DATASTORE_ROARING_ARRAY_MAX values become arrays and larger arrays become bitmaps.
+ * Modifying a run container expands it, call `optimize` again to compress runs.
+ *
+ * # Serialization
+ *
+ * `serialize` writes a portable little-endian format, read back by `deserialize`:
+ *
+ * | Size | Field                                                                     |
+ * |------|---------------------------------------------------------------------------|
+ * | 4    | Magic, `"DSRB"`                                                           |
+ * | 4    | Format version, @ref DATASTORE_ROARING_VERSION                            |
+ * | 4    | Number of containers                                                      |
+ *
+ * Followed by the containers, in increasing key order:
+ *
+ * | Size | Field                                                                     |
+ * |------|---------------------------------------------------------------------------|
+ * | 2    | Key                                                                       |
+ * | 1    | Form, see @ref datastore_roaring_kind                                     |
+ * | 1    | Reserved, zero                                                            |
+ * | 4    | Number of values                                                          |
+ * | ...  | Array: the values, 2 bytes each. Bitmap: 1024 words of 8 bytes. Run: the  |
+ * |      | number of runs on 4 bytes, then `(start, length - 1)` on 2 + 2 bytes      |
+ *
+ * `deserialize` checks every field and rejects malformed input.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_ROARING(idset)
+ * // Methods definition (in the .c)
+ * DATASTORE_ROARING_IMPL(idset)
+ *
+ * struct idset red = idset_new();
+ * for (size_t i = 0; i < count; ++i)
+ * 	idset_insert(&red, ids[i]);
+ * idset_optimize(&red);
+ * struct idset both = idset_intersect(&red, &blue);
+ * printf("%zu common\n", idset_cardinality(&both));
+ *
+ * struct idset_bytes bytes = idset_bytes_new(0);
+ * idset_serialize(&both, &bytes);
+ * struct idset copy;
+ * if (!idset_deserialize(&copy, bytes.data, bytes.size))
+ * 	fail();
+ * @endcode
+ *
+ * **Macro `DATASTORE_ROARING(name)`**: Define a new set type, with the vectors
+ * `name_containers` (of @ref datastore_roaring_container), `name_values` (of `uint32_t`) and
+ * `name_bytes` (of `unsigned char`)
+ *
+ * **Macro `DATASTORE_ROARING_IMPL(name)`** and **`DATASTORE_ROARING_IMPL_S(name, settings)`**:
+ * Implements methods for a set type. The settings allocate both the vectors and the storage
+ * of the containers.
+ *
+ * The resulting type will look like this:
+ * @code{.c}
+ * struct name {
+ *     struct name_containers containers; // Sorted by key
+ * };
+ * @endcode
+ *
+ * ## Exposed methods
+ *
+ * - `set new()`: Create an empty set
+ * - `void free(struct set *self)`: Free the set
+ * - `set clone(const struct set *self)`: Copy of the set
+ * - `bool insert(struct set *self, uint32_t value)`: Add a value, returns false if it was present
+ * - `bool remove(struct set *self, uint32_t value)`: Remove a value, returns false if it was
+ *   absent
+ * - `bool contains(const struct set *self, uint32_t value)`: Whether a value is present
+ * - `size_t cardinality(const struct set *self)`: Number of values
+ * - `set union(const struct set *a, const struct set *b)`, `set intersect(...)`,
+ *   `set difference(...)` (`a` without `b`): New set combining two sets
+ * - `void optimize(struct set *self)`: Convert containers to runs where it is smaller, and
+ *   release unused capacity beyond @ref DATASTORE_ROARING_SLACK
+ * - `struct set_values flatten(const struct set *self)`: Sorted values of the set
+ * - `size_t serialized_size(const struct set *self)`: Number of bytes written by `serialize`
+ * - `void serialize(const struct set *self, struct set_bytes *out)`: Append the set to `out`
+ * - `size_t deserialize(struct set *out, const void *data, size_t size)`: Read a set from the
+ *   start of `data` into `out`, returns the number of bytes read, `0` if the data is malformed
+ *   (`out` is then unchanged)
+ */
+
+/**
+ * @brief Largest number of values of an array container
+ */
+#define DATASTORE_ROARING_ARRAY_MAX 4096
+
+/**
+ * @brief Number of words of a bitmap container
+ */
+#define DATASTORE_ROARING_BITMAP_WORDS 1024
+
+/**
+ * @brief Unused bytes a container keeps after `optimize`, on top of half its size
+ *
+ * Allocators round sizes up, smaller slack is not worth copying the container.
+ */
+#define DATASTORE_ROARING_SLACK 64
+
+/**
+ * @brief Current version of the serialization format
+ */
+#define DATASTORE_ROARING_VERSION 1
+
+/**
+ * @brief Form of a container
+ */
+enum datastore_roaring_kind
+{
+	/** Sorted values */
+	DATASTORE_ROARING_ARRAY = 0,
+	/** One bit per value */
+	DATASTORE_ROARING_BITMAP = 1,
+	/** Sorted runs of consecutive values */
+	DATASTORE_ROARING_RUN = 2,
+};
+
+/**
+ * @brief Set operation applied to two containers
+ */
+enum datastore_roaring_op
+{
+	DATASTORE_ROARING_AND,
+	DATASTORE_ROARING_OR,
+	DATASTORE_ROARING_ANDNOT,
+};
+
+/**
+ * @brief Values of a set sharing the same 16 high bits
+ */
+struct datastore_roaring_container
+{
+	/**
+	 * @brief `uint16_t` values, `uint16_t` runs or `uint64_t` words, depending on `kind`
+	 */
+	void *data;
+	/**
+	 * @brief Allocated bytes of `data`
+	 */
+	uint32_t capacity;
+	/**
+	 * @brief Number of values
+	 */
+	uint32_t cardinality;
+	/**
+	 * @brief Number of runs of a run container
+	 */
+	uint32_t runs;
+	/**
+	 * @brief 16 high bits of the values
+	 */
+	uint16_t key;
+	/**
+	 * @brief A @ref datastore_roaring_kind
+	 */
+	uint8_t kind;
+};
+
+#define DATASTORE_ROARING_CONTAINER_TRAIT(X) \
+	X(TYPE, struct datastore_roaring_container) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+#define DATASTORE_ROARING_VALUE_TRAIT(X) \
+	X(TYPE, uint32_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+#define DATASTORE_ROARING_BYTE_TRAIT(X) \
+	X(TYPE, unsigned char) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+// {{{ Kernels
+/**
+ * @brief Position of the first of `n` sorted values not smaller than `value`
+ */
+static inline size_t datastore_roaring_lower_bound(const uint16_t *values, size_t n, uint16_t value)
+{
+	size_t first = 0;
+	while (n)
+	{
+		const size_t half = n / 2;
+		if (values[first + half] < value)
+		{
+			first += half + 1;
+			n -= half + 1;
+		}
+		else
+			n = half;
+	}
+	return first;
+}
+
+/**
+ * @brief Position of the first value not smaller than `value`, at or after `from`
+ *
+ * Doubles the step from `from` before a binary search, so that a sequence of increasing
+ * searches costs the logarithm of the distance travelled.
+ */
+static inline size_t datastore_roaring_gallop(const uint16_t *values, size_t n, size_t from, uint16_t value)
+{
+	if (from >= n || values[from] >= value)
+		return from;
+	size_t low = from, step = 1;
+	while (low + step < n && values[low + step] < value)
+	{
+		low += step;
+		step *= 2;
+	}
+	const size_t high = low + step < n ? low + step : n;
+	return low + 1 + datastore_roaring_lower_bound(values + low + 1, high - low - 1, value);
+}
+
+static inline size_t datastore_roaring_intersect_scalar(const uint16_t *a, size_t na, const uint16_t *b, size_t nb,
+		uint16_t *out)
+{
+	size_t i = 0, j = 0, count = 0;
+	while (i < na && j < nb)
+	{
+		if (a[i] < b[j])
+			++i;
+		else if (b[j] < a[i])
+			++j;
+		else
+		{
+			out[count++] = a[i];
+			++i;
+			++j;
+		}
+	}
+	return count;
+}
+
+#if DATASTORE_SIMD_X86
+/*
+ * Compares 8 values of `a` with the 8 rotations of 8 values of `b`, then moves past the block
+ * with the smaller maximum. A value of `a` matches at most one value of `b`, so values kept
+ * across blocks are never emitted twice.
+ */
+static inline size_t datastore_roaring_intersect_SSE2(const uint16_t *a, size_t na, const uint16_t *b, size_t nb,
+		uint16_t *out)
+{
+	size_t i = 0, j = 0, count = 0;
+	while (i + 8 <= na && j + 8 <= nb)
+	{
+		const __m128i va = DATASTORE_SIMD_LOAD_SSE2(a + i);
+		__m128i vb = DATASTORE_SIMD_LOAD_SSE2(b + j);
+		__m128i match = _mm_cmpeq_epi16(va, vb);
+		for (int rotation = 1; rotation < 8; ++rotation)
+		{
+			vb = _mm_or_si128(_mm_srli_si128(vb, 2), _mm_slli_si128(vb, 14));
+			match = _mm_or_si128(match, _mm_cmpeq_epi16(va, vb));
+		}
+		// Two bits per matching lane
+		unsigned mask = (unsigned)_mm_movemask_epi8(match);
+		while (mask)
+		{
+			const unsigned lane = (unsigned)__builtin_ctz(mask) / 2;
+			out[count++] = a[i + lane];
+			mask &= ~(3u << (2 * lane));
+		}
+		const uint16_t max_a = a[i + 7], max_b = b[j + 7];
+		if (max_a <= max_b)
+			i += 8;
+		if (max_b <= max_a)
+			j += 8;
+	}
+	return count + datastore_roaring_intersect_scalar(a + i, na - i, b + j, nb - j, out + count);
+}
+#endif // DATASTORE_SIMD_X86
+
+/**
+ * @brief Intersection of two sorted arrays without duplicates, returns the size of `out`
+ */
+static inline size_t datastore_roaring_intersect_u16(const uint16_t *a, size_t na, const uint16_t *b, size_t nb,
+		uint16_t *out)
+{
+	if (na > nb)
+		return datastore_roaring_intersect_u16(b, nb, a, na, out);
+	// Galloping wins when the larger array is mostly skipped
+	if (na * 32 < nb)
+	{
+		size_t j = 0, count = 0;
+		for (size_t i = 0; i < na && j < nb; ++i)
+		{
+			j = datastore_roaring_gallop(b, nb, j, a[i]);
+			if (j < nb && b[j] == a[i])
+				out[count++] = a[i];
+		}
+		return count;
+	}
+#if DATASTORE_SIMD_X86
+	return datastore_roaring_intersect_SSE2(a, na, b, nb, out);
+#else
+	return datastore_roaring_intersect_scalar(a, na, b, nb, out);
+#endif
+}
+
+/**
+ * @brief Union of two sorted arrays without duplicates, returns the size of `out`
+ */
+static inline size_t datastore_roaring_union_u16(const uint16_t *a, size_t na, const uint16_t *b, size_t nb,
+		uint16_t *out)
+{
+	size_t i = 0, j = 0, count = 0;
+	while (i < na && j < nb)
+	{
+		if (a[i] < b[j])
+			out[count++] = a[i++];
+		else if (b[j] < a[i])
+			out[count++] = b[j++];
+		else
+		{
+			out[count++] = a[i++];
+			++j;
+		}
+	}
+	while (i < na)
+		out[count++] = a[i++];
+	while (j < nb)
+		out[count++] = b[j++];
+	return count;
+}
+
+/**
+ * @brief Values of `a` absent from `b`, both sorted without duplicates, returns the size of `out`
+ */
+static inline size_t datastore_roaring_difference_u16(const uint16_t *a, size_t na, const uint16_t *b, size_t nb,
+		uint16_t *out)
+{
+	size_t j = 0, count = 0;
+	for (size_t i = 0; i < na; ++i)
+	{
+		while (j < nb && b[j] < a[i])
+			++j;
+		if (j == nb || b[j] != a[i])
+			out[count++] = a[i];
+	}
+	return count;
+}
+
+/**
+ * @brief Sets the bits `first` to `last` (included)
+ */
+static inline void datastore_roaring_set_range(uint64_t *words, unsigned first, unsigned last)
+{
+	const unsigned first_word = first / 64, last_word = last / 64;
+	const uint64_t first_mask = ~(uint64_t)0 << (first % 64), last_mask = ~(uint64_t)0 >> (63 - last % 64);
+	if (first_word == last_word)
+	{
+		words[first_word] |= first_mask & last_mask;
+		return;
+	}
+	words[first_word] |= first_mask;
+	for (unsigned word = first_word + 1; word < last_word; ++word)
+		words[word] = ~(uint64_t)0;
+	words[last_word] |= last_mask;
+}
+
+/**
+ * @brief Positions of the set bits of a bitmap container, returns their count
+ */
+static inline size_t datastore_roaring_bitmap_values(const uint64_t *words, uint16_t *out)
+{
+	size_t count = 0;
+	for (unsigned word = 0; word < DATASTORE_ROARING_BITMAP_WORDS; ++word)
+		for (uint64_t bits = words[word]; bits; bits &= bits - 1)
+			out[count++] = (uint16_t)(word * 64 + (unsigned)__builtin_ctzll(bits));
+	return count;
+}
+
+/**
+ * @brief Number of runs of consecutive values in a sorted array
+ */
+static inline size_t datastore_roaring_array_runs(const uint16_t *values, size_t n)
+{
+	size_t runs = n != 0;
+	for (size_t i = 1; i < n; ++i)
+		runs += values[i] != values[i - 1] + 1;
+	return runs;
+}
+
+/**
+ * @brief Number of runs of set bits in a bitmap container, counting the bits set after a clear bit
+ */
+static inline size_t datastore_roaring_bitmap_runs(const uint64_t *words)
+{
+	size_t runs = 0;
+	uint64_t carry = 0;
+	for (unsigned word = 0; word < DATASTORE_ROARING_BITMAP_WORDS; ++word)
+	{
+		runs += (size_t)__builtin_popcountll(words[word] & ~((words[word] << 1) | carry));
+		carry = words[word] >> 63;
+	}
+	return runs;
+}
+
+static inline void datastore_roaring_put16(unsigned char *p, uint16_t value)
+{
+	p[0] = (unsigned char)value;
+	p[1] = (unsigned char)(value >> 8);
+}
+
+static inline void datastore_roaring_put32(unsigned char *p, uint32_t value)
+{
+	datastore_roaring_put16(p, (uint16_t)value);
+	datastore_roaring_put16(p + 2, (uint16_t)(value >> 16));
+}
+
+static inline void datastore_roaring_put64(unsigned char *p, uint64_t value)
+{
+	datastore_roaring_put32(p, (uint32_t)value);
+	datastore_roaring_put32(p + 4, (uint32_t)(value >> 32));
+}
+
+static inline uint16_t datastore_roaring_get16(const unsigned char *p)
+{
+	return (uint16_t)(p[0] | (unsigned)p[1] << 8);
+}
+
+static inline uint32_t datastore_roaring_get32(const unsigned char *p)
+{
+	return datastore_roaring_get16(p) | (uint32_t)datastore_roaring_get16(p + 2) << 16;
+}
+
+static inline uint64_t datastore_roaring_get64(const unsigned char *p)
+{
+	return datastore_roaring_get32(p) | (uint64_t)datastore_roaring_get32(p + 4) << 32;
+}
+// }}}
+
+/**
+ * @brief Roaring set type definition and methods declaration
+ *
+ * @param name__ Name of the set type
+ */
+#define DATASTORE_ROARING(name__) \
+DATASTORE_VEC(struct datastore_roaring_container, DATASTORE_IDENT(name__, containers)) \
+DATASTORE_VEC(uint32_t, DATASTORE_IDENT(name__, values)) \
+DATASTORE_VEC(unsigned char, DATASTORE_IDENT(name__, bytes)) \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, containers) containers; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(void); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+bool DATASTORE_IDENT(name__, insert)(struct name__ *self, uint32_t value); \
+bool DATASTORE_IDENT(name__, remove)(struct name__ *self, uint32_t value); \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, uint32_t value); \
+size_t DATASTORE_IDENT(name__, cardinality)(const struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, union)(const struct name__ *a, const struct name__ *b); \
+struct name__ DATASTORE_IDENT(name__, intersect)(const struct name__ *a, const struct name__ *b); \
+struct name__ DATASTORE_IDENT(name__, difference)(const struct name__ *a, const struct name__ *b); \
+void DATASTORE_IDENT(name__, optimize)(struct name__ *self); \
+struct DATASTORE_IDENT(name__, values) DATASTORE_IDENT(name__, flatten)(const struct name__ *self); \
+size_t DATASTORE_IDENT(name__, serialized_size)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, serialize)(const struct name__ *self, struct DATASTORE_IDENT(name__, bytes) *out); \
+size_t DATASTORE_IDENT(name__, deserialize)(struct name__ *out, const void *data, size_t size);
+
+/**
+ * @brief Roaring set methods implementation
+ *
+ * @param name__ Name of the set, must match the name passed to @ref DATASTORE_ROARING
+ * @param settings__ Custom settings for the vectors and the containers, see
+ * @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_ROARING_IMPL_S(name__, settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_ROARING_CONTAINER_TRAIT, DATASTORE_IDENT(name__, containers), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_ROARING_VALUE_TRAIT, DATASTORE_IDENT(name__, values), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_ROARING_BYTE_TRAIT, DATASTORE_IDENT(name__, bytes), settings__) \
+/* Bytes requested by `impl_alloc` for `bytes` bytes of storage */ \
+static inline size_t DATASTORE_IDENT(name__, impl_alloc_size)(size_t bytes) \
+{ \
+	if (bytes < sizeof(uint64_t)) \
+		bytes = sizeof(uint64_t); \
+	return datastore_vec_pad(bytes, DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__)); \
+} \
+/* Allocates the storage of a container, never empty so that it is never `NULL` */ \
+static inline void *DATASTORE_IDENT(name__, impl_alloc)(size_t bytes, uint32_t *capacity) \
+{ \
+	unsigned char *ptr; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = DATASTORE_IDENT(name__, impl_alloc_size)(bytes); \
+	size_t usable = size; \
+	settings__(DATASTORE_VEC_SETTINGS_NEW) \
+	assert(usable >= size); \
+	assert(!align || ((uintptr_t)ptr & (align - 1)) == 0); \
+	DATASTORE_MAYBE_UNUSED(align); \
+	*capacity = (uint32_t)usable; \
+	return ptr; \
+} \
+static inline void DATASTORE_IDENT(name__, impl_release)(void *data, uint32_t capacity) \
+{ \
+	if (!data) \
+		return; \
+	unsigned char *ptr = data; \
+	const size_t size = capacity; \
+	DATASTORE_MAYBE_UNUSED(size); \
+	settings__(DATASTORE_VEC_SETTINGS_FREE) \
+} \
+/* Grows the storage of a container to at least `bytes`, keeping its content */ \
+static inline void DATASTORE_IDENT(name__, impl_reserve)(struct datastore_roaring_container *c, size_t bytes) \
+{ \
+	if (c->capacity >= bytes) \
+		return; \
+	if (bytes < 2 * (size_t)c->capacity) \
+		bytes = 2 * (size_t)c->capacity; \
+	unsigned char *ptr = c->data; \
+	const size_t old_size = c->capacity; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(bytes, align); \
+	size_t usable = size; \
+	DATASTORE_MAYBE_UNUSED(old_size); \
+	settings__(DATASTORE_VEC_SETTINGS_REALLOC) \
+	assert(usable >= size); \
+	c->data = ptr; \
+	c->capacity = (uint32_t)usable; \
+} \
+/* Bytes of the content of a container */ \
+static inline size_t DATASTORE_IDENT(name__, impl_bytes)(const struct datastore_roaring_container *c) \
+{ \
+	switch (c->kind) \
+	{ \
+		case DATASTORE_ROARING_ARRAY: \
+			return c->cardinality * sizeof(uint16_t); \
+		case DATASTORE_ROARING_BITMAP: \
+			return DATASTORE_ROARING_BITMAP_WORDS * sizeof(uint64_t); \
+		default: \
+			return c->runs * 2 * sizeof(uint16_t); \
+	} \
+} \
+/* Empty container, bitmaps are cleared */ \
+static inline struct datastore_roaring_container DATASTORE_IDENT(name__, impl_container)(uint16_t key, \
+		enum datastore_roaring_kind kind, size_t bytes) \
+{ \
+	struct datastore_roaring_container c = { \
+		.data = NULL, \
+		.capacity = 0, \
+		.cardinality = 0, \
+		.runs = 0, \
+		.key = key, \
+		.kind = (uint8_t)kind, \
+	}; \
+	if (kind == DATASTORE_ROARING_BITMAP) \
+		bytes = DATASTORE_ROARING_BITMAP_WORDS * sizeof(uint64_t); \
+	c.data = DATASTORE_IDENT(name__, impl_alloc)(bytes, &c.capacity); \
+	if (kind == DATASTORE_ROARING_BITMAP) \
+		memset(c.data, 0, bytes); \
+	return c; \
+} \
+static inline struct datastore_roaring_container DATASTORE_IDENT(name__, impl_container_clone)( \
+		const struct datastore_roaring_container *c) \
+{ \
+	struct datastore_roaring_container clone = *c; \
+	const size_t bytes = DATASTORE_IDENT(name__, impl_bytes)(c); \
+	clone.data = DATASTORE_IDENT(name__, impl_alloc)(bytes, &clone.capacity); \
+	if (bytes) \
+		memcpy(clone.data, c->data, bytes); \
+	return clone; \
+} \
+/* Replaces the storage of a container */ \
+static inline void DATASTORE_IDENT(name__, impl_replace)(struct datastore_roaring_container *c, void *data, \
+		uint32_t capacity, enum datastore_roaring_kind kind) \
+{ \
+	DATASTORE_IDENT(name__, impl_release)(c->data, c->capacity); \
+	c->data = data; \
+	c->capacity = capacity; \
+	c->kind = (uint8_t)kind; \
+} \
+static inline void DATASTORE_IDENT(name__, impl_to_bitmap)(struct datastore_roaring_container *c) \
+{ \
+	uint32_t capacity; \
+	uint64_t *words = DATASTORE_IDENT(name__, impl_alloc)(DATASTORE_ROARING_BITMAP_WORDS * sizeof(uint64_t), &capacity); \
+	memset(words, 0, DATASTORE_ROARING_BITMAP_WORDS * sizeof(uint64_t)); \
+	const uint16_t *values = c->data; \
+	if (c->kind == DATASTORE_ROARING_ARRAY) \
+		for (uint32_t i = 0; i < c->cardinality; ++i) \
+			words[values[i] / 64] |= (uint64_t)1 << (values[i] % 64); \
+	else \
+		for (uint32_t run = 0; run < c->runs; ++run) \
+			datastore_roaring_set_range(words, values[2 * run], (unsigned)values[2 * run] + values[2 * run + 1]); \
+	DATASTORE_IDENT(name__, impl_replace)(c, words, capacity, DATASTORE_ROARING_BITMAP); \
+	c->runs = 0; \
+} \
+static inline void DATASTORE_IDENT(name__, impl_to_array)(struct datastore_roaring_container *c) \
+{ \
+	uint32_t capacity; \
+	uint16_t *values = DATASTORE_IDENT(name__, impl_alloc)(c->cardinality * sizeof(uint16_t), &capacity); \
+	if (c->kind == DATASTORE_ROARING_BITMAP) \
+		datastore_roaring_bitmap_values(c->data, values); \
+	else \
+	{ \
+		const uint16_t *runs = c->data; \
+		size_t count = 0; \
+		for (uint32_t run = 0; run < c->runs; ++run) \
+			for (unsigned value = runs[2 * run]; value <= (unsigned)runs[2 * run] + runs[2 * run + 1]; ++value) \
+				values[count++] = (uint16_t)value; \
+	} \
+	DATASTORE_IDENT(name__, impl_replace)(c, values, capacity, DATASTORE_ROARING_ARRAY); \
+	c->runs = 0; \
+} \
+static inline void DATASTORE_IDENT(name__, impl_to_run)(struct datastore_roaring_container *c, size_t runs) \
+{ \
+	uint32_t capacity; \
+	uint16_t *pairs = DATASTORE_IDENT(name__, impl_alloc)(runs * 2 * sizeof(uint16_t), &capacity); \
+	size_t run = 0; \
+	unsigned start = 0, previous = 0; \
+	bool open = false; \
+	/* Closes the current run when `value` does not extend it */ \
+	DATASTORE_ROARING_IMPL_RUNS(c, value, { \
+		if (open && value == previous + 1) \
+			previous = value; \
+		else \
+		{ \
+			if (open) \
+			{ \
+				pairs[2 * run] = (uint16_t)start; \
+				pairs[2 * run + 1] = (uint16_t)(previous - start); \
+				++run; \
+			} \
+			start = previous = value; \
+			open = true; \
+		} \
+	}) \
+	pairs[2 * run] = (uint16_t)start; \
+	pairs[2 * run + 1] = (uint16_t)(previous - start); \
+	assert(run + 1 == runs); \
+	DATASTORE_IDENT(name__, impl_replace)(c, pairs, capacity, DATASTORE_ROARING_RUN); \
+	c->runs = (uint32_t)runs; \
+} \
+/* Expands a run container to an array or a bitmap */ \
+static inline void DATASTORE_IDENT(name__, impl_materialize)(struct datastore_roaring_container *c) \
+{ \
+	if (c->kind != DATASTORE_ROARING_RUN) \
+		return; \
+	if (c->cardinality > DATASTORE_ROARING_ARRAY_MAX) \
+		DATASTORE_IDENT(name__, impl_to_bitmap)(c); \
+	else \
+		DATASTORE_IDENT(name__, impl_to_array)(c); \
+} \
+/* Picks the form matching the cardinality of a non-empty array or bitmap */ \
+static inline void DATASTORE_IDENT(name__, impl_normalize)(struct datastore_roaring_container *c) \
+{ \
+	if (!c->cardinality) \
+		return; \
+	if (c->kind == DATASTORE_ROARING_BITMAP && c->cardinality <= DATASTORE_ROARING_ARRAY_MAX) \
+		DATASTORE_IDENT(name__, impl_to_array)(c); \
+	else if (c->kind == DATASTORE_ROARING_ARRAY && c->cardinality > DATASTORE_ROARING_ARRAY_MAX) \
+		DATASTORE_IDENT(name__, impl_to_bitmap)(c); \
+} \
+static inline bool DATASTORE_IDENT(name__, impl_test)(const struct datastore_roaring_container *c, uint16_t low) \
+{ \
+	const uint16_t *values = c->data; \
+	switch (c->kind) \
+	{ \
+		case DATASTORE_ROARING_ARRAY: \
+		{ \
+			const size_t i = datastore_roaring_lower_bound(values, c->cardinality, low); \
+			return i < c->cardinality && values[i] == low; \
+		} \
+		case DATASTORE_ROARING_BITMAP: \
+			return (((const uint64_t *)c->data)[low / 64] >> (low % 64)) & 1; \
+		default: \
+		{ \
+			/* Last run starting at or before `low` */ \
+			size_t first = 0, n = c->runs; \
+			while (n) \
+			{ \
+				const size_t half = n / 2; \
+				if (values[2 * (first + half)] <= low) \
+				{ \
+					first += half + 1; \
+					n -= half + 1; \
+				} \
+				else \
+					n = half; \
+			} \
+			return first && low - values[2 * (first - 1)] <= values[2 * (first - 1) + 1]; \
+		} \
+	} \
+} \
+/* Position of the container of `key`, or where it would be inserted */ \
+static inline bool DATASTORE_IDENT(name__, impl_find)(const struct name__ *self, uint16_t key, size_t *index) \
+{ \
+	size_t first = 0, n = self->containers.size; \
+	while (n) \
+	{ \
+		const size_t half = n / 2; \
+		if (self->containers.data[first + half].key < key) \
+		{ \
+			first += half + 1; \
+			n -= half + 1; \
+		} \
+		else \
+			n = half; \
+	} \
+	*index = first; \
+	return first < self->containers.size && self->containers.data[first].key == key; \
+} \
+/* Combines two containers of the same key, neither being a run container */ \
+static inline struct datastore_roaring_container DATASTORE_IDENT(name__, impl_op_plain)( \
+		const struct datastore_roaring_container *x, const struct datastore_roaring_container *y, \
+		enum datastore_roaring_op op) \
+{ \
+	struct datastore_roaring_container r; \
+	const uint16_t *xv = x->data, *yv = y->data; \
+	const uint64_t *xw = x->data, *yw = y->data; \
+	if (x->kind == DATASTORE_ROARING_ARRAY && y->kind == DATASTORE_ROARING_ARRAY) \
+	{ \
+		if (op == DATASTORE_ROARING_OR && x->cardinality + y->cardinality > DATASTORE_ROARING_ARRAY_MAX) \
+		{ \
+			r = DATASTORE_IDENT(name__, impl_container)(x->key, DATASTORE_ROARING_BITMAP, 0); \
+			uint64_t *words = r.data; \
+			for (uint32_t i = 0; i < x->cardinality; ++i) \
+				words[xv[i] / 64] |= (uint64_t)1 << (xv[i] % 64); \
+			for (uint32_t i = 0; i < y->cardinality; ++i) \
+				words[yv[i] / 64] |= (uint64_t)1 << (yv[i] % 64); \
+			r.cardinality = (uint32_t)datastore_simd_popcount_u64(words, DATASTORE_ROARING_BITMAP_WORDS); \
+			DATASTORE_IDENT(name__, impl_normalize)(&r); \
+			return r; \
+		} \
+		const size_t bytes = (op == DATASTORE_ROARING_AND \
+			? (x->cardinality < y->cardinality ? x->cardinality : y->cardinality) \
+			: op == DATASTORE_ROARING_OR ? x->cardinality + y->cardinality : x->cardinality) * sizeof(uint16_t); \
+		r = DATASTORE_IDENT(name__, impl_container)(x->key, DATASTORE_ROARING_ARRAY, bytes); \
+		uint16_t *out = r.data; \
+		if (op == DATASTORE_ROARING_AND) \
+			r.cardinality = (uint32_t)datastore_roaring_intersect_u16(xv, x->cardinality, yv, y->cardinality, out); \
+		else if (op == DATASTORE_ROARING_OR) \
+			r.cardinality = (uint32_t)datastore_roaring_union_u16(xv, x->cardinality, yv, y->cardinality, out); \
+		else \
+			r.cardinality = (uint32_t)datastore_roaring_difference_u16(xv, x->cardinality, yv, y->cardinality, out); \
+		return r; \
+	} \
+	if (x->kind == DATASTORE_ROARING_BITMAP && y->kind == DATASTORE_ROARING_BITMAP) \
+	{ \
+		r = DATASTORE_IDENT(name__, impl_container)(x->key, DATASTORE_ROARING_BITMAP, 0); \
+		uint64_t *words = r.data; \
+		if (op == DATASTORE_ROARING_AND) \
+			datastore_simd_and_u64(words, xw, yw, DATASTORE_ROARING_BITMAP_WORDS); \
+		else if (op == DATASTORE_ROARING_OR) \
+			datastore_simd_or_u64(words, xw, yw, DATASTORE_ROARING_BITMAP_WORDS); \
+		else \
+			datastore_simd_andnot_u64(words, xw, yw, DATASTORE_ROARING_BITMAP_WORDS); \
+		r.cardinality = (uint32_t)datastore_simd_popcount_u64(words, DATASTORE_ROARING_BITMAP_WORDS); \
+		DATASTORE_IDENT(name__, impl_normalize)(&r); \
+		return r; \
+	} \
+	/* An array and a bitmap */ \
+	const struct datastore_roaring_container *array = x->kind == DATASTORE_ROARING_ARRAY ? x : y; \
+	const struct datastore_roaring_container *bitmap = x->kind == DATASTORE_ROARING_ARRAY ? y : x; \
+	const uint16_t *values = array->data; \
+	const uint64_t *bits = bitmap->data; \
+	if (op == DATASTORE_ROARING_AND || (op == DATASTORE_ROARING_ANDNOT && x == array)) \
+	{ \
+		/* Values of the array kept by the bitmap */ \
+		const uint64_t keep = op == DATASTORE_ROARING_AND; \
+		r = DATASTORE_IDENT(name__, impl_container)(x->key, DATASTORE_ROARING_ARRAY, \
+			array->cardinality * sizeof(uint16_t)); \
+		uint16_t *out = r.data; \
+		for (uint32_t i = 0; i < array->cardinality; ++i) \
+		{ \
+			out[r.cardinality] = values[i]; \
+			r.cardinality += (uint32_t)(((bits[values[i] / 64] >> (values[i] % 64)) & 1) == keep); \
+		} \
+		return r; \
+	} \
+	/* Union, or bitmap without array: update a copy of the bitmap */ \
+	r = DATASTORE_IDENT(name__, impl_container_clone)(bitmap); \
+	uint64_t *words = r.data; \
+	for (uint32_t i = 0; i < array->cardinality; ++i) \
+	{ \
+		uint64_t *word = &words[values[i] / 64]; \
+		const uint64_t bit = (uint64_t)1 << (values[i] % 64); \
+		if (op == DATASTORE_ROARING_OR) \
+		{ \
+			r.cardinality += !(*word & bit); \
+			*word |= bit; \
+		} \
+		else \
+		{ \
+			r.cardinality -= !!(*word & bit); \
+			*word &= ~bit; \
+		} \
+	} \
+	DATASTORE_IDENT(name__, impl_normalize)(&r); \
+	return r; \
+} \
+static inline struct datastore_roaring_container DATASTORE_IDENT(name__, impl_op)( \
+		const struct datastore_roaring_container *x, const struct datastore_roaring_container *y, \
+		enum datastore_roaring_op op) \
+{ \
+	if (x->kind != DATASTORE_ROARING_RUN && y->kind != DATASTORE_ROARING_RUN) \
+		return DATASTORE_IDENT(name__, impl_op_plain)(x, y, op); \
+	struct datastore_roaring_container tx = DATASTORE_IDENT(name__, impl_container_clone)(x); \
+	struct datastore_roaring_container ty = DATASTORE_IDENT(name__, impl_container_clone)(y); \
+	DATASTORE_IDENT(name__, impl_materialize)(&tx); \
+	DATASTORE_IDENT(name__, impl_materialize)(&ty); \
+	const struct datastore_roaring_container r = DATASTORE_IDENT(name__, impl_op_plain)(&tx, &ty, op); \
+	DATASTORE_IDENT(name__, impl_release)(tx.data, tx.capacity); \
+	DATASTORE_IDENT(name__, impl_release)(ty.data, ty.capacity); \
+	return r; \
+} \
+/* Merges the keys of two sets, keeping the containers of `a` only (AND NOT), of both (OR), and */ \
+/* the non-empty combinations of equal keys */ \
+static inline struct name__ DATASTORE_IDENT(name__, impl_combine)(const struct name__ *a, const struct name__ *b, \
+		enum datastore_roaring_op op) \
+{ \
+	struct name__ result = DATASTORE_IDENT(name__, new)(); \
+	const struct datastore_roaring_container *ca = a->containers.data, *cb = b->containers.data; \
+	const size_t na = a->containers.size, nb = b->containers.size; \
+	size_t i = 0, j = 0; \
+	while (i < na || j < nb) \
+	{ \
+		if (j == nb || (i < na && ca[i].key < cb[j].key)) \
+		{ \
+			if (op != DATASTORE_ROARING_AND) \
+				DATASTORE_IDENT(DATASTORE_IDENT(name__, containers), push)(&result.containers, \
+					DATASTORE_IDENT(name__, impl_container_clone)(&ca[i])); \
+			++i; \
+		} \
+		else if (i == na || cb[j].key < ca[i].key) \
+		{ \
+			if (op == DATASTORE_ROARING_OR) \
+				DATASTORE_IDENT(DATASTORE_IDENT(name__, containers), push)(&result.containers, \
+					DATASTORE_IDENT(name__, impl_container_clone)(&cb[j])); \
+			++j; \
+		} \
+		else \
+		{ \
+			struct datastore_roaring_container c = DATASTORE_IDENT(name__, impl_op)(&ca[i], &cb[j], op); \
+			if (c.cardinality) \
+				DATASTORE_IDENT(DATASTORE_IDENT(name__, containers), push)(&result.containers, c); \
+			else \
+				DATASTORE_IDENT(name__, impl_release)(c.data, c.capacity); \
+			++i; \
+			++j; \
+		} \
+	} \
+	return result; \
+} \
+/* Reads one container, returns false if it is malformed */ \
+static inline bool DATASTORE_IDENT(name__, impl_read)(struct datastore_roaring_container *c, \
+		const unsigned char **p, const unsigned char *end) \
+{ \
+	const uint32_t cardinality = c->cardinality; \
+	if (c->kind == DATASTORE_ROARING_ARRAY) \
+	{ \
+		if (cardinality > DATASTORE_ROARING_ARRAY_MAX || (size_t)(end - *p) < 2 * (size_t)cardinality) \
+			return false; \
+		uint16_t *values = c->data; \
+		for (uint32_t i = 0; i < cardinality; ++i) \
+		{ \
+			values[i] = datastore_roaring_get16(*p + 2 * i); \
+			if (i && values[i] <= values[i - 1]) \
+				return false; \
+		} \
+		*p += 2 * (size_t)cardinality; \
+		return true; \
+	} \
+	if (c->kind == DATASTORE_ROARING_BITMAP) \
+	{ \
+		if (cardinality <= DATASTORE_ROARING_ARRAY_MAX \
+			|| (size_t)(end - *p) < DATASTORE_ROARING_BITMAP_WORDS * sizeof(uint64_t)) \
+			return false; \
+		uint64_t *words = c->data; \
+		for (size_t i = 0; i < DATASTORE_ROARING_BITMAP_WORDS; ++i) \
+			words[i] = datastore_roaring_get64(*p + 8 * i); \
+		*p += DATASTORE_ROARING_BITMAP_WORDS * sizeof(uint64_t); \
+		return datastore_simd_popcount_u64(words, DATASTORE_ROARING_BITMAP_WORDS) == cardinality; \
+	} \
+	if ((size_t)(end - *p) < 4) \
+		return false; \
+	const uint32_t runs = datastore_roaring_get32(*p); \
+	*p += 4; \
+	if (!runs || runs > 32768 || (size_t)(end - *p) < 4 * (size_t)runs) \
+		return false; \
+	DATASTORE_IDENT(name__, impl_reserve)(c, runs * 2 * sizeof(uint16_t)); \
+	uint16_t *pairs = c->data; \
+	size_t total = 0, next = 0; \
+	for (uint32_t run = 0; run < runs; ++run) \
+	{ \
+		pairs[2 * run] = datastore_roaring_get16(*p + 4 * run); \
+		pairs[2 * run + 1] = datastore_roaring_get16(*p + 4 * run + 2); \
+		/* Runs are sorted and disjoint, and end before 65536 */ \
+		if (pairs[2 * run] < next || (size_t)pairs[2 * run] + pairs[2 * run + 1] > UINT16_MAX) \
+			return false; \
+		next = (size_t)pairs[2 * run] + pairs[2 * run + 1] + 1; \
+		total += (size_t)pairs[2 * run + 1] + 1; \
+	} \
+	c->runs = runs; \
+	*p += 4 * (size_t)runs; \
+	return total == cardinality; \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(void) \
+{ \
+	return (struct name__){ \
+		.containers = DATASTORE_IDENT(DATASTORE_IDENT(name__, containers), new)(0), \
+	}; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	for (size_t i = 0; i < self->containers.size; ++i) \
+		DATASTORE_IDENT(name__, impl_release)(self->containers.data[i].data, self->containers.data[i].capacity); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, containers), free)(&self->containers); \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	struct name__ clone = { \
+		.containers = DATASTORE_IDENT(DATASTORE_IDENT(name__, containers), clone)(&self->containers), \
+	}; \
+	for (size_t i = 0; i < clone.containers.size; ++i) \
+		clone.containers.data[i] = DATASTORE_IDENT(name__, impl_container_clone)(&self->containers.data[i]); \
+	return clone; \
+} \
+bool DATASTORE_IDENT(name__, insert)(struct name__ *self, uint32_t value) \
+{ \
+	const uint16_t key = (uint16_t)(value >> 16), low = (uint16_t)value; \
+	size_t index; \
+	if (!DATASTORE_IDENT(name__, impl_find)(self, key, &index)) \
+	{ \
+		struct datastore_roaring_container c = DATASTORE_IDENT(name__, impl_container)(key, DATASTORE_ROARING_ARRAY, \
+			4 * sizeof(uint16_t)); \
+		((uint16_t *)c.data)[0] = low; \
+		c.cardinality = 1; \
+		/* Append, then rotate into place */ \
+		DATASTORE_IDENT(DATASTORE_IDENT(name__, containers), push)(&self->containers, c); \
+		struct datastore_roaring_container *containers = self->containers.data; \
+		memmove(containers + index + 1, containers + index, (self->containers.size - 1 - index) * sizeof(c)); \
+		containers[index] = c; \
+		return true; \
+	} \
+	struct datastore_roaring_container *c = &self->containers.data[index]; \
+	if (DATASTORE_IDENT(name__, impl_test)(c, low)) \
+		return false; \
+	DATASTORE_IDENT(name__, impl_materialize)(c); \
+	if (c->kind == DATASTORE_ROARING_BITMAP) \
+		((uint64_t *)c->data)[low / 64] |= (uint64_t)1 << (low % 64); \
+	else \
+	{ \
+		DATASTORE_IDENT(name__, impl_reserve)(c, (c->cardinality + 1) * sizeof(uint16_t)); \
+		uint16_t *values = c->data; \
+		const size_t i = datastore_roaring_lower_bound(values, c->cardinality, low); \
+		memmove(values + i + 1, values + i, (c->cardinality - i) * sizeof(uint16_t)); \
+		values[i] = low; \
+	} \
+	++c->cardinality; \
+	DATASTORE_IDENT(name__, impl_normalize)(c); \
+	return true; \
+} \
+bool DATASTORE_IDENT(name__, remove)(struct name__ *self, uint32_t value) \
+{ \
+	const uint16_t key = (uint16_t)(value >> 16), low = (uint16_t)value; \
+	size_t index; \
+	if (!DATASTORE_IDENT(name__, impl_find)(self, key, &index)) \
+		return false; \
+	struct datastore_roaring_container *c = &self->containers.data[index]; \
+	if (!DATASTORE_IDENT(name__, impl_test)(c, low)) \
+		return false; \
+	if (c->cardinality == 1) \
+	{ \
+		DATASTORE_IDENT(name__, impl_release)(c->data, c->capacity); \
+		memmove(c, c + 1, (self->containers.size - 1 - index) * sizeof(*c)); \
+		--self->containers.size; \
+		return true; \
+	} \
+	DATASTORE_IDENT(name__, impl_materialize)(c); \
+	if (c->kind == DATASTORE_ROARING_BITMAP) \
+		((uint64_t *)c->data)[low / 64] &= ~((uint64_t)1 << (low % 64)); \
+	else \
+	{ \
+		uint16_t *values = c->data; \
+		const size_t i = datastore_roaring_lower_bound(values, c->cardinality, low); \
+		memmove(values + i, values + i + 1, (c->cardinality - i - 1) * sizeof(uint16_t)); \
+	} \
+	--c->cardinality; \
+	DATASTORE_IDENT(name__, impl_normalize)(c); \
+	return true; \
+} \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, uint32_t value) \
+{ \
+	size_t index; \
+	return DATASTORE_IDENT(name__, impl_find)(self, (uint16_t)(value >> 16), &index) \
+		&& DATASTORE_IDENT(name__, impl_test)(&self->containers.data[index], (uint16_t)value); \
+} \
+size_t DATASTORE_IDENT(name__, cardinality)(const struct name__ *self) \
+{ \
+	size_t cardinality = 0; \
+	for (size_t i = 0; i < self->containers.size; ++i) \
+		cardinality += self->containers.data[i].cardinality; \
+	return cardinality; \
+} \
+struct name__ DATASTORE_IDENT(name__, union)(const struct name__ *a, const struct name__ *b) \
+{ \
+	return DATASTORE_IDENT(name__, impl_combine)(a, b, DATASTORE_ROARING_OR); \
+} \
+struct name__ DATASTORE_IDENT(name__, intersect)(const struct name__ *a, const struct name__ *b) \
+{ \
+	return DATASTORE_IDENT(name__, impl_combine)(a, b, DATASTORE_ROARING_AND); \
+} \
+struct name__ DATASTORE_IDENT(name__, difference)(const struct name__ *a, const struct name__ *b) \
+{ \
+	return DATASTORE_IDENT(name__, impl_combine)(a, b, DATASTORE_ROARING_ANDNOT); \
+} \
+void DATASTORE_IDENT(name__, optimize)(struct name__ *self) \
+{ \
+	for (size_t i = 0; i < self->containers.size; ++i) \
+	{ \
+		struct datastore_roaring_container *c = &self->containers.data[i]; \
+		size_t runs = c->runs; \
+		if (c->kind == DATASTORE_ROARING_ARRAY) \
+			runs = datastore_roaring_array_runs(c->data, c->cardinality); \
+		else if (c->kind == DATASTORE_ROARING_BITMAP) \
+			runs = datastore_roaring_bitmap_runs(c->data); \
+		const size_t plain = c->cardinality > DATASTORE_ROARING_ARRAY_MAX \
+			? DATASTORE_ROARING_BITMAP_WORDS * sizeof(uint64_t) : c->cardinality * sizeof(uint16_t); \
+		if (runs * 2 * sizeof(uint16_t) < plain) \
+		{ \
+			if (c->kind != DATASTORE_ROARING_RUN) \
+				DATASTORE_IDENT(name__, impl_to_run)(c, runs); \
+		} \
+		else \
+			DATASTORE_IDENT(name__, impl_materialize)(c); \
+		/* Release the capacity left by insertions */ \
+		const size_t bytes = DATASTORE_IDENT(name__, impl_bytes)(c); \
+		const size_t needed = DATASTORE_IDENT(name__, impl_alloc_size)(bytes); \
+		if (c->capacity > needed && c->capacity - needed > needed / 2 + DATASTORE_ROARING_SLACK) \
+		{ \
+			uint32_t capacity; \
+			void *data = DATASTORE_IDENT(name__, impl_alloc)(bytes, &capacity); \
+			memcpy(data, c->data, bytes); \
+			DATASTORE_IDENT(name__, impl_replace)(c, data, capacity, (enum datastore_roaring_kind)c->kind); \
+		} \
+	} \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, containers), shrink_to_fit)(&self->containers); \
+} \
+struct DATASTORE_IDENT(name__, values) DATASTORE_IDENT(name__, flatten)(const struct name__ *self) \
+{ \
+	struct DATASTORE_IDENT(name__, values) values = DATASTORE_IDENT(DATASTORE_IDENT(name__, values), new)( \
+		DATASTORE_IDENT(name__, cardinality)(self)); \
+	for (size_t i = 0; i < self->containers.size; ++i) \
+	{ \
+		const struct datastore_roaring_container *c = &self->containers.data[i]; \
+		const uint32_t high = (uint32_t)c->key << 16; \
+		DATASTORE_ROARING_IMPL_RUNS(c, value, { values.data[values.size++] = high | value; }) \
+	} \
+	return values; \
+} \
+size_t DATASTORE_IDENT(name__, serialized_size)(const struct name__ *self) \
+{ \
+	size_t size = 12; \
+	for (size_t i = 0; i < self->containers.size; ++i) \
+	{ \
+		const struct datastore_roaring_container *c = &self->containers.data[i]; \
+		size += (c->kind == DATASTORE_ROARING_RUN ? 12u : 8u) + DATASTORE_IDENT(name__, impl_bytes)(c); \
+	} \
+	return size; \
+} \
+void DATASTORE_IDENT(name__, serialize)(const struct name__ *self, struct DATASTORE_IDENT(name__, bytes) *out) \
+{ \
+	const size_t size = DATASTORE_IDENT(name__, serialized_size)(self); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, bytes), reserve)(out, out->size + size); \
+	unsigned char *p = out->data + out->size; \
+	memcpy(p, "DSRB", 4); \
+	datastore_roaring_put32(p + 4, DATASTORE_ROARING_VERSION); \
+	datastore_roaring_put32(p + 8, (uint32_t)self->containers.size); \
+	p += 12; \
+	for (size_t i = 0; i < self->containers.size; ++i) \
+	{ \
+		const struct datastore_roaring_container *c = &self->containers.data[i]; \
+		datastore_roaring_put16(p, c->key); \
+		p[2] = c->kind; \
+		p[3] = 0; \
+		datastore_roaring_put32(p + 4, c->cardinality); \
+		p += 8; \
+		if (c->kind == DATASTORE_ROARING_BITMAP) \
+		{ \
+			const uint64_t *words = c->data; \
+			for (size_t w = 0; w < DATASTORE_ROARING_BITMAP_WORDS; ++w, p += 8) \
+				datastore_roaring_put64(p, words[w]); \
+			continue; \
+		} \
+		size_t count = c->cardinality; \
+		if (c->kind == DATASTORE_ROARING_RUN) \
+		{ \
+			datastore_roaring_put32(p, c->runs); \
+			p += 4; \
+			count = 2 * (size_t)c->runs; \
+		} \
+		const uint16_t *values = c->data; \
+		for (size_t v = 0; v < count; ++v, p += 2) \
+			datastore_roaring_put16(p, values[v]); \
+	} \
+	out->size += size; \
+} \
+size_t DATASTORE_IDENT(name__, deserialize)(struct name__ *out, const void *data, size_t size) \
+{ \
+	const unsigned char *p = data, *const end = p + size; \
+	if (size < 12 || memcmp(p, "DSRB", 4) || datastore_roaring_get32(p + 4) != DATASTORE_ROARING_VERSION) \
+		return 0; \
+	const uint32_t count = datastore_roaring_get32(p + 8); \
+	p += 12; \
+	if (count > 65536) \
+		return 0; \
+	struct name__ result = DATASTORE_IDENT(name__, new)(); \
+	bool ok = true; \
+	for (uint32_t i = 0; ok && i < count; ++i) \
+	{ \
+		if (end - p < 8) \
+		{ \
+			ok = false; \
+			break; \
+		} \
+		const uint16_t key = datastore_roaring_get16(p); \
+		const unsigned kind = p[2]; \
+		const uint32_t cardinality = datastore_roaring_get32(p + 4); \
+		ok = p[3] == 0 && kind <= DATASTORE_ROARING_RUN && cardinality && cardinality <= 65536 \
+			&& (!i || key > result.containers.data[i - 1].key); \
+		p += 8; \
+		if (!ok) \
+			break; \
+		struct datastore_roaring_container c = DATASTORE_IDENT(name__, impl_container)(key, \
+			(enum datastore_roaring_kind)kind, \
+			kind == DATASTORE_ROARING_ARRAY && cardinality <= DATASTORE_ROARING_ARRAY_MAX \
+				? cardinality * sizeof(uint16_t) : 0); \
+		c.cardinality = cardinality; \
+		ok = DATASTORE_IDENT(name__, impl_read)(&c, &p, end); \
+		DATASTORE_IDENT(DATASTORE_IDENT(name__, containers), push)(&result.containers, c); \
+	} \
+	if (!ok) \
+	{ \
+		DATASTORE_IDENT(name__, free)(&result); \
+		return 0; \
+	} \
+	*out = result; \
+	return (size_t)(p - (const unsigned char *)data); \
+}
+
+/*
+ * Runs `body__` with `value__` (an `unsigned`) set to every low value of a container, in
+ * increasing order.
+ */
+#define DATASTORE_ROARING_IMPL_RUNS(c__, value__, body__) \
+	{ \
+		const uint16_t *values__ = (c__)->data; \
+		if ((c__)->kind == DATASTORE_ROARING_ARRAY) \
+			for (uint32_t i__ = 0; i__ < (c__)->cardinality; ++i__) \
+			{ \
+				const unsigned value__ = values__[i__]; \
+				body__ \
+			} \
+		else if ((c__)->kind == DATASTORE_ROARING_BITMAP) \
+		{ \
+			const uint64_t *words__ = (c__)->data; \
+			for (unsigned w__ = 0; w__ < DATASTORE_ROARING_BITMAP_WORDS; ++w__) \
+				for (uint64_t bits__ = words__[w__]; bits__; bits__ &= bits__ - 1) \
+				{ \
+					const unsigned value__ = w__ * 64 + (unsigned)__builtin_ctzll(bits__); \
+					body__ \
+				} \
+		} \
+		else \
+			for (uint32_t r__ = 0; r__ < (c__)->runs; ++r__) \
+				for (unsigned value__ = values__[2 * r__]; \
+					value__ <= (unsigned)values__[2 * r__] + values__[2 * r__ + 1]; ++value__) \
+				{ \
+					body__ \
+				} \
+	}
+
+/**
+ * @brief Roaring set methods implementation
+ *
+ * This macro will call @ref DATASTORE_ROARING_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param name__ Name of the set, must match the name passed to @ref DATASTORE_ROARING
+ */
+#define DATASTORE_ROARING_IMPL(name__) \
+	DATASTORE_ROARING_IMPL_S(name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup Roaring */
+
+#endif // DATASTORE_ROARING_H
@@ -0,0 +1,177 @@
+#include "test.h"
+
+DATASTORE_ROARING_IMPL_S(idset, SETTINGS)
+// Capacities reported by the allocator, larger than requested
+DATASTORE_ROARING(idset_usable)
+DATASTORE_ROARING_IMPL_S(idset_usable, DATASTORE_VEC_SETTINGS_USABLE)
+
+static uint32_t g_seed = 99;
+static uint32_t next_u32(void)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return g_seed >> 8;
+}
+
+// Compares a set to a flag per value of the universe
+static int matches(const idset *set, const unsigned char *flags)
+{
+	int ok = 1;
+	size_t count = 0;
+	for (uint32_t v = 0; v < UNIVERSE; ++v)
+	{
+		ok &= idset_contains(set, v) == flags[v];
+		count += flags[v];
+	}
+	ok &= idset_cardinality(set) == count;
+	struct idset_values values = idset_flatten(set);
+	ok &= values.size == count;
+	for (size_t i = 1; i < values.size; ++i)
+		ok &= values.data[i - 1] < values.data[i];
+	idset_values_free(&values);
+	return ok;
+}
+
+static unsigned kind_of(const idset *set, uint16_t key)
+{
+	for (size_t i = 0; i < set->containers.size; ++i)
+		if (set->containers.data[i].key == key)
+			return set->containers.data[i].kind;
+	return 255;
+}
+
+TESTS(roaring_basic, {
+	TEST("empty", {
+		idset set = idset_new();
+		ASSERT(idset_cardinality(&set) == 0)
+		ASSERT(!idset_contains(&set, 0))
+		ASSERT(!idset_remove(&set, 0))
+		idset_optimize(&set);
+		ASSERT(set.containers.size == 0)
+		idset_free(&set);
+	})
+	TEST("insert remove", {
+		unsigned char *flags = calloc(UNIVERSE, 1);
+		if (!flags)
+			abort();
+		idset set = idset_new();
+		int ok = 1;
+		// Key 0 sparse, key 1 dense, keys 2 and 3 in between
+		for (size_t i = 0; i < 40000; ++i)
+		{
+			const uint32_t key = next_u32() % 4;
+			if (key == 0 && i % 4)
+				continue;
+			const uint32_t v = key << 16 | (next_u32() % (key == 0 ? 65536 : key == 1 ? 30000 : 9000));
+			ok &= idset_insert(&set, v) == !flags[v];
+			flags[v] = 1;
+		}
+		ASSERT(ok)
+		ASSERT(matches(&set, flags))
+		ASSERT(kind_of(&set, 0) == DATASTORE_ROARING_ARRAY)
+		ASSERT(kind_of(&set, 1) == DATASTORE_ROARING_BITMAP)
+		for (size_t i = 0; i < 60000; ++i)
+		{
+			const uint32_t v = next_u32() % UNIVERSE;
+			ok &= idset_remove(&set, v) == flags[v];
+			flags[v] = 0;
+		}
+		ASSERT(ok)
+		ASSERT(matches(&set, flags))
+		idset_free(&set);
+		free(flags);
+	})
+	TEST("transitions", {
+		idset set = idset_new();
+		for (uint32_t v = 0; v < 2 * (DATASTORE_ROARING_ARRAY_MAX + 1); v += 2)
+			idset_insert(&set, v);
+		ASSERT(kind_of(&set, 0) == DATASTORE_ROARING_BITMAP)
+		ASSERT(idset_remove(&set, 0))
+		ASSERT(kind_of(&set, 0) == DATASTORE_ROARING_ARRAY)
+		ASSERT(idset_cardinality(&set) == DATASTORE_ROARING_ARRAY_MAX)
+		// Removing the last value drops the container
+		idset_insert(&set, 7u << 16);
+		ASSERT(set.containers.size == 2)
+		ASSERT(idset_remove(&set, 7u << 16))
+		ASSERT(set.containers.size == 1)
+		idset_free(&set);
+	})
+	TEST("runs", {
+		unsigned char *flags = calloc(UNIVERSE, 1);
+		if (!flags)
+			abort();
+		idset set = idset_new();
+		for (uint32_t v = 1000; v < 70000; ++v)
+		{
+			idset_insert(&set, v);
+			flags[v] = 1;
+		}
+		for (uint32_t v = 200000; v < 200010; ++v)
+		{
+			idset_insert(&set, v);
+			flags[v] = 1;
+		}
+		idset_insert(&set, 65535 + 3 * 65536);
+		flags[65535 + 3 * 65536] = 1;
+		// Isolated values are smaller as an array
+		for (uint32_t v = 2 * 65536; v < 2 * 65536 + 100; v += 7)
+		{
+			idset_insert(&set, v);
+			flags[v] = 1;
+		}
+		idset_optimize(&set);
+		ASSERT(kind_of(&set, 0) == DATASTORE_ROARING_RUN)
+		ASSERT(kind_of(&set, 1) == DATASTORE_ROARING_RUN)
+		ASSERT(kind_of(&set, 2) == DATASTORE_ROARING_ARRAY)
+		ASSERT(kind_of(&set, 3) == DATASTORE_ROARING_RUN)
+		ASSERT(set.containers.data[0].runs == 1)
+		ASSERT(set.containers.data[3].runs == 2)
+		ASSERT(matches(&set, flags))
+		// Containers already at their size are not reallocated
+		const void *small = set.containers.data[0].data;
+		idset_optimize(&set);
+		ASSERT(set.containers.data[0].data == small)
+		struct idset_usable usable = idset_usable_new();
+		for (uint32_t v = 0; v < UNIVERSE; ++v)
+			if (flags[v])
+				idset_usable_insert(&usable, v);
+		idset_usable_optimize(&usable);
+		const void *before[4];
+		for (size_t i = 0; i < 4; ++i)
+			before[i] = usable.containers.data[i].data;
+		idset_usable_optimize(&usable);
+		int stable = usable.containers.size == 4;
+		for (size_t i = 0; i < 4; ++i)
+			stable &= usable.containers.data[i].data == before[i];
+		ASSERT(stable)
+		idset_usable_free(&usable);
+		idset clone = idset_clone(&set);
+		// Modifying a run container expands it
+		ASSERT(idset_insert(&set, 10))
+		ASSERT(!idset_insert(&set, 5000))
+		ASSERT(idset_remove(&set, 6000))
+		flags[10] = 1;
+		flags[6000] = 0;
+		ASSERT(kind_of(&set, 0) == DATASTORE_ROARING_BITMAP)
+		ASSERT(matches(&set, flags))
+		idset_optimize(&set);
+		ASSERT(kind_of(&set, 0) == DATASTORE_ROARING_RUN)
+		ASSERT(set.containers.data[0].runs == 3)
+		ASSERT(matches(&set, flags))
+		ASSERT(idset_cardinality(&clone) == 69000 + 10 + 1 + 15)
+		ASSERT(idset_contains(&clone, 6000) && !idset_contains(&clone, 10))
+		idset_free(&clone);
+		idset_free(&set);
+		free(flags);
+	})
+	TEST("extremes", {
+		idset set = idset_new();
+		ASSERT(idset_insert(&set, UINT32_MAX))
+		ASSERT(idset_insert(&set, 0))
+		ASSERT(idset_contains(&set, UINT32_MAX) && idset_contains(&set, 0))
+		ASSERT(!idset_contains(&set, UINT32_MAX - 1))
+		struct idset_values values = idset_flatten(&set);
+		ASSERT(values.size == 2 && values.data[0] == 0 && values.data[1] == UINT32_MAX)
+		idset_values_free(&values);
+		idset_free(&set);
+	})
+})
@@ -0,0 +1,191 @@
+#include "test.h"
+
+static uint32_t g_seed = 31337;
+static uint32_t next_u32(void)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return g_seed >> 8;
+}
+
+/* Shape of the values of one container */
+enum shape
+{
+	SPARSE,
+	DENSE,
+	RANGES,
+	NONE,
+};
+
+// Fills a container of a set and its flags, `optimize` must be called afterwards for runs
+static void fill(idset *set, unsigned char *flags, uint32_t key, enum shape shape)
+{
+	for (uint32_t low = 0; low < 65536; ++low)
+	{
+		bool present = false;
+		if (shape == SPARSE)
+			present = next_u32() % 40 == 0;
+		else if (shape == DENSE)
+			present = next_u32() % 3 != 0;
+		else if (shape == RANGES)
+			present = (low / 1000) % 3 == key % 3;
+		if (present)
+		{
+			idset_insert(set, key << 16 | low);
+			flags[key << 16 | low] = 1;
+		}
+	}
+}
+
+static int matches(const idset *set, const unsigned char *flags)
+{
+	int ok = 1;
+	size_t count = 0;
+	for (uint32_t v = 0; v < UNIVERSE; ++v)
+	{
+		ok &= idset_contains(set, v) == flags[v];
+		count += flags[v];
+	}
+	return ok && idset_cardinality(set) == count;
+}
+
+// Builds two sets with given shapes per container and checks the three operations
+static int check_ops(const enum shape *shapes_a, const enum shape *shapes_b)
+{
+	unsigned char *fa = calloc(UNIVERSE, 1), *fb = calloc(UNIVERSE, 1), *expected = malloc(UNIVERSE);
+	if (!fa || !fb || !expected)
+		abort();
+	idset a = idset_new(), b = idset_new();
+	for (uint32_t key = 0; key < 4; ++key)
+	{
+		fill(&a, fa, key, shapes_a[key]);
+		fill(&b, fb, key, shapes_b[key]);
+	}
+	idset_optimize(&a);
+	idset_optimize(&b);
+	int ok = 1;
+	idset r = idset_union(&a, &b);
+	for (size_t v = 0; v < UNIVERSE; ++v)
+		expected[v] = fa[v] | fb[v];
+	ok &= matches(&r, expected);
+	idset_free(&r);
+	r = idset_intersect(&a, &b);
+	for (size_t v = 0; v < UNIVERSE; ++v)
+		expected[v] = fa[v] & fb[v];
+	ok &= matches(&r, expected);
+	idset_free(&r);
+	r = idset_difference(&a, &b);
+	for (size_t v = 0; v < UNIVERSE; ++v)
+		expected[v] = fa[v] & !fb[v];
+	ok &= matches(&r, expected);
+	idset_free(&r);
+	idset_free(&a);
+	idset_free(&b);
+	free(fa);
+	free(fb);
+	free(expected);
+	return ok;
+}
+
+// Checks that two sets hold the same values in the same forms
+static int identical(const idset *x, const idset *y)
+{
+	int ok = x->containers.size == y->containers.size;
+	for (size_t i = 0; ok && i < x->containers.size; ++i)
+		ok &= x->containers.data[i].key == y->containers.data[i].key
+			&& x->containers.data[i].kind == y->containers.data[i].kind
+			&& x->containers.data[i].cardinality == y->containers.data[i].cardinality;
+	struct idset_values vx = idset_flatten(x), vy = idset_flatten(y);
+	ok &= vx.size == vy.size && (!vx.size || !memcmp(vx.data, vy.data, vx.size * sizeof(uint32_t)));
+	idset_values_free(&vx);
+	idset_values_free(&vy);
+	return ok;
+}
+
+TESTS(roaring_ops, {
+	TEST("array kernels", {
+		uint16_t a[300] = { 0 }, b[3000] = { 0 }, out[300];
+		int ok = 1;
+		for (size_t trial = 0; trial < 50; ++trial)
+		{
+			const size_t na = 1 + next_u32() % 300, nb = 1 + next_u32() % 3000;
+			uint16_t v = 0;
+			for (size_t i = 0; i < na; ++i)
+				a[i] = v = (uint16_t)(v + 1 + next_u32() % (trial % 2 ? 200 : 4));
+			v = 0;
+			for (size_t i = 0; i < nb; ++i)
+				b[i] = v = (uint16_t)(v + 1 + next_u32() % 20);
+			const size_t count = datastore_roaring_intersect_u16(a, na, b, nb, out);
+			uint16_t expected[300] = { 0 };
+			const size_t expected_count = datastore_roaring_intersect_scalar(a, na, b, nb, expected);
+			ok &= count == expected_count && (!count || !memcmp(out, expected, count * sizeof(uint16_t)));
+		}
+		ASSERT(ok)
+	})
+	TEST("operations", {
+		const enum shape mixed_a[4] = { SPARSE, DENSE, RANGES, SPARSE };
+		const enum shape mixed_b[4] = { DENSE, SPARSE, RANGES, NONE };
+		const enum shape dense[4] = { DENSE, DENSE, DENSE, NONE };
+		const enum shape ranges[4] = { RANGES, RANGES, NONE, RANGES };
+		const enum shape sparse[4] = { NONE, SPARSE, SPARSE, SPARSE };
+		ASSERT(check_ops(mixed_a, mixed_b))
+		ASSERT(check_ops(mixed_b, mixed_a))
+		ASSERT(check_ops(dense, ranges))
+		ASSERT(check_ops(ranges, dense))
+		ASSERT(check_ops(sparse, dense))
+		ASSERT(check_ops(sparse, sparse))
+		ASSERT(check_ops(ranges, sparse))
+	})
+	TEST("serialize", {
+		unsigned char *flags = calloc(UNIVERSE, 1);
+		if (!flags)
+			abort();
+		idset set = idset_new();
+		fill(&set, flags, 0, SPARSE);
+		fill(&set, flags, 1, DENSE);
+		fill(&set, flags, 3, RANGES);
+		idset_optimize(&set);
+		idset_insert(&set, UINT32_MAX);
+		struct idset_bytes bytes = idset_bytes_new(0);
+		idset_bytes_push(&bytes, 42);
+		idset_serialize(&set, &bytes);
+		ASSERT(bytes.size == 1 + idset_serialized_size(&set))
+		idset copy;
+		ASSERT(idset_deserialize(&copy, bytes.data + 1, bytes.size - 1) == bytes.size - 1)
+		ASSERT(identical(&set, &copy))
+		idset_free(&copy);
+		// Every truncation is rejected
+		int ok = 1;
+		for (size_t size = 0; size < bytes.size - 1; size += 1 + size / 64)
+			ok &= idset_deserialize(&copy, bytes.data + 1, size) == 0;
+		ASSERT(ok)
+		idset_bytes_free(&bytes);
+		idset_free(&set);
+		free(flags);
+	})
+	TEST("malformed", {
+		idset set = idset_new();
+		idset_insert(&set, 5);
+		idset_insert(&set, 9);
+		struct idset_bytes bytes = idset_bytes_new(0);
+		idset_serialize(&set, &bytes);
+		idset copy;
+		ASSERT(idset_deserialize(&copy, bytes.data, bytes.size) == bytes.size)
+		idset_free(&copy);
+		// Unsorted values
+		bytes.data[20] = 10;
+		ASSERT(idset_deserialize(&copy, bytes.data, bytes.size) == 0)
+		bytes.data[20] = 9;
+		// Wrong cardinality
+		bytes.data[16] = 3;
+		ASSERT(idset_deserialize(&copy, bytes.data, bytes.size) == 0)
+		bytes.data[16] = 2;
+		// Unknown form
+		bytes.data[14] = 7;
+		ASSERT(idset_deserialize(&copy, bytes.data, bytes.size) == 0)
+		bytes.data[14] = 0;
+		bytes.data[0] = 'X';
+		ASSERT(idset_deserialize(&copy, bytes.data, bytes.size) == 0)
+		idset_bytes_free(&bytes);
+		idset_free(&set);
+	})
+})
@@ -0,0 +1,22 @@
+#ifndef DATASTORE_ROARING_TEST_H
+#define DATASTORE_ROARING_TEST_H
+
+#include "../tests/tests.h"
+#include "roaring.h"
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+DATASTORE_ROARING(idset)
+typedef struct idset idset;
+
+/* Values of the tests fit in the first four containers */
+#define UNIVERSE (4 * 65536)
+
+extern const unit_test test_roaring_basic;
+extern const unit_test test_roaring_ops;
+
+#endif // DATASTORE_ROARING_TEST_H
@@ -0,0 +1,807 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef DATASTORE_ROPE_H
+#define DATASTORE_ROPE_H
+
+#include "../vector/vector.h"
+#include "../vector/vector_string.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @file rope.h
+ * @defgroup Rope DATASTORE_ROPE: Rope for large editable texts
+ *
+ * @brief B-tree of byte chunks, with cached lengths and newline counts
+ *
+ * A rope stores a sequence of bytes in leaves of at most @ref DATASTORE_ROPE_LEAF bytes, the
+ * leaves of a B-tree whose internal nodes have between 2 and @ref DATASTORE_ROPE_FANOUT
+ * children. Every leaf is at the same depth. Each internal node caches the length and the number
+ * of `'\n'` of each child next to its pointer, so reaching the leaf of a byte offset, or of the
+ * start of a line, reads one node per level.
+ *
+ * - `insert` and `erase` within a single leaf move at most @ref DATASTORE_ROPE_LEAF bytes, and
+ *   update the cached counts on the path to the root.
+ * - Other edits are made by splitting the tree at the edit boundaries and joining the pieces.
+ *   Joining two trees walks down the edge of the highest one to the height of the other, and
+ *   merges the leaves meeting at the seam when they fit in one leaf (or evens them out when one
+ *   is less than half full), so edits do not leave small fragments behind. Splits and joins take
+ *   O(log n) time.
+ * - Conversions from bytes build a balanced tree of full leaves in one pass.
+ *
+ * Lines are numbered from `0`: line `k` starts after the `k`-th `'\n'`. Nodes are allocated with
+ * the settings of @ref advanced_usage "Advanced Usage".
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_ROPE(text)
+ * // Methods definition (in the .c)
+ * DATASTORE_ROPE_IMPL(text)
+ *
+ * struct text doc = text_from_bytes(file_data, file_size);
+ * const size_t start = text_line_start(&doc, 41);
+ * text_insert(&doc, start, "// TODO\n", 8);
+ * text_erase(&doc, 0, text_line_start(&doc, 1));
+ * // Back to a contiguous vector of char
+ * struct text_chars out = text_to_vec(&doc);
+ * text_free(&doc);
+ * @endcode
+ *
+ * **Macro `DATASTORE_ROPE(name)`**: Define a new rope type, its vector of chars `name_chars`
+ * (with the builder methods of @ref VectorString "vector_string.h") and its vector of node
+ * pointers `name_nodes`
+ *
+ * **Macro `DATASTORE_ROPE_IMPL(name)`** and **`DATASTORE_ROPE_IMPL_S(name, settings)`**:
+ * Implements methods for a rope type
+ *
+ * The resulting type will look like this:
+ * @code{.c}
+ * struct name {
+ *     struct datastore_rope_node *root; // NULL when empty
+ * };
+ * @endcode
+ *
+ * ## Exposed methods
+ *
+ * - `struct rope new(void)`: Create an empty rope
+ * - `struct rope from_bytes(const char *bytes, size_t size)`: Rope holding a copy of `size`
+ *   bytes
+ * - `struct rope from_vec(const struct rope_chars *chars)`: Rope holding a copy of a vector
+ * - `struct rope_chars to_vec(const struct rope *self)`: Contiguous copy of the rope
+ * - `void free(struct rope *self)`: Free the rope
+ * - `struct rope clone(const struct rope *self)`: Copy of the rope
+ * - `size_t length(const struct rope *self)`: Number of bytes
+ * - `size_t lines(const struct rope *self)`: Number of lines, the number of `'\n'` plus one
+ * - `void insert(struct rope *self, size_t offset, const char *bytes, size_t size)`: Inserts
+ *   `size` bytes before the byte at `offset` (`offset <= length`)
+ * - `void erase(struct rope *self, size_t offset, size_t size)`: Removes `size` bytes from
+ *   `offset` (`offset + size <= length`)
+ * - `struct rope split(struct rope *self, size_t offset)`: Moves the bytes from `offset` to a new
+ *   rope, which is returned
+ * - `void concat(struct rope *self, struct rope *other)`: Moves the bytes of `other` to the end of
+ *   `self`, `other` becomes empty
+ * - `char byte_at(const struct rope *self, size_t offset)`: Byte at `offset` (`offset < length`)
+ * - `const char *chunk(const struct rope *self, size_t offset, size_t *size)`: Contiguous bytes
+ *   from `offset` (`offset < length`) to the end of their leaf, their number stored in `size`
+ * - `void copy(const struct rope *self, size_t offset, size_t size, char *out)`: Copies `size`
+ *   bytes from `offset` to `out`
+ * - `size_t line_start(const struct rope *self, size_t line)`: Offset of the first byte of a line
+ *   (`line < lines`)
+ * - `size_t line_of(const struct rope *self, size_t offset)`: Line of the byte at `offset`
+ *   (`offset <= length`)
+ */
+
+/**
+ * @brief Maximum number of bytes in a leaf
+ */
+#ifndef DATASTORE_ROPE_LEAF
+	#define DATASTORE_ROPE_LEAF 1024
+#endif
+
+/**
+ * @brief Maximum number of children of an internal node
+ */
+#ifndef DATASTORE_ROPE_FANOUT
+	#define DATASTORE_ROPE_FANOUT 16
+#endif
+
+/* Internal nodes have at least 2 children, which bounds the height by the bits of a size */
+#define DATASTORE_ROPE_MAX_HEIGHT 64
+
+/**
+ * @brief Header of the nodes
+ */
+struct datastore_rope_node
+{
+	/* Bytes and '\n' under the node */
+	size_t length;
+	size_t newlines;
+	/* Bytes of a leaf, children of an internal node */
+	uint32_t count;
+	/* 0 for leaves */
+	uint32_t height;
+};
+
+/**
+ * @brief Leaf, `node.length == node.count`
+ */
+struct datastore_rope_leaf
+{
+	struct datastore_rope_node node;
+	char data[DATASTORE_ROPE_LEAF];
+};
+
+/**
+ * @brief Internal node, with the length and newlines of each child
+ */
+struct datastore_rope_inner
+{
+	struct datastore_rope_node node;
+	size_t lengths[DATASTORE_ROPE_FANOUT];
+	size_t newlines[DATASTORE_ROPE_FANOUT];
+	struct datastore_rope_node *children[DATASTORE_ROPE_FANOUT];
+};
+
+#define DATASTORE_ROPE_NODE_TRAIT(X) \
+	X(TYPE, struct datastore_rope_node *) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+static inline struct datastore_rope_leaf *datastore_rope_as_leaf(struct datastore_rope_node *node)
+{
+	assert(!node->height);
+	return (struct datastore_rope_leaf *)node;
+}
+
+static inline const struct datastore_rope_leaf *datastore_rope_as_leaf_const(const struct datastore_rope_node *node)
+{
+	assert(!node->height);
+	return (const struct datastore_rope_leaf *)node;
+}
+
+static inline struct datastore_rope_inner *datastore_rope_as_inner(struct datastore_rope_node *node)
+{
+	assert(node->height);
+	return (struct datastore_rope_inner *)node;
+}
+
+static inline const struct datastore_rope_inner *datastore_rope_as_inner_const(const struct datastore_rope_node *node)
+{
+	assert(node->height);
+	return (const struct datastore_rope_inner *)node;
+}
+
+/**
+ * @brief Number of `'\n'` in `size` bytes, counted 8 bytes at a time
+ */
+static inline size_t datastore_rope_count_newlines(const char *bytes, size_t size)
+{
+	const uint64_t ones = 0x0101010101010101ull;
+	const uint64_t high = 0x8080808080808080ull;
+	size_t count = 0, i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, bytes + i, 8);
+		word ^= ones * '\n';
+		/* High bit of the bytes that were '\n', without carries between bytes */
+		const uint64_t zero = ~(((word & ~high) + ~high) | word) & high;
+		/* Sums the bytes of `zero >> 7` in the top byte */
+		count += (size_t)(((zero >> 7) * ones) >> 56);
+	}
+	for (; i < size; ++i)
+		count += (size_t)(bytes[i] == '\n');
+	return count;
+}
+
+/**
+ * @brief Sets the children of an internal node, and its cached counts
+ */
+static inline void datastore_rope_fill(struct datastore_rope_inner *inner, struct datastore_rope_node *const *children,
+	size_t count)
+{
+	assert(count >= 2 && count <= DATASTORE_ROPE_FANOUT);
+	inner->node.length = 0;
+	inner->node.newlines = 0;
+	inner->node.count = (uint32_t)count;
+	for (size_t i = 0; i < count; ++i)
+	{
+		assert(children[i]->height + 1 == inner->node.height);
+		inner->children[i] = children[i];
+		inner->lengths[i] = children[i]->length;
+		inner->newlines[i] = children[i]->newlines;
+		inner->node.length += children[i]->length;
+		inner->node.newlines += children[i]->newlines;
+	}
+}
+
+/**
+ * @brief Copies `size` bytes from `offset` under a node to `out`
+ */
+static inline void datastore_rope_copy(const struct datastore_rope_node *node, size_t offset, size_t size, char *out)
+{
+	if (!node->height)
+	{
+		memcpy(out, datastore_rope_as_leaf_const(node)->data + offset, size);
+		return;
+	}
+	const struct datastore_rope_inner *inner = datastore_rope_as_inner_const(node);
+	for (size_t i = 0; i < inner->node.count && size; ++i)
+	{
+		if (offset >= inner->lengths[i])
+		{
+			offset -= inner->lengths[i];
+			continue;
+		}
+		const size_t take = inner->lengths[i] - offset < size ? inner->lengths[i] - offset : size;
+		datastore_rope_copy(inner->children[i], offset, take, out);
+		out += take;
+		size -= take;
+		offset = 0;
+	}
+}
+
+/**
+ * @brief Rope type definition and methods declaration
+ *
+ * @param name__ Name of the rope type
+ */
+#define DATASTORE_ROPE(name__) \
+DATASTORE_VEC(char, DATASTORE_IDENT(name__, chars)) \
+DATASTORE_VEC_STRING(DATASTORE_IDENT(name__, chars)) \
+DATASTORE_VEC(struct datastore_rope_node *, DATASTORE_IDENT(name__, nodes)) \
+struct name__ \
+{ \
+	struct datastore_rope_node *root; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(void); \
+struct name__ DATASTORE_IDENT(name__, from_bytes)(const char *bytes, size_t size); \
+struct name__ DATASTORE_IDENT(name__, from_vec)(const struct DATASTORE_IDENT(name__, chars) *chars); \
+struct DATASTORE_IDENT(name__, chars) DATASTORE_IDENT(name__, to_vec)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+size_t DATASTORE_IDENT(name__, length)(const struct name__ *self); \
+size_t DATASTORE_IDENT(name__, lines)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, insert)(struct name__ *self, size_t offset, const char *bytes, size_t size); \
+void DATASTORE_IDENT(name__, erase)(struct name__ *self, size_t offset, size_t size); \
+struct name__ DATASTORE_IDENT(name__, split)(struct name__ *self, size_t offset); \
+void DATASTORE_IDENT(name__, concat)(struct name__ *self, struct name__ *other); \
+char DATASTORE_IDENT(name__, byte_at)(const struct name__ *self, size_t offset); \
+const char *DATASTORE_IDENT(name__, chunk)(const struct name__ *self, size_t offset, size_t *size); \
+void DATASTORE_IDENT(name__, copy)(const struct name__ *self, size_t offset, size_t size, char *out); \
+size_t DATASTORE_IDENT(name__, line_start)(const struct name__ *self, size_t line); \
+size_t DATASTORE_IDENT(name__, line_of)(const struct name__ *self, size_t offset);
+
+/**
+ * @brief Rope methods implementation
+ *
+ * @param name__ Name of the rope, must match the name passed to @ref DATASTORE_ROPE
+ * @param settings__ Custom settings for the nodes and vectors, see
+ * @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_ROPE_IMPL_S(name__, settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_VEC_STRING_TRAIT, DATASTORE_IDENT(name__, chars), settings__) \
+DATASTORE_VEC_STRING_IMPL(DATASTORE_IDENT(name__, chars)) \
+DATASTORE_VEC_IMPL_S(DATASTORE_ROPE_NODE_TRAIT, DATASTORE_IDENT(name__, nodes), settings__) \
+static inline struct datastore_rope_node *DATASTORE_IDENT(name__, impl_alloc)(size_t bytes, uint32_t height) \
+{ \
+	struct datastore_rope_node *ptr; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(bytes, align); \
+	size_t usable = size; \
+	settings__(DATASTORE_VEC_SETTINGS_NEW) \
+	assert(usable >= size); \
+	DATASTORE_MAYBE_UNUSED(usable); \
+	ptr->length = 0; \
+	ptr->newlines = 0; \
+	ptr->count = 0; \
+	ptr->height = height; \
+	return ptr; \
+} \
+static inline struct datastore_rope_leaf *DATASTORE_IDENT(name__, impl_new_leaf)(void) \
+{ \
+	return datastore_rope_as_leaf(DATASTORE_IDENT(name__, impl_alloc)(sizeof(struct datastore_rope_leaf), 0)); \
+} \
+static inline struct datastore_rope_inner *DATASTORE_IDENT(name__, impl_new_inner)(uint32_t height) \
+{ \
+	return datastore_rope_as_inner(DATASTORE_IDENT(name__, impl_alloc)(sizeof(struct datastore_rope_inner), height)); \
+} \
+/* Frees a single node */ \
+static inline void DATASTORE_IDENT(name__, impl_release)(struct datastore_rope_node *ptr) \
+{ \
+	const size_t size = ptr->height ? sizeof(struct datastore_rope_inner) : sizeof(struct datastore_rope_leaf); \
+	DATASTORE_MAYBE_UNUSED(size); \
+	settings__(DATASTORE_VEC_SETTINGS_FREE) \
+} \
+/* Frees a node and its descendants */ \
+static void DATASTORE_IDENT(name__, impl_destroy)(struct datastore_rope_node *node) \
+{ \
+	if (node->height) \
+	{ \
+		struct datastore_rope_inner *inner = datastore_rope_as_inner(node); \
+		for (size_t i = 0; i < inner->node.count; ++i) \
+			DATASTORE_IDENT(name__, impl_destroy)(inner->children[i]); \
+	} \
+	DATASTORE_IDENT(name__, impl_release)(node); \
+} \
+static struct datastore_rope_node *DATASTORE_IDENT(name__, impl_clone)(const struct datastore_rope_node *node) \
+{ \
+	if (!node->height) \
+	{ \
+		struct datastore_rope_leaf *leaf = DATASTORE_IDENT(name__, impl_new_leaf)(); \
+		leaf->node = *node; \
+		memcpy(leaf->data, datastore_rope_as_leaf_const(node)->data, node->count); \
+		return &leaf->node; \
+	} \
+	const struct datastore_rope_inner *inner = datastore_rope_as_inner_const(node); \
+	struct datastore_rope_inner *clone = DATASTORE_IDENT(name__, impl_new_inner)(node->height); \
+	*clone = *inner; \
+	for (size_t i = 0; i < inner->node.count; ++i) \
+		clone->children[i] = DATASTORE_IDENT(name__, impl_clone)(inner->children[i]); \
+	return &clone->node; \
+} \
+/* Merges two leaves into one, or evens them out when one is less than half full */ \
+static size_t DATASTORE_IDENT(name__, impl_merge_leaves)(struct datastore_rope_leaf *a, struct datastore_rope_leaf *b, \
+	struct datastore_rope_node **out) \
+{ \
+	const size_t total = (size_t)a->node.count + b->node.count; \
+	if (total <= DATASTORE_ROPE_LEAF) \
+	{ \
+		memcpy(a->data + a->node.count, b->data, b->node.count); \
+		a->node.count = (uint32_t)total; \
+		a->node.length = total; \
+		a->node.newlines += b->node.newlines; \
+		DATASTORE_IDENT(name__, impl_release)(&b->node); \
+		out[0] = &a->node; \
+		return 1; \
+	} \
+	const size_t half = total / 2; \
+	if (a->node.count < DATASTORE_ROPE_LEAF / 2 && a->node.count < half) \
+	{ \
+		/* Moves the front of `b` to the end of `a` */ \
+		const size_t moved = half - a->node.count; \
+		const size_t newlines = datastore_rope_count_newlines(b->data, moved); \
+		memcpy(a->data + a->node.count, b->data, moved); \
+		memmove(b->data, b->data + moved, b->node.count - moved); \
+		a->node.count = (uint32_t)half; \
+		b->node.count = (uint32_t)(total - half); \
+		a->node.newlines += newlines; \
+		b->node.newlines -= newlines; \
+	} \
+	else if (b->node.count < DATASTORE_ROPE_LEAF / 2 && b->node.count < half) \
+	{ \
+		/* Moves the end of `a` to the front of `b` */ \
+		const size_t moved = half - b->node.count; \
+		const size_t newlines = datastore_rope_count_newlines(a->data + a->node.count - moved, moved); \
+		memmove(b->data + moved, b->data, b->node.count); \
+		memcpy(b->data, a->data + a->node.count - moved, moved); \
+		a->node.count = (uint32_t)(total - half); \
+		b->node.count = (uint32_t)half; \
+		a->node.newlines -= newlines; \
+		b->node.newlines += newlines; \
+	} \
+	a->node.length = a->node.count; \
+	b->node.length = b->node.count; \
+	out[0] = &a->node; \
+	out[1] = &b->node; \
+	return 2; \
+} \
+/* Places `count` children in `a`, and in `b` (allocated if NULL) when they do not fit */ \
+static size_t DATASTORE_IDENT(name__, impl_distribute)(struct datastore_rope_inner *a, struct datastore_rope_inner *b, \
+	struct datastore_rope_node *const *children, size_t count, struct datastore_rope_node **out) \
+{ \
+	if (count <= DATASTORE_ROPE_FANOUT) \
+	{ \
+		datastore_rope_fill(a, children, count); \
+		if (b) \
+			DATASTORE_IDENT(name__, impl_release)(&b->node); \
+		out[0] = &a->node; \
+		return 1; \
+	} \
+	if (!b) \
+		b = DATASTORE_IDENT(name__, impl_new_inner)(a->node.height); \
+	const size_t left = (count + 1) / 2; \
+	datastore_rope_fill(a, children, left); \
+	datastore_rope_fill(b, children + left, count - left); \
+	out[0] = &a->node; \
+	out[1] = &b->node; \
+	return 2; \
+} \
+/* Merges two trees in one or two nodes, of the height of the highest */ \
+static size_t DATASTORE_IDENT(name__, impl_merge)(struct datastore_rope_node *x, struct datastore_rope_node *y, \
+	struct datastore_rope_node **out) \
+{ \
+	struct datastore_rope_node *children[2 * DATASTORE_ROPE_FANOUT]; \
+	struct datastore_rope_node *seam[2]; \
+	size_t count = 0; \
+	if (x->height == y->height) \
+	{ \
+		if (!x->height) \
+			return DATASTORE_IDENT(name__, impl_merge_leaves)(datastore_rope_as_leaf(x), datastore_rope_as_leaf(y), out); \
+		struct datastore_rope_inner *a = datastore_rope_as_inner(x); \
+		struct datastore_rope_inner *b = datastore_rope_as_inner(y); \
+		const size_t merged = DATASTORE_IDENT(name__, impl_merge)(a->children[a->node.count - 1], b->children[0], seam); \
+		for (size_t i = 0; i + 1 < a->node.count; ++i) \
+			children[count++] = a->children[i]; \
+		for (size_t i = 0; i < merged; ++i) \
+			children[count++] = seam[i]; \
+		for (size_t i = 1; i < b->node.count; ++i) \
+			children[count++] = b->children[i]; \
+		return DATASTORE_IDENT(name__, impl_distribute)(a, b, children, count, out); \
+	} \
+	if (x->height > y->height) \
+	{ \
+		struct datastore_rope_inner *a = datastore_rope_as_inner(x); \
+		const size_t merged = DATASTORE_IDENT(name__, impl_merge)(a->children[a->node.count - 1], y, seam); \
+		for (size_t i = 0; i + 1 < a->node.count; ++i) \
+			children[count++] = a->children[i]; \
+		for (size_t i = 0; i < merged; ++i) \
+			children[count++] = seam[i]; \
+		return DATASTORE_IDENT(name__, impl_distribute)(a, NULL, children, count, out); \
+	} \
+	struct datastore_rope_inner *b = datastore_rope_as_inner(y); \
+	const size_t merged = DATASTORE_IDENT(name__, impl_merge)(x, b->children[0], seam); \
+	for (size_t i = 0; i < merged; ++i) \
+		children[count++] = seam[i]; \
+	for (size_t i = 1; i < b->node.count; ++i) \
+		children[count++] = b->children[i]; \
+	return DATASTORE_IDENT(name__, impl_distribute)(b, NULL, children, count, out); \
+} \
+/* Concatenation of two trees, either may be NULL */ \
+static struct datastore_rope_node *DATASTORE_IDENT(name__, impl_join)(struct datastore_rope_node *x, \
+	struct datastore_rope_node *y) \
+{ \
+	if (!x) \
+		return y; \
+	if (!y) \
+		return x; \
+	struct datastore_rope_node *out[2]; \
+	if (DATASTORE_IDENT(name__, impl_merge)(x, y, out) == 1) \
+		return out[0]; \
+	struct datastore_rope_inner *root = DATASTORE_IDENT(name__, impl_new_inner)(out[0]->height + 1); \
+	datastore_rope_fill(root, out, 2); \
+	return &root->node; \
+} \
+/* Tree of `count` children of the same height, NULL if there are none. Uses `*spare` as the \
+ * node when there are several children, and clears it */ \
+static struct datastore_rope_node *DATASTORE_IDENT(name__, impl_group)(struct datastore_rope_inner **spare, \
+	struct datastore_rope_node *const *children, size_t count) \
+{ \
+	if (count == 0) \
+		return NULL; \
+	if (count == 1) \
+		return children[0]; \
+	struct datastore_rope_inner *inner = *spare; \
+	*spare = NULL; \
+	if (!inner) \
+		inner = DATASTORE_IDENT(name__, impl_new_inner)(children[0]->height + 1); \
+	datastore_rope_fill(inner, children, count); \
+	return &inner->node; \
+} \
+/* Splits a tree before `offset` */ \
+static void DATASTORE_IDENT(name__, impl_split)(struct datastore_rope_node *node, size_t offset, \
+	struct datastore_rope_node **left, struct datastore_rope_node **right) \
+{ \
+	if (!node->height) \
+	{ \
+		struct datastore_rope_leaf *a = datastore_rope_as_leaf(node); \
+		*left = offset ? &a->node : NULL; \
+		*right = offset ? NULL : &a->node; \
+		if (!offset || offset >= a->node.count) \
+			return; \
+		struct datastore_rope_leaf *b = DATASTORE_IDENT(name__, impl_new_leaf)(); \
+		b->node.count = a->node.count - (uint32_t)offset; \
+		memcpy(b->data, a->data + offset, b->node.count); \
+		b->node.length = b->node.count; \
+		b->node.newlines = datastore_rope_count_newlines(b->data, b->node.count); \
+		a->node.count = (uint32_t)offset; \
+		a->node.length = offset; \
+		a->node.newlines -= b->node.newlines; \
+		*right = &b->node; \
+		return; \
+	} \
+	struct datastore_rope_inner *inner = datastore_rope_as_inner(node); \
+	struct datastore_rope_node *children[DATASTORE_ROPE_FANOUT]; \
+	const size_t count = inner->node.count; \
+	size_t i = 0; \
+	while (i + 1 < count && offset >= inner->lengths[i]) \
+		offset -= inner->lengths[i++]; \
+	memcpy(children, inner->children, count * sizeof(*children)); \
+	struct datastore_rope_node *l, *r; \
+	DATASTORE_IDENT(name__, impl_split)(children[i], offset, &l, &r); \
+	struct datastore_rope_node *before = DATASTORE_IDENT(name__, impl_group)(&inner, children, i); \
+	struct datastore_rope_node *after = DATASTORE_IDENT(name__, impl_group)(&inner, children + i + 1, count - i - 1); \
+	if (inner) \
+		DATASTORE_IDENT(name__, impl_release)(&inner->node); \
+	*left = DATASTORE_IDENT(name__, impl_join)(before, l); \
+	*right = DATASTORE_IDENT(name__, impl_join)(r, after); \
+} \
+/* Balanced tree of full leaves holding `size` bytes, NULL if there are none */ \
+static struct datastore_rope_node *DATASTORE_IDENT(name__, impl_build)(const char *bytes, size_t size) \
+{ \
+	if (!size) \
+		return NULL; \
+	const size_t leaves = (size + DATASTORE_ROPE_LEAF - 1) / DATASTORE_ROPE_LEAF; \
+	struct DATASTORE_IDENT(name__, nodes) nodes = DATASTORE_IDENT(DATASTORE_IDENT(name__, nodes), new)(leaves); \
+	for (size_t i = 0, offset = 0; i < leaves; ++i) \
+	{ \
+		/* Spreads the bytes evenly, so the leaves are all at least half full */ \
+		const size_t take = size / leaves + (i < size % leaves); \
+		struct datastore_rope_leaf *leaf = DATASTORE_IDENT(name__, impl_new_leaf)(); \
+		memcpy(leaf->data, bytes + offset, take); \
+		leaf->node.count = (uint32_t)take; \
+		leaf->node.length = take; \
+		leaf->node.newlines = datastore_rope_count_newlines(leaf->data, take); \
+		DATASTORE_IDENT(DATASTORE_IDENT(name__, nodes), push)(&nodes, &leaf->node); \
+		offset += take; \
+	} \
+	while (nodes.size > 1) \
+	{ \
+		const size_t groups = (nodes.size + DATASTORE_ROPE_FANOUT - 1) / DATASTORE_ROPE_FANOUT; \
+		size_t read = 0; \
+		for (size_t g = 0; g < groups; ++g) \
+		{ \
+			const size_t take = nodes.size / groups + (g < nodes.size % groups); \
+			struct datastore_rope_inner *inner = DATASTORE_IDENT(name__, impl_new_inner)(nodes.data[read]->height + 1); \
+			datastore_rope_fill(inner, nodes.data + read, take); \
+			nodes.data[g] = &inner->node; \
+			read += take; \
+		} \
+		nodes.size = groups; \
+	} \
+	struct datastore_rope_node *root = nodes.data[0]; \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, nodes), free)(&nodes); \
+	return root; \
+} \
+/* Leaf holding the byte at `*offset`, or the end of the last leaf when `after` is set and \
+ * `*offset` is at a boundary. Stores the offset in the leaf in `*offset`, and the path in `path` */ \
+static struct datastore_rope_leaf *DATASTORE_IDENT(name__, impl_descend)(struct datastore_rope_node *node, \
+	size_t *offset, bool after, struct datastore_rope_inner **path, size_t *slots, size_t *depth) \
+{ \
+	size_t at = *offset; \
+	*depth = 0; \
+	while (node->height) \
+	{ \
+		struct datastore_rope_inner *inner = datastore_rope_as_inner(node); \
+		size_t i = 0; \
+		while (i + 1 < inner->node.count && (after ? at > inner->lengths[i] : at >= inner->lengths[i])) \
+			at -= inner->lengths[i++]; \
+		assert(*depth < DATASTORE_ROPE_MAX_HEIGHT); \
+		path[*depth] = inner; \
+		slots[(*depth)++] = i; \
+		node = inner->children[i]; \
+	} \
+	*offset = at; \
+	return datastore_rope_as_leaf(node); \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(void) \
+{ \
+	return (struct name__){ .root = NULL }; \
+} \
+struct name__ DATASTORE_IDENT(name__, from_bytes)(const char *bytes, size_t size) \
+{ \
+	return (struct name__){ .root = DATASTORE_IDENT(name__, impl_build)(bytes, size) }; \
+} \
+struct name__ DATASTORE_IDENT(name__, from_vec)(const struct DATASTORE_IDENT(name__, chars) *chars) \
+{ \
+	return DATASTORE_IDENT(name__, from_bytes)(chars->data, chars->size); \
+} \
+struct DATASTORE_IDENT(name__, chars) DATASTORE_IDENT(name__, to_vec)(const struct name__ *self) \
+{ \
+	const size_t length = DATASTORE_IDENT(name__, length)(self); \
+	struct DATASTORE_IDENT(name__, chars) chars = DATASTORE_IDENT(DATASTORE_IDENT(name__, chars), new)(length); \
+	if (length) \
+		datastore_rope_copy(self->root, 0, length, chars.data); \
+	chars.size = length; \
+	return chars; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	if (self->root) \
+		DATASTORE_IDENT(name__, impl_destroy)(self->root); \
+	self->root = NULL; \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	return (struct name__){ .root = self->root ? DATASTORE_IDENT(name__, impl_clone)(self->root) : NULL }; \
+} \
+size_t DATASTORE_IDENT(name__, length)(const struct name__ *self) \
+{ \
+	return self->root ? self->root->length : 0; \
+} \
+size_t DATASTORE_IDENT(name__, lines)(const struct name__ *self) \
+{ \
+	return (self->root ? self->root->newlines : 0) + 1; \
+} \
+void DATASTORE_IDENT(name__, insert)(struct name__ *self, size_t offset, const char *bytes, size_t size) \
+{ \
+	assert(offset <= DATASTORE_IDENT(name__, length)(self)); \
+	if (!size) \
+		return; \
+	if (self->root) \
+	{ \
+		struct datastore_rope_inner *path[DATASTORE_ROPE_MAX_HEIGHT]; \
+		size_t slots[DATASTORE_ROPE_MAX_HEIGHT]; \
+		size_t depth, at = offset; \
+		struct datastore_rope_leaf *leaf = DATASTORE_IDENT(name__, impl_descend)(self->root, &at, true, path, slots, &depth); \
+		if (leaf->node.count + size <= DATASTORE_ROPE_LEAF) \
+		{ \
+			const size_t newlines = datastore_rope_count_newlines(bytes, size); \
+			memmove(leaf->data + at + size, leaf->data + at, leaf->node.count - at); \
+			memcpy(leaf->data + at, bytes, size); \
+			leaf->node.count += (uint32_t)size; \
+			leaf->node.length += size; \
+			leaf->node.newlines += newlines; \
+			while (depth--) \
+			{ \
+				path[depth]->lengths[slots[depth]] += size; \
+				path[depth]->newlines[slots[depth]] += newlines; \
+				path[depth]->node.length += size; \
+				path[depth]->node.newlines += newlines; \
+			} \
+			return; \
+		} \
+	} \
+	struct datastore_rope_node *left = NULL, *right = NULL; \
+	if (self->root) \
+		DATASTORE_IDENT(name__, impl_split)(self->root, offset, &left, &right); \
+	struct datastore_rope_node *middle = DATASTORE_IDENT(name__, impl_build)(bytes, size); \
+	self->root = DATASTORE_IDENT(name__, impl_join)(DATASTORE_IDENT(name__, impl_join)(left, middle), right); \
+} \
+void DATASTORE_IDENT(name__, erase)(struct name__ *self, size_t offset, size_t size) \
+{ \
+	assert(offset + size <= DATASTORE_IDENT(name__, length)(self)); \
+	if (!size) \
+		return; \
+	struct datastore_rope_inner *path[DATASTORE_ROPE_MAX_HEIGHT]; \
+	size_t slots[DATASTORE_ROPE_MAX_HEIGHT]; \
+	size_t depth, at = offset; \
+	struct datastore_rope_leaf *leaf = DATASTORE_IDENT(name__, impl_descend)(self->root, &at, false, path, slots, &depth); \
+	/* Leaves left less than a quarter full are merged with their neighbours by a join */ \
+	if (at + size <= leaf->node.count && (leaf->node.count - size >= DATASTORE_ROPE_LEAF / 4 || !depth) \
+		&& leaf->node.count > size) \
+	{ \
+		const size_t newlines = datastore_rope_count_newlines(leaf->data + at, size); \
+		memmove(leaf->data + at, leaf->data + at + size, leaf->node.count - at - size); \
+		leaf->node.count -= (uint32_t)size; \
+		leaf->node.length -= size; \
+		leaf->node.newlines -= newlines; \
+		while (depth--) \
+		{ \
+			path[depth]->lengths[slots[depth]] -= size; \
+			path[depth]->newlines[slots[depth]] -= newlines; \
+			path[depth]->node.length -= size; \
+			path[depth]->node.newlines -= newlines; \
+		} \
+		return; \
+	} \
+	struct datastore_rope_node *left, *middle, *right; \
+	DATASTORE_IDENT(name__, impl_split)(self->root, offset, &left, &right); \
+	DATASTORE_IDENT(name__, impl_split)(right, size, &middle, &right); \
+	DATASTORE_IDENT(name__, impl_destroy)(middle); \
+	self->root = DATASTORE_IDENT(name__, impl_join)(left, right); \
+} \
+struct name__ DATASTORE_IDENT(name__, split)(struct name__ *self, size_t offset) \
+{ \
+	assert(offset <= DATASTORE_IDENT(name__, length)(self)); \
+	struct name__ right = { .root = NULL }; \
+	if (self->root) \
+		DATASTORE_IDENT(name__, impl_split)(self->root, offset, &self->root, &right.root); \
+	return right; \
+} \
+void DATASTORE_IDENT(name__, concat)(struct name__ *self, struct name__ *other) \
+{ \
+	self->root = DATASTORE_IDENT(name__, impl_join)(self->root, other->root); \
+	other->root = NULL; \
+} \
+const char *DATASTORE_IDENT(name__, chunk)(const struct name__ *self, size_t offset, size_t *size) \
+{ \
+	assert(offset < DATASTORE_IDENT(name__, length)(self)); \
+	const struct datastore_rope_node *node = self->root; \
+	while (node->height) \
+	{ \
+		const struct datastore_rope_inner *inner = datastore_rope_as_inner_const(node); \
+		size_t i = 0; \
+		while (offset >= inner->lengths[i]) \
+			offset -= inner->lengths[i++]; \
+		node = inner->children[i]; \
+	} \
+	*size = node->count - offset; \
+	return datastore_rope_as_leaf_const(node)->data + offset; \
+} \
+char DATASTORE_IDENT(name__, byte_at)(const struct name__ *self, size_t offset) \
+{ \
+	size_t size; \
+	return *DATASTORE_IDENT(name__, chunk)(self, offset, &size); \
+} \
+void DATASTORE_IDENT(name__, copy)(const struct name__ *self, size_t offset, size_t size, char *out) \
+{ \
+	assert(offset + size <= DATASTORE_IDENT(name__, length)(self)); \
+	if (size) \
+		datastore_rope_copy(self->root, offset, size, out); \
+} \
+size_t DATASTORE_IDENT(name__, line_start)(const struct name__ *self, size_t line) \
+{ \
+	assert(line < DATASTORE_IDENT(name__, lines)(self)); \
+	if (!line) \
+		return 0; \
+	/* Offset past the `line`-th newline */ \
+	const struct datastore_rope_node *node = self->root; \
+	size_t offset = 0; \
+	while (node->height) \
+	{ \
+		const struct datastore_rope_inner *inner = datastore_rope_as_inner_const(node); \
+		size_t i = 0; \
+		while (line > inner->newlines[i]) \
+		{ \
+			line -= inner->newlines[i]; \
+			offset += inner->lengths[i++]; \
+		} \
+		node = inner->children[i]; \
+	} \
+	const char *data = datastore_rope_as_leaf_const(node)->data; \
+	const char *newline = data; \
+	for (;; ++newline) \
+	{ \
+		newline = memchr(newline, '\n', (size_t)(data + node->count - newline)); \
+		assert(newline); \
+		if (!--line) \
+			break; \
+	} \
+	return offset + (size_t)(newline - data) + 1; \
+} \
+size_t DATASTORE_IDENT(name__, line_of)(const struct name__ *self, size_t offset) \
+{ \
+	assert(offset <= DATASTORE_IDENT(name__, length)(self)); \
+	if (offset == DATASTORE_IDENT(name__, length)(self)) \
+		return DATASTORE_IDENT(name__, lines)(self) - 1; \
+	const struct datastore_rope_node *node = self->root; \
+	size_t line = 0; \
+	while (node->height) \
+	{ \
+		const struct datastore_rope_inner *inner = datastore_rope_as_inner_const(node); \
+		size_t i = 0; \
+		while (offset >= inner->lengths[i]) \
+		{ \
+			offset -= inner->lengths[i]; \
+			line += inner->newlines[i++]; \
+		} \
+		node = inner->children[i]; \
+	} \
+	return line + datastore_rope_count_newlines(datastore_rope_as_leaf_const(node)->data, offset); \
+}
+
+/**
+ * @brief Rope methods implementation
+ *
+ * This macro will call @ref DATASTORE_ROPE_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param name__ Name of the rope, must match the name passed to @ref DATASTORE_ROPE
+ */
+#define DATASTORE_ROPE_IMPL(name__) \
+	DATASTORE_ROPE_IMPL_S(name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup Rope */
+
+#endif // DATASTORE_ROPE_H
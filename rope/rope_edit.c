@@ -0,0 +1,116 @@
+#include "test.h"
+
+DATASTORE_ROPE_IMPL_S(text, SETTINGS)
+
+#define REF_MAX 4096
+
+/* Random text of `size` bytes, with a newline every few bytes */
+static void random_text(uint64_t *state, char *out, size_t size)
+{
+	for (size_t i = 0; i < size; ++i)
+	{
+		const uint64_t r = rope_next(state);
+		out[i] = r % 7 ? (char)('a' + r % 26) : '\n';
+	}
+}
+
+TESTS(rope_edit, {
+	TEST("insert_erase", {
+		static char ref[REF_MAX];
+		char bytes[64] = { 0 };
+		size_t size = 0;
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		text t = text_new();
+		int ok = 1;
+		for (size_t step = 0; step < 4000; ++step)
+		{
+			const uint64_t r = rope_next(&state);
+			// Grows the text to about half of `REF_MAX`, then keeps it there
+			if (size < REF_MAX / 2 ? r % 3 : r % 2)
+			{
+				const size_t n = 1 + rope_next(&state) % (r % 5 ? 4 : sizeof(bytes));
+				const size_t at = rope_next(&state) % (size + 1);
+				if (size + n > REF_MAX)
+					continue;
+				random_text(&state, bytes, n);
+				memmove(ref + at + n, ref + at, size - at);
+				memcpy(ref + at, bytes, n);
+				size += n;
+				text_insert(&t, at, bytes, n);
+			}
+			else if (size)
+			{
+				const size_t at = rope_next(&state) % size;
+				const size_t n = 1 + rope_next(&state) % (r % 5 ? 3 : size - at);
+				const size_t erased = n < size - at ? n : size - at;
+				memmove(ref + at, ref + at + erased, size - at - erased);
+				size -= erased;
+				text_erase(&t, at, erased);
+			}
+			ok &= rope_equals(&t, ref, size);
+		}
+		ASSERT(ok)
+		// Empties the rope
+		text_erase(&t, 0, size);
+		ASSERT(t.root == NULL && text_length(&t) == 0 && text_lines(&t) == 1)
+		text_insert(&t, 0, "x", 1);
+		text_insert(&t, 0, "", 0);
+		ASSERT(rope_equals(&t, "x", 1))
+		text_free(&t);
+	})
+	TEST("split_concat", {
+		static char ref[REF_MAX];
+		uint64_t state = 0x2545F4914F6CDD1Dull;
+		int ok = 1;
+		for (size_t round = 0; round < 200; ++round)
+		{
+			const size_t size = rope_next(&state) % REF_MAX;
+			random_text(&state, ref, size);
+			text t = text_from_bytes(ref, size);
+			ok &= rope_equals(&t, ref, size);
+			// Splits in three, then joins the pieces back in the same order
+			const size_t a = size ? rope_next(&state) % (size + 1) : 0;
+			const size_t b = a + (size - a ? rope_next(&state) % (size - a + 1) : 0);
+			text right = text_split(&t, a);
+			text middle = right;
+			right = text_split(&middle, b - a);
+			ok &= rope_equals(&t, ref, a);
+			ok &= rope_equals(&middle, ref + a, b - a);
+			ok &= rope_equals(&right, ref + b, size - b);
+			text_concat(&middle, &right);
+			ok &= right.root == NULL && rope_equals(&middle, ref + a, size - a);
+			text_concat(&t, &middle);
+			ok &= middle.root == NULL && rope_equals(&t, ref, size);
+			text_free(&t);
+		}
+		ASSERT(ok)
+
+		// Ropes of very different heights
+		random_text(&state, ref, REF_MAX);
+		text big = text_from_bytes(ref, REF_MAX - 1);
+		text small = text_from_bytes(ref + REF_MAX - 1, 1);
+		text_concat(&big, &small);
+		ASSERT(rope_equals(&big, ref, REF_MAX))
+		text front = text_from_bytes(ref, 3);
+		text rest = text_split(&big, 3);
+		text_concat(&front, &rest);
+		ASSERT(rope_equals(&front, ref, REF_MAX))
+		text_free(&big);
+		text_free(&front);
+	})
+	TEST("clone", {
+		static char ref[REF_MAX];
+		uint64_t state = 0x1234567887654321ull;
+		random_text(&state, ref, REF_MAX);
+		text t = text_from_bytes(ref, REF_MAX);
+		text c = text_clone(&t);
+		text_erase(&t, 100, 1000);
+		text_insert(&t, 0, "head", 4);
+		ASSERT(rope_equals(&c, ref, REF_MAX))
+		text_free(&t);
+		text_free(&c);
+		text e = text_new();
+		text ce = text_clone(&e);
+		ASSERT(ce.root == NULL)
+	})
+})
@@ -0,0 +1,84 @@
+#include "test.h"
+
+#define SIZE 3000
+
+TESTS(rope_lines, {
+	TEST("vec", {
+		struct text_chars chars = text_chars_new(0);
+		text empty = text_from_vec(&chars);
+		ASSERT(empty.root == NULL && text_length(&empty) == 0)
+		struct text_chars back = text_to_vec(&empty);
+		ASSERT(back.size == 0)
+		text_chars_free(&back);
+
+		for (size_t i = 0; i < SIZE; ++i)
+			text_chars_append_char(&chars, (char)('a' + i % 26));
+		text t = text_from_vec(&chars);
+		ASSERT(rope_equals(&t, chars.data, SIZE))
+		back = text_to_vec(&t);
+		ASSERT(!strcmp(text_chars_cstr(&back), text_chars_cstr(&chars)))
+		text_chars_free(&back);
+		text_chars_free(&chars);
+		text_free(&t);
+	})
+	TEST("access", {
+		static char ref[SIZE];
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (size_t i = 0; i < SIZE; ++i)
+			ref[i] = (char)('a' + rope_next(&state) % 26);
+		text t = text_from_bytes(ref, SIZE);
+		int ok = 1;
+		for (size_t i = 0; i < SIZE; ++i)
+		{
+			ok &= text_byte_at(&t, i) == ref[i];
+			size_t size;
+			const char *chunk = text_chunk(&t, i, &size);
+			ok &= size >= 1 && i + size <= SIZE && !memcmp(chunk, ref + i, size);
+		}
+		char out[SIZE];
+		for (size_t round = 0; round < 500; ++round)
+		{
+			const size_t at = rope_next(&state) % SIZE;
+			const size_t size = rope_next(&state) % (SIZE - at + 1);
+			text_copy(&t, at, size, out);
+			ok &= !memcmp(out, ref + at, size);
+		}
+		ASSERT(ok)
+		text_free(&t);
+	})
+	TEST("lines", {
+		static char ref[SIZE];
+		uint64_t state = 0x2545F4914F6CDD1Dull;
+		text t = text_new();
+		ASSERT(text_lines(&t) == 1 && text_line_start(&t, 0) == 0 && text_line_of(&t, 0) == 0)
+		for (size_t i = 0; i < SIZE; ++i)
+			ref[i] = rope_next(&state) % 5 ? 'x' : '\n';
+		// Builds the rope by inserts, to check the counts cached on the fast path
+		for (size_t i = 0; i < SIZE; i += 7)
+			text_insert(&t, i, ref + i, i + 7 < SIZE ? 7 : SIZE - i);
+		ASSERT(rope_equals(&t, ref, SIZE))
+
+		int ok = 1;
+		size_t line = 0, start = 0;
+		for (size_t i = 0; i <= SIZE; ++i)
+		{
+			ok &= text_line_of(&t, i) == line;
+			if (i == start)
+				ok &= text_line_start(&t, line) == start;
+			if (i < SIZE && ref[i] == '\n')
+			{
+				++line;
+				start = i + 1;
+			}
+		}
+		ok &= text_lines(&t) == line + 1;
+		ASSERT(ok)
+
+		// Removes every newline
+		for (size_t l = text_lines(&t) - 1; l > 0; --l)
+			text_erase(&t, text_line_start(&t, l) - 1, 1);
+		ASSERT(text_lines(&t) == 1 && text_length(&t) == SIZE - line)
+		ASSERT(rope_valid(t.root, t.root->height))
+		text_free(&t);
+	})
+})
@@ -0,0 +1,68 @@
+#ifndef DATASTORE_ROPE_TEST_H
+#define DATASTORE_ROPE_TEST_H
+
+// Small nodes, so that short texts build trees of several levels
+#define DATASTORE_ROPE_LEAF 16
+#define DATASTORE_ROPE_FANOUT 4
+
+#include "../tests/tests.h"
+#include "rope.h"
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+DATASTORE_ROPE(text)
+typedef struct text text;
+
+/* Whether a tree respects the invariants of the rope, and its cached counts are right */
+static inline int rope_valid(const struct datastore_rope_node *node, uint32_t height)
+{
+	if (!node)
+		return 1;
+	if (node->height != height)
+		return 0;
+	if (!height)
+	{
+		const struct datastore_rope_leaf *leaf = datastore_rope_as_leaf_const(node);
+		return node->count >= 1 && node->count <= DATASTORE_ROPE_LEAF && node->length == node->count
+			&& node->newlines == datastore_rope_count_newlines(leaf->data, node->count);
+	}
+	const struct datastore_rope_inner *inner = datastore_rope_as_inner_const(node);
+	int ok = node->count >= 2 && node->count <= DATASTORE_ROPE_FANOUT;
+	size_t length = 0, newlines = 0;
+	for (size_t i = 0; ok && i < node->count; ++i)
+	{
+		ok &= rope_valid(inner->children[i], height - 1);
+		ok &= inner->lengths[i] == inner->children[i]->length && inner->newlines[i] == inner->children[i]->newlines;
+		length += inner->lengths[i];
+		newlines += inner->newlines[i];
+	}
+	return ok && length == node->length && newlines == node->newlines;
+}
+
+/* Whether a rope is valid and holds `size` bytes equal to `expected` */
+static inline int rope_equals(const text *t, const char *expected, size_t size)
+{
+	if (!rope_valid(t->root, t->root ? t->root->height : 0) || text_length(t) != size)
+		return 0;
+	struct text_chars chars = text_to_vec(t);
+	const int ok = chars.size == size && (!size || !memcmp(chars.data, expected, size));
+	text_chars_free(&chars);
+	return ok;
+}
+
+static inline uint64_t rope_next(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+extern const unit_test test_rope_edit;
+extern const unit_test test_rope_lines;
+
+#endif // DATASTORE_ROPE_TEST_H
@@ -0,0 +1,304 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_SEGMENTED_H
+#define DATASTORE_SEGMENTED_H
+
+#include "../vector/vector.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file segmented.h
+ * @defgroup Segmented DATASTORE_SEGVEC: Segmented vector with stable element addresses
+ *
+ * @brief Segmented vector with stable element addresses
+ *
+ * A segmented vector stores its elements in blocks of geometrically increasing size: block `k`
+ * holds `2^(DATASTORE_SEGVEC_SHIFT + k)` elements. Growing allocates the next block and never
+ * moves the previous ones, so:
+ * - `push` costs O(1) in the worst case, there is no reallocation copying every element,
+ * - pointers to elements stay valid until the element is popped or the vector freed.
+ *
+ * Element `i` is in block `floor(log2(i + 2^S)) - S` with `S = DATASTORE_SEGVEC_SHIFT`, found
+ * with a count of leading zeros, so indexing is O(1) without any loop. The table of blocks is
+ * part of the vector and never reallocated.
+ *
+ * Blocks are allocated with the `NEW` and `FREE` settings (and `ALIGN`) of
+ * @ref advanced_usage "Advanced Usage", `REALLOC` and `GROW` are not used. Elements are owned by
+ * the vector, released with `FREE` and copied with `CLONE` (see @ref trait_type "Trait Type").
+ *
+ * When a contiguous buffer is needed, `flatten` copies the elements into a @ref DATASTORE_VEC.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define INT_TRAIT(X) \
+ * 	X(TYPE, int) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; })
+ *
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_SEGVEC(int, ints)
+ * // Methods definition (in the .c)
+ * DATASTORE_SEGVEC_IMPL(INT_TRAIT, ints)
+ *
+ * struct ints v = ints_new(0);
+ * ints_push(&v, 1);
+ * int *first = ints_get(&v, 0);
+ * for (int i = 0; i < 1000000; ++i)
+ * 	ints_push(&v, i); // `first` stays valid
+ * struct ints_vec flat = ints_flatten(&v); // DATASTORE_VEC(int, ints_vec)
+ * ints_vec_free(&flat);
+ * ints_free(&v);
+ * @endcode
+ *
+ * **Macro `DATASTORE_SEGVEC(type, name)`**: Define a new segmented vector type, and the vector
+ * type `name_vec` returned by `flatten`
+ *
+ * **Macro `DATASTORE_SEGVEC_IMPL(trait, name)`** and
+ * **`DATASTORE_SEGVEC_IMPL_S(trait, name, settings)`**: Implements methods for a segmented vector
+ * type, and for `name_vec`
+ *
+ * The resulting type will look like this:
+ * @code{.c}
+ * struct name {
+ *     type *blocks[DATASTORE_SEGVEC_BLOCKS]; // Allocated blocks, then NULL
+ *     size_t size; // Number of elements
+ *     size_t capacity; // Number of elements in the allocated blocks
+ *     size_t block_count; // Number of allocated blocks
+ * };
+ * @endcode
+ *
+ * ## Exposed methods
+ *
+ * - `vec new(size_t capacity)`: Create a new vector with room for `capacity` elements
+ * - `void free(struct vec *self)`: Free the vector and its elements
+ * - `vec clone(const struct vec *self)`: Deep copy of the vector
+ * - `void reserve(struct vec *self, size_t capacity)`: Allocate blocks for at least `capacity`
+ *   elements
+ * - `void push(struct vec *self, type value)`: Append an element, the vector takes ownership
+ * - `void pop(struct vec *self)`: Remove and free the last element, blocks are kept
+ * - `type *get(const struct vec *self, size_t index)`: Pointer to element `index`, which must be
+ *   lower than `size`
+ * - `type *block(const struct vec *self, size_t block, size_t *count)`: Elements of a block, and
+ *   their number in `count`. Iterating over blocks is faster than calling `get` for each index
+ * - `struct vec_vec flatten(const struct vec *self)`: Contiguous copy of the elements, made with
+ *   `CLONE`
+ */
+
+/**
+ * @brief Log2 of the number of elements of the first block
+ */
+#ifndef DATASTORE_SEGVEC_SHIFT
+	#define DATASTORE_SEGVEC_SHIFT 4
+#endif
+
+/**
+ * @brief Maximum number of blocks, enough to address every `size_t` index
+ */
+#define DATASTORE_SEGVEC_BLOCKS (sizeof(size_t) * 8 - DATASTORE_SEGVEC_SHIFT)
+
+/**
+ * @brief Number of elements of block `block`
+ */
+static inline size_t datastore_segvec_block_size(size_t block)
+{
+	return (size_t)1 << (block + DATASTORE_SEGVEC_SHIFT);
+}
+
+/**
+ * @brief Block holding element `index`
+ */
+static inline size_t datastore_segvec_block(size_t index)
+{
+	const unsigned long long biased = (unsigned long long)index + ((unsigned long long)1 << DATASTORE_SEGVEC_SHIFT);
+	return (size_t)(sizeof(biased) * 8 - 1 - (size_t)__builtin_clzll(biased)) - DATASTORE_SEGVEC_SHIFT;
+}
+
+/**
+ * @brief Position of element `index` in block `block`
+ */
+static inline size_t datastore_segvec_offset(size_t index, size_t block)
+{
+	return index + ((size_t)1 << DATASTORE_SEGVEC_SHIFT) - datastore_segvec_block_size(block);
+}
+
+/**
+ * @brief Segmented vector type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the segmented vector type
+ */
+#define DATASTORE_SEGVEC(type__, name__) \
+DATASTORE_VEC(type__, DATASTORE_IDENT(name__, vec)) \
+struct name__ \
+{ \
+	type__ *blocks[DATASTORE_SEGVEC_BLOCKS]; \
+	size_t size; \
+	size_t capacity; \
+	size_t block_count; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t capacity); \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, type__ value); \
+void DATASTORE_IDENT(name__, pop)(struct name__ *self); \
+type__ *DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t index); \
+type__ *DATASTORE_IDENT(name__, block)(const struct name__ *self, size_t block, size_t *count); \
+struct DATASTORE_IDENT(name__, vec) DATASTORE_IDENT(name__, flatten)(const struct name__ *self);
+
+/**
+ * @brief Segmented vector methods implementation
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the segmented vector, must match the name passed to @ref DATASTORE_SEGVEC
+ * @param settings__ Allocation settings for the blocks, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_SEGVEC_IMPL_S(trait__, name__, settings__) \
+DATASTORE_VEC_IMPL_S(trait__, DATASTORE_IDENT(name__, vec), settings__) \
+/* Allocates the next block */ \
+static void DATASTORE_IDENT(name__, impl_grow)(struct name__ *self) \
+{ \
+	assert(self->block_count < DATASTORE_SEGVEC_BLOCKS); \
+	const size_t count = datastore_segvec_block_size(self->block_count); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(sizeof(*ptr) * count, align); \
+	size_t usable = size; \
+	settings__(DATASTORE_VEC_SETTINGS_NEW) \
+	DATASTORE_MAYBE_UNUSED(usable); \
+	assert(!align || ((uintptr_t)ptr & (align - 1)) == 0); \
+	self->blocks[self->block_count++] = ptr; \
+	self->capacity += count; \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity) \
+{ \
+	struct name__ self = { .size = 0 }; \
+	DATASTORE_IDENT(name__, reserve)(&self, capacity); \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	for (size_t block = 0; block < self->block_count; ++block) \
+	{ \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->blocks[block]; \
+		const size_t count = datastore_segvec_block_size(block); \
+		size_t used; \
+		DATASTORE_IDENT(name__, block)(self, block, &used); \
+		for (size_t i = 0; i < used; ++i) \
+		{ \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *val = ptr + i; \
+			DATASTORE_MAYBE_UNUSED(val); \
+			trait__(DATASTORE_VEC_TRAIT_FREE) \
+		} \
+		const size_t size = count * sizeof(*ptr); \
+		DATASTORE_MAYBE_UNUSED(size); \
+		settings__(DATASTORE_VEC_SETTINGS_FREE) \
+		self->blocks[block] = NULL; \
+	} \
+	self->size = 0; \
+	self->capacity = 0; \
+	self->block_count = 0; \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	struct name__ clone = DATASTORE_IDENT(name__, new)(self->size); \
+	for (size_t block = 0; block < self->block_count; ++block) \
+	{ \
+		size_t count; \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *from = DATASTORE_IDENT(name__, block)(self, block, &count); \
+		for (size_t i = 0; i < count; ++i) \
+		{ \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *val = from + i; \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *new = clone.blocks[block] + i; \
+			trait__(DATASTORE_VEC_TRAIT_CLONE) \
+		} \
+	} \
+	clone.size = self->size; \
+	return clone; \
+} \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t capacity) \
+{ \
+	while (self->capacity < capacity) \
+		DATASTORE_IDENT(name__, impl_grow)(self); \
+} \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	if (self->size == self->capacity) \
+		DATASTORE_IDENT(name__, impl_grow)(self); \
+	const size_t block = datastore_segvec_block(self->size); \
+	self->blocks[block][datastore_segvec_offset(self->size, block)] = value; \
+	++self->size; \
+} \
+void DATASTORE_IDENT(name__, pop)(struct name__ *self) \
+{ \
+	assert(self->size != 0); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *val = DATASTORE_IDENT(name__, get)(self, self->size - 1); \
+	--self->size; \
+	DATASTORE_MAYBE_UNUSED(val); \
+	trait__(DATASTORE_VEC_TRAIT_FREE) \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t index) \
+{ \
+	assert(index < self->size); \
+	const size_t block = datastore_segvec_block(index); \
+	return self->blocks[block] + datastore_segvec_offset(index, block); \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, block)(const struct name__ *self, size_t block, \
+	size_t *count) \
+{ \
+	assert(block < self->block_count); \
+	const size_t first = datastore_segvec_block_size(block) - ((size_t)1 << DATASTORE_SEGVEC_SHIFT); \
+	const size_t size = datastore_segvec_block_size(block); \
+	*count = self->size <= first ? 0 : (self->size - first < size ? self->size - first : size); \
+	return self->blocks[block]; \
+} \
+struct DATASTORE_IDENT(name__, vec) DATASTORE_IDENT(name__, flatten)(const struct name__ *self) \
+{ \
+	struct DATASTORE_IDENT(name__, vec) flat = DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), new)(self->size); \
+	for (size_t block = 0; block < self->block_count; ++block) \
+	{ \
+		size_t count; \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *from = DATASTORE_IDENT(name__, block)(self, block, &count); \
+		for (size_t i = 0; i < count; ++i) \
+		{ \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *val = from + i; \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *new = flat.data + flat.size + i; \
+			trait__(DATASTORE_VEC_TRAIT_CLONE) \
+		} \
+		flat.size += count; \
+	} \
+	return flat; \
+}
+
+/**
+ * @brief Segmented vector methods implementation
+ *
+ * This macro will call @ref DATASTORE_SEGVEC_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the segmented vector, must match the name passed to @ref DATASTORE_SEGVEC
+ */
+#define DATASTORE_SEGVEC_IMPL(trait__, name__) \
+	DATASTORE_SEGVEC_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup Segmented */
+
+#endif // DATASTORE_SEGMENTED_H
@@ -0,0 +1,168 @@
+#include "test.h"
+
+#define U64_TRAIT(X) \
+	X(TYPE, uint64_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_SEGVEC_CONCURRENT(uint64_t, segc)
+typedef struct segc segc;
+DATASTORE_SEGVEC_CONCURRENT_IMPL_S(U64_TRAIT, segc, SETTINGS)
+
+#define PRODUCERS 4
+#define PER_PRODUCER 20000
+
+struct producer
+{
+	segc *log;
+	uint64_t id;
+	// Pushes one value at a time when zero, batches of 7 otherwise
+	int batch;
+};
+
+static void *produce(void *arg)
+{
+	struct producer *producer = arg;
+	uint64_t values[7];
+	for (uint64_t i = 0; i < PER_PRODUCER;)
+	{
+		if (!producer->batch || PER_PRODUCER - i < 7)
+		{
+			segc_push(producer->log, producer->id << 32 | (i + 1));
+			++i;
+			continue;
+		}
+		for (uint64_t j = 0; j < 7; ++j)
+			values[j] = producer->id << 32 | (i + j + 1);
+		segc_push_many(producer->log, values, 7);
+		i += 7;
+	}
+	return NULL;
+}
+
+struct reader
+{
+	segc *log;
+	int stop;
+	int bad;
+};
+
+static void *read_log(void *arg)
+{
+	struct reader *reader = arg;
+	size_t seen = 0;
+	while (!__atomic_load_n(&reader->stop, __ATOMIC_ACQUIRE))
+	{
+		const size_t size = segc_size(reader->log);
+		if (size < seen)
+			reader->bad = 1;
+		// Every published slot is fully written, and values are never zero
+		for (size_t i = seen; i < size; ++i)
+			reader->bad |= *segc_get(reader->log, i) == 0;
+		seen = size;
+	}
+	return NULL;
+}
+
+static int run_producers(int batch)
+{
+	segc log = segc_new(0);
+	struct producer producers[PRODUCERS];
+	pthread_t threads[PRODUCERS];
+	struct reader reader = { &log, 0, 0 };
+	pthread_t reader_thread;
+	if (pthread_create(&reader_thread, NULL, read_log, &reader))
+		abort();
+	for (size_t i = 0; i < PRODUCERS; ++i)
+	{
+		producers[i].log = &log;
+		producers[i].id = i + 1;
+		producers[i].batch = batch;
+		if (pthread_create(&threads[i], NULL, produce, &producers[i]))
+			abort();
+	}
+	for (size_t i = 0; i < PRODUCERS; ++i)
+		pthread_join(threads[i], NULL);
+	__atomic_store_n(&reader.stop, 1, __ATOMIC_RELEASE);
+	pthread_join(reader_thread, NULL);
+
+	int ok = !reader.bad;
+	ok &= segc_size(&log) == PRODUCERS * PER_PRODUCER;
+	// Each producer's values appear once, in the order it pushed them
+	uint64_t next[PRODUCERS] = { 0 };
+	for (size_t i = 0; i < segc_size(&log); ++i)
+	{
+		const uint64_t value = *segc_get(&log, i);
+		const uint64_t id = value >> 32;
+		if (id < 1 || id > PRODUCERS)
+		{
+			ok = 0;
+			break;
+		}
+		ok &= (value & 0xFFFFFFFF) == ++next[id - 1];
+	}
+	for (size_t i = 0; i < PRODUCERS; ++i)
+		ok &= next[i] == PER_PRODUCER;
+	segc_free(&log);
+	return ok;
+}
+
+TESTS(segmented_concurrent, {
+	TEST("push", {
+		segc log = segc_new(0);
+		int ok = 1;
+		for (uint64_t i = 0; i < 1000; ++i)
+			ok &= segc_push(&log, i * 2) == i;
+		ASSERT(ok)
+		ASSERT(segc_size(&log) == 1000)
+		for (size_t i = 0; i < 1000; ++i)
+			ok &= *segc_get(&log, i) == i * 2;
+		ASSERT(ok)
+		segc_free(&log);
+		ASSERT(segc_size(&log) == 0)
+	})
+	TEST("push many", {
+		segc log = segc_new(100);
+		uint64_t values[100];
+		for (uint64_t i = 0; i < 100; ++i)
+			values[i] = i;
+		// Batches straddle block boundaries
+		ASSERT(segc_push_many(&log, values, 5) == 0)
+		ASSERT(segc_push_many(&log, values, 100) == 5)
+		ASSERT(segc_push_many(&log, values, 0) == 105)
+		ASSERT(segc_size(&log) == 105)
+		int ok = 1;
+		for (size_t i = 0; i < 100; ++i)
+			ok &= *segc_get(&log, 5 + i) == i;
+		ASSERT(ok)
+		segc_free(&log);
+	})
+	TEST("stable addresses", {
+		segc log = segc_new(0);
+		segc_push(&log, 7);
+		uint64_t *first = segc_get(&log, 0);
+		for (uint64_t i = 0; i < 10000; ++i)
+			segc_push(&log, i);
+		ASSERT(first == segc_get(&log, 0))
+		ASSERT(*first == 7)
+		segc_free(&log);
+	})
+	TEST("producers", {
+		ASSERT(run_producers(0))
+	})
+	TEST("batched producers", {
+		ASSERT(run_producers(1))
+	})
+	TEST("flatten", {
+		segc log = segc_new(0);
+		for (uint64_t i = 0; i < 300; ++i)
+			segc_push(&log, i + 1);
+		struct segc_vec flat = segc_flatten(&log);
+		ASSERT(flat.size == 300)
+		int ok = 1;
+		for (size_t i = 0; i < flat.size; ++i)
+			ok &= flat.data[i] == i + 1;
+		ASSERT(ok)
+		segc_vec_free(&flat);
+		segc_free(&log);
+	})
+})
@@ -0,0 +1,315 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_SEGMENTED_CONCURRENT_H
+#define DATASTORE_SEGMENTED_CONCURRENT_H
+
+#include "segmented.h"
+
+#include <stdbool.h>
+
+/**
+ * @file segmented_concurrent.h
+ * @defgroup SegmentedConcurrent DATASTORE_SEGVEC_CONCURRENT: Concurrent append-only vector
+ *
+ * @brief Append-only vector where any number of threads push without a lock
+ *
+ * The vector uses the block layout of @ref Segmented: blocks of geometrically increasing size
+ * that are never moved, so a slot has the same address for the whole lifetime of the vector.
+ *
+ * - A producer reserves its slots with a single `fetch_add` on the reserved counter, then writes
+ *   them without any synchronization with other producers.
+ * - A block is allocated by the first producer that needs it. When two producers race, one
+ *   installs its block with a compare-and-swap and the other frees its own.
+ * - Once written, slots are published with a compare-and-swap on the `published` watermark when
+ *   it is already at the first one. Otherwise they are flagged ready, and the watermark is moved
+ *   over every consecutive ready slot by whichever producer reaches it. A producer never waits for another
+ *   one: when it is preempted before flagging its slots, the watermark stops there, and it is the
+ *   producer itself that moves it past the slots written meanwhile.
+ *
+ * Readers call `size` to load the watermark, every element below it is fully written and can be
+ * read concurrently with producers. Elements are never modified or removed once published, there
+ * is no `pop`.
+ *
+ * `push`, `push_many`, `size`, `get` and `flatten` may be called concurrently with each other.
+ * `new` and `free` must not run concurrently with any other method on the same vector.
+ *
+ * Each block stores one ready byte per element after its elements. Atomics use the GCC
+ * `__atomic` builtins.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define LOG_TRAIT(X) \
+ * 	X(TYPE, struct entry) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; })
+ *
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_SEGVEC_CONCURRENT(struct entry, log)
+ * // Methods definition (in the .c)
+ * DATASTORE_SEGVEC_CONCURRENT_IMPL(LOG_TRAIT, log)
+ *
+ * struct log l = log_new(0);
+ * // From any thread
+ * log_push(&l, entry);
+ * // From a reader
+ * const size_t size = log_size(&l);
+ * for (size_t i = seen; i < size; ++i)
+ * 	consume(log_get(&l, i));
+ * // Once every producer has stopped
+ * log_free(&l);
+ * @endcode
+ *
+ * **Macro `DATASTORE_SEGVEC_CONCURRENT(type, name)`**: Define a new concurrent vector type, and
+ * the vector type `name_vec` returned by `flatten`
+ *
+ * **Macro `DATASTORE_SEGVEC_CONCURRENT_IMPL(trait, name)`** and
+ * **`DATASTORE_SEGVEC_CONCURRENT_IMPL_S(trait, name, settings)`**: Implements methods for a
+ * concurrent vector type, and for `name_vec`. The `NEW` and `FREE` settings must be thread-safe
+ *
+ * ## Exposed methods
+ *
+ * - `vec new(size_t capacity)`: Create a new vector with blocks for `capacity` elements
+ * - `void free(struct vec *self)`: Free the vector and its elements
+ * - `size_t push(struct vec *self, type value)`: Append an element and return its index
+ * - `size_t push_many(struct vec *self, const type *values, size_t count)`: Append `count`
+ *   contiguous elements with a single reservation, return the index of the first one
+ * - `size_t size(const struct vec *self)`: Published length, every element below it is readable
+ * - `type *get(const struct vec *self, size_t index)`: Pointer to element `index`, which must be
+ *   below a value returned by `size`
+ * - `struct vec_vec flatten(const struct vec *self)`: Copy of the published elements, made with
+ *   `CLONE`
+ */
+
+/* Counters are kept on separate cache lines, so producers bumping `reserved` do not slow readers */
+#define DATASTORE_SEGVEC_CACHE_LINE 64
+
+/**
+ * @brief Concurrent vector type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the concurrent vector type
+ */
+#define DATASTORE_SEGVEC_CONCURRENT(type__, name__) \
+DATASTORE_VEC(type__, DATASTORE_IDENT(name__, vec)) \
+struct name__ \
+{ \
+	type__ *blocks[DATASTORE_SEGVEC_BLOCKS]; \
+	unsigned char pad_blocks[DATASTORE_SEGVEC_CACHE_LINE]; \
+	size_t reserved; \
+	unsigned char pad_reserved[DATASTORE_SEGVEC_CACHE_LINE - sizeof(size_t)]; \
+	size_t published; \
+	unsigned char pad_published[DATASTORE_SEGVEC_CACHE_LINE - sizeof(size_t)]; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+size_t DATASTORE_IDENT(name__, push)(struct name__ *self, type__ value); \
+size_t DATASTORE_IDENT(name__, push_many)(struct name__ *self, type__ const *values, size_t count); \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self); \
+type__ *DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t index); \
+struct DATASTORE_IDENT(name__, vec) DATASTORE_IDENT(name__, flatten)(const struct name__ *self);
+
+/**
+ * @brief Concurrent vector methods implementation
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the concurrent vector, must match the name passed to
+ * @ref DATASTORE_SEGVEC_CONCURRENT
+ * @param settings__ Allocation settings for the blocks, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_SEGVEC_CONCURRENT_IMPL_S(trait__, name__, settings__) \
+DATASTORE_VEC_IMPL_S(trait__, DATASTORE_IDENT(name__, vec), settings__) \
+/* Returns block `block`, allocating it if no producer did yet */ \
+static trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, impl_block)(struct name__ *self, size_t block) \
+{ \
+	assert(block < DATASTORE_SEGVEC_BLOCKS); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = __atomic_load_n(&self->blocks[block], __ATOMIC_ACQUIRE); \
+	if (ptr) \
+		return ptr; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t count = datastore_segvec_block_size(block); \
+	{ \
+		const size_t size = datastore_vec_pad((sizeof(*ptr) + 1) * count, align); \
+		size_t usable = size; \
+		settings__(DATASTORE_VEC_SETTINGS_NEW) \
+		DATASTORE_MAYBE_UNUSED(usable); \
+	} \
+	memset(ptr + count, 0, count); \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *installed = NULL; \
+	if (__atomic_compare_exchange_n(&self->blocks[block], &installed, ptr, false, __ATOMIC_ACQ_REL, \
+		__ATOMIC_ACQUIRE)) \
+		return ptr; \
+	/* Another producer won the race */ \
+	const size_t size = (sizeof(*ptr) + 1) * count; \
+	DATASTORE_MAYBE_UNUSED(size); \
+	settings__(DATASTORE_VEC_SETTINGS_FREE) \
+	return installed; \
+} \
+/* \
+ * Publishes [first, end). When the watermark is already at `first`, it is moved directly; \
+ * otherwise the range is flagged ready, the first flag set last so a scan reading it sees the \
+ * whole range. Then the watermark is moved past consecutive ready slots. Flags and the watermark \
+ * are sequentially consistent: of two producers publishing adjacent ranges, at least one sees the \
+ * other's. \
+ */ \
+static void DATASTORE_IDENT(name__, impl_publish)(struct name__ *self, size_t first, size_t end) \
+{ \
+	size_t published = first; \
+	if (__atomic_compare_exchange_n(&self->published, &published, end, false, __ATOMIC_SEQ_CST, \
+		__ATOMIC_SEQ_CST)) \
+		published = end; \
+	else \
+	{ \
+		for (size_t index = end; index-- > first;) \
+		{ \
+			const size_t block = datastore_segvec_block(index); \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = __atomic_load_n(&self->blocks[block], __ATOMIC_RELAXED); \
+			unsigned char *ready = (unsigned char *)(ptr + datastore_segvec_block_size(block)); \
+			__atomic_store_n(&ready[datastore_segvec_offset(index, block)], 1, \
+				index == first ? __ATOMIC_SEQ_CST : __ATOMIC_RELAXED); \
+		} \
+		published = __atomic_load_n(&self->published, __ATOMIC_SEQ_CST); \
+	} \
+	for (;;) \
+	{ \
+		size_t watermark = published; \
+		size_t block = datastore_segvec_block(watermark); \
+		size_t offset = datastore_segvec_offset(watermark, block); \
+		for (;;) \
+		{ \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = __atomic_load_n(&self->blocks[block], __ATOMIC_ACQUIRE); \
+			if (!ptr) \
+				break; \
+			const size_t count = datastore_segvec_block_size(block); \
+			unsigned char *ready = (unsigned char *)(ptr + count); \
+			while (offset < count && __atomic_load_n(&ready[offset], __ATOMIC_SEQ_CST)) \
+				++offset; \
+			watermark = count - datastore_segvec_block_size(0) + offset; \
+			if (offset < count || ++block == DATASTORE_SEGVEC_BLOCKS) \
+				break; \
+			offset = 0; \
+		} \
+		if (watermark == published || __atomic_compare_exchange_n(&self->published, &published, watermark, \
+			false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) \
+			return; \
+	} \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity) \
+{ \
+	struct name__ self = { .reserved = 0 }; \
+	for (size_t block = 0; capacity && block <= datastore_segvec_block(capacity - 1); ++block) \
+		DATASTORE_IDENT(name__, impl_block)(&self, block); \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	const size_t published = __atomic_load_n(&self->published, __ATOMIC_ACQUIRE); \
+	assert(published == __atomic_load_n(&self->reserved, __ATOMIC_RELAXED)); \
+	for (size_t block = 0; block < DATASTORE_SEGVEC_BLOCKS && self->blocks[block]; ++block) \
+	{ \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->blocks[block]; \
+		const size_t count = datastore_segvec_block_size(block); \
+		const size_t first = count - datastore_segvec_block_size(0); \
+		const size_t used = published <= first ? 0 : (published - first < count ? published - first : count); \
+		for (size_t i = 0; i < used; ++i) \
+		{ \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *val = ptr + i; \
+			DATASTORE_MAYBE_UNUSED(val); \
+			trait__(DATASTORE_VEC_TRAIT_FREE) \
+		} \
+		const size_t size = (sizeof(*ptr) + 1) * count; \
+		DATASTORE_MAYBE_UNUSED(size); \
+		settings__(DATASTORE_VEC_SETTINGS_FREE) \
+		self->blocks[block] = NULL; \
+	} \
+	self->reserved = 0; \
+	self->published = 0; \
+} \
+size_t DATASTORE_IDENT(name__, push)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	const size_t index = __atomic_fetch_add(&self->reserved, 1, __ATOMIC_RELAXED); \
+	const size_t block = datastore_segvec_block(index); \
+	DATASTORE_IDENT(name__, impl_block)(self, block)[datastore_segvec_offset(index, block)] = value; \
+	DATASTORE_IDENT(name__, impl_publish)(self, index, index + 1); \
+	return index; \
+} \
+size_t DATASTORE_IDENT(name__, push_many)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) const *values, \
+	size_t count) \
+{ \
+	const size_t first = __atomic_fetch_add(&self->reserved, count, __ATOMIC_RELAXED); \
+	size_t index = first; \
+	while (index != first + count) \
+	{ \
+		const size_t block = datastore_segvec_block(index); \
+		const size_t offset = datastore_segvec_offset(index, block); \
+		const size_t room = datastore_segvec_block_size(block) - offset; \
+		const size_t chunk = first + count - index < room ? first + count - index : room; \
+		memcpy(DATASTORE_IDENT(name__, impl_block)(self, block) + offset, values + (index - first), \
+			chunk * sizeof(*values)); \
+		index += chunk; \
+	} \
+	DATASTORE_IDENT(name__, impl_publish)(self, first, first + count); \
+	return first; \
+} \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self) \
+{ \
+	return __atomic_load_n(&self->published, __ATOMIC_ACQUIRE); \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t index) \
+{ \
+	const size_t block = datastore_segvec_block(index); \
+	/* Published slots are in blocks made visible by the acquire load of `size` */ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = __atomic_load_n(&self->blocks[block], __ATOMIC_RELAXED); \
+	assert(ptr); \
+	return ptr + datastore_segvec_offset(index, block); \
+} \
+struct DATASTORE_IDENT(name__, vec) DATASTORE_IDENT(name__, flatten)(const struct name__ *self) \
+{ \
+	const size_t size = DATASTORE_IDENT(name__, size)(self); \
+	struct DATASTORE_IDENT(name__, vec) flat = DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), new)(size); \
+	for (size_t block = 0; flat.size != size; ++block) \
+	{ \
+		trait__(DATASTORE_VEC_TRAIT_TYPE) *from = __atomic_load_n(&self->blocks[block], __ATOMIC_RELAXED); \
+		const size_t room = datastore_segvec_block_size(block); \
+		const size_t count = size - flat.size < room ? size - flat.size : room; \
+		for (size_t i = 0; i < count; ++i) \
+		{ \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *val = from + i; \
+			trait__(DATASTORE_VEC_TRAIT_TYPE) *new = flat.data + flat.size + i; \
+			trait__(DATASTORE_VEC_TRAIT_CLONE) \
+		} \
+		flat.size += count; \
+	} \
+	return flat; \
+}
+
+/**
+ * @brief Concurrent vector methods implementation
+ *
+ * This macro will call @ref DATASTORE_SEGVEC_CONCURRENT_IMPL_S, with
+ * @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the concurrent vector, must match the name passed to
+ * @ref DATASTORE_SEGVEC_CONCURRENT
+ */
+#define DATASTORE_SEGVEC_CONCURRENT_IMPL(trait__, name__) \
+	DATASTORE_SEGVEC_CONCURRENT_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup SegmentedConcurrent */
+
+#endif // DATASTORE_SEGMENTED_CONCURRENT_H
@@ -0,0 +1,107 @@
+#include "test.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_SEGVEC(int, segi)
+typedef struct segi segi;
+DATASTORE_SEGVEC_IMPL_S(INT_TRAIT, segi, SETTINGS)
+
+TESTS(segmented_int, {
+	TEST("indexing", {
+		int ok = 1;
+		for (size_t i = 0; i < 100000; ++i)
+		{
+			const size_t block = datastore_segvec_block(i);
+			const size_t offset = datastore_segvec_offset(i, block);
+			const size_t first = datastore_segvec_block_size(block) - datastore_segvec_block_size(0);
+			ok &= offset < datastore_segvec_block_size(block);
+			ok &= first + offset == i;
+		}
+		ASSERT(ok)
+		ASSERT(datastore_segvec_block(0) == 0)
+		ASSERT(datastore_segvec_block(datastore_segvec_block_size(0) - 1) == 0)
+		ASSERT(datastore_segvec_block(datastore_segvec_block_size(0)) == 1)
+		ASSERT(datastore_segvec_block(SIZE_MAX - datastore_segvec_block_size(0)) == DATASTORE_SEGVEC_BLOCKS - 1)
+	})
+	TEST("push", {
+		segi v = segi_new(0);
+		ASSERT(v.block_count == 0)
+		for (int i = 0; i < 10000; ++i)
+			segi_push(&v, i);
+		ASSERT(v.size == 10000)
+		ASSERT(v.capacity >= v.size)
+		int ok = 1;
+		for (size_t i = 0; i < v.size; ++i)
+			ok &= *segi_get(&v, i) == (int)i;
+		ASSERT(ok)
+		segi_pop(&v);
+		ASSERT(v.size == 9999)
+		segi_free(&v);
+		ASSERT(v.capacity == 0)
+	})
+	TEST("stable addresses", {
+		segi v = segi_new(0);
+		segi_push(&v, 42);
+		int *first = segi_get(&v, 0);
+		for (int i = 0; i < 5000; ++i)
+			segi_push(&v, i);
+		int *middle = segi_get(&v, 2500);
+		for (int i = 0; i < 50000; ++i)
+			segi_push(&v, i);
+		ASSERT(first == segi_get(&v, 0))
+		ASSERT(*first == 42)
+		ASSERT(middle == segi_get(&v, 2500))
+		ASSERT(*middle == 2499)
+		segi_free(&v);
+	})
+	TEST("reserve", {
+		segi v = segi_new(1000);
+		ASSERT(v.capacity >= 1000)
+		const size_t blocks = v.block_count;
+		for (int i = 0; i < 1000; ++i)
+			segi_push(&v, i);
+		ASSERT(v.block_count == blocks)
+		segi_reserve(&v, 10);
+		ASSERT(v.block_count == blocks)
+		segi_free(&v);
+	})
+	TEST("blocks", {
+		segi v = segi_new(0);
+		for (int i = 0; i < 100; ++i)
+			segi_push(&v, i);
+		size_t total = 0;
+		int ok = 1;
+		for (size_t block = 0; block < v.block_count; ++block)
+		{
+			size_t count;
+			const int *values = segi_block(&v, block, &count);
+			for (size_t i = 0; i < count; ++i)
+				ok &= values[i] == (int)(total + i);
+			total += count;
+		}
+		ASSERT(ok)
+		ASSERT(total == 100)
+		segi_free(&v);
+	})
+	TEST("flatten", {
+		segi v = segi_new(0);
+		for (int i = 0; i < 1000; ++i)
+			segi_push(&v, i * 3);
+		struct segi_vec flat = segi_flatten(&v);
+		ASSERT(flat.size == 1000)
+		int ok = 1;
+		for (size_t i = 0; i < flat.size; ++i)
+			ok &= flat.data[i] == (int)i * 3;
+		ASSERT(ok)
+		segi_vec_free(&flat);
+		segi_free(&v);
+
+		segi empty = segi_new(0);
+		struct segi_vec none = segi_flatten(&empty);
+		ASSERT(none.size == 0)
+		segi_vec_free(&none);
+		segi_free(&empty);
+	})
+})
@@ -0,0 +1,80 @@
+#include "test.h"
+
+static char *dup(const char *s)
+{
+	const size_t len = strlen(s) + 1;
+	char *copy = iso_malloc(len);
+	if (!copy)
+		abort();
+	memcpy(copy, s, len);
+	return copy;
+}
+
+static char *number(size_t i)
+{
+	char buf[32];
+	size_t len = 0;
+	do
+	{
+		buf[len++] = (char)('0' + i % 10);
+		i /= 10;
+	} while (i);
+	char *s = iso_malloc(len + 1);
+	if (!s)
+		abort();
+	for (size_t j = 0; j < len; ++j)
+		s[j] = buf[len - 1 - j];
+	s[len] = '\0';
+	return s;
+}
+
+#define STR_TRAIT(X) \
+	X(TYPE, char *) \
+	X(FREE, { iso_free(*val); }) \
+	X(CLONE, { *new = dup(*val); })
+DATASTORE_SEGVEC(char *, segs)
+typedef struct segs segs;
+DATASTORE_SEGVEC_IMPL_S(STR_TRAIT, segs, SETTINGS)
+
+TESTS(segmented_str, {
+	TEST("owned", {
+		segs v = segs_new(0);
+		for (size_t i = 0; i < 500; ++i)
+			segs_push(&v, number(i));
+		ASSERT(strcmp(*segs_get(&v, 123), "123") == 0)
+		segs_pop(&v);
+		segs_pop(&v);
+		ASSERT(v.size == 498)
+		ASSERT(strcmp(*segs_get(&v, v.size - 1), "497") == 0)
+		segs_free(&v);
+	})
+	TEST("clone", {
+		segs v = segs_new(0);
+		for (size_t i = 0; i < 200; ++i)
+			segs_push(&v, number(i));
+		segs c = segs_clone(&v);
+		segs_free(&v);
+		ASSERT(c.size == 200)
+		int ok = 1;
+		for (size_t i = 0; i < c.size; ++i)
+		{
+			char *expected = number(i);
+			ok &= strcmp(*segs_get(&c, i), expected) == 0;
+			iso_free(expected);
+		}
+		ASSERT(ok)
+		segs_free(&c);
+	})
+	TEST("flatten", {
+		segs v = segs_new(0);
+		segs_push(&v, dup("a"));
+		segs_push(&v, dup("b"));
+		segs_push(&v, dup("c"));
+		struct segs_vec flat = segs_flatten(&v);
+		segs_free(&v);
+		ASSERT(flat.size == 3)
+		ASSERT(strcmp(flat.data[0], "a") == 0)
+		ASSERT(strcmp(flat.data[2], "c") == 0)
+		segs_vec_free(&flat);
+	})
+})
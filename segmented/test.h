@@ -0,0 +1,22 @@
+#ifndef DATASTORE_SEGMENTED_TEST_H
+#define DATASTORE_SEGMENTED_TEST_H
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../tests/tests.h"
+#include "segmented.h"
+#include "segmented_concurrent.h"
+
+#include <pthread.h>
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+extern const unit_test test_segmented_int;
+extern const unit_test test_segmented_str;
+extern const unit_test test_segmented_concurrent;
+
+#endif // DATASTORE_SEGMENTED_TEST_H
@@ -0,0 +1,338 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_SLOT_MAP_H
+#define DATASTORE_SLOT_MAP_H
+
+#include "../vector/vector.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file slot_map.h
+ * @defgroup SlotMap DATASTORE_SLOT_MAP: Slot map with generational handles
+ *
+ * @brief Dense storage addressed by handles that stay valid across removals
+ *
+ * A slot map stores its elements densely in a @ref DATASTORE_VEC, and gives out a
+ * @ref datastore_slot_handle for each element: a 32-bit slot index and a 32-bit generation.
+ *
+ * - Each slot stores the generation of its element, and its position in the dense vector.
+ *   Resolving a handle indexes the slot array, compares generations, then indexes the dense
+ *   vector: no hashing and no tree walk.
+ * - Removing an element moves the last element into its place, so live elements stay packed and
+ *   can be iterated directly in `values`. Only the slot of the moved element is updated, handles
+ *   are unaffected.
+ * - A freed slot gets its generation bumped, so handles to the removed element no longer resolve,
+ *   and is pushed on a free list threaded through the slots themselves, to be reused by the next
+ *   insert.
+ *
+ * The generation is odd while a slot is occupied and even while it is free. A stale handle could
+ * only resolve again after its slot was reused 2^31 times.
+ *
+ * Elements are owned by the map, released with `FREE` and copied with `CLONE` (see
+ * @ref trait_type "Trait Type"). The vectors use the settings of @ref advanced_usage
+ * "Advanced Usage".
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define ENTITY_TRAIT(X) \
+ * 	X(TYPE, struct entity) \
+ * 	X(FREE, { entity_free(val); }) \
+ * 	X(CLONE, { *new = entity_clone(val); })
+ *
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_SLOT_MAP(struct entity, entities)
+ * // Methods definition (in the .c)
+ * DATASTORE_SLOT_MAP_IMPL(ENTITY_TRAIT, entities)
+ *
+ * struct entities world = entities_new(0);
+ * struct datastore_slot_handle player = entities_insert(&world, entity);
+ * entities_get(&world, player)->health -= 10;
+ * entities_remove(&world, player);
+ * assert(entities_get(&world, player) == NULL);
+ * // Iterate over live entities
+ * for (size_t i = 0; i < world.values.size; ++i)
+ * 	update(&world.values.data[i]);
+ * entities_free(&world);
+ * @endcode
+ *
+ * **Macro `DATASTORE_SLOT_MAP(type, name)`**: Define a new slot map type, and its vectors
+ * `name_vec` (elements), `name_indices` and `name_slots`
+ *
+ * **Macro `DATASTORE_SLOT_MAP_IMPL(trait, name)`** and
+ * **`DATASTORE_SLOT_MAP_IMPL_S(trait, name, settings)`**: Implements methods for a slot map type
+ *
+ * The resulting type will look like this:
+ * @code{.c}
+ * struct name {
+ *     struct name_vec values; // Live elements, densely packed
+ *     struct name_indices owners; // Slot of each element
+ *     struct name_slots slots; // Generation and dense position (or next free slot) of each slot
+ *     uint32_t free_head; // First free slot, or DATASTORE_SLOT_NONE
+ * };
+ * @endcode
+ *
+ * ## Exposed methods
+ *
+ * - `map new(size_t capacity)`: Create a new slot map
+ * - `void free(struct map *self)`: Free the map and its elements
+ * - `map clone(const struct map *self)`: Deep copy of the map, handles remain valid in the copy
+ * - `void clear(struct map *self)`: Remove every element, handles to them are invalidated
+ * - `struct datastore_slot_handle insert(struct map *self, type value)`: Insert an element and
+ *   return its handle
+ * - `bool contains(const struct map *self, struct datastore_slot_handle handle)`: Whether the
+ *   handle refers to a live element
+ * - `type *get(const struct map *self, struct datastore_slot_handle handle)`: Element of the
+ *   handle, or NULL when it was removed
+ * - `bool remove(struct map *self, struct datastore_slot_handle handle)`: Remove and free the
+ *   element, returns false when the handle is stale
+ * - `bool take(struct map *self, struct datastore_slot_handle handle, type *out)`: Remove the
+ *   element and move it to `out`, returns false when the handle is stale
+ * - `struct datastore_slot_handle handle_at(const struct map *self, size_t index)`: Handle of the
+ *   element at `index` in `values`
+ */
+
+/**
+ * @brief End of the free list, and index of @ref DATASTORE_SLOT_NULL
+ */
+#define DATASTORE_SLOT_NONE UINT32_MAX
+
+/**
+ * @brief Generational handle to an element of a slot map
+ */
+struct datastore_slot_handle
+{
+	/**
+	 * @brief Slot of the element
+	 */
+	uint32_t index;
+	/**
+	 * @brief Generation of the slot when the element was inserted, always odd
+	 */
+	uint32_t generation;
+};
+
+/**
+ * @brief Handle that never resolves
+ */
+#define DATASTORE_SLOT_NULL ((struct datastore_slot_handle){ DATASTORE_SLOT_NONE, 0 })
+
+/**
+ * @brief Packs a handle into 64 bits
+ */
+static inline uint64_t datastore_slot_handle_pack(struct datastore_slot_handle handle)
+{
+	return (uint64_t)handle.generation << 32 | handle.index;
+}
+
+/**
+ * @brief Unpacks a handle packed with @ref datastore_slot_handle_pack
+ */
+static inline struct datastore_slot_handle datastore_slot_handle_unpack(uint64_t packed)
+{
+	struct datastore_slot_handle handle;
+	handle.index = (uint32_t)packed;
+	handle.generation = (uint32_t)(packed >> 32);
+	return handle;
+}
+
+/**
+ * @brief Slot of a slot map
+ */
+struct datastore_slot
+{
+	/**
+	 * @brief Position of the element in `values` when occupied, next free slot otherwise
+	 */
+	uint32_t index;
+	/**
+	 * @brief Odd when occupied, even when free
+	 */
+	uint32_t generation;
+};
+
+#define DATASTORE_SLOT_TRAIT(X) \
+	X(TYPE, struct datastore_slot) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+#define DATASTORE_SLOT_INDEX_TRAIT(X) \
+	X(TYPE, uint32_t) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+/**
+ * @brief Slot map type definition and methods declaration
+ *
+ * @param type__ Type of the elements
+ * @param name__ Name of the slot map type
+ */
+#define DATASTORE_SLOT_MAP(type__, name__) \
+DATASTORE_VEC(type__, DATASTORE_IDENT(name__, vec)) \
+DATASTORE_VEC(uint32_t, DATASTORE_IDENT(name__, indices)) \
+DATASTORE_VEC(struct datastore_slot, DATASTORE_IDENT(name__, slots)) \
+struct name__ \
+{ \
+	struct DATASTORE_IDENT(name__, vec) values; \
+	struct DATASTORE_IDENT(name__, indices) owners; \
+	struct DATASTORE_IDENT(name__, slots) slots; \
+	uint32_t free_head; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, clear)(struct name__ *self); \
+struct datastore_slot_handle DATASTORE_IDENT(name__, insert)(struct name__ *self, type__ value); \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, struct datastore_slot_handle handle); \
+type__ *DATASTORE_IDENT(name__, get)(const struct name__ *self, struct datastore_slot_handle handle); \
+bool DATASTORE_IDENT(name__, remove)(struct name__ *self, struct datastore_slot_handle handle); \
+bool DATASTORE_IDENT(name__, take)(struct name__ *self, struct datastore_slot_handle handle, type__ *out); \
+struct datastore_slot_handle DATASTORE_IDENT(name__, handle_at)(const struct name__ *self, size_t index);
+
+/**
+ * @brief Slot map methods implementation
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the slot map, must match the name passed to @ref DATASTORE_SLOT_MAP
+ * @param settings__ Custom settings for the vectors, see @ref advanced_usage "Advanced Usage"
+ */
+#define DATASTORE_SLOT_MAP_IMPL_S(trait__, name__, settings__) \
+DATASTORE_VEC_IMPL_S(trait__, DATASTORE_IDENT(name__, vec), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_SLOT_INDEX_TRAIT, DATASTORE_IDENT(name__, indices), settings__) \
+DATASTORE_VEC_IMPL_S(DATASTORE_SLOT_TRAIT, DATASTORE_IDENT(name__, slots), settings__) \
+struct name__ DATASTORE_IDENT(name__, new)(size_t capacity) \
+{ \
+	return (struct name__){ \
+		.values = DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), new)(capacity), \
+		.owners = DATASTORE_IDENT(DATASTORE_IDENT(name__, indices), new)(capacity), \
+		.slots = DATASTORE_IDENT(DATASTORE_IDENT(name__, slots), new)(capacity), \
+		.free_head = DATASTORE_SLOT_NONE, \
+	}; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), free)(&self->values); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, indices), free)(&self->owners); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, slots), free)(&self->slots); \
+	self->free_head = DATASTORE_SLOT_NONE; \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	return (struct name__){ \
+		.values = DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), clone)(&self->values), \
+		.owners = DATASTORE_IDENT(DATASTORE_IDENT(name__, indices), clone)(&self->owners), \
+		.slots = DATASTORE_IDENT(DATASTORE_IDENT(name__, slots), clone)(&self->slots), \
+		.free_head = self->free_head, \
+	}; \
+} \
+void DATASTORE_IDENT(name__, clear)(struct name__ *self) \
+{ \
+	while (self->values.size) \
+		DATASTORE_IDENT(name__, remove)(self, DATASTORE_IDENT(name__, handle_at)(self, self->values.size - 1)); \
+} \
+struct datastore_slot_handle DATASTORE_IDENT(name__, insert)(struct name__ *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	uint32_t index = self->free_head; \
+	if (index != DATASTORE_SLOT_NONE) \
+		self->free_head = self->slots.data[index].index; \
+	else \
+	{ \
+		assert(self->slots.size < DATASTORE_SLOT_NONE); \
+		struct datastore_slot slot = { 0, 0 }; \
+		DATASTORE_IDENT(DATASTORE_IDENT(name__, slots), push)(&self->slots, slot); \
+		index = (uint32_t)(self->slots.size - 1); \
+	} \
+	struct datastore_slot *slot = &self->slots.data[index]; \
+	++slot->generation; \
+	slot->index = (uint32_t)self->values.size; \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, vec), push)(&self->values, value); \
+	DATASTORE_IDENT(DATASTORE_IDENT(name__, indices), push)(&self->owners, index); \
+	struct datastore_slot_handle handle; \
+	handle.index = index; \
+	handle.generation = slot->generation; \
+	return handle; \
+} \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, struct datastore_slot_handle handle) \
+{ \
+	/* Handles have odd generations, a match means the slot is occupied */ \
+	return handle.index < self->slots.size && self->slots.data[handle.index].generation == handle.generation \
+		&& (handle.generation & 1); \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) *DATASTORE_IDENT(name__, get)(const struct name__ *self, \
+	struct datastore_slot_handle handle) \
+{ \
+	if (!DATASTORE_IDENT(name__, contains)(self, handle)) \
+		return NULL; \
+	return &self->values.data[self->slots.data[handle.index].index]; \
+} \
+bool DATASTORE_IDENT(name__, take)(struct name__ *self, struct datastore_slot_handle handle, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *out) \
+{ \
+	if (!DATASTORE_IDENT(name__, contains)(self, handle)) \
+		return false; \
+	struct datastore_slot *slot = &self->slots.data[handle.index]; \
+	const uint32_t position = slot->index; \
+	const size_t last = self->values.size - 1; \
+	*out = self->values.data[position]; \
+	/* Move the last element into the hole */ \
+	self->values.data[position] = self->values.data[last]; \
+	self->owners.data[position] = self->owners.data[last]; \
+	self->slots.data[self->owners.data[position]].index = position; \
+	--self->values.size; \
+	--self->owners.size; \
+	++slot->generation; \
+	slot->index = self->free_head; \
+	self->free_head = handle.index; \
+	return true; \
+} \
+bool DATASTORE_IDENT(name__, remove)(struct name__ *self, struct datastore_slot_handle handle) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value; \
+	if (!DATASTORE_IDENT(name__, take)(self, handle, &value)) \
+		return false; \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *val = &value; \
+	DATASTORE_MAYBE_UNUSED(val); \
+	trait__(DATASTORE_VEC_TRAIT_FREE) \
+	return true; \
+} \
+struct datastore_slot_handle DATASTORE_IDENT(name__, handle_at)(const struct name__ *self, size_t index) \
+{ \
+	assert(index < self->values.size); \
+	struct datastore_slot_handle handle; \
+	handle.index = self->owners.data[index]; \
+	handle.generation = self->slots.data[handle.index].generation; \
+	return handle; \
+}
+
+/**
+ * @brief Slot map methods implementation
+ *
+ * This macro will call @ref DATASTORE_SLOT_MAP_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param trait__ Type-trait for the elements, see @ref trait_type "Trait Type"
+ * @param name__ Name of the slot map, must match the name passed to @ref DATASTORE_SLOT_MAP
+ */
+#define DATASTORE_SLOT_MAP_IMPL(trait__, name__) \
+	DATASTORE_SLOT_MAP_IMPL_S(trait__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup SlotMap */
+
+#endif // DATASTORE_SLOT_MAP_H
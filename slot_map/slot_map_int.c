@@ -0,0 +1,142 @@
+#include "test.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_SLOT_MAP(int, smi)
+typedef struct smi smi;
+DATASTORE_SLOT_MAP_IMPL_S(INT_TRAIT, smi, SETTINGS)
+
+typedef struct datastore_slot_handle handle;
+
+// Value of a handle, -1 when it does not resolve
+static int value_of(const smi *m, handle h)
+{
+	const int *value = smi_get(m, h);
+	return value ? *value : -1;
+}
+
+static handle null_handle(void)
+{
+	return DATASTORE_SLOT_NULL;
+}
+
+// Checks that every live element is reachable from its handle, and the slots point back to it
+static int consistent(const smi *m)
+{
+	int ok = m->values.size == m->owners.size;
+	for (size_t i = 0; ok && i < m->values.size; ++i)
+	{
+		const handle h = smi_handle_at(m, i);
+		ok &= smi_get(m, h) == &m->values.data[i];
+	}
+	return ok;
+}
+
+TESTS(slot_map_int, {
+	TEST("insert get", {
+		smi m = smi_new(0);
+		const handle a = smi_insert(&m, 1);
+		const handle b = smi_insert(&m, 2);
+		const handle c = smi_insert(&m, 3);
+		ASSERT(value_of(&m, a) == 1)
+		ASSERT(value_of(&m, b) == 2)
+		ASSERT(value_of(&m, c) == 3)
+		ASSERT(smi_get(&m, null_handle()) == NULL)
+		ASSERT(!smi_contains(&m, null_handle()))
+		ASSERT(m.values.size == 3)
+		smi_free(&m);
+	})
+	TEST("remove", {
+		smi m = smi_new(0);
+		const handle a = smi_insert(&m, 1);
+		const handle b = smi_insert(&m, 2);
+		const handle c = smi_insert(&m, 3);
+		ASSERT(smi_remove(&m, a))
+		ASSERT(!smi_remove(&m, a))
+		ASSERT(smi_get(&m, a) == NULL)
+		// The last element moved into the hole, its handle still resolves
+		ASSERT(m.values.data[0] == 3)
+		ASSERT(value_of(&m, c) == 3)
+		ASSERT(value_of(&m, b) == 2)
+		int out;
+		ASSERT(smi_take(&m, b, &out) && out == 2)
+		ASSERT(!smi_take(&m, b, &out))
+		ASSERT(consistent(&m))
+		smi_free(&m);
+	})
+	TEST("generations", {
+		smi m = smi_new(0);
+		const handle a = smi_insert(&m, 1);
+		smi_remove(&m, a);
+		const handle b = smi_insert(&m, 2);
+		// The slot is reused with a new generation
+		ASSERT(b.index == a.index)
+		ASSERT(b.generation != a.generation)
+		ASSERT(smi_get(&m, a) == NULL)
+		ASSERT(value_of(&m, b) == 2)
+		ASSERT(datastore_slot_handle_unpack(datastore_slot_handle_pack(b)).generation == b.generation)
+		ASSERT(datastore_slot_handle_unpack(datastore_slot_handle_pack(b)).index == b.index)
+		// A handle with a free slot's generation never resolves
+		smi_remove(&m, b);
+		handle forged = b;
+		++forged.generation;
+		ASSERT(!smi_contains(&m, forged))
+		smi_free(&m);
+	})
+	TEST("free list", {
+		smi m = smi_new(0);
+		handle handles[100];
+		for (int i = 0; i < 100; ++i)
+			handles[i] = smi_insert(&m, i);
+		for (int i = 0; i < 100; i += 2)
+			smi_remove(&m, handles[i]);
+		ASSERT(m.values.size == 50)
+		ASSERT(consistent(&m))
+		// Freed slots are reused before the slot array grows
+		for (int i = 0; i < 50; ++i)
+			smi_insert(&m, 1000 + i);
+		ASSERT(m.slots.size == 100)
+		ASSERT(m.free_head == DATASTORE_SLOT_NONE)
+		int ok = 1;
+		for (int i = 1; i < 100; i += 2)
+			ok &= value_of(&m, handles[i]) == i;
+		for (int i = 0; i < 100; i += 2)
+			ok &= smi_get(&m, handles[i]) == NULL;
+		ASSERT(ok)
+		ASSERT(consistent(&m))
+		smi_clear(&m);
+		ASSERT(m.values.size == 0)
+		ASSERT(smi_get(&m, handles[1]) == NULL)
+		smi_free(&m);
+	})
+	TEST("random", {
+		smi m = smi_new(0);
+		handle live[64];
+		int expected[64];
+		size_t count = 0;
+		uint32_t seed = 1;
+		int ok = 1;
+		for (int step = 0; step < 5000; ++step)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			if (count < 64 && (count == 0 || (seed >> 16) % 3))
+			{
+				expected[count] = step;
+				live[count++] = smi_insert(&m, step);
+				continue;
+			}
+			const size_t victim = (seed >> 8) % count;
+			ok &= smi_remove(&m, live[victim]);
+			live[victim] = live[--count];
+			expected[victim] = expected[count];
+		}
+		for (size_t i = 0; i < count; ++i)
+			ok &= value_of(&m, live[i]) == expected[i];
+		ok &= m.values.size == count;
+		ASSERT(ok)
+		ASSERT(consistent(&m))
+		smi_free(&m);
+	})
+})
@@ -0,0 +1,55 @@
+#include "test.h"
+
+static char *dup(const char *s)
+{
+	const size_t len = strlen(s) + 1;
+	char *copy = iso_malloc(len);
+	if (!copy)
+		abort();
+	memcpy(copy, s, len);
+	return copy;
+}
+
+#define STR_TRAIT(X) \
+	X(TYPE, char *) \
+	X(FREE, { iso_free(*val); }) \
+	X(CLONE, { *new = dup(*val); })
+DATASTORE_SLOT_MAP(char *, sms)
+typedef struct sms sms;
+DATASTORE_SLOT_MAP_IMPL_S(STR_TRAIT, sms, SETTINGS)
+
+// String of a handle, empty when it does not resolve
+static const char *str_of(const sms *m, struct datastore_slot_handle h)
+{
+	char **value = sms_get(m, h);
+	return value ? *value : "";
+}
+
+TESTS(slot_map_str, {
+	TEST("owned", {
+		sms m = sms_new(4);
+		const struct datastore_slot_handle a = sms_insert(&m, dup("alpha"));
+		const struct datastore_slot_handle b = sms_insert(&m, dup("beta"));
+		sms_insert(&m, dup("gamma"));
+		ASSERT(sms_remove(&m, a))
+		char *taken;
+		ASSERT(sms_take(&m, b, &taken))
+		ASSERT(strcmp(taken, "beta") == 0)
+		iso_free(taken);
+		sms_free(&m);
+	})
+	TEST("clone", {
+		sms m = sms_new(0);
+		const struct datastore_slot_handle a = sms_insert(&m, dup("alpha"));
+		const struct datastore_slot_handle b = sms_insert(&m, dup("beta"));
+		sms_remove(&m, a);
+		sms c = sms_clone(&m);
+		sms_free(&m);
+		ASSERT(sms_get(&c, a) == NULL)
+		ASSERT(strcmp(str_of(&c, b), "beta") == 0)
+		// The free list is cloned too
+		const struct datastore_slot_handle d = sms_insert(&c, dup("delta"));
+		ASSERT(d.index == a.index)
+		sms_free(&c);
+	})
+})
@@ -0,0 +1,297 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_SOA_H
+#define DATASTORE_SOA_H
+
+#include "../vector/vector.h"
+
+/**
+ * @file soa.h
+ * @defgroup Soa DATASTORE_SOA: A struct-of-arrays dynamic array implementation
+ *
+ * @brief A struct-of-arrays dynamic array implementation
+ *
+ * A vector of structs stores every field of an element next to each other, so scanning a single
+ * field loads the whole struct. `DATASTORE_SOA` instead stores each field in its own contiguous
+ * column, all columns sharing the same size and capacity. Scans over a column are cache-dense
+ * and can be vectorized by the compiler.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * // Field list X-macro: X(type, name)
+ * #define FOO_FIELDS(X) \
+ * 	X(int, x) \
+ * 	X(void*, ptr) \
+ * 	X(float, u)
+ *
+ * // Type definitions and methods declaration (in the .h)
+ * DATASTORE_SOA(FOO_FIELDS, foos)
+ * // Methods definition (in the .c)
+ * DATASTORE_SOA_IMPL(FOO_FIELDS, foos)
+ *
+ * float sum_u(const struct foos *f)
+ * {
+ * 	float sum = 0.f;
+ * 	for (size_t i = 0; i < f->size; ++i)
+ * 		sum += f->u[i];
+ * 	return sum;
+ * }
+ * @endcode
+ *
+ * **Macro `DATASTORE_SOA(fields, name)`**: Define a new struct-of-arrays type
+ *  - `fields`: Field list X-macro, each entry is `X(type, field_name)`
+ *  - `name`: Name of the type
+ *
+ * **Macro `DATASTORE_SOA_IMPL(fields, name)`**: Implements methods for a corresponding type
+ *
+ * **Macro `DATASTORE_SOA_IMPL_S(fields, name, settings)`**: Implements methods for a
+ * corresponding type, using the vector settings `settings`, see
+ * @ref advanced_usage "DATASTORE_VEC Advanced Usage"
+ *
+ * The resulting types will look like this:
+ * @code{.c}
+ * struct foos_row {
+ *     int x;
+ *     void* ptr;
+ *     float u;
+ * };
+ * struct foos {
+ *     unsigned char *data;
+ *     int *x;
+ *     void* *ptr;
+ *     float *u;
+ *     size_t capacity;
+ *     size_t size;
+ * };
+ * @endcode
+ * Each column is directly accessible as a member, e.g `foos.u[i]`. All columns live in a single
+ * allocation pointed to by `data`, each column starting on a @ref DATASTORE_SOA_COLUMN_ALIGN
+ * bytes boundary relative to `data`. Use an `ALIGN` setting to align `data` itself.
+ *
+ * Fields are copied bitwise: there is no FREE or CLONE hook for individual fields.
+ *
+ * # Exposed methods
+ *
+ * - `soa new(size_t initial_capacity)`: Create a new instance with an initial capacity
+ * - `void free(struct soa *self)`: Free memory taken by all columns
+ * - `soa clone(const struct soa *self)`: Copy all columns
+ * - `void shrink_to_fit(struct soa *self)`: Reduce the capacity to the size
+ * - `void reserve(struct soa *self, size_t new_capacity)`: Ensure all columns can hold at least
+ *   `new_capacity` elements
+ * - `void push(struct soa *self, struct soa_row row)`: Append a row to every column
+ * - `void pop(struct soa *self)`: Remove the last row, the instance must not be empty
+ * - `struct soa_row get(const struct soa *self, size_t index)`: Gather a row from the columns
+ * - `void set(struct soa *self, size_t index, struct soa_row row)`: Scatter a row to the columns
+ *
+ * Each method must be prefixed by the name of the type + `_`.
+ *
+ * Growing allocates the new block with the `NEW` setting, copies each column once, then releases
+ * the old block with `FREE`. `REALLOC` is not used, as every column but the first one moves when
+ * the capacity changes.
+ */
+
+/**
+ * @brief Alignment of each column, relative to the start of the allocation
+ */
+#ifndef DATASTORE_SOA_COLUMN_ALIGN
+	#define DATASTORE_SOA_COLUMN_ALIGN ((size_t)64)
+#endif
+
+#define DATASTORE_SOA_FIELD_COLUMN(type__, field__) type__ *field__;
+#define DATASTORE_SOA_FIELD_ROW(type__, field__) type__ field__;
+#define DATASTORE_SOA_FIELD_BYTES(type__, field__) \
+	bytes = datastore_vec_pad(bytes, DATASTORE_SOA_COLUMN_ALIGN) + capacity * sizeof(type__);
+#define DATASTORE_SOA_FIELD_BIND(type__, field__) \
+	bytes = datastore_vec_pad(bytes, DATASTORE_SOA_COLUMN_ALIGN); \
+	self->field__ = self->data ? (type__ *)(void *)(self->data + bytes) : NULL; \
+	bytes += self->capacity * sizeof(type__);
+#define DATASTORE_SOA_FIELD_COPY(type__, field__) \
+	if (count && dst->field__ && src->field__) \
+		memcpy(dst->field__, src->field__, count * sizeof(type__));
+#define DATASTORE_SOA_FIELD_STORE(type__, field__) self->field__[index] = row.field__;
+#define DATASTORE_SOA_FIELD_LOAD(type__, field__) row.field__ = self->field__[index];
+
+/**
+ * @brief Struct-of-arrays type definition and methods declaration
+ *
+ * @param fields__ Field list X-macro, each entry is `X(type, field_name)`
+ * @param name__ Name of the type
+ */
+#define DATASTORE_SOA(fields__, name__) \
+struct DATASTORE_IDENT(name__, row) \
+{ \
+	fields__(DATASTORE_SOA_FIELD_ROW) \
+}; \
+struct name__ \
+{ \
+	unsigned char *data; \
+	fields__(DATASTORE_SOA_FIELD_COLUMN) \
+	size_t capacity; \
+	size_t size; \
+}; \
+struct name__ DATASTORE_IDENT(name__, new)(size_t initial_capacity); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+void DATASTORE_IDENT(name__, shrink_to_fit)(struct name__ *self); \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t new_capacity); \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, struct DATASTORE_IDENT(name__, row) row); \
+void DATASTORE_IDENT(name__, pop)(struct name__ *self); \
+struct DATASTORE_IDENT(name__, row) DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t index); \
+void DATASTORE_IDENT(name__, set)(struct name__ *self, size_t index, struct DATASTORE_IDENT(name__, row) row);
+
+/**
+ * @brief Struct-of-arrays methods implementation
+ *
+ * @param fields__ Field list X-macro, must match the one passed to @ref DATASTORE_SOA
+ * @param name__ Name of the type, must match the name passed to @ref DATASTORE_SOA
+ * @param settings__ Vector settings, see @ref advanced_usage "DATASTORE_VEC Advanced Usage"
+ */
+#define DATASTORE_SOA_IMPL_S(fields__, name__, settings__) \
+static size_t DATASTORE_IDENT(name__, impl_bytes)(size_t capacity) \
+{ \
+	size_t bytes = 0; \
+	fields__(DATASTORE_SOA_FIELD_BYTES) \
+	return bytes; \
+} \
+static void DATASTORE_IDENT(name__, impl_bind)(struct name__ *self) \
+{ \
+	size_t bytes = 0; \
+	fields__(DATASTORE_SOA_FIELD_BIND) \
+	DATASTORE_MAYBE_UNUSED(bytes); \
+} \
+static void DATASTORE_IDENT(name__, impl_release)(struct name__ *self) \
+{ \
+	unsigned char *ptr = self->data; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(DATASTORE_IDENT(name__, impl_bytes)(self->capacity), align); \
+	DATASTORE_MAYBE_UNUSED(size); \
+	settings__(DATASTORE_VEC_SETTINGS_FREE) \
+} \
+static void DATASTORE_IDENT(name__, impl_copy)(struct name__ *dst, const struct name__ *src, size_t count) \
+{ \
+	fields__(DATASTORE_SOA_FIELD_COPY) \
+} \
+static void DATASTORE_IDENT(name__, impl_resize)(struct name__ *self, size_t new_capacity) \
+{ \
+	struct name__ resized = DATASTORE_IDENT(name__, new)(new_capacity); \
+	DATASTORE_IDENT(name__, impl_copy)(&resized, self, self->size); \
+	resized.size = self->size; \
+	DATASTORE_IDENT(name__, impl_release)(self); \
+	*self = resized; \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(size_t initial_capacity) \
+{ \
+	struct name__ self; \
+	self.data = NULL; \
+	self.capacity = 0; \
+	self.size = 0; \
+	if (initial_capacity != 0) \
+	{ \
+		unsigned char *ptr; \
+		const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+		const size_t size = datastore_vec_pad(DATASTORE_IDENT(name__, impl_bytes)(initial_capacity), align); \
+		size_t usable = size; \
+		settings__(DATASTORE_VEC_SETTINGS_NEW) \
+		DATASTORE_MAYBE_UNUSED(usable); \
+		assert(!align || ((uintptr_t)ptr & (align - 1)) == 0); \
+		self.data = ptr; \
+		self.capacity = initial_capacity; \
+	} \
+	DATASTORE_IDENT(name__, impl_bind)(&self); \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	assert(self->size <= self->capacity); \
+	DATASTORE_IDENT(name__, impl_release)(self); \
+	self->data = NULL; \
+	self->capacity = 0; \
+	self->size = 0; \
+	DATASTORE_IDENT(name__, impl_bind)(self); \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	assert(self->size <= self->capacity); \
+	struct name__ clone = DATASTORE_IDENT(name__, new)(self->size); \
+	DATASTORE_IDENT(name__, impl_copy)(&clone, self, self->size); \
+	clone.size = self->size; \
+	return clone; \
+} \
+void DATASTORE_IDENT(name__, shrink_to_fit)(struct name__ *self) \
+{ \
+	assert(self->size <= self->capacity); \
+	if (self->size == self->capacity) \
+		return; \
+	DATASTORE_IDENT(name__, impl_resize)(self, self->size); \
+} \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t new_capacity) \
+{ \
+	assert(self->size <= self->capacity); \
+	if (self->capacity >= new_capacity) \
+		return; \
+	DATASTORE_IDENT(name__, impl_resize)(self, new_capacity); \
+} \
+void DATASTORE_IDENT(name__, push)(struct name__ *self, struct DATASTORE_IDENT(name__, row) row) \
+{ \
+	assert(self->size <= self->capacity); \
+	if (self->size == self->capacity) \
+	{ \
+		const size_t capacity = self->capacity; \
+		const size_t elem_size = sizeof(row); \
+		size_t new_capacity; \
+		DATASTORE_MAYBE_UNUSED(elem_size); \
+		settings__(DATASTORE_VEC_SETTINGS_GROW) \
+		assert(new_capacity > self->size); \
+		DATASTORE_IDENT(name__, impl_resize)(self, new_capacity); \
+	} \
+	const size_t index = self->size++; \
+	fields__(DATASTORE_SOA_FIELD_STORE) \
+} \
+void DATASTORE_IDENT(name__, pop)(struct name__ *self) \
+{ \
+	assert(self->size <= self->capacity); \
+	assert(self->size != 0); \
+	--self->size; \
+} \
+struct DATASTORE_IDENT(name__, row) DATASTORE_IDENT(name__, get)(const struct name__ *self, size_t index) \
+{ \
+	assert(index < self->size); \
+	struct DATASTORE_IDENT(name__, row) row; \
+	fields__(DATASTORE_SOA_FIELD_LOAD) \
+	return row; \
+} \
+void DATASTORE_IDENT(name__, set)(struct name__ *self, size_t index, struct DATASTORE_IDENT(name__, row) row) \
+{ \
+	assert(index < self->size); \
+	fields__(DATASTORE_SOA_FIELD_STORE) \
+}
+
+/**
+ * @brief Struct-of-arrays methods implementation
+ *
+ * It will call @ref DATASTORE_SOA_IMPL_S, with @ref DATASTORE_VEC_SETTINGS_DEFAULT.
+ *
+ * @param fields__ Field list X-macro, must match the one passed to @ref DATASTORE_SOA
+ * @param name__ Name of the type, must match the name passed to @ref DATASTORE_SOA
+ */
+#define DATASTORE_SOA_IMPL(fields__, name__) \
+	DATASTORE_SOA_IMPL_S(fields__, name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+
+/** @endgroup Soa */
+
+#endif // DATASTORE_SOA_H
@@ -0,0 +1,146 @@
+#include "test.h"
+
+#define FOO_FIELDS(X) \
+	X(int, x) \
+	X(void*, ptr) \
+	X(float, u)
+DATASTORE_SOA(FOO_FIELDS, foos)
+typedef struct foos foos;
+typedef struct foos_row foos_row;
+DATASTORE_SOA_IMPL_S(FOO_FIELDS, foos, SETTINGS)
+
+#define BYTE_FIELDS(X) \
+	X(char, c) \
+	X(double, d)
+DATASTORE_SOA(BYTE_FIELDS, bytes)
+DATASTORE_SOA_IMPL_S(BYTE_FIELDS, bytes, DATASTORE_VEC_SETTINGS_ALIGN64)
+
+static foos_row row(int i)
+{
+	return (foos_row){ .x = i, .ptr = (void*)(uintptr_t)(i * 8), .u = (float)i * .5f };
+}
+
+static struct bytes_row byte_row(int i)
+{
+	return (struct bytes_row){ .c = (char)i, .d = (double)i };
+}
+
+static int check(const foos *f, size_t n)
+{
+	int ok = f->size == n;
+	for (size_t i = 0; ok && i < n; ++i)
+	{
+		ok &= f->x[i] == (int)i;
+		ok &= f->ptr[i] == (void*)(uintptr_t)(i * 8);
+		ok &= f->u[i] == (float)i * .5f;
+	}
+	return ok;
+}
+
+TESTS(soa_foo, {
+	TEST("new", {
+		foos a = foos_new(16);
+		ASSERT(a.data != NULL)
+		ASSERT(a.capacity == 16)
+		ASSERT(a.size == 0)
+		ASSERT((void*)a.x == (void*)a.data)
+		ASSERT((uintptr_t)a.ptr % DATASTORE_SOA_COLUMN_ALIGN == (uintptr_t)a.data % DATASTORE_SOA_COLUMN_ALIGN)
+		ASSERT((unsigned char*)a.ptr >= (unsigned char*)(a.x + 16))
+		ASSERT((unsigned char*)a.u >= (unsigned char*)(a.ptr + 16))
+		foos_free(&a);
+		ASSERT(a.data == NULL)
+		ASSERT(a.x == NULL)
+		ASSERT(a.ptr == NULL)
+		ASSERT(a.u == NULL)
+		ASSERT(a.capacity == 0)
+
+		foos b = foos_new(0);
+		ASSERT(b.data == NULL)
+		ASSERT(b.x == NULL)
+		foos_free(&b);
+	})
+	TEST("push", {
+		foos a = foos_new(0);
+		for (int i = 0; i < 1000; ++i)
+			foos_push(&a, row(i));
+		ASSERT(a.capacity >= 1000)
+		ASSERT(check(&a, 1000))
+
+		const foos_row r = foos_get(&a, 123);
+		ASSERT(r.x == 123)
+		ASSERT(r.u == 61.5f)
+		foos_set(&a, 123, row(7));
+		ASSERT(a.x[123] == 7)
+		ASSERT(a.u[123] == 3.5f)
+		foos_set(&a, 123, row(123));
+		ASSERT(check(&a, 1000))
+		foos_free(&a);
+	})
+	TEST("pop", {
+		foos a = foos_new(4);
+		foos_push(&a, row(0));
+		foos_push(&a, row(1));
+		foos_pop(&a);
+		ASSERT(a.size == 1)
+		ASSERT(a.capacity == 4)
+		ASSERT(check(&a, 1))
+		foos_pop(&a);
+		ASSERT(a.size == 0)
+		foos_free(&a);
+	})
+	TEST("reserve", {
+		foos a = foos_new(2);
+		foos_push(&a, row(0));
+		foos_push(&a, row(1));
+		foos_reserve(&a, 1);
+		ASSERT(a.capacity == 2)
+		foos_reserve(&a, 100);
+		ASSERT(a.capacity == 100)
+		ASSERT(check(&a, 2))
+		foos_free(&a);
+	})
+	TEST("shrink_to_fit", {
+		foos a = foos_new(100);
+		for (int i = 0; i < 5; ++i)
+			foos_push(&a, row(i));
+		foos_shrink_to_fit(&a);
+		ASSERT(a.capacity == 5)
+		ASSERT(check(&a, 5))
+		while (a.size)
+			foos_pop(&a);
+		foos_shrink_to_fit(&a);
+		ASSERT(a.data == NULL)
+		ASSERT(a.capacity == 0)
+		foos_free(&a);
+	})
+	TEST("clone", {
+		foos a = foos_new(0);
+		for (int i = 0; i < 100; ++i)
+			foos_push(&a, row(i));
+		foos b = foos_clone(&a);
+		ASSERT(b.data != a.data)
+		ASSERT(b.capacity == 100)
+		ASSERT(check(&b, 100))
+		foos_free(&a);
+		foos_free(&b);
+
+		foos c = foos_new(0);
+		foos d = foos_clone(&c);
+		ASSERT(d.data == NULL)
+		ASSERT(d.size == 0)
+	})
+	TEST("aligned columns", {
+		struct bytes a = bytes_new(0);
+		int ok = 1;
+		for (int i = 0; i < 100; ++i)
+		{
+			bytes_push(&a, byte_row(i));
+			ok &= (uintptr_t)a.c % 64 == 0;
+			ok &= (uintptr_t)a.d % 64 == 0;
+		}
+		ASSERT(ok)
+		ASSERT(a.c[99] == 99)
+		ASSERT(a.d[99] == 99.)
+		bytes_free(&a);
+	})
+})
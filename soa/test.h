@@ -0,0 +1,15 @@
+#ifndef DATASTORE_SOA_TEST_H
+#define DATASTORE_SOA_TEST_H
+
+#include "../tests/tests.h"
+#include "soa.h"
+
+#define SETTINGS(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+extern const unit_test test_soa_foo;
+
+#endif // DATASTORE_SOA_TEST_H
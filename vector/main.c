@@ -38,5 +38,5 @@ main(int argc, char** argv)
 		filter = argv[1];
 	if (argc >= 3)
 		id_filter = atoi(argv[2]);
-	run_tests(filter, id_filter, (unit_test[]){ test_vec_integer, test_vec_string }, 2);
+	run_tests(filter, id_filter, (unit_test[]){ test_vec_integer, test_vec_string, test_vec_usable, test_vec_mmap, test_vec_aligned, test_vec_simd, test_vec_sort, test_vec_search, test_vec_external, test_vec_io, test_vec_file, test_vec_builder, test_vec_sso }, 13);
 }
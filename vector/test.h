@@ -9,6 +9,11 @@
     X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); }) \
     X(FREE, { iso_free(ptr); }) \
     X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+#define SETTINGS_USABLE(X) \
+    X(NEW, { ptr = iso_malloc(size); if (!ptr) abort(); usable = DATASTORE_VEC_USABLE_SIZE(ptr, size); }) \
+    X(REALLOC, { ptr = iso_realloc(ptr, size); if (!ptr) abort(); usable = DATASTORE_VEC_USABLE_SIZE(ptr, size); }) \
+    X(FREE, { iso_free(ptr); }) \
+    X(GROW, { new_capacity = datastore_vec_grow_policy(capacity, elem_size); })
 // Use this to re-enable -fanalyzer checks
 #define SETTINGS_FANALYZER(X) \
     X(NEW, { ptr = malloc(size); if (!ptr) abort(); }) \
@@ -18,5 +23,16 @@
 
 extern const unit_test test_vec_integer;
 extern const unit_test test_vec_string;
+extern const unit_test test_vec_usable;
+extern const unit_test test_vec_mmap;
+extern const unit_test test_vec_aligned;
+extern const unit_test test_vec_simd;
+extern const unit_test test_vec_sort;
+extern const unit_test test_vec_search;
+extern const unit_test test_vec_external;
+extern const unit_test test_vec_io;
+extern const unit_test test_vec_file;
+extern const unit_test test_vec_builder;
+extern const unit_test test_vec_sso;
 
 #endif // DATASTORE_VEC_TEST_H
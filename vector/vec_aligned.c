@@ -0,0 +1,107 @@
+#include "test.h"
+
+#define FLOAT_TRAIT(X) \
+	X(TYPE, float) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_VEC(float, vf32)
+typedef struct vf32 vf32;
+DATASTORE_VEC_IMPL_S(FLOAT_TRAIT, vf32, DATASTORE_VEC_SETTINGS_ALIGN32)
+DATASTORE_VEC(float, vf64)
+typedef struct vf64 vf64;
+DATASTORE_VEC_IMPL_S(FLOAT_TRAIT, vf64, DATASTORE_VEC_SETTINGS_ALIGN64)
+
+#define ALIGNED(ptr, align) (((uintptr_t)(ptr) & ((align) - 1)) == 0)
+
+TESTS(vec_aligned, {
+	TEST("aligned_realloc", {
+		unsigned char *p = datastore_vec_aligned_alloc(64, 100);
+		ASSERT(p != NULL)
+		ASSERT(ALIGNED(p, 64))
+		for (int i = 0; i < 100; ++i)
+			p[i] = (unsigned char)i;
+		int ok = 1;
+		for (size_t size = 100; size < 100000; size = size * 3 / 2)
+		{
+			p = datastore_vec_aligned_realloc(p, 100, size, 64);
+			if (!p)
+				abort();
+			ok &= ALIGNED(p, 64);
+		}
+		for (int i = 0; i < 100; ++i)
+			ok &= p[i] == (unsigned char)i;
+		ASSERT(ok)
+		p = datastore_vec_aligned_realloc(p, 100, 10, 64);
+		if (!p)
+			abort();
+		ASSERT(ALIGNED(p, 64))
+		ASSERT(p[9] == 9)
+		datastore_vec_aligned_free(p);
+		datastore_vec_aligned_free(NULL);
+	})
+	TEST("new", {
+		vf32 a = vf32_new(3);
+		ASSERT(a.data != NULL)
+		ASSERT(ALIGNED(a.data, 32))
+		// Padded to a whole AVX register
+		ASSERT(a.capacity == 8)
+		vf32_free(&a);
+		ASSERT(a.data == NULL)
+
+		vf64 b = vf64_new(17);
+		ASSERT(ALIGNED(b.data, 64))
+		ASSERT(b.capacity == 32)
+		vf64_free(&b);
+
+		vf64 c = vf64_new(0);
+		ASSERT(c.data == NULL)
+		ASSERT(c.capacity == 0)
+	})
+	TEST("push", {
+		vf32 a = vf32_new(0);
+		int ok = 1;
+		for (int i = 0; i < 100000; ++i)
+		{
+			vf32_push(&a, (float)i);
+			ok &= ALIGNED(a.data, 32);
+			ok &= a.capacity % 8 == 0;
+		}
+		ASSERT(ok)
+		for (int i = 0; i < 100000; ++i)
+			ok &= a.data[i] == (float)i;
+		ASSERT(ok)
+		vf32_free(&a);
+	})
+	TEST("reserve", {
+		vf64 a = vf64_new(1);
+		vf64_push(&a, 1.f);
+		int ok = 1;
+		for (size_t cap = 2; cap < 50000; cap = cap * 5 / 2)
+		{
+			vf64_reserve(&a, cap);
+			ok &= ALIGNED(a.data, 64);
+			ok &= a.capacity >= cap;
+			ok &= a.capacity % 16 == 0;
+		}
+		ASSERT(ok)
+		ASSERT(a.data[0] == 1.f)
+		vf64_free(&a);
+	})
+	TEST("shrink_to_fit", {
+		vf64 a = vf64_new(1000);
+		for (int i = 0; i < 20; ++i)
+			vf64_push(&a, (float)i);
+		vf64_shrink_to_fit(&a);
+		ASSERT(ALIGNED(a.data, 64))
+		ASSERT(a.capacity == 32)
+		ASSERT(a.size == 20)
+		ASSERT(a.data[19] == 19.f)
+
+		vf64 b = vf64_clone(&a);
+		ASSERT(ALIGNED(b.data, 64))
+		ASSERT(b.size == 20)
+		ASSERT(b.data[19] == 19.f)
+		vf64_free(&a);
+		vf64_free(&b);
+	})
+})
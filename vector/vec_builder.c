@@ -0,0 +1,170 @@
+#include "test.h"
+#include "vector_string.h"
+
+#include <stdio.h>
+
+DATASTORE_VEC(char, vbuild)
+typedef struct vbuild vbuild;
+DATASTORE_VEC_STRING(vbuild)
+DATASTORE_VEC_IMPL_S(DATASTORE_VEC_STRING_TRAIT, vbuild, SETTINGS)
+DATASTORE_VEC_STRING_IMPL(vbuild)
+
+static uint64_t next(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/* Whether the builder formats `value` like `"%.*f"`, up to one unit of the last decimal */
+static int check_f64(double value, unsigned precision)
+{
+	char expected[512];
+	snprintf(expected, sizeof(expected), "%.*f", (int)precision, value);
+	vbuild b = vbuild_new(0);
+	vbuild_append_f64(&b, value, precision);
+	const char *got = vbuild_cstr(&b);
+	int ok = b.size == strlen(got);
+	if (strcmp(got, expected))
+	{
+		const double diff = strtod(got, NULL) - strtod(expected, NULL);
+		ok &= (diff < 0 ? -diff : diff) <= 1.5 / (double)datastore_str_pow10[precision];
+	}
+	vbuild_free(&b);
+	return ok;
+}
+
+TESTS(vec_builder, {
+	TEST("append", {
+		vbuild b = vbuild_new(0);
+		vbuild_append_cstr(&b, "");
+		ASSERT(b.size == 0)
+		ASSERT(!strcmp(vbuild_cstr(&b), ""))
+		vbuild_append_cstr(&b, "key");
+		vbuild_append_char(&b, '=');
+		vbuild_append_bytes(&b, "value, ignored", 5);
+		ASSERT(b.size == 9)
+		ASSERT(b.capacity > b.size)
+		ASSERT(!strcmp(vbuild_cstr(&b), "key=value"))
+		// The terminator is not part of the content
+		vbuild_push(&b, '!');
+		ASSERT(!strcmp(vbuild_cstr(&b), "key=value!"))
+
+		int ok = 1;
+		vbuild c = vbuild_new(0);
+		for (size_t i = 0; i < 1000; ++i)
+			vbuild_append_cstr(&c, "0123456789");
+		ok &= c.size == 10000;
+		for (size_t i = 0; i < c.size; ++i)
+			ok &= c.data[i] == (char)('0' + i % 10);
+		ASSERT(ok)
+		vbuild_free(&b);
+		vbuild_free(&c);
+	})
+	TEST("integers", {
+		int ok = 1;
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		char expected[32];
+		vbuild b = vbuild_new(0);
+		for (size_t i = 0; i < 2000; ++i)
+		{
+			// Powers of ten and their neighbours, then random widths
+			uint64_t value;
+			if (i < 60)
+				value = datastore_str_pow10[i / 3] + (uint64_t)(i % 3) - 1;
+			else
+				value = next(&state) >> (next(&state) % 64);
+			b.size = 0;
+			vbuild_append_u64(&b, value);
+			snprintf(expected, sizeof(expected), "%llu", (unsigned long long)value);
+			ok &= !strcmp(vbuild_cstr(&b), expected);
+
+			const int64_t svalue = (int64_t)(i & 1 ? value : ~value);
+			b.size = 0;
+			vbuild_append_i64(&b, svalue);
+			snprintf(expected, sizeof(expected), "%lld", (long long)svalue);
+			ok &= !strcmp(vbuild_cstr(&b), expected);
+		}
+		b.size = 0;
+		vbuild_append_u64(&b, UINT64_MAX);
+		vbuild_append_char(&b, ' ');
+		vbuild_append_i64(&b, INT64_MIN);
+		vbuild_append_char(&b, ' ');
+		vbuild_append_i64(&b, 0);
+		ok &= !strcmp(vbuild_cstr(&b), "18446744073709551615 -9223372036854775808 0");
+		ASSERT(ok)
+		vbuild_free(&b);
+	})
+	TEST("floats", {
+		int ok = 1;
+		uint64_t state = 0x2545F4914F6CDD1Dull;
+		for (size_t i = 0; i < 4000; ++i)
+		{
+			const double magnitude = (double)datastore_str_pow10[next(&state) % 16];
+			const double value = (double)(int64_t)(next(&state) >> 11) / (double)(1ull << 53) * magnitude
+				* (i & 1 ? -1. : 1.);
+			ok &= check_f64(value, (unsigned)(i % (DATASTORE_STR_F64_PRECISION + 1)));
+		}
+		ASSERT(ok)
+		ASSERT(check_f64(0.0, 0) && check_f64(0.999, 2) && check_f64(9.9999999999, 9) && check_f64(0.5, 3))
+		ASSERT(check_f64(999999999999999.0, 0) && check_f64(1e-12, 9))
+
+		vbuild b = vbuild_new(0);
+		vbuild_append_f64(&b, -0.0, 1);
+		vbuild_append_char(&b, ' ');
+		vbuild_append_f64(&b, 1.0 / 0.0, 3);
+		vbuild_append_char(&b, ' ');
+		vbuild_append_f64(&b, -1.0 / 0.0, 3);
+		vbuild_append_char(&b, ' ');
+		vbuild_append_f64(&b, 0.0 / 0.0, 3);
+		vbuild_append_char(&b, ' ');
+		vbuild_append_f64(&b, 1.5e20, 3);
+		vbuild_append_char(&b, ' ');
+		vbuild_append_f64(&b, 1e15, 0);
+		vbuild_append_char(&b, ' ');
+		vbuild_append_f64(&b, 9.9999996e15, 6);
+		ASSERT(!strcmp(vbuild_cstr(&b), "-0.0 inf -inf nan 1.500e+20 1e+15 1.000000e+16"))
+
+		// Larger precisions are clamped
+		b.size = 0;
+		vbuild_append_f64(&b, 123456789012345.0, 17);
+		vbuild_append_char(&b, ' ');
+		vbuild_append_f64(&b, -1.5e300, 40);
+		ASSERT(!strcmp(vbuild_cstr(&b), "123456789012345.000000000 -1.500000000e+300"))
+
+		// Scientific notation keeps `precision` significant decimals
+		for (size_t i = 0; i < 1000; ++i)
+		{
+			const double value = (double)(next(&state) >> 11) * 1e15 * (double)(1 + i % 7);
+			b.size = 0;
+			vbuild_append_f64(&b, value, 6);
+			const double error = (strtod(vbuild_cstr(&b), NULL) - value) / value;
+			ok &= (error < 0 ? -error : error) < 1e-6;
+		}
+		b.size = 0;
+		vbuild_append_f64(&b, 1.7976931348623157e308, 9);
+		ok &= !strcmp(vbuild_cstr(&b), "1.797693135e+308");
+		ASSERT(ok)
+		vbuild_free(&b);
+	})
+	TEST("into_cstr", {
+		vbuild b = vbuild_new(0);
+		// Room for the content and the terminator, reserved once
+		vbuild_reserve(&b, 11 + 1);
+		char *data = b.data;
+		vbuild_append_cstr(&b, "id=");
+		vbuild_append_u64(&b, 12345678);
+		ASSERT(b.data == data)
+		char *cstr = vbuild_into_cstr(&b);
+		ASSERT(cstr == data)
+		ASSERT(!strcmp(cstr, "id=12345678"))
+		ASSERT(b.data == NULL && b.capacity == 0 && b.size == 0)
+		iso_free(cstr);
+
+		cstr = vbuild_into_cstr(&b);
+		ASSERT(cstr != NULL && !strcmp(cstr, ""))
+		iso_free(cstr);
+		vbuild_free(&b);
+	})
+})
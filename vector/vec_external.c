@@ -0,0 +1,176 @@
+#define _GNU_SOURCE
+// Small blocks, so that small budgets still merge many runs at once
+#define DATASTORE_VEC_EXTERNAL_BLOCK 256
+#include "test.h"
+#include "vector_external.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+struct ext_record
+{
+	uint32_t key;
+	uint32_t index;
+};
+#define RECORD_TRAIT(X) \
+	X(TYPE, struct ext_record) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (lhs->key > rhs->key) - (lhs->key < rhs->key); })
+DATASTORE_VEC(int, vext_i)
+typedef struct vext_i vext_i;
+DATASTORE_VEC_EXTERNAL_SORT(INT_TRAIT, vext_i)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vext_i, SETTINGS)
+DATASTORE_VEC_EXTERNAL_SORT_IMPL(INT_TRAIT, vext_i)
+DATASTORE_VEC(struct ext_record, vext_r)
+typedef struct vext_r vext_r;
+DATASTORE_VEC_EXTERNAL_SORT(RECORD_TRAIT, vext_r)
+DATASTORE_VEC_IMPL_S(RECORD_TRAIT, vext_r, SETTINGS)
+DATASTORE_VEC_EXTERNAL_SORT_IMPL(RECORD_TRAIT, vext_r)
+
+static unsigned next(unsigned *state)
+{
+	*state = *state * 1103515245u + 12345u;
+	return *state >> 16;
+}
+
+static struct ext_record make_ext_record(uint32_t key, uint32_t index)
+{
+	struct ext_record record = { key, index };
+	return record;
+}
+
+/* Sorts `size` pseudo-random ints with a budget of `budget` bytes, checks the order and the sum */
+static int sort_ints(size_t size, size_t budget, unsigned seed)
+{
+	struct vext_i_external sorter = vext_i_external_new(budget, NULL);
+	int ok = 1;
+	long long total = 0;
+	for (size_t i = 0; i < size; ++i)
+	{
+		const int value = (int)(next(&seed) % 100000) - 50000;
+		total += value;
+		ok &= vext_i_external_push(&sorter, value);
+	}
+	ok &= vext_i_external_finish(&sorter);
+	size_t count = 0;
+	int previous = INT32_MIN;
+	int value;
+	while (vext_i_external_next(&sorter, &value))
+	{
+		ok &= previous <= value;
+		previous = value;
+		total -= value;
+		++count;
+	}
+	ok &= count == size && total == 0 && sorter.error == 0;
+	vext_i_external_free(&sorter);
+	return ok;
+}
+
+TESTS(vec_external, {
+	TEST("in_memory", {
+		ASSERT(sort_ints(0, 1 << 16, 1))
+		ASSERT(sort_ints(1000, 1 << 16, 2))
+		struct vext_i_external sorter = vext_i_external_new(1 << 16, NULL);
+		vext_i_external_push(&sorter, 1);
+		ASSERT(vext_i_external_finish(&sorter))
+		// Nothing spilled
+		ASSERT(sorter.fd == -1)
+		ASSERT(!vext_i_external_push(&sorter, 0))
+		int value = 0;
+		ASSERT(vext_i_external_next(&sorter, &value) && value == 1)
+		ASSERT(!vext_i_external_next(&sorter, &value))
+		vext_i_external_free(&sorter);
+	})
+	TEST("spill", {
+		// A single spilled run, then a few runs merged at once
+		ASSERT(sort_ints(1025, 4096, 3))
+		ASSERT(sort_ints(10000, 4096, 4))
+		struct vext_i_external sorter = vext_i_external_new(4096, NULL);
+		for (int i = 0; i < 5000; ++i)
+			vext_i_external_push(&sorter, 5000 - i);
+		ASSERT(sorter.runs.size == 4)
+		ASSERT(vext_i_external_finish(&sorter))
+		// The input is closed, the merge output is untouched
+		const int late[2] = { 0, -1 };
+		ASSERT(!vext_i_external_push(&sorter, 0))
+		ASSERT(!vext_i_external_push_many(&sorter, late, 2))
+		int value = 0;
+		int ok = 1;
+		for (int i = 1; i <= 5000; ++i)
+			ok &= vext_i_external_next(&sorter, &value) && value == i;
+		ASSERT(ok)
+		ASSERT(!vext_i_external_next(&sorter, &value))
+		vext_i_external_free(&sorter);
+	})
+	TEST("merge_passes", {
+		// Fan-in of 15, then of 2 with the smallest budget
+		ASSERT(sort_ints(100000, 4096, 5))
+		ASSERT(sort_ints(1000, 1, 6))
+	})
+	TEST("push_many", {
+		int values[3000];
+		unsigned seed = 7;
+		for (size_t i = 0; i < 3000; ++i)
+			values[i] = (int)next(&seed);
+		struct vext_i_external sorter = vext_i_external_new(1000 * sizeof(int), NULL);
+		ASSERT(vext_i_external_push_many(&sorter, values, 1500))
+		ASSERT(vext_i_external_push_many(&sorter, values + 1500, 1500))
+		ASSERT(vext_i_external_finish(&sorter))
+		int ok = 1;
+		int previous = INT32_MIN;
+		size_t count = 0;
+		int value;
+		while (vext_i_external_next(&sorter, &value))
+		{
+			ok &= previous <= value;
+			previous = value;
+			++count;
+		}
+		ASSERT(ok && count == 3000)
+		vext_i_external_free(&sorter);
+	})
+	TEST("write_fd", {
+		const size_t budgets[] = { 1 << 20, 512 };
+		int ok = 1;
+		for (size_t b = 0; b < 2; ++b)
+		{
+			struct vext_r_external sorter = vext_r_external_new(budgets[b], NULL);
+			unsigned seed = 8;
+			for (uint32_t i = 0; i < 20000; ++i)
+				ok &= vext_r_external_push(&sorter, make_ext_record(next(&seed) % 64, i));
+			ok &= vext_r_external_finish(&sorter);
+			const int fd = datastore_external_tmpfile(NULL);
+			ok &= fd >= 0 && vext_r_external_write_fd(&sorter, fd);
+			vext_r_external_free(&sorter);
+
+			struct ext_record *records = malloc(20000 * sizeof(*records));
+			ok &= records && datastore_external_pread(fd, records, 20000 * sizeof(*records), 0);
+			// Every index comes out once, keys in order
+			unsigned char *seen = calloc(20000, 1);
+			for (size_t i = 0; ok && seen && i < 20000; ++i)
+			{
+				ok &= i == 0 || records[i - 1].key <= records[i].key;
+				ok &= records[i].index < 20000 && !seen[records[i].index];
+				if (ok)
+					seen[records[i].index] = 1;
+			}
+			free(seen);
+			free(records);
+			close(fd);
+		}
+		ASSERT(ok)
+	})
+	TEST("bad_dir", {
+		struct vext_i_external sorter = vext_i_external_new(16, "/nonexistent/datastore");
+		int ok = 1;
+		for (int i = 0; ok && i < 100; ++i)
+			ok &= vext_i_external_push(&sorter, i);
+		ASSERT(!ok)
+		ASSERT(sorter.error == ENOENT)
+		vext_i_external_free(&sorter);
+	})
+})
@@ -0,0 +1,174 @@
+#define _GNU_SOURCE
+#include "test.h"
+#include "vector_file.h"
+
+#define LONG_TRAIT(X) \
+	X(TYPE, long) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_VEC(long, vfile)
+typedef struct vfile vfile;
+DATASTORE_VEC_FILE(LONG_TRAIT, vfile)
+DATASTORE_VEC_IMPL_S(LONG_TRAIT, vfile, DATASTORE_VEC_SETTINGS_FILE)
+DATASTORE_VEC_FILE_IMPL(LONG_TRAIT, vfile)
+DATASTORE_VEC(long, vfile_heap)
+typedef struct vfile_heap vfile_heap;
+DATASTORE_VEC_IO(LONG_TRAIT, vfile_heap)
+DATASTORE_VEC_IMPL_S(LONG_TRAIT, vfile_heap, SETTINGS)
+DATASTORE_VEC_IO_IMPL(LONG_TRAIT, vfile_heap)
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_VEC(int, vfile_int)
+typedef struct vfile_int vfile_int;
+DATASTORE_VEC_FILE(INT_TRAIT, vfile_int)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vfile_int, DATASTORE_VEC_SETTINGS_FILE)
+DATASTORE_VEC_FILE_IMPL(INT_TRAIT, vfile_int)
+
+static char g_path[] = "/tmp/datastore-vec-file-XXXXXX";
+
+/* Picks a new path for the test file, which does not exist yet */
+static const char *tmp_path(void)
+{
+	memcpy(g_path + sizeof(g_path) - 7, "XXXXXX", 6);
+	const int fd = mkstemp(g_path);
+	if (fd < 0)
+		abort();
+	close(fd);
+	unlink(g_path);
+	return g_path;
+}
+
+static int check_sequence(const vfile *v, size_t size)
+{
+	int ok = v->size == size;
+	for (size_t i = 0; ok && i < size; ++i)
+		ok &= v->data[i] == (long)(i * i);
+	return ok;
+}
+
+TESTS(vec_file, {
+	TEST("persist", {
+		const char *path = tmp_path();
+		vfile v = vfile_new(0);
+		ASSERT(vfile_open_file(&v, path, 0) == DATASTORE_VEC_IO_OK)
+		ASSERT(v.size == 0 && v.capacity == 0)
+		for (size_t i = 0; i < 100000; ++i)
+			vfile_push(&v, (long)(i * i));
+		ASSERT(vfile_sync(&v) == DATASTORE_VEC_IO_OK)
+		vfile_push(&v, -1);
+		vfile_free(&v);
+
+		// The last push was not synced
+		ASSERT(vfile_open_file(&v, path, 0) == DATASTORE_VEC_IO_OK)
+		ASSERT(check_sequence(&v, 100000))
+		ASSERT(v.capacity >= 100001)
+		for (size_t i = 100000; i < 150000; ++i)
+			vfile_push(&v, (long)(i * i));
+		ASSERT(vfile_sync(&v) == DATASTORE_VEC_IO_OK)
+		vfile_free(&v);
+		ASSERT(vfile_open_file(&v, path, 0) == DATASTORE_VEC_IO_OK)
+		ASSERT(check_sequence(&v, 150000))
+		// Opening again releases the previous mapping
+		ASSERT(vfile_open_file(&v, path, 0) == DATASTORE_VEC_IO_OK)
+		ASSERT(check_sequence(&v, 150000))
+		// Errors leave the vector bound to its file
+		ASSERT(vfile_open_file(&v, "/nonexistent/datastore", 0) == DATASTORE_VEC_IO_ERRNO)
+		ASSERT(check_sequence(&v, 150000))
+		vfile_free(&v);
+		unlink(path);
+	})
+	TEST("stable", {
+		const char *path = tmp_path();
+		vfile v = vfile_new(0);
+		ASSERT(vfile_open_file(&v, path, DATASTORE_VEC_FILE_STABLE) == DATASTORE_VEC_IO_OK)
+		vfile_push(&v, 0);
+		const long *first = v.data;
+		int ok = 1;
+		for (size_t i = 1; i < 200000; ++i)
+		{
+			vfile_push(&v, (long)(i * i));
+			ok &= v.data == first;
+		}
+		ASSERT(ok)
+		vfile_reserve(&v, 1000000);
+		ASSERT(v.data == first)
+		vfile_shrink_to_fit(&v);
+		ASSERT(v.data == first && v.capacity == 200000)
+		ASSERT(check_sequence(&v, 200000))
+		ASSERT(vfile_sync(&v) == DATASTORE_VEC_IO_OK)
+		vfile_free(&v);
+		ASSERT(vfile_open_file(&v, path, DATASTORE_VEC_FILE_STABLE) == DATASTORE_VEC_IO_OK)
+		ASSERT(check_sequence(&v, 200000))
+		vfile_free(&v);
+		unlink(path);
+	})
+	TEST("mark_dirty", {
+		const char *path = tmp_path();
+		vfile v = vfile_new(0);
+		ASSERT(vfile_open_file(&v, path, 0) == DATASTORE_VEC_IO_OK)
+		for (long i = 0; i < 10000; ++i)
+			vfile_push(&v, 0);
+		ASSERT(vfile_sync(&v) == DATASTORE_VEC_IO_OK)
+		// Counters updated in place
+		for (size_t i = 5000; i < 5010; ++i)
+			v.data[i] += 7;
+		vfile_mark_dirty(&v, 5000, 5010);
+		ASSERT(vfile_sync(&v) == DATASTORE_VEC_IO_OK)
+		vfile_free(&v);
+		ASSERT(vfile_open_file(&v, path, 0) == DATASTORE_VEC_IO_OK)
+		ASSERT(v.size == 10000 && v.data[5009] == 7 && v.data[5010] == 0 && v.data[4999] == 0)
+		vfile_free(&v);
+		unlink(path);
+	})
+	TEST("format", {
+		const char *path = tmp_path();
+		vfile v = vfile_new(0);
+		ASSERT(vfile_open_file(&v, path, 0) == DATASTORE_VEC_IO_OK)
+		for (size_t i = 0; i < 1000; ++i)
+			vfile_push(&v, (long)(i * i));
+		ASSERT(vfile_sync(&v) == DATASTORE_VEC_IO_OK)
+		vfile_free(&v);
+
+		// The file has spare capacity after the elements, read_fd stops at the count
+		vfile_heap heap = vfile_heap_new(0);
+		int fd = open(path, O_RDONLY);
+		ASSERT(vfile_heap_read_fd(&heap, fd) == DATASTORE_VEC_IO_OK)
+		close(fd);
+		ASSERT(heap.size == 1000 && heap.data[999] == 999 * 999)
+
+		// A file written by write_fd opens as a persistent vector
+		unlink(path);
+		fd = open(path, O_RDWR | O_CREAT, 0644);
+		ASSERT(vfile_heap_write_fd(&heap, fd) == DATASTORE_VEC_IO_OK)
+		close(fd);
+		ASSERT(vfile_open_file(&v, path, 0) == DATASTORE_VEC_IO_OK)
+		ASSERT(check_sequence(&v, 1000) && v.capacity == 1000)
+		vfile_push(&v, 0);
+		ASSERT(vfile_sync(&v) == DATASTORE_VEC_IO_OK)
+		vfile_free(&v);
+		vfile_heap_free(&heap);
+
+		vfile_int ints = vfile_int_new(0);
+		ASSERT(vfile_int_open_file(&ints, path, 0) == DATASTORE_VEC_IO_ELEM_SIZE)
+		ASSERT(truncate(path, 10) == 0)
+		ASSERT(vfile_open_file(&v, path, 0) == DATASTORE_VEC_IO_TRUNCATED)
+		unlink(path);
+		ASSERT(vfile_open_file(&v, "/nonexistent/datastore", 0) == DATASTORE_VEC_IO_ERRNO)
+	})
+	TEST("anonymous", {
+		vfile v = vfile_new(10);
+		for (size_t i = 0; i < 5000; ++i)
+			vfile_push(&v, (long)(i * i));
+		vfile c = vfile_clone(&v);
+		ASSERT(check_sequence(&c, 5000))
+		ASSERT(vfile_sync(&c) == DATASTORE_VEC_IO_OK)
+		vfile_free(&c);
+		vfile_free(&v);
+		vfile e = vfile_new(0);
+		vfile_push(&e, 0);
+		ASSERT(check_sequence(&e, 1))
+		vfile_free(&e);
+	})
+})
@@ -0,0 +1,253 @@
+#define _GNU_SOURCE
+#include "test.h"
+#include "vector_io.h"
+
+#include <stdio.h>
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+struct io_point
+{
+	double x;
+	double y;
+	int id;
+};
+#define POINT_TRAIT(X) \
+	X(TYPE, struct io_point) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_VEC(int, vio_i)
+typedef struct vio_i vio_i;
+DATASTORE_VEC_IO(INT_TRAIT, vio_i)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vio_i, SETTINGS)
+DATASTORE_VEC_IO_IMPL(INT_TRAIT, vio_i)
+DATASTORE_VEC(int, vio_view)
+typedef struct vio_view vio_view;
+DATASTORE_VEC_MAP(INT_TRAIT, vio_view)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vio_view, DATASTORE_VEC_SETTINGS_MAPPED)
+DATASTORE_VEC_MAP_IMPL(INT_TRAIT, vio_view)
+DATASTORE_VEC(struct io_point, vio_p)
+typedef struct vio_p vio_p;
+DATASTORE_VEC_IO(POINT_TRAIT, vio_p)
+DATASTORE_VEC_IMPL_S(POINT_TRAIT, vio_p, SETTINGS)
+DATASTORE_VEC_IO_IMPL(POINT_TRAIT, vio_p)
+
+static char g_path[] = "/tmp/datastore-vec-io-XXXXXX";
+
+/* Creates the test file, returns a descriptor positioned at its start */
+static int open_tmp(void)
+{
+	memcpy(g_path + sizeof(g_path) - 7, "XXXXXX", 6);
+	return mkstemp(g_path);
+}
+
+static vio_i make_ints(size_t size)
+{
+	vio_i v = vio_i_new(size);
+	for (size_t i = 0; i < size; ++i)
+		vio_i_push(&v, (int)(i * 2654435761u));
+	return v;
+}
+
+/* Overwrites `size` bytes at `offset` of the test file */
+static void patch(long offset, const void *data, size_t size)
+{
+	FILE *file = fopen(g_path, "r+b");
+	if (!file)
+		abort();
+	fseek(file, offset, SEEK_SET);
+	fwrite(data, 1, size, file);
+	fclose(file);
+}
+
+static enum datastore_vec_io read_back(vio_i *out)
+{
+	const int fd = open(g_path, O_RDONLY);
+	const enum datastore_vec_io status = vio_i_read_fd(out, fd);
+	close(fd);
+	return status;
+}
+
+TESTS(vec_io, {
+	TEST("checksum", {
+		unsigned char bytes[100];
+		for (size_t i = 0; i < sizeof(bytes); ++i)
+			bytes[i] = (unsigned char)i;
+		ASSERT(datastore_vec_checksum("", 0) == 0xEF46DB3751D8E999ull)
+		ASSERT(datastore_vec_checksum("a", 1) == 0xD24EC4F1A98C6E5Bull)
+		ASSERT(datastore_vec_checksum("abc", 3) == 0x44BC2CF5AD770999ull)
+		ASSERT(datastore_vec_checksum(bytes, sizeof(bytes)) == 0x6AC1E58032166597ull)
+	})
+	TEST("roundtrip", {
+		vio_i v = make_ints(1000);
+		int fd = open_tmp();
+		ASSERT(fd >= 0)
+		ASSERT(vio_i_write_fd(&v, fd) == DATASTORE_VEC_IO_OK)
+		vio_i empty = vio_i_new(0);
+		ASSERT(vio_i_write_fd(&empty, fd) == DATASTORE_VEC_IO_OK)
+		ASSERT(lseek(fd, 0, SEEK_END) == 2 * DATASTORE_VEC_FILE_HEADER + 1000 * sizeof(int))
+		lseek(fd, 0, SEEK_SET);
+
+		// Appends to the elements already there
+		vio_i w = vio_i_new(0);
+		vio_i_push(&w, -1);
+		ASSERT(vio_i_read_fd(&w, fd) == DATASTORE_VEC_IO_OK)
+		ASSERT(w.size == 1001)
+		ASSERT(w.data[0] == -1)
+		ASSERT(!memcmp(w.data + 1, v.data, 1000 * sizeof(int)))
+		ASSERT(vio_i_read_fd(&empty, fd) == DATASTORE_VEC_IO_OK)
+		ASSERT(empty.size == 0)
+		// End of file
+		ASSERT(vio_i_read_fd(&empty, fd) == DATASTORE_VEC_IO_FORMAT)
+		close(fd);
+		unlink(g_path);
+		vio_i_free(&w);
+		vio_i_free(&empty);
+		vio_i_free(&v);
+	})
+	TEST("structs", {
+		vio_p v = vio_p_new(0);
+		for (int i = 0; i < 100; ++i)
+		{
+			struct io_point point;
+			memset(&point, 0, sizeof(point));
+			point.x = i * 0.5;
+			point.y = -i;
+			point.id = i;
+			vio_p_push(&v, point);
+		}
+		int fd = open_tmp();
+		ASSERT(vio_p_write_fd(&v, fd) == DATASTORE_VEC_IO_OK)
+		lseek(fd, 0, SEEK_SET);
+		vio_p w = vio_p_new(0);
+		ASSERT(vio_p_read_fd(&w, fd) == DATASTORE_VEC_IO_OK)
+		ASSERT(w.size == 100 && w.data[42].x == 21.0 && w.data[42].id == 42)
+		// Reading points as ints
+		lseek(fd, 0, SEEK_SET);
+		vio_i ints = vio_i_new(0);
+		ASSERT(vio_i_read_fd(&ints, fd) == DATASTORE_VEC_IO_ELEM_SIZE)
+		ASSERT(ints.size == 0)
+		close(fd);
+		unlink(g_path);
+		vio_i_free(&ints);
+		vio_p_free(&w);
+		vio_p_free(&v);
+	})
+	TEST("corruption", {
+		vio_i v = make_ints(100);
+		int fd = open_tmp();
+		ASSERT(vio_i_write_fd(&v, fd) == DATASTORE_VEC_IO_OK)
+		close(fd);
+		vio_i w = vio_i_new(0);
+		const int bad = 12345;
+		patch(DATASTORE_VEC_FILE_HEADER + 40, &bad, sizeof(bad));
+		ASSERT(read_back(&w) == DATASTORE_VEC_IO_CHECKSUM)
+		ASSERT(w.size == 0)
+		patch(DATASTORE_VEC_FILE_HEADER + 40, v.data + 10, sizeof(int));
+		ASSERT(read_back(&w) == DATASTORE_VEC_IO_OK)
+		w.size = 0;
+
+		const uint32_t swapped = 0x04030201u;
+		patch(12, &swapped, sizeof(swapped));
+		ASSERT(read_back(&w) == DATASTORE_VEC_IO_ENDIAN)
+		const uint32_t endian = 0x01020304u;
+		patch(12, &endian, sizeof(endian));
+		const uint32_t version = 2;
+		patch(8, &version, sizeof(version));
+		ASSERT(read_back(&w) == DATASTORE_VEC_IO_FORMAT)
+		patch(8, "\1\0\0\0", 4);
+		patch(0, "XXXXX", 5);
+		ASSERT(read_back(&w) == DATASTORE_VEC_IO_FORMAT)
+		patch(0, "DSVEC", 5);
+		ASSERT(read_back(&w) == DATASTORE_VEC_IO_OK)
+		w.size = 0;
+
+		// Sizes past the end of the file are rejected before allocating
+		const size_t cap = w.capacity;
+		const uint64_t huge = UINT64_MAX / 8;
+		patch(24, &huge, sizeof(huge));
+		ASSERT(read_back(&w) == DATASTORE_VEC_IO_TRUNCATED)
+		ASSERT(w.capacity == cap)
+		const uint64_t size = 100;
+		patch(24, &size, sizeof(size));
+
+		ASSERT(truncate(g_path, DATASTORE_VEC_FILE_HEADER + 99 * sizeof(int)) == 0)
+		ASSERT(read_back(&w) == DATASTORE_VEC_IO_TRUNCATED)
+		ASSERT(truncate(g_path, 10) == 0)
+		ASSERT(read_back(&w) == DATASTORE_VEC_IO_TRUNCATED)
+		ASSERT(w.size == 0)
+		unlink(g_path);
+		vio_i_free(&w);
+		vio_i_free(&v);
+	})
+	TEST("pipe", {
+		vio_i v = make_ints(1000);
+		int fds[2];
+		ASSERT(pipe(fds) == 0)
+		ASSERT(vio_i_write_fd(&v, fds[1]) == DATASTORE_VEC_IO_OK)
+		// Claims far more elements than the pipe holds
+		struct datastore_vec_file_header header = datastore_vec_file_header(v.data, sizeof(int), 1000);
+		header.size = UINT64_MAX / 8;
+		ASSERT(write(fds[1], &header, sizeof(header)) == sizeof(header))
+		ASSERT(write(fds[1], v.data, 10 * sizeof(int)) == 10 * sizeof(int))
+		close(fds[1]);
+		vio_i w = vio_i_new(0);
+		ASSERT(vio_i_read_fd(&w, fds[0]) == DATASTORE_VEC_IO_OK)
+		ASSERT(w.size == 1000 && !memcmp(w.data, v.data, 1000 * sizeof(int)))
+		ASSERT(vio_i_read_fd(&w, fds[0]) == DATASTORE_VEC_IO_TRUNCATED)
+		ASSERT(w.size == 1000)
+		ASSERT(w.capacity * sizeof(int) <= 2 * (1000 * sizeof(int) + DATASTORE_VEC_IO_CHUNK + sizeof(int)))
+		close(fds[0]);
+		vio_i_free(&w);
+		vio_i_free(&v);
+	})
+	TEST("map_file", {
+		vio_i v = make_ints(5000);
+		int fd = open_tmp();
+		ASSERT(vio_i_write_fd(&v, fd) == DATASTORE_VEC_IO_OK)
+		close(fd);
+
+		vio_view view;
+		ASSERT(vio_view_map_file(&view, g_path, true) == DATASTORE_VEC_IO_OK)
+		ASSERT(view.size == 5000 && view.capacity == 5000)
+		ASSERT(((uintptr_t)view.data & 63) == 0)
+		ASSERT(!memcmp(view.data, v.data, 5000 * sizeof(int)))
+		// Growing copies the view out of the file
+		vio_view_push(&view, 7);
+		view.data[0] = 1;
+		ASSERT(view.size == 5001 && view.data[5000] == 7)
+		vio_view_free(&view);
+		ASSERT(view.data == NULL)
+
+		vio_view again;
+		ASSERT(vio_view_map_file(&again, g_path, false) == DATASTORE_VEC_IO_OK)
+		ASSERT(again.data[0] == v.data[0])
+		vio_view clone = vio_view_clone(&again);
+		ASSERT(clone.size == 5000 && clone.data[4999] == v.data[4999])
+		vio_view_free(&clone);
+		vio_view_free(&again);
+
+		const int bad = 0;
+		patch(DATASTORE_VEC_FILE_HEADER + 4, &bad, sizeof(bad));
+		ASSERT(vio_view_map_file(&again, g_path, true) == DATASTORE_VEC_IO_CHECKSUM)
+		ASSERT(vio_view_map_file(&again, g_path, false) == DATASTORE_VEC_IO_OK)
+		vio_view_free(&again);
+		ASSERT(truncate(g_path, DATASTORE_VEC_FILE_HEADER + 100) == 0)
+		ASSERT(vio_view_map_file(&again, g_path, false) == DATASTORE_VEC_IO_TRUNCATED)
+		unlink(g_path);
+		ASSERT(vio_view_map_file(&again, g_path, false) == DATASTORE_VEC_IO_ERRNO)
+		ASSERT(errno == ENOENT)
+
+		vio_i empty = vio_i_new(0);
+		fd = open_tmp();
+		ASSERT(vio_i_write_fd(&empty, fd) == DATASTORE_VEC_IO_OK)
+		close(fd);
+		ASSERT(vio_view_map_file(&again, g_path, true) == DATASTORE_VEC_IO_OK)
+		ASSERT(again.size == 0)
+		vio_view_free(&again);
+		unlink(g_path);
+		vio_i_free(&v);
+	})
+})
@@ -0,0 +1,142 @@
+#define _GNU_SOURCE
+#include "test.h"
+#include "vector_mmap.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_VEC(int, vmi)
+typedef struct vmi vmi;
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vmi, DATASTORE_VEC_SETTINGS_MREMAP)
+
+DATASTORE_VEC(int, vri)
+typedef struct vri vri;
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vri, DATASTORE_VEC_SETTINGS_MMAP_RESERVE)
+
+struct page
+{
+	char bytes[5000];
+};
+#define PAGE_TRAIT(X) \
+	X(TYPE, struct page) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_VEC(struct page, vpage)
+typedef struct vpage vpage;
+DATASTORE_VEC_IMPL_S(PAGE_TRAIT, vpage, DATASTORE_VEC_SETTINGS_MREMAP)
+
+TESTS(vec_mmap, {
+	TEST("mremap new", {
+		const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+		vmi a = vmi_new(3);
+		ASSERT(a.data != NULL)
+		ASSERT((uintptr_t)a.data % page == 0)
+		// The whole page is usable
+		ASSERT(a.capacity == page / sizeof(int))
+		ASSERT(a.size == 0)
+		vmi_free(&a);
+		ASSERT(a.data == NULL)
+		ASSERT(a.capacity == 0)
+
+		vmi b = vmi_new(0);
+		ASSERT(b.data == NULL)
+		vmi_free(&b);
+	})
+	TEST("mremap push", {
+		vmi a = vmi_new(0);
+		for (int i = 0; i < 1000000; ++i)
+			vmi_push(&a, i);
+		ASSERT(a.size == 1000000)
+		ASSERT(a.capacity >= a.size)
+		int ok = 1;
+		for (int i = 0; i < 1000000; ++i)
+			ok &= a.data[i] == i;
+		ASSERT(ok)
+
+		vmi b = vmi_clone(&a);
+		ASSERT(b.size == a.size)
+		ASSERT(!memcmp(a.data, b.data, a.size * sizeof(int)))
+		vmi_free(&b);
+
+		vmi_reserve(&a, 4000000);
+		ASSERT(a.capacity >= 4000000)
+		ASSERT(a.data[999999] == 999999)
+		vmi_free(&a);
+	})
+	TEST("mremap shrink_to_fit", {
+		vmi a = vmi_new(100000);
+		for (int i = 0; i < 10; ++i)
+			vmi_push(&a, i);
+		vmi_shrink_to_fit(&a);
+		ASSERT(a.size == 10)
+		ASSERT(a.capacity >= 10)
+		ASSERT(a.capacity < 100000)
+		ASSERT(a.data[0] == 0)
+		ASSERT(a.data[9] == 9)
+		while (a.size)
+			vmi_pop(&a);
+		vmi_shrink_to_fit(&a);
+		ASSERT(a.data == NULL)
+		ASSERT(a.capacity == 0)
+	})
+	TEST("mremap large elements", {
+		vpage a = vpage_new(1);
+		ASSERT(a.capacity == 1)
+		struct page p;
+		for (int i = 0; i < 9; ++i)
+		{
+			memset(p.bytes, i, sizeof(p.bytes));
+			vpage_push(&a, p);
+		}
+		ASSERT(a.size == 9)
+		int ok = 1;
+		for (int i = 0; i < 9; ++i)
+			ok &= a.data[i].bytes[4999] == i;
+		ASSERT(ok)
+		vpage_free(&a);
+	})
+	TEST("reserve stable address", {
+		vri a = vri_new(1);
+		ASSERT(a.data != NULL)
+		int *const base = a.data;
+		for (int i = 0; i < 1000000; ++i)
+			vri_push(&a, i);
+		ASSERT(a.data == base)
+		ASSERT(a.size == 1000000)
+		int ok = 1;
+		for (int i = 0; i < 1000000; ++i)
+			ok &= a.data[i] == i;
+		ASSERT(ok)
+
+		vri_reserve(&a, 8000000);
+		ASSERT(a.data == base)
+		ASSERT(a.capacity >= 8000000)
+
+		for (int i = 0; i < 999990; ++i)
+			vri_pop(&a);
+		vri_shrink_to_fit(&a);
+		ASSERT(a.data == base)
+		ASSERT(a.size == 10)
+		ASSERT(a.data[9] == 9)
+		// Committing again after a shrink
+		for (int i = 10; i < 100000; ++i)
+			vri_push(&a, i);
+		ASSERT(a.data == base)
+		ASSERT(a.data[99999] == 99999)
+		vri_free(&a);
+		ASSERT(a.data == NULL)
+	})
+	TEST("reserve from empty", {
+		vri a = vri_new(0);
+		ASSERT(a.data == NULL)
+		vri_push(&a, 42);
+		ASSERT(a.data != NULL)
+		ASSERT(a.data[0] == 42)
+		vri b = vri_clone(&a);
+		ASSERT(b.data != a.data)
+		ASSERT(b.data[0] == 42)
+		vri_free(&a);
+		vri_free(&b);
+	})
+})
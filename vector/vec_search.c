@@ -0,0 +1,117 @@
+#include "test.h"
+#include "vector_search.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+#define STR_TRAIT(X) \
+	X(TYPE, const char *) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = strcmp(*lhs, *rhs); })
+DATASTORE_VEC(int, vsearch_i)
+typedef struct vsearch_i vsearch_i;
+DATASTORE_VEC_SEARCH(INT_TRAIT, vsearch_i)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vsearch_i, SETTINGS)
+DATASTORE_VEC_SEARCH_IMPL(INT_TRAIT, vsearch_i)
+DATASTORE_VEC(const char *, vsearch_s)
+typedef struct vsearch_s vsearch_s;
+DATASTORE_VEC_SEARCH(STR_TRAIT, vsearch_s)
+DATASTORE_VEC_IMPL_S(STR_TRAIT, vsearch_s, SETTINGS)
+DATASTORE_VEC_SEARCH_IMPL(STR_TRAIT, vsearch_s)
+
+/* Reference lower bound */
+static size_t linear_lower_bound(const vsearch_i *v, int value)
+{
+	size_t i = 0;
+	while (i < v->size && v->data[i] < value)
+		++i;
+	return i;
+}
+
+/* Sorted vector of `size` elements, each even value from 0 repeated `1 + value % 3` times */
+static vsearch_i sorted_vec(size_t size)
+{
+	vsearch_i v = vsearch_i_new(0);
+	for (int value = 0; v.size < size; value += 2)
+		for (int r = 0; r <= value % 3 && v.size < size; ++r)
+			vsearch_i_push(&v, value);
+	return v;
+}
+
+TESTS(vec_search, {
+	TEST("lower_upper_bound", {
+		int ok = 1;
+		for (size_t size = 0; size < 70; ++size)
+		{
+			vsearch_i v = sorted_vec(size);
+			const int last = size ? v.data[size - 1] : 0;
+			for (int value = -1; value <= last + 2; ++value)
+			{
+				const size_t lower = linear_lower_bound(&v, value);
+				ok &= vsearch_i_lower_bound(&v, value) == lower;
+				ok &= vsearch_i_upper_bound(&v, value) == linear_lower_bound(&v, value + 1);
+				const struct datastore_vec_range range = vsearch_i_equal_range(&v, value);
+				ok &= range.begin == lower && range.end == linear_lower_bound(&v, value + 1);
+			}
+			vsearch_i_free(&v);
+		}
+		ASSERT(ok)
+	})
+	TEST("strings", {
+		static const char *words[] = { "apple", "banana", "banana", "cherry", "fig", "pear" };
+		vsearch_s v = vsearch_s_new(0);
+		for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i)
+			vsearch_s_push(&v, words[i]);
+		ASSERT(vsearch_s_lower_bound(&v, "banana") == 1)
+		ASSERT(vsearch_s_upper_bound(&v, "banana") == 3)
+		ASSERT(vsearch_s_lower_bound(&v, "date") == 4)
+		ASSERT(vsearch_s_lower_bound(&v, "zucchini") == 6)
+		ASSERT(vsearch_s_equal_range(&v, "kiwi").begin == vsearch_s_equal_range(&v, "kiwi").end)
+		vsearch_s_free(&v);
+	})
+	TEST("lower_bound_many", {
+		vsearch_i v = sorted_vec(1000);
+		int values[300];
+		size_t out[300];
+		// Ascending, with repeats and values past the end
+		for (int i = 0; i < 300; ++i)
+			values[i] = i * 5 - 10;
+		vsearch_i_lower_bound_many(&v, values, 300, out);
+		int ok = 1;
+		for (size_t i = 0; i < 300; ++i)
+			ok &= out[i] == linear_lower_bound(&v, values[i]);
+		ASSERT(ok)
+		// Out of order values are still correct
+		for (int i = 0; i < 300; ++i)
+			values[i] = (i * 7919) % 800;
+		vsearch_i_lower_bound_many(&v, values, 300, out);
+		for (size_t i = 0; i < 300; ++i)
+			ok &= out[i] == linear_lower_bound(&v, values[i]);
+		ASSERT(ok)
+		vsearch_i_free(&v);
+	})
+	TEST("eytzinger", {
+		int ok = 1;
+		for (size_t size = 0; size < 70; ++size)
+		{
+			vsearch_i v = sorted_vec(size);
+			struct vsearch_i_eytzinger e = vsearch_i_eytzinger_build(&v);
+			ok &= e.data != NULL;
+			ok &= ((uintptr_t)e.data & (DATASTORE_EYTZINGER_ALIGN - 1)) == 0;
+			const int last = size ? v.data[size - 1] : 0;
+			for (int value = -1; value <= last + 2; ++value)
+			{
+				ok &= vsearch_i_eytzinger_lower_bound(&e, value) == linear_lower_bound(&v, value);
+				const size_t lower = linear_lower_bound(&v, value);
+				ok &= vsearch_i_eytzinger_contains(&e, value) == (lower < v.size && v.data[lower] == value);
+			}
+			vsearch_i_eytzinger_free(&e);
+			ok &= e.data == NULL;
+			vsearch_i_free(&v);
+		}
+		ASSERT(ok)
+	})
+})
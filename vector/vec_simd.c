@@ -0,0 +1,195 @@
+#include "test.h"
+#include "vector_simd.h"
+
+#define CHAR_TRAIT(X) \
+	X(TYPE, char) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(KIND, CHAR)
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(KIND, INT)
+#define FLOAT_TRAIT(X) \
+	X(TYPE, float) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(KIND, FLOAT)
+DATASTORE_VEC(char, vsc)
+typedef struct vsc vsc;
+DATASTORE_VEC_SIMD(CHAR_TRAIT, vsc)
+DATASTORE_VEC_IMPL_S(CHAR_TRAIT, vsc, SETTINGS)
+DATASTORE_VEC_SIMD_IMPL(CHAR_TRAIT, vsc)
+DATASTORE_VEC(int, vsi)
+typedef struct vsi vsi;
+DATASTORE_VEC_SIMD(INT_TRAIT, vsi)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vsi, SETTINGS)
+DATASTORE_VEC_SIMD_IMPL(INT_TRAIT, vsi)
+DATASTORE_VEC(float, vsf)
+typedef struct vsf vsf;
+DATASTORE_VEC_SIMD(FLOAT_TRAIT, vsf)
+DATASTORE_VEC_IMPL_S(FLOAT_TRAIT, vsf, SETTINGS)
+DATASTORE_VEC_SIMD_IMPL(FLOAT_TRAIT, vsf)
+
+/* Compares every ISA variant of a kernel against the scalar one, for sizes around the lane widths */
+#if DATASTORE_SIMD_X86
+	#define SAME(op, suffix, ...) \
+		(datastore_simd_##op##_##suffix##_SSE2(__VA_ARGS__) == datastore_simd_##op##_##suffix##_scalar(__VA_ARGS__) \
+		 && (!datastore_simd_has_avx2() \
+			 || datastore_simd_##op##_##suffix##_AVX2(__VA_ARGS__) == datastore_simd_##op##_##suffix##_scalar(__VA_ARGS__)))
+#else
+	#define SAME(op, suffix, ...) ((void)datastore_simd_##op##_##suffix(__VA_ARGS__), 1)
+#endif
+
+static unsigned next(unsigned *state)
+{
+	*state = *state * 1103515245u + 12345u;
+	return *state >> 16;
+}
+
+TESTS(vec_simd, {
+	TEST("kernels_i8", {
+		char a[300], b[300];
+		unsigned state = 1;
+		int ok = 1;
+		for (size_t i = 0; i < 300; ++i)
+		{
+			a[i] = (char)next(&state);
+			b[i] = (char)(a[i] + 1);
+		}
+		for (size_t n = 1; n <= 300; n += 7)
+		{
+			ok &= SAME(find, i8, a, n, a[n - 1]);
+			ok &= SAME(find, i8, a, n, (char)42);
+			ok &= SAME(count, i8, a, n, a[n / 2]);
+			ok &= SAME(min, i8, a, n);
+			ok &= SAME(max, i8, a, n);
+			ok &= SAME(sum, i8, a, n);
+			ok &= SAME(any_eq, i8, a, b, n);
+		}
+		b[250] = a[250];
+		ok &= SAME(any_eq, i8, a, b, 300);
+		ok &= datastore_simd_any_eq_i8(a, b, 300);
+		ok &= !datastore_simd_any_eq_i8(a, b, 250);
+		ASSERT(ok)
+
+		// Long enough for byte counters to be flushed several times
+		char *big = malloc(20000);
+		if (!big)
+			abort();
+		memset(big, 'x', 20000);
+		big[19999] = 'y';
+		ASSERT(datastore_simd_count_i8(big, 20000, 'x') == 19999)
+		ASSERT(datastore_simd_find_i8(big, 20000, 'y') == 19999)
+		free(big);
+	})
+	TEST("kernels_i32", {
+		int a[300], b[300];
+		unsigned state = 2;
+		int ok = 1;
+		for (size_t i = 0; i < 300; ++i)
+		{
+			a[i] = (int)(next(&state) % 2000) - 1000;
+			b[i] = a[i] + 1;
+		}
+		a[123] = INT_MIN;
+		a[77] = INT_MAX;
+		for (size_t n = 1; n <= 300; n += 5)
+		{
+			ok &= SAME(find, i32, a, n, a[n - 1]);
+			ok &= SAME(find, i32, a, n, 5000);
+			ok &= SAME(count, i32, a, n, a[n / 3]);
+			ok &= SAME(min, i32, a, n);
+			ok &= SAME(max, i32, a, n);
+			ok &= SAME(sum, i32, a, n);
+			ok &= SAME(any_eq, i32, a, b, n);
+		}
+		ASSERT(ok)
+		ASSERT(datastore_simd_min_i32(a, 300) == INT_MIN)
+		ASSERT(datastore_simd_max_i32(a, 300) == INT_MAX)
+	})
+	TEST("kernels_f32", {
+		float a[300], b[300];
+		unsigned state = 3;
+		int ok = 1;
+		// Small integers, so that sums are exact whatever the order
+		for (size_t i = 0; i < 300; ++i)
+		{
+			a[i] = (float)((int)(next(&state) % 200) - 100);
+			b[i] = a[i] + 0.5f;
+		}
+		for (size_t n = 1; n <= 300; n += 5)
+		{
+			ok &= SAME(find, f32, a, n, a[n - 1]);
+			ok &= SAME(count, f32, a, n, a[n / 2]);
+			ok &= SAME(min, f32, a, n);
+			ok &= SAME(max, f32, a, n);
+			ok &= SAME(sum, f32, a, n);
+			ok &= SAME(any_eq, f32, a, b, n);
+		}
+		ASSERT(ok)
+	})
+	TEST("nan", {
+		float a[64];
+		for (size_t i = 0; i < 64; ++i)
+			a[i] = (float)i;
+		a[1] = a[40] = 0.f / 0.f;
+		a[50] = -3.f;
+		ASSERT(datastore_simd_min_f32(a, 64) == -3.f)
+		ASSERT(datastore_simd_max_f32(a, 64) == 63.f)
+		ASSERT(datastore_simd_find_f32(a, 64, a[1]) == 64)
+		ASSERT(datastore_simd_count_f32(a, 64, 2.f) == 1)
+		ASSERT(SAME(min, f32, a, 64))
+		ASSERT(SAME(max, f32, a, 64))
+	})
+	TEST("methods_int", {
+		vsi v = vsi_new(0);
+		ASSERT(vsi_find(&v, 1) == 0)
+		ASSERT(!vsi_contains(&v, 1))
+		ASSERT(vsi_sum(&v) == 0)
+		for (int i = 0; i < 1000; ++i)
+			vsi_push(&v, i % 100);
+		ASSERT(vsi_find(&v, 57) == 57)
+		ASSERT(vsi_contains(&v, 99))
+		ASSERT(!vsi_contains(&v, 100))
+		ASSERT(vsi_count(&v, 3) == 10)
+		ASSERT(vsi_min(&v) == 0)
+		ASSERT(vsi_max(&v) == 99)
+		ASSERT(vsi_sum(&v) == 49500)
+
+		vsi w = vsi_new(0);
+		for (int i = 0; i < 500; ++i)
+			vsi_push(&w, -1);
+		ASSERT(!vsi_any_eq(&v, &w))
+		w.data[321] = v.data[321];
+		ASSERT(vsi_any_eq(&v, &w))
+		ASSERT(vsi_any_eq(&w, &v))
+		vsi_free(&w);
+		vsi_free(&v);
+	})
+	TEST("methods_char_float", {
+		vsc c = vsc_new(0);
+		const char *text = "the quick brown fox jumps over the lazy dog";
+		for (const char *p = text; *p; ++p)
+			vsc_push(&c, *p);
+		ASSERT(vsc_find(&c, 'q') == 4)
+		ASSERT(vsc_count(&c, 'o') == 4)
+		ASSERT(vsc_min(&c) == ' ')
+		ASSERT(vsc_max(&c) == 'z')
+		int64_t sum = 0;
+		for (const char *p = text; *p; ++p)
+			sum += *p;
+		ASSERT(vsc_sum(&c) == sum)
+		vsc_free(&c);
+
+		vsf f = vsf_new(0);
+		for (int i = 0; i < 100; ++i)
+			vsf_push(&f, (float)(i - 50));
+		ASSERT(vsf_find(&f, 0.f) == 50)
+		ASSERT(vsf_min(&f) == -50.f)
+		ASSERT(vsf_max(&f) == 49.f)
+		ASSERT(vsf_sum(&f) == -50.f)
+		vsf_free(&f);
+	})
+})
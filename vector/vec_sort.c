@@ -0,0 +1,299 @@
+#include "test.h"
+#include "vector_sort.h"
+
+#define INT_TRAIT(X) \
+	X(TYPE, int) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(KIND, INT) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+#define FLOAT_TRAIT(X) \
+	X(TYPE, float) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(KIND, FLOAT) \
+	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+#define CHAR_TRAIT(X) \
+	X(TYPE, char) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(KIND, CHAR)
+#define STR_TRAIT(X) \
+	X(TYPE, const char *) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = strcmp(*lhs, *rhs); })
+struct record
+{
+	int key;
+	size_t order;
+};
+#define RECORD_TRAIT(X) \
+	X(TYPE, struct record) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; }) \
+	X(CMP, { cmp = (lhs->key > rhs->key) - (lhs->key < rhs->key); })
+DATASTORE_VEC(int, vsort_i)
+typedef struct vsort_i vsort_i;
+DATASTORE_VEC_SORT(INT_TRAIT, vsort_i)
+DATASTORE_VEC_RADIX_SORT(INT_TRAIT, vsort_i)
+DATASTORE_VEC_IMPL_S(INT_TRAIT, vsort_i, SETTINGS)
+DATASTORE_VEC_SORT_IMPL(INT_TRAIT, vsort_i)
+DATASTORE_VEC_RADIX_SORT_IMPL(INT_TRAIT, vsort_i)
+DATASTORE_VEC(float, vsort_f)
+typedef struct vsort_f vsort_f;
+DATASTORE_VEC_SORT(FLOAT_TRAIT, vsort_f)
+DATASTORE_VEC_RADIX_SORT(FLOAT_TRAIT, vsort_f)
+DATASTORE_VEC_IMPL_S(FLOAT_TRAIT, vsort_f, SETTINGS)
+DATASTORE_VEC_SORT_IMPL(FLOAT_TRAIT, vsort_f)
+DATASTORE_VEC_RADIX_SORT_IMPL(FLOAT_TRAIT, vsort_f)
+DATASTORE_VEC(char, vsort_c)
+typedef struct vsort_c vsort_c;
+DATASTORE_VEC_RADIX_SORT(CHAR_TRAIT, vsort_c)
+DATASTORE_VEC_IMPL_S(CHAR_TRAIT, vsort_c, SETTINGS)
+DATASTORE_VEC_RADIX_SORT_IMPL(CHAR_TRAIT, vsort_c)
+DATASTORE_VEC(const char *, vsort_s)
+typedef struct vsort_s vsort_s;
+DATASTORE_VEC_SORT(STR_TRAIT, vsort_s)
+DATASTORE_VEC_IMPL_S(STR_TRAIT, vsort_s, SETTINGS)
+DATASTORE_VEC_SORT_IMPL(STR_TRAIT, vsort_s)
+DATASTORE_VEC(struct record, vsort_r)
+typedef struct vsort_r vsort_r;
+DATASTORE_VEC_SORT(RECORD_TRAIT, vsort_r)
+DATASTORE_VEC_IMPL_S(RECORD_TRAIT, vsort_r, SETTINGS)
+DATASTORE_VEC_SORT_IMPL(RECORD_TRAIT, vsort_r)
+
+static int cmp_int(const void *a, const void *b)
+{
+	const int x = *(const int *)a, y = *(const int *)b;
+	return (x > y) - (x < y);
+}
+
+static int cmp_float(const void *a, const void *b)
+{
+	const float x = *(const float *)a, y = *(const float *)b;
+	return (x > y) - (x < y);
+}
+
+static uint64_t record_key(const struct record *value)
+{
+	return datastore_sort_key_i64(value->key);
+}
+
+static struct record make_record(int key, size_t order)
+{
+	return (struct record){ .key = key, .order = order };
+}
+
+static unsigned next(unsigned *state)
+{
+	*state = *state * 1103515245u + 12345u;
+	return *state >> 16;
+}
+
+/* Fills `v` with `size` elements following one of several patterns */
+static void fill(vsort_i *v, size_t size, unsigned pattern, unsigned *state)
+{
+	v->size = 0;
+	for (size_t i = 0; i < size; ++i)
+	{
+		int value;
+		switch (pattern)
+		{
+			case 0: value = (int)next(state) - 16384; break;
+			case 1: value = (int)i; break;
+			case 2: value = (int)(size - i); break;
+			case 3: value = (int)(next(state) % 4); break;
+			case 4: value = (int)(i < size / 2 ? i : size - i); break;
+			default: value = (int)i + (next(state) % 16 == 0 ? (int)(next(state) % 64) : 0); break;
+		}
+		vsort_i_push(v, value);
+	}
+}
+
+/*
+ * McIlroy's adversary: values are undecided ("gas", equal to the size) until compared, and one of
+ * two undecided values is frozen to the lowest free value, preferably the last pivot candidate
+ */
+#define ADVERSARY_SIZE 5000
+static int *g_adversary;
+static int g_solid;
+static int g_candidate;
+static size_t g_compares;
+
+static bool adversary_less(const int *a, const int *b)
+{
+	const int gas = ADVERSARY_SIZE;
+	++g_compares;
+	if (g_adversary[*a] == gas && g_adversary[*b] == gas)
+		g_adversary[*a == g_candidate ? *a : *b] = g_solid++;
+	if (g_adversary[*a] == gas)
+		g_candidate = *a;
+	else if (g_adversary[*b] == gas)
+		g_candidate = *b;
+	return g_adversary[*a] < g_adversary[*b];
+}
+DATASTORE_PDQSORT(adversary_sort, int, adversary_less)
+
+TESTS(vec_sort, {
+	TEST("sort_patterns", {
+		static const size_t sizes[] = { 0, 1, 2, 3, 23, 24, 25, 127, 128, 129, 1000, 50000 };
+		vsort_i v = vsort_i_new(0);
+		int *expected = malloc(50000 * sizeof(int));
+		if (!expected)
+			abort();
+		unsigned state = 1;
+		int ok = 1;
+		for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+			for (unsigned pattern = 0; pattern < 6; ++pattern)
+			{
+				fill(&v, sizes[s], pattern, &state);
+				if (v.size)
+					memcpy(expected, v.data, v.size * sizeof(int));
+				qsort(expected, v.size, sizeof(int), cmp_int);
+				vsort_i_sort(&v);
+				ok &= vsort_i_is_sorted(&v);
+				ok &= v.size == 0 || memcmp(expected, v.data, v.size * sizeof(int)) == 0;
+			}
+		ASSERT(ok)
+		free(expected);
+		vsort_i_free(&v);
+	})
+	TEST("heapsort_fallback", {
+		// Answers the comparisons of the sort itself so that every partition is unbalanced
+		const int size = ADVERSARY_SIZE;
+		int *order = malloc((size_t)size * sizeof(int));
+		g_adversary = malloc((size_t)size * sizeof(int));
+		if (!order || !g_adversary)
+			abort();
+		g_solid = 0;
+		g_candidate = 0;
+		g_compares = 0;
+		for (int i = 0; i < size; ++i)
+		{
+			order[i] = i;
+			g_adversary[i] = size;
+		}
+		adversary_sort(order, (size_t)size);
+		// Quadratic without the fallback, about 12M comparisons
+		ASSERT(g_compares < (size_t)size * 13 * 20)
+		for (int i = 0; i < size; ++i)
+			if (g_adversary[i] == size)
+				g_adversary[i] = g_solid++;
+		// The values frozen by the adversary take the same path through `sort`
+		vsort_i v = vsort_i_new(0);
+		for (int i = 0; i < size; ++i)
+			vsort_i_push(&v, g_adversary[i]);
+		vsort_i_sort(&v);
+		int ok = 1;
+		for (int i = 0; i < size; ++i)
+			ok &= v.data[i] == i;
+		ASSERT(ok)
+		vsort_i_free(&v);
+		free(g_adversary);
+		free(order);
+	})
+	TEST("sort_strings", {
+		static const char *words[] = { "pear", "apple", "fig", "banana", "apple", "kiwi", "cherry" };
+		vsort_s v = vsort_s_new(0);
+		for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i)
+			vsort_s_push(&v, words[i]);
+		vsort_s_sort(&v);
+		ASSERT(vsort_s_is_sorted(&v))
+		ASSERT(strcmp(v.data[0], "apple") == 0)
+		ASSERT(strcmp(v.data[1], "apple") == 0)
+		ASSERT(strcmp(v.data[6], "pear") == 0)
+		vsort_s_free(&v);
+	})
+	TEST("radix_int", {
+		vsort_i v = vsort_i_new(0);
+		struct datastore_sort_scratch scratch = { NULL, 0 };
+		int *expected = malloc(20000 * sizeof(int));
+		if (!expected)
+			abort();
+		unsigned state = 2;
+		int ok = 1;
+		for (unsigned pattern = 0; pattern < 6; ++pattern)
+		{
+			fill(&v, 20000, pattern, &state);
+			v.data[7] = INT_MIN;
+			v.data[8] = INT_MAX;
+			v.data[9] = -1;
+			memcpy(expected, v.data, v.size * sizeof(int));
+			qsort(expected, v.size, sizeof(int), cmp_int);
+			ok &= vsort_i_radix_sort(&v, &scratch);
+			ok &= memcmp(expected, v.data, v.size * sizeof(int)) == 0;
+		}
+		ASSERT(ok)
+		ASSERT(scratch.size >= 2 * 20000 * sizeof(uint32_t))
+		// Without scratch buffer
+		fill(&v, 1000, 2, &state);
+		ASSERT(vsort_i_radix_sort(&v, NULL))
+		ASSERT(vsort_i_is_sorted(&v))
+		datastore_sort_scratch_free(&scratch);
+		free(expected);
+		vsort_i_free(&v);
+	})
+	TEST("radix_float", {
+		vsort_f v = vsort_f_new(0);
+		float expected[1000];
+		unsigned state = 3;
+		for (size_t i = 0; i < 1000; ++i)
+		{
+			const float value = ((float)next(&state) - 16384.f) / 7.f;
+			vsort_f_push(&v, value);
+			expected[i] = value;
+		}
+		v.data[5] = expected[5] = -1e30f;
+		v.data[6] = expected[6] = 1e30f;
+		v.data[7] = expected[7] = 0.f;
+		qsort(expected, 1000, sizeof(float), cmp_float);
+		ASSERT(vsort_f_radix_sort(&v, NULL))
+		ASSERT(memcmp(expected, v.data, sizeof(expected)) == 0)
+
+		vsort_f_push(&v, -0.f);
+		vsort_f_sort(&v);
+		ASSERT(vsort_f_is_sorted(&v))
+		vsort_f_free(&v);
+	})
+	TEST("radix_char", {
+		vsort_c v = vsort_c_new(0);
+		const char *text = "radix sort of chars, with some -punctuation- too!";
+		for (const char *p = text; *p; ++p)
+			vsort_c_push(&v, *p);
+		vsort_c_push(&v, (char)-3);
+		vsort_c_push(&v, (char)127);
+		ASSERT(vsort_c_radix_sort(&v, NULL))
+		int ok = 1;
+		for (size_t i = 1; i < v.size; ++i)
+			ok &= v.data[i - 1] <= v.data[i];
+		ASSERT(ok)
+		ASSERT(v.size == strlen(text) + 2)
+		vsort_c_free(&v);
+	})
+	TEST("sort_by_key", {
+		vsort_r v = vsort_r_new(0);
+		struct datastore_sort_scratch scratch = { NULL, 0 };
+		unsigned state = 4;
+		for (size_t i = 0; i < 10000; ++i)
+			vsort_r_push(&v, make_record((int)(next(&state) % 100) - 50, i));
+		ASSERT(vsort_r_sort_by_key(&v, record_key, &scratch))
+		ASSERT(vsort_r_is_sorted(&v))
+		// Stable: equal keys keep their insertion order
+		int ok = 1;
+		for (size_t i = 1; i < v.size; ++i)
+			ok &= v.data[i - 1].key != v.data[i].key || v.data[i - 1].order < v.data[i].order;
+		ASSERT(ok)
+		ASSERT(vsort_r_sort_by_key(&v, record_key, NULL))
+		datastore_sort_scratch_free(&scratch);
+		vsort_r_free(&v);
+	})
+	TEST("sort_keys", {
+		ASSERT(datastore_sort_key_i64(-1) < datastore_sort_key_i64(0))
+		ASSERT(datastore_sort_key_i64(INT64_MIN) < datastore_sort_key_i64(INT64_MAX))
+		ASSERT(datastore_sort_key_f64(-2.5) < datastore_sort_key_f64(-1.0))
+		ASSERT(datastore_sort_key_f64(-1.0) < datastore_sort_key_f64(0.0))
+		ASSERT(datastore_sort_key_f64(0.0) < datastore_sort_key_f64(1e-300))
+		ASSERT(datastore_sort_key_f64(1.0) < datastore_sort_key_f64(2.0))
+	})
+})
@@ -0,0 +1,150 @@
+#include "test.h"
+#include "vector_string.h"
+
+DATASTORE_VEC(char, vsref)
+typedef struct vsref vsref;
+DATASTORE_VEC_STRING(vsref)
+DATASTORE_VEC_IMPL_S(DATASTORE_VEC_STRING_TRAIT, vsref, SETTINGS)
+DATASTORE_VEC_STRING_IMPL(vsref)
+DATASTORE_STR(sso)
+typedef struct sso sso;
+DATASTORE_STR_IMPL_S(sso, SETTINGS)
+
+static uint64_t next(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/* Whether a string holds the content of the reference builder */
+static int same(const sso *s, vsref *ref)
+{
+	const char *cstr = sso_cstr(s);
+	return sso_size(s) == ref->size && !memcmp(cstr, vsref_cstr(ref), ref->size + 1);
+}
+
+TESTS(vec_sso, {
+	TEST("inline", {
+		ASSERT(sizeof(sso) == 24 || sizeof(void *) < 8)
+		sso s = sso_new();
+		ASSERT(sso_is_inline(&s) && sso_size(&s) == 0 && !strcmp(sso_cstr(&s), ""))
+		int ok = 1;
+		for (size_t i = 0; i < DATASTORE_STR_INLINE; ++i)
+		{
+			sso_append_char(&s, (char)('a' + i));
+			ok &= sso_is_inline(&s) && sso_size(&s) == i + 1 && sso_cstr(&s)[i + 1] == '\0';
+		}
+		ASSERT(ok)
+		ASSERT(!strcmp(sso_cstr(&s), "abcdefghijklmnopqrstuv"))
+		sso_append_char(&s, 'w');
+		ASSERT(!sso_is_inline(&s) && sso_size(&s) == DATASTORE_STR_INLINE + 1)
+		ASSERT(!strcmp(sso_cstr(&s), "abcdefghijklmnopqrstuvw"))
+		sso_free(&s);
+		ASSERT(sso_is_inline(&s) && sso_size(&s) == 0)
+
+		sso t = sso_from("-1234567890", 11);
+		sso_append_i64(&t, -9876543210);
+		ASSERT(sso_is_inline(&t) && !strcmp(sso_cstr(&t), "-1234567890-9876543210"))
+		sso_free(&t);
+	})
+	TEST("append", {
+		int ok = 1;
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (size_t round = 0; round < 50; ++round)
+		{
+			sso s = sso_new();
+			vsref ref = vsref_new(0);
+			// Strings stay on the heap once they outgrow the inline storage
+			int outgrown = 0;
+			for (size_t i = 0; i < round * 4; ++i)
+			{
+				const uint64_t value = next(&state) >> (next(&state) % 64);
+				switch (value % 5)
+				{
+				case 0:
+					sso_append_cstr(&s, "log");
+					vsref_append_cstr(&ref, "log");
+					break;
+				case 1:
+					sso_append_char(&s, ':');
+					vsref_append_char(&ref, ':');
+					break;
+				case 2:
+					sso_append_u64(&s, value);
+					vsref_append_u64(&ref, value);
+					break;
+				case 3:
+					sso_append_i64(&s, -(int64_t)(value >> 1));
+					vsref_append_i64(&ref, -(int64_t)(value >> 1));
+					break;
+				default:
+					sso_append_f64(&s, (double)value / 1e6, 3);
+					vsref_append_f64(&ref, (double)value / 1e6, 3);
+					break;
+				}
+				outgrown |= ref.size > DATASTORE_STR_INLINE;
+				ok &= same(&s, &ref) && sso_is_inline(&s) == !outgrown;
+			}
+			sso_free(&s);
+			vsref_free(&ref);
+		}
+		ASSERT(ok)
+	})
+	TEST("clone_compare", {
+		sso a = sso_from("short", 5);
+		sso b = sso_from("a string too long to be stored inline", 37);
+		sso ca = sso_clone(&a);
+		sso cb = sso_clone(&b);
+		ASSERT(sso_is_inline(&ca) && !sso_is_inline(&cb))
+		ASSERT(sso_cstr(&cb) != sso_cstr(&b))
+		ASSERT(sso_compare(&a, &ca) == 0 && sso_compare(&b, &cb) == 0)
+		ASSERT(sso_compare(&a, &b) > 0 && sso_compare(&b, &a) < 0)
+
+		sso prefix = sso_from("short", 4);
+		ASSERT(sso_compare(&prefix, &a) < 0 && sso_compare(&a, &prefix) > 0)
+		sso_append_cstr(&cb, "!");
+		ASSERT(sso_compare(&b, &cb) < 0 && !strcmp(sso_cstr(&b), "a string too long to be stored inline"))
+
+		sso_free(&a);
+		sso_free(&b);
+		sso_free(&ca);
+		sso_free(&cb);
+		sso_free(&prefix);
+	})
+	TEST("reserve_clear", {
+		sso s = sso_new();
+		sso_reserve(&s, 10);
+		ASSERT(sso_is_inline(&s))
+		sso_reserve(&s, 1000);
+		ASSERT(!sso_is_inline(&s))
+		const char *data = sso_cstr(&s);
+		int ok = 1;
+		for (size_t i = 0; i < 100; ++i)
+			sso_append_cstr(&s, "0123456789");
+		ok &= sso_cstr(&s) == data && sso_size(&s) == 1000;
+		sso_clear(&s);
+		ok &= sso_size(&s) == 0 && !strcmp(sso_cstr(&s), "") && sso_cstr(&s) == data;
+		sso_append_u64(&s, 42);
+		ok &= !strcmp(sso_cstr(&s), "42");
+		ASSERT(ok)
+		sso_free(&s);
+	})
+	TEST("into_cstr", {
+		sso s = sso_from("inline", 6);
+		char *cstr = sso_into_cstr(&s);
+		ASSERT(!strcmp(cstr, "inline"))
+		ASSERT(sso_is_inline(&s) && sso_size(&s) == 0)
+		iso_free(cstr);
+
+		sso_append_cstr(&s, "a string that lives on the heap: ");
+		sso_append_f64(&s, 2.5, 1);
+		const char *data = sso_cstr(&s);
+		cstr = sso_into_cstr(&s);
+		ASSERT(cstr == data && !strcmp(cstr, "a string that lives on the heap: 2.5"))
+		ASSERT(sso_is_inline(&s) && sso_size(&s) == 0)
+		iso_free(cstr);
+		sso_free(&s);
+	})
+})
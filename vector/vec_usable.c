@@ -0,0 +1,110 @@
+#include "test.h"
+
+#define LONG_TRAIT(X) \
+	X(TYPE, long) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+DATASTORE_VEC(long, vl)
+typedef struct vl vl;
+DATASTORE_VEC_IMPL_S(LONG_TRAIT, vl, SETTINGS_USABLE)
+
+TESTS(vec_usable, {
+	TEST("grow policy", {
+		ASSERT(datastore_vec_grow_policy(0, 1) == 64)
+		ASSERT(datastore_vec_grow_policy(0, 8) == 8)
+		ASSERT(datastore_vec_grow_policy(0, 256) == 1)
+		// 1.5x below threshold
+		ASSERT(datastore_vec_grow_policy(100, 8) == 150)
+		ASSERT(datastore_vec_grow_policy(1, 8) == 2)
+		// 2x above threshold
+		ASSERT(datastore_vec_grow_policy(DATASTORE_VEC_GROW_THRESHOLD, 1) == DATASTORE_VEC_GROW_THRESHOLD * 2)
+		// Page multiple for large buffers
+		const size_t big = datastore_vec_grow_policy(DATASTORE_VEC_GROW_PAGE_MIN / 4 + 1, 4);
+		ASSERT((big * 4) % DATASTORE_VEC_GROW_PAGE == 0)
+		ASSERT(big > DATASTORE_VEC_GROW_PAGE_MIN / 4 + 1)
+		// Saturates instead of overflowing
+		ASSERT(datastore_vec_grow_policy(SIZE_MAX / 2 + 1, 1) == SIZE_MAX)
+		// Always grows
+		int grows = 1;
+		for (size_t cap = 0, i = 0; i < 64; ++i)
+		{
+			const size_t next = datastore_vec_grow_policy(cap, 24);
+			grows &= next > cap;
+			cap = next;
+		}
+		ASSERT(grows)
+	})
+	TEST("new", {
+		vl a = vl_new(3);
+		ASSERT(a.data != NULL)
+		ASSERT(a.capacity >= 3)
+		ASSERT(a.capacity * sizeof(long) <= DATASTORE_VEC_USABLE_SIZE(a.data, 0))
+		ASSERT(a.size == 0)
+		vl_free(&a);
+		ASSERT(a.data == NULL)
+		ASSERT(a.capacity == 0)
+
+		vl b = vl_new(0);
+		ASSERT(b.data == NULL)
+		ASSERT(b.capacity == 0)
+	})
+	TEST("push", {
+		vl a = vl_new(0);
+		size_t reallocs = 0;
+		long *prev = NULL;
+		size_t prev_cap = 0;
+		int stable = 1;
+		for (long i = 0; i < 10000; ++i)
+		{
+			vl_push(&a, i);
+			if (a.capacity != prev_cap)
+			{
+				++reallocs;
+				prev_cap = a.capacity;
+				prev = a.data;
+			}
+			// Pushes that fit in the usable size never move the buffer
+			else
+				stable &= prev == a.data;
+		}
+		ASSERT(stable)
+		ASSERT(a.size == 10000)
+		ASSERT(a.capacity >= a.size)
+		ASSERT(a.capacity * sizeof(long) <= DATASTORE_VEC_USABLE_SIZE(a.data, 0))
+		ASSERT(reallocs < 40)
+		int ok = 1;
+		for (long i = 0; i < 10000; ++i)
+			ok &= a.data[i] == i;
+		ASSERT(ok)
+		vl_free(&a);
+	})
+	TEST("reserve", {
+		vl a = vl_new(0);
+		vl_reserve(&a, 5);
+		ASSERT(a.capacity >= 5)
+		const size_t cap = a.capacity;
+		// Slack is used before reallocating
+		for (size_t i = 0; i < cap; ++i)
+			vl_push(&a, (long)i);
+		ASSERT(a.capacity == cap)
+		vl_free(&a);
+	})
+	TEST("shrink_to_fit", {
+		vl a = vl_new(64);
+		for (long i = 0; i < 5; ++i)
+			vl_push(&a, i);
+		vl_shrink_to_fit(&a);
+		ASSERT(a.size == 5)
+		ASSERT(a.capacity >= 5)
+		ASSERT(a.capacity < 64)
+		ASSERT(a.capacity * sizeof(long) <= DATASTORE_VEC_USABLE_SIZE(a.data, 0))
+		ASSERT(a.data[0] == 0)
+		ASSERT(a.data[4] == 4)
+
+		vl b = vl_clone(&a);
+		ASSERT(b.size == 5)
+		ASSERT(b.capacity >= 5)
+		vl_free(&a);
+		vl_free(&b);
+	})
+})
@@ -18,6 +18,8 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define DATASTORE_VEC_H
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <assert.h>
 
 /**
@@ -79,6 +81,13 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
  *  - `FREE`: Function to free your object, `{}` for none
  *  - `CLONE`: Function to clone your object
  *
+ * The following X-macros are optional, and enable additional methods:
+ *  - `KIND`: Primitive kind of the object, one of `CHAR`, `INT` or `FLOAT`. Enables the SIMD
+ *    kernels of @ref VectorSimd "vector_simd.h" and the radix sort of
+ *    @ref VectorSort "vector_sort.h"
+ *  - `CMP`: Three-way comparison of `*lhs` and `*rhs`, stored in `int cmp` (negative, zero or
+ *    positive). Enables the sorts of @ref VectorSort "vector_sort.h"
+ *
  * ## Examples
  *
  * **For primitives**: `int`, `float`, `char`, etc.
@@ -87,7 +96,8 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
  * #define INT_TRAIT(X) \
  * 	X(TYPE, int) \
  * 	X(FREE, {}) \
- * 	X(CLONE, { *new = *val; })
+ * 	X(CLONE, { *new = *val; }) \
+ * 	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
  *
  * #define FLOAT_TRAIT(X) \
  * 	X(TYPE, float) \
@@ -101,7 +111,8 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
  * #define STR_TRAIT(X) \
  * 	X(TYPE, char*) \
  * 	X(FREE, { free(*val); }) \
- * 	X(CLONE, { *new = strdup(*val); })
+ * 	X(CLONE, { *new = strdup(*val); }) \
+ * 	X(CMP, { cmp = strcmp(*lhs, *rhs); })
  * @endcode
  *
  * @anchor advanced_usage
@@ -124,16 +135,43 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
  *   that will become the vector's `data`.
  * - `REALLOC` is the reallocator, used when changing the capacity of the internal buffer.
  *   It is used by `push`, `shrink_to_fit` and `reserve`. It should reallocate `ptr` to be able
- *   to hold at least `size` bytes, and return the new buffer inside `ptr`.
+ *   to hold at least `size` bytes, and return the new buffer inside `ptr`. The size of the
+ *   current buffer, computed from the vector's capacity, is available as `old_size`.
  * - `FREE` is the deallocator, used when freeing data from the vector. It should free the buffer
- *   `ptr`.
+ *   `ptr`, whose size is available as `size`.
  * - `GROW` is the vector's growth strategy. It should return a value in `new_capacity` that is
  *   strictly greater than `capacity`. By defaults it doubles length, which guarantees O(1)
  *   `push` operations. Note that you may want to increase the default size from `1` to a larger
- *   value.
+ *   value. The size of one element is available as `elem_size`.
  *
  * Checking for allocation errors it up to you.
  *
+ * ## Alignment
+ *
+ * The optional `ALIGN` setting requests `data` to be aligned on a power of two number of bytes,
+ * e.g `X(ALIGN, 64)`. The requested alignment is available as `align` in `NEW` and `REALLOC`,
+ * which are responsible for honoring it. Every allocation size is also padded to a multiple of
+ * `align`, so that the capacity always covers whole SIMD registers and kernels can process the
+ * tail of the vector without a scalar loop.
+ *
+ * @ref DATASTORE_VEC_SETTINGS_ALIGN32 and @ref DATASTORE_VEC_SETTINGS_ALIGN64 use
+ * @ref datastore_vec_aligned_alloc and @ref datastore_vec_aligned_realloc, which keep the
+ * alignment across reallocations.
+ *
+ * ## Usable size
+ *
+ * Most allocators round requests up to a size class, so the buffer returned by `NEW` or `REALLOC`
+ * is often larger than `size`. Both settings may report the real byte count of the buffer in
+ * `usable` (which is initialized to `size`), the vector's `capacity` will then be computed from
+ * it and the slack will be used before the next reallocation.
+ *
+ * @ref DATASTORE_VEC_SETTINGS_USABLE does this using `malloc_usable_size` (or `malloc_size` on
+ * Apple platforms), and grows using @ref datastore_vec_grow_policy :
+ * - `1.5x` while the buffer is smaller than @ref DATASTORE_VEC_GROW_THRESHOLD bytes,
+ * - `2x` above that threshold,
+ * - rounded up to a multiple of @ref DATASTORE_VEC_GROW_PAGE once the buffer is larger than
+ *   @ref DATASTORE_VEC_GROW_PAGE_MIN bytes, as big buffers are served by `mmap` in page units.
+ *
  * # Exposed methods
  *
  * The following methods are exposed and can be used on all DataStore's vector types:
@@ -195,6 +233,9 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
  * }
  * @endcode
  *
+ * Pushing one character at a time checks the capacity for every byte. The builder methods of
+ * @ref VectorString "vector_string.h" append whole strings and format numbers in place.
+ *
  * **Matrix manipulation**
  * @code{.c}
  * #include <vector.h>
@@ -253,6 +294,69 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 	#define DATASTORE_MAYBE_UNUSED(expr) do { (void)(expr); } while (0)
 #endif
 
+#ifndef DATASTORE_VEC_USABLE_SIZE
+	#if defined(__GLIBC__)
+		#include <malloc.h>
+		#define DATASTORE_VEC_USABLE_SIZE(ptr, size) malloc_usable_size(ptr)
+	#elif defined(__APPLE__)
+		#include <malloc/malloc.h>
+		#define DATASTORE_VEC_USABLE_SIZE(ptr, size) malloc_size(ptr)
+	#else
+		#define DATASTORE_VEC_USABLE_SIZE(ptr, size) (size)
+	#endif
+#endif
+
+/**
+ * @brief Buffer size (in bytes) under which @ref datastore_vec_grow_policy grows by `1.5x`
+ */
+#ifndef DATASTORE_VEC_GROW_THRESHOLD
+	#define DATASTORE_VEC_GROW_THRESHOLD ((size_t)64 * 1024)
+#endif
+
+/**
+ * @brief Buffer size (in bytes) above which @ref datastore_vec_grow_policy rounds to pages
+ */
+#ifndef DATASTORE_VEC_GROW_PAGE_MIN
+	#define DATASTORE_VEC_GROW_PAGE_MIN ((size_t)128 * 1024)
+#endif
+
+/**
+ * @brief Page size used by @ref datastore_vec_grow_policy
+ */
+#ifndef DATASTORE_VEC_GROW_PAGE
+	#define DATASTORE_VEC_GROW_PAGE ((size_t)4096)
+#endif
+
+/**
+ * @brief Size-class aware growth policy
+ *
+ * Grows by `1.5x` below @ref DATASTORE_VEC_GROW_THRESHOLD bytes, then by `2x`. Buffers larger
+ * than @ref DATASTORE_VEC_GROW_PAGE_MIN bytes are rounded up to a multiple of
+ * @ref DATASTORE_VEC_GROW_PAGE. The first allocation holds at least 64 bytes. The byte size
+ * saturates at `SIZE_MAX` instead of overflowing.
+ *
+ * @param capacity Current capacity of the vector, in elements
+ * @param elem_size Size of a single element, in bytes
+ *
+ * @returns The new capacity, strictly greater than `capacity`
+ */
+static inline size_t datastore_vec_grow_policy(size_t capacity, size_t elem_size)
+{
+	if (capacity == 0)
+		return elem_size < 64 ? 64 / elem_size : 1;
+	const size_t bytes = capacity * elem_size;
+	size_t new_bytes;
+	if (bytes < DATASTORE_VEC_GROW_THRESHOLD)
+		new_bytes = bytes + bytes / 2;
+	else
+		// Saturate instead of wrapping around
+		new_bytes = bytes > SIZE_MAX / 2 ? SIZE_MAX : bytes * 2;
+	if (new_bytes > DATASTORE_VEC_GROW_PAGE_MIN && new_bytes <= SIZE_MAX - (DATASTORE_VEC_GROW_PAGE - 1))
+		new_bytes = (new_bytes + DATASTORE_VEC_GROW_PAGE - 1) & ~(DATASTORE_VEC_GROW_PAGE - 1);
+	const size_t new_capacity = new_bytes / elem_size;
+	return new_capacity > capacity ? new_capacity : capacity + 1;
+}
+
 /**
  * @brief Vector type definition and methods declaration
  *
@@ -280,16 +384,106 @@ void DATASTORE_IDENT(name__, pop)(struct name__ *self);
 #define DATASTORE_VEC_TRAIT_TYPE_TYPE(tokens) tokens
 #define DATASTORE_VEC_TRAIT_TYPE_FREE(tokens)
 #define DATASTORE_VEC_TRAIT_TYPE_CLONE(tokens)
+#define DATASTORE_VEC_TRAIT_TYPE_KIND(tokens)
+#define DATASTORE_VEC_TRAIT_TYPE_CMP(tokens)
 
 #define DATASTORE_VEC_TRAIT_FREE(tag, tokens) DATASTORE_VEC_TRAIT_FREE_##tag(tokens)
 #define DATASTORE_VEC_TRAIT_FREE_TYPE(tokens)
 #define DATASTORE_VEC_TRAIT_FREE_FREE(tokens) tokens
 #define DATASTORE_VEC_TRAIT_FREE_CLONE(tokens)
+#define DATASTORE_VEC_TRAIT_FREE_KIND(tokens)
+#define DATASTORE_VEC_TRAIT_FREE_CMP(tokens)
 
 #define DATASTORE_VEC_TRAIT_CLONE(tag, tokens) DATASTORE_VEC_TRAIT_CLONE_##tag(tokens)
 #define DATASTORE_VEC_TRAIT_CLONE_TYPE(tokens)
 #define DATASTORE_VEC_TRAIT_CLONE_FREE(tokens)
 #define DATASTORE_VEC_TRAIT_CLONE_CLONE(tokens) tokens
+#define DATASTORE_VEC_TRAIT_CLONE_KIND(tokens)
+#define DATASTORE_VEC_TRAIT_CLONE_CMP(tokens)
+
+#define DATASTORE_VEC_TRAIT_KIND(tag, tokens) DATASTORE_VEC_TRAIT_KIND_##tag(tokens)
+#define DATASTORE_VEC_TRAIT_KIND_TYPE(tokens)
+#define DATASTORE_VEC_TRAIT_KIND_FREE(tokens)
+#define DATASTORE_VEC_TRAIT_KIND_CLONE(tokens)
+#define DATASTORE_VEC_TRAIT_KIND_KIND(tokens) tokens
+#define DATASTORE_VEC_TRAIT_KIND_CMP(tokens)
+
+#define DATASTORE_VEC_TRAIT_CMP(tag, tokens) DATASTORE_VEC_TRAIT_CMP_##tag(tokens)
+#define DATASTORE_VEC_TRAIT_CMP_TYPE(tokens)
+#define DATASTORE_VEC_TRAIT_CMP_FREE(tokens)
+#define DATASTORE_VEC_TRAIT_CMP_CLONE(tokens)
+#define DATASTORE_VEC_TRAIT_CMP_KIND(tokens)
+#define DATASTORE_VEC_TRAIT_CMP_CMP(tokens) tokens
+
+/**
+ * @brief Rounds `size` up to a multiple of `align`
+ *
+ * @param size Size to round, in bytes
+ * @param align Power of two, or `0` to leave `size` unchanged
+ */
+static inline size_t datastore_vec_pad(size_t size, size_t align)
+{
+	return align ? (size + align - 1) & ~(align - 1) : size;
+}
+
+/**
+ * @brief Allocates `size` bytes aligned on `align`
+ *
+ * The offset to the underlying `malloc` block is stored in the byte preceding the returned
+ * pointer, the buffer must be released with @ref datastore_vec_aligned_free.
+ *
+ * @param align Power of two, at most `128`
+ * @param size Number of bytes to allocate
+ *
+ * @returns The aligned buffer, NULL on failure
+ */
+static inline void *datastore_vec_aligned_alloc(size_t align, size_t size)
+{
+	assert(align && align <= 128 && !(align & (align - 1)));
+	unsigned char *raw = malloc(size + align);
+	if (!raw)
+		return NULL;
+	const size_t offset = align - ((uintptr_t)raw & (align - 1));
+	raw[offset - 1] = (unsigned char)offset;
+	return raw + offset;
+}
+
+/**
+ * @brief Reallocates a buffer from @ref datastore_vec_aligned_alloc, keeping its alignment
+ *
+ * The underlying block is resized with `realloc`. If the new block does not have the same
+ * alignment offset as the old one, the content is moved in place with a single `memmove`.
+ *
+ * @param ptr Buffer to reallocate, may be NULL
+ * @param old_size Number of bytes used in `ptr`
+ * @param size New size of the buffer
+ * @param align Alignment passed to @ref datastore_vec_aligned_alloc
+ *
+ * @returns The aligned buffer, NULL on failure
+ */
+static inline void *datastore_vec_aligned_realloc(void *ptr, size_t old_size, size_t size, size_t align)
+{
+	if (!ptr)
+		return datastore_vec_aligned_alloc(align, size);
+	const size_t old_offset = ((unsigned char *)ptr)[-1];
+	unsigned char *raw = realloc((unsigned char *)ptr - old_offset, size + align);
+	if (!raw)
+		return NULL;
+	const size_t offset = align - ((uintptr_t)raw & (align - 1));
+	if (offset != old_offset)
+		memmove(raw + offset, raw + old_offset, old_size < size ? old_size : size);
+	raw[offset - 1] = (unsigned char)offset;
+	return raw + offset;
+}
+
+/**
+ * @brief Frees a buffer from @ref datastore_vec_aligned_alloc
+ */
+static inline void datastore_vec_aligned_free(void *ptr)
+{
+	if (ptr)
+		free((unsigned char *)ptr - ((unsigned char *)ptr)[-1]);
+}
 
 /**
  * @brief Default settings for the vector type
@@ -300,29 +494,77 @@ void DATASTORE_IDENT(name__, pop)(struct name__ *self);
 	X(FREE, { free(ptr); }) \
 	X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
 
+/**
+ * @brief Size-class aware settings for the vector type
+ *
+ * `NEW` and `REALLOC` report the usable size of the allocation, and growth follows
+ * @ref datastore_vec_grow_policy
+ */
+#define DATASTORE_VEC_SETTINGS_USABLE(X) \
+	X(NEW, { ptr = malloc(size); if (!ptr) abort(); usable = DATASTORE_VEC_USABLE_SIZE(ptr, size); }) \
+	X(REALLOC, { ptr = realloc(ptr, size); if (!ptr) abort(); usable = DATASTORE_VEC_USABLE_SIZE(ptr, size); }) \
+	X(FREE, { free(ptr); }) \
+	X(GROW, { new_capacity = datastore_vec_grow_policy(capacity, elem_size); })
+
+/**
+ * @brief Settings for vectors whose data is aligned on 32 bytes (AVX)
+ */
+#define DATASTORE_VEC_SETTINGS_ALIGN32(X) \
+	X(NEW, { ptr = datastore_vec_aligned_alloc(align, size); if (!ptr) abort(); }) \
+	X(REALLOC, { ptr = datastore_vec_aligned_realloc(ptr, old_size, size, align); if (!ptr) abort(); }) \
+	X(FREE, { datastore_vec_aligned_free(ptr); }) \
+	X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; }) \
+	X(ALIGN, 32)
+
+/**
+ * @brief Settings for vectors whose data is aligned on 64 bytes (cache line, AVX-512)
+ */
+#define DATASTORE_VEC_SETTINGS_ALIGN64(X) \
+	X(NEW, { ptr = datastore_vec_aligned_alloc(align, size); if (!ptr) abort(); }) \
+	X(REALLOC, { ptr = datastore_vec_aligned_realloc(ptr, old_size, size, align); if (!ptr) abort(); }) \
+	X(FREE, { datastore_vec_aligned_free(ptr); }) \
+	X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; }) \
+	X(ALIGN, 64)
+
 #define DATASTORE_VEC_SETTINGS_NEW(tag, tokens) DATASTORE_VEC_SETTINGS_NEW_##tag(tokens)
 #define DATASTORE_VEC_SETTINGS_NEW_NEW(tokens) tokens
 #define DATASTORE_VEC_SETTINGS_NEW_REALLOC(tokens)
 #define DATASTORE_VEC_SETTINGS_NEW_FREE(tokens)
 #define DATASTORE_VEC_SETTINGS_NEW_GROW(tokens)
+#define DATASTORE_VEC_SETTINGS_NEW_ALIGN(tokens)
 
 #define DATASTORE_VEC_SETTINGS_REALLOC(tag, tokens) DATASTORE_VEC_SETTINGS_REALLOC_##tag(tokens)
 #define DATASTORE_VEC_SETTINGS_REALLOC_NEW(tokens)
 #define DATASTORE_VEC_SETTINGS_REALLOC_REALLOC(tokens) tokens
 #define DATASTORE_VEC_SETTINGS_REALLOC_FREE(tokens)
 #define DATASTORE_VEC_SETTINGS_REALLOC_GROW(tokens)
+#define DATASTORE_VEC_SETTINGS_REALLOC_ALIGN(tokens)
 
 #define DATASTORE_VEC_SETTINGS_FREE(tag, tokens) DATASTORE_VEC_SETTINGS_FREE_##tag(tokens)
 #define DATASTORE_VEC_SETTINGS_FREE_NEW(tokens)
 #define DATASTORE_VEC_SETTINGS_FREE_REALLOC(tokens)
 #define DATASTORE_VEC_SETTINGS_FREE_FREE(tokens) tokens
 #define DATASTORE_VEC_SETTINGS_FREE_GROW(tokens)
+#define DATASTORE_VEC_SETTINGS_FREE_ALIGN(tokens)
 
 #define DATASTORE_VEC_SETTINGS_GROW(tag, tokens) DATASTORE_VEC_SETTINGS_GROW_##tag(tokens)
 #define DATASTORE_VEC_SETTINGS_GROW_NEW(tokens)
 #define DATASTORE_VEC_SETTINGS_GROW_REALLOC(tokens)
 #define DATASTORE_VEC_SETTINGS_GROW_FREE(tokens)
 #define DATASTORE_VEC_SETTINGS_GROW_GROW(tokens) tokens
+#define DATASTORE_VEC_SETTINGS_GROW_ALIGN(tokens)
+
+#define DATASTORE_VEC_SETTINGS_ALIGN(tag, tokens) DATASTORE_VEC_SETTINGS_ALIGN_##tag(tokens)
+#define DATASTORE_VEC_SETTINGS_ALIGN_NEW(tokens)
+#define DATASTORE_VEC_SETTINGS_ALIGN_REALLOC(tokens)
+#define DATASTORE_VEC_SETTINGS_ALIGN_FREE(tokens)
+#define DATASTORE_VEC_SETTINGS_ALIGN_GROW(tokens)
+#define DATASTORE_VEC_SETTINGS_ALIGN_ALIGN(tokens) + (tokens)
+
+/**
+ * @brief Alignment requested by the `ALIGN` setting, `0` when the setting is absent
+ */
+#define DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__) ((size_t)(0 settings__(DATASTORE_VEC_SETTINGS_ALIGN)))
 
 /**
  * @brief Vector methods implementation
@@ -343,11 +585,15 @@ struct name__ DATASTORE_IDENT(name__, new)(size_t initial_capacity) \
 			.size = 0, \
 		}; \
 	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr; \
-	const size_t size = sizeof(trait__(DATASTORE_VEC_TRAIT_TYPE)) * initial_capacity; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(sizeof(trait__(DATASTORE_VEC_TRAIT_TYPE)) * initial_capacity, align); \
+	size_t usable = size; \
 	settings__(DATASTORE_VEC_SETTINGS_NEW) \
+	assert(usable >= size); \
+	assert(!align || ((uintptr_t)ptr & (align - 1)) == 0); \
 	return (struct name__){ \
 		.data = ptr, \
-		.capacity = initial_capacity, \
+		.capacity = usable / sizeof(*ptr), \
 		.size = 0, \
 	}; \
 } \
@@ -361,6 +607,8 @@ void DATASTORE_IDENT(name__, free)(struct name__ *self) \
 		trait__(DATASTORE_VEC_TRAIT_FREE) \
 	} \
 	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->data; \
+	const size_t size = self->capacity * sizeof(*ptr); \
+	DATASTORE_MAYBE_UNUSED(size); \
 	settings__(DATASTORE_VEC_SETTINGS_FREE) \
 	self->data = NULL; \
 	self->capacity = 0; \
@@ -385,16 +633,24 @@ void DATASTORE_IDENT(name__, shrink_to_fit)(struct name__ *self) \
 	if (self->size == 0) \
 	{ \
 		trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->data; \
+		const size_t size = self->capacity * sizeof(*ptr); \
+		DATASTORE_MAYBE_UNUSED(size); \
 		settings__(DATASTORE_VEC_SETTINGS_FREE) \
 		self->data = NULL; \
 		self->capacity = 0; \
 		return; \
 	} \
 	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->data; \
-	const size_t size = self->size * sizeof(*ptr); \
+	const size_t old_size = self->capacity * sizeof(*ptr); \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(self->size * sizeof(*ptr), align); \
+	size_t usable = size; \
+	DATASTORE_MAYBE_UNUSED(old_size); \
 	settings__(DATASTORE_VEC_SETTINGS_REALLOC) \
+	assert(usable >= size); \
+	assert(!align || ((uintptr_t)ptr & (align - 1)) == 0); \
 	self->data = ptr; \
-	self->capacity = self->size; \
+	self->capacity = usable / sizeof(*ptr); \
 } \
 void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t new_capacity) \
 { \
@@ -402,10 +658,16 @@ void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t new_capacity)
 	if (self->capacity >= new_capacity || new_capacity == 0) \
 		return; \
 	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->data; \
-	const size_t size = new_capacity * sizeof(*ptr); \
+	const size_t old_size = self->capacity * sizeof(*ptr); \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(new_capacity * sizeof(*ptr), align); \
+	size_t usable = size; \
+	DATASTORE_MAYBE_UNUSED(old_size); \
 	settings__(DATASTORE_VEC_SETTINGS_REALLOC) \
+	assert(usable >= size); \
+	assert(!align || ((uintptr_t)ptr & (align - 1)) == 0); \
 	self->data = ptr; \
-	self->capacity = new_capacity; \
+	self->capacity = usable / sizeof(*ptr); \
 } \
 void DATASTORE_IDENT(name__, push)(struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
 { \
@@ -416,14 +678,22 @@ void DATASTORE_IDENT(name__, push)(struct name__ *self, trait__(DATASTORE_VEC_TR
 		return; \
 	} \
 	const size_t capacity = self->capacity; \
+	const size_t elem_size = sizeof(*self->data); \
 	size_t new_capacity; \
+	DATASTORE_MAYBE_UNUSED(elem_size); \
 	settings__(DATASTORE_VEC_SETTINGS_GROW) \
 	assert(new_capacity > self->size); \
 	trait__(DATASTORE_VEC_TRAIT_TYPE) *ptr = self->data; \
-	const size_t size = new_capacity * sizeof(*ptr); \
+	const size_t old_size = self->capacity * sizeof(*ptr); \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(new_capacity * sizeof(*ptr), align); \
+	size_t usable = size; \
+	DATASTORE_MAYBE_UNUSED(old_size); \
 	settings__(DATASTORE_VEC_SETTINGS_REALLOC) \
+	assert(usable >= size); \
+	assert(!align || ((uintptr_t)ptr & (align - 1)) == 0); \
 	self->data = ptr; \
-	self->capacity = new_capacity; \
+	self->capacity = usable / sizeof(*ptr); \
 	self->data[self->size++] = value; \
 } \
 void DATASTORE_IDENT(name__, pop)(struct name__ *self) \
@@ -0,0 +1,607 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_VEC_EXTERNAL_H
+#define DATASTORE_VEC_EXTERNAL_H
+
+#include "vector.h"
+#include "vector_sort.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/**
+ * @file vector_external.h
+ * @defgroup VectorExternal DATASTORE_VEC external sort: Sorting vectors larger than memory
+ *
+ * @brief Sorting vectors larger than memory
+ *
+ * An external sorter receives elements with `push`, like a vector, into a buffer of fixed
+ * size in bytes (the memory budget). When the buffer is full it is sorted and written as a run
+ * to a temporary file. `finish` then merges the runs with a loser tree: each run reads its file
+ * through a slice of the buffer, and the sorted elements are returned one by one with `next`, or
+ * written to a file descriptor with `write_fd`. When there are too many runs to give every run a
+ * slice of at least @ref DATASTORE_VEC_EXTERNAL_BLOCK bytes, groups of runs are first merged
+ * into longer runs. All file accesses are large sequential reads and writes.
+ *
+ * If every element fits in the budget, nothing is written to disk.
+ *
+ * Elements are written to disk bitwise: the vector's type must not own resources, its `FREE`
+ * trait entry is never called. The trait needs a `CMP` entry, see @ref VectorSort "vector_sort.h".
+ *
+ * This header uses `mkstemp`, `pread` and `pwrite`: define `_POSIX_C_SOURCE` (at least
+ * `200809L`) or `_GNU_SOURCE` before including any system header.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * DATASTORE_VEC(struct record, vr)
+ * DATASTORE_VEC_EXTERNAL_SORT(RECORD_TRAIT, vr)
+ * DATASTORE_VEC_IMPL(RECORD_TRAIT, vr)
+ * DATASTORE_VEC_EXTERNAL_SORT_IMPL(RECORD_TRAIT, vr)
+ *
+ * struct vr_external sorter = vr_external_new(256 << 20, NULL); // 256MiB, in $TMPDIR
+ * while (read_record(&record))
+ * 	if (!vr_external_push(&sorter, record))
+ * 		fail(sorter.error);
+ * if (!vr_external_finish(&sorter))
+ * 	fail(sorter.error);
+ * while (vr_external_next(&sorter, &record))
+ * 	use(&record);
+ * vr_external_free(&sorter);
+ * @endcode
+ *
+ * # Exposed methods
+ *
+ * - `struct vec_external external_new(size_t budget, const char *dir)`: New sorter using
+ *   `budget` bytes of memory, with temporary files in `dir` (`NULL` for `$TMPDIR` or `/tmp`)
+ * - `void external_free(struct vec_external *self)`: Releases the sorter and its files
+ * - `bool external_push(struct vec_external *self, type value)`: Adds an element, returns false
+ *   after `external_finish`
+ * - `bool external_push_many(struct vec_external *self, const type *values, size_t count)`: Adds
+ *   `count` elements, returns false after `external_finish`
+ * - `bool external_finish(struct vec_external *self)`: Ends the input and prepares the merge
+ * - `bool external_next(struct vec_external *self, type *value)`: Moves the next element in
+ *   sorted order to `value`, returns false once every element was returned or on error
+ * - `bool external_write_fd(struct vec_external *self, int fd)`: Writes the remaining elements
+ *   in sorted order to `fd`
+ *
+ * Each method must be prefixed by the name of the vector type + `_`.
+ *
+ * Methods returning `bool` return false on I/O errors, with `errno` saved in the `error` field.
+ */
+
+/**
+ * @brief Minimum size of the buffer of each run during merges, in bytes
+ */
+#ifndef DATASTORE_VEC_EXTERNAL_BLOCK
+	#define DATASTORE_VEC_EXTERNAL_BLOCK (1 << 20)
+#endif
+
+/**
+ * @brief Sorted run stored in a temporary file
+ */
+struct datastore_external_run
+{
+	/** Offset of the first element in the file, in bytes */
+	uint64_t offset;
+	/** Number of elements */
+	uint64_t size;
+};
+
+/**
+ * @brief Growable list of runs
+ */
+struct datastore_external_runs
+{
+	struct datastore_external_run *data;
+	size_t size;
+	size_t capacity;
+};
+
+static inline bool datastore_external_runs_push(struct datastore_external_runs *runs, struct datastore_external_run run)
+{
+	if (runs->size == runs->capacity)
+	{
+		const size_t capacity = runs->capacity ? runs->capacity * 2 : 16;
+		struct datastore_external_run *data = realloc(runs->data, capacity * sizeof(*data));
+		if (!data)
+			return false;
+		runs->data = data;
+		runs->capacity = capacity;
+	}
+	runs->data[runs->size++] = run;
+	return true;
+}
+
+/**
+ * @brief Creates an unlinked temporary file in `dir`, returns -1 on error
+ */
+static inline int datastore_external_tmpfile(const char *dir)
+{
+	if (!dir)
+		dir = getenv("TMPDIR");
+	if (!dir || !*dir)
+		dir = "/tmp";
+	static const char name[] = "/datastore-sort-XXXXXX";
+	const size_t len = strlen(dir);
+	char *path = malloc(len + sizeof(name));
+	if (!path)
+		return -1;
+	memcpy(path, dir, len);
+	memcpy(path + len, name, sizeof(name));
+	const int fd = mkstemp(path);
+	if (fd >= 0)
+	{
+		unlink(path);
+		DATASTORE_MAYBE_UNUSED(posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL));
+	}
+	free(path);
+	return fd;
+}
+
+/**
+ * @brief Writes `size` bytes at `offset`, retrying on partial writes
+ */
+static inline bool datastore_external_pwrite(int fd, const void *data, size_t size, uint64_t offset)
+{
+	const unsigned char *bytes = data;
+	while (size)
+	{
+		const ssize_t written = pwrite(fd, bytes, size, (off_t)offset);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		bytes += written;
+		size -= (size_t)written;
+		offset += (uint64_t)written;
+	}
+	return true;
+}
+
+/**
+ * @brief Writes `size` bytes at the position of `fd`, retrying on partial writes
+ */
+static inline bool datastore_external_write(int fd, const void *data, size_t size)
+{
+	const unsigned char *bytes = data;
+	while (size)
+	{
+		const ssize_t written = write(fd, bytes, size);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		bytes += written;
+		size -= (size_t)written;
+	}
+	return true;
+}
+
+/**
+ * @brief Reads `size` bytes at `offset`, retrying on partial reads
+ */
+static inline bool datastore_external_pread(int fd, void *data, size_t size, uint64_t offset)
+{
+	unsigned char *bytes = data;
+	while (size)
+	{
+		const ssize_t got = pread(fd, bytes, size, (off_t)offset);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0)
+		{
+			if (got == 0)
+				errno = EIO;
+			return false;
+		}
+		bytes += got;
+		size -= (size_t)got;
+		offset += (uint64_t)got;
+	}
+	return true;
+}
+
+/**
+ * @brief External sort methods declaration
+ *
+ * @param trait__ Vector type-trait, must declare a `CMP`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_EXTERNAL_SORT(trait__, name__) \
+/* Read position of a run during a merge */ \
+struct DATASTORE_IDENT(name__, external_cursor) \
+{ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *data; \
+	size_t pos; \
+	size_t len; \
+	size_t block; \
+	uint64_t offset; \
+	uint64_t remaining; \
+}; \
+/** @brief External sorter for a vector type */ \
+struct DATASTORE_IDENT(name__, external) \
+{ \
+	/* Pending elements, then the buffers of the merge */ \
+	struct name__ buffer; \
+	const char *dir; \
+	/* Run file, and the file the next merge pass writes to */ \
+	int fd; \
+	int spare_fd; \
+	uint64_t end; \
+	struct datastore_external_runs runs; \
+	/* Merge state, `tree[0]` is the current winner and other nodes hold losers */ \
+	struct DATASTORE_IDENT(name__, external_cursor) *cursors; \
+	size_t *tree; \
+	size_t leaves; \
+	/* Read position when every element fit in memory */ \
+	size_t pos; \
+	bool finished; \
+	int error; \
+}; \
+struct DATASTORE_IDENT(name__, external) DATASTORE_IDENT(name__, external_new)(size_t budget, const char *dir); \
+void DATASTORE_IDENT(name__, external_free)(struct DATASTORE_IDENT(name__, external) *self); \
+bool DATASTORE_IDENT(name__, external_push)(struct DATASTORE_IDENT(name__, external) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value); \
+bool DATASTORE_IDENT(name__, external_push_many)(struct DATASTORE_IDENT(name__, external) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *values, size_t count); \
+bool DATASTORE_IDENT(name__, external_finish)(struct DATASTORE_IDENT(name__, external) *self); \
+bool DATASTORE_IDENT(name__, external_next)(struct DATASTORE_IDENT(name__, external) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *value); \
+bool DATASTORE_IDENT(name__, external_write_fd)(struct DATASTORE_IDENT(name__, external) *self, int fd);
+
+/**
+ * @brief External sort methods implementation
+ *
+ * @param trait__ Vector type-trait, must declare a `CMP`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_EXTERNAL_SORT_IMPL(trait__, name__) \
+static inline bool DATASTORE_IDENT(name__, impl_ext_less)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *lhs, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *rhs) \
+{ \
+	int cmp = 0; \
+	trait__(DATASTORE_VEC_TRAIT_CMP) \
+	return cmp < 0; \
+} \
+DATASTORE_PDQSORT(DATASTORE_IDENT(name__, impl_ext_pdqsort), trait__(DATASTORE_VEC_TRAIT_TYPE), \
+	DATASTORE_IDENT(name__, impl_ext_less)) \
+struct DATASTORE_IDENT(name__, external) DATASTORE_IDENT(name__, external_new)(size_t budget, const char *dir) \
+{ \
+	size_t capacity = budget / sizeof(trait__(DATASTORE_VEC_TRAIT_TYPE)); \
+	/* A merge needs at least two runs and an output buffer */ \
+	if (capacity < 3) \
+		capacity = 3; \
+	struct DATASTORE_IDENT(name__, external) self = { \
+		.buffer = DATASTORE_IDENT(name__, new)(capacity), \
+		.dir = dir, \
+		.fd = -1, \
+		.spare_fd = -1, \
+	}; \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, external_free)(struct DATASTORE_IDENT(name__, external) *self) \
+{ \
+	/* Elements are plain bytes, FREE is not called */ \
+	self->buffer.size = 0; \
+	DATASTORE_IDENT(name__, free)(&self->buffer); \
+	if (self->fd >= 0) \
+		close(self->fd); \
+	if (self->spare_fd >= 0) \
+		close(self->spare_fd); \
+	self->fd = self->spare_fd = -1; \
+	free(self->runs.data); \
+	free(self->cursors); \
+	free(self->tree); \
+	self->runs = (struct datastore_external_runs){ NULL, 0, 0 }; \
+	self->cursors = NULL; \
+	self->tree = NULL; \
+	self->leaves = 0; \
+} \
+/* Sorts the buffer and appends it as a run to the run file */ \
+static bool DATASTORE_IDENT(name__, impl_ext_spill)(struct DATASTORE_IDENT(name__, external) *self) \
+{ \
+	if (self->fd < 0 && (self->fd = datastore_external_tmpfile(self->dir)) < 0) \
+	{ \
+		self->error = errno; \
+		return false; \
+	} \
+	DATASTORE_IDENT(name__, impl_ext_pdqsort)(self->buffer.data, self->buffer.size); \
+	const size_t bytes = self->buffer.size * sizeof(*self->buffer.data); \
+	const struct datastore_external_run run = { self->end, self->buffer.size }; \
+	if (!datastore_external_pwrite(self->fd, self->buffer.data, bytes, self->end)) \
+	{ \
+		self->error = errno; \
+		return false; \
+	} \
+	if (!datastore_external_runs_push(&self->runs, run)) \
+	{ \
+		self->error = ENOMEM; \
+		return false; \
+	} \
+	self->end += bytes; \
+	self->buffer.size = 0; \
+	return true; \
+} \
+bool DATASTORE_IDENT(name__, external_push)(struct DATASTORE_IDENT(name__, external) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	if (self->finished) \
+		return false; \
+	if (self->buffer.size == self->buffer.capacity && !DATASTORE_IDENT(name__, impl_ext_spill)(self)) \
+		return false; \
+	self->buffer.data[self->buffer.size++] = value; \
+	return true; \
+} \
+bool DATASTORE_IDENT(name__, external_push_many)(struct DATASTORE_IDENT(name__, external) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *values, size_t count) \
+{ \
+	if (self->finished) \
+		return false; \
+	while (count) \
+	{ \
+		if (self->buffer.size == self->buffer.capacity && !DATASTORE_IDENT(name__, impl_ext_spill)(self)) \
+			return false; \
+		size_t n = self->buffer.capacity - self->buffer.size; \
+		n = n < count ? n : count; \
+		memcpy(self->buffer.data + self->buffer.size, values, n * sizeof(*values)); \
+		self->buffer.size += n; \
+		values += n; \
+		count -= n; \
+	} \
+	return true; \
+} \
+/* Reads the next block of a run, leaves `len` to 0 once the run is exhausted */ \
+static bool DATASTORE_IDENT(name__, impl_ext_refill)(struct DATASTORE_IDENT(name__, external) *self, \
+	struct DATASTORE_IDENT(name__, external_cursor) *cursor) \
+{ \
+	const size_t n = cursor->remaining < cursor->block ? (size_t)cursor->remaining : cursor->block; \
+	const size_t bytes = n * sizeof(*cursor->data); \
+	cursor->pos = 0; \
+	cursor->len = n; \
+	if (n && !datastore_external_pread(self->fd, cursor->data, bytes, cursor->offset)) \
+	{ \
+		self->error = errno; \
+		cursor->len = 0; \
+		return false; \
+	} \
+	cursor->offset += bytes; \
+	cursor->remaining -= n; \
+	return true; \
+} \
+/* Whether leaf `a` wins against leaf `b`, exhausted runs always lose, ties go to the first run */ \
+static inline bool DATASTORE_IDENT(name__, impl_ext_beats)(const struct DATASTORE_IDENT(name__, external) *self, \
+	size_t a, size_t b) \
+{ \
+	const struct DATASTORE_IDENT(name__, external_cursor) *x = self->cursors + a; \
+	const struct DATASTORE_IDENT(name__, external_cursor) *y = self->cursors + b; \
+	if (x->pos == x->len) \
+		return false; \
+	if (y->pos == y->len) \
+		return true; \
+	if (a < b) \
+		return !DATASTORE_IDENT(name__, impl_ext_less)(y->data + y->pos, x->data + x->pos); \
+	return DATASTORE_IDENT(name__, impl_ext_less)(x->data + x->pos, y->data + y->pos); \
+} \
+/* Plays the matches of the subtree rooted at `node`, returns its winner */ \
+static size_t DATASTORE_IDENT(name__, impl_ext_build)(struct DATASTORE_IDENT(name__, external) *self, size_t node) \
+{ \
+	if (node >= self->leaves) \
+		return node - self->leaves; \
+	const size_t left = DATASTORE_IDENT(name__, impl_ext_build)(self, 2 * node); \
+	const size_t right = DATASTORE_IDENT(name__, impl_ext_build)(self, 2 * node + 1); \
+	if (DATASTORE_IDENT(name__, impl_ext_beats)(self, left, right)) \
+	{ \
+		self->tree[node] = right; \
+		return left; \
+	} \
+	self->tree[node] = left; \
+	return right; \
+} \
+/* Sets up a merge of `count` runs, each reading through a slice of `block` elements */ \
+static bool DATASTORE_IDENT(name__, impl_ext_start)(struct DATASTORE_IDENT(name__, external) *self, \
+	const struct datastore_external_run *runs, size_t count, size_t block) \
+{ \
+	size_t leaves = 1; \
+	while (leaves < count) \
+		leaves *= 2; \
+	if (leaves > self->leaves) \
+	{ \
+		free(self->cursors); \
+		free(self->tree); \
+		self->cursors = malloc(leaves * sizeof(*self->cursors)); \
+		self->tree = malloc(leaves * sizeof(*self->tree)); \
+		if (!self->cursors || !self->tree) \
+		{ \
+			self->leaves = 0; \
+			self->error = ENOMEM; \
+			return false; \
+		} \
+	} \
+	self->leaves = leaves; \
+	for (size_t i = 0; i < leaves; ++i) \
+	{ \
+		struct DATASTORE_IDENT(name__, external_cursor) *cursor = self->cursors + i; \
+		*cursor = (struct DATASTORE_IDENT(name__, external_cursor)){ .block = block }; \
+		if (i < count) \
+		{ \
+			cursor->data = self->buffer.data + i * block; \
+			cursor->offset = runs[i].offset; \
+			cursor->remaining = runs[i].size; \
+			if (!DATASTORE_IDENT(name__, impl_ext_refill)(self, cursor)) \
+				return false; \
+		} \
+	} \
+	self->tree[0] = DATASTORE_IDENT(name__, impl_ext_build)(self, 1); \
+	return true; \
+} \
+/* Moves the smallest element of the merge to `value` */ \
+static bool DATASTORE_IDENT(name__, impl_ext_pop)(struct DATASTORE_IDENT(name__, external) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *value) \
+{ \
+	size_t winner = self->tree[0]; \
+	struct DATASTORE_IDENT(name__, external_cursor) *cursor = self->cursors + winner; \
+	if (cursor->pos == cursor->len) \
+		return false; \
+	*value = cursor->data[cursor->pos++]; \
+	if (cursor->pos == cursor->len && !DATASTORE_IDENT(name__, impl_ext_refill)(self, cursor)) \
+		return false; \
+	for (size_t node = (winner + self->leaves) / 2; node; node /= 2) \
+		if (DATASTORE_IDENT(name__, impl_ext_beats)(self, self->tree[node], winner)) \
+		{ \
+			const size_t loser = winner; \
+			winner = self->tree[node]; \
+			self->tree[node] = loser; \
+		} \
+	self->tree[0] = winner; \
+	return true; \
+} \
+/* Drains the merge into `fd` through the output slice of the buffer, at `*offset` if not NULL */ \
+static bool DATASTORE_IDENT(name__, impl_ext_drain)(struct DATASTORE_IDENT(name__, external) *self, \
+	int fd, uint64_t *offset) \
+{ \
+	const size_t block = self->cursors[0].block; \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *out = self->buffer.data + self->buffer.capacity - block; \
+	size_t n = 0; \
+	for (;;) \
+	{ \
+		const bool more = DATASTORE_IDENT(name__, impl_ext_pop)(self, out + n); \
+		if (!more && self->error) \
+			return false; \
+		n += more; \
+		if (n == block || (!more && n)) \
+		{ \
+			const size_t bytes = n * sizeof(*out); \
+			if (offset ? !datastore_external_pwrite(fd, out, bytes, *offset) \
+				: !datastore_external_write(fd, out, bytes)) \
+			{ \
+				self->error = errno; \
+				return false; \
+			} \
+			if (offset) \
+				*offset += bytes; \
+			n = 0; \
+		} \
+		if (!more) \
+			return true; \
+	} \
+} \
+bool DATASTORE_IDENT(name__, external_finish)(struct DATASTORE_IDENT(name__, external) *self) \
+{ \
+	if (self->finished) \
+		return !self->error; \
+	self->finished = true; \
+	if (self->fd < 0) \
+	{ \
+		DATASTORE_IDENT(name__, impl_ext_pdqsort)(self->buffer.data, self->buffer.size); \
+		return true; \
+	} \
+	if (self->buffer.size && !DATASTORE_IDENT(name__, impl_ext_spill)(self)) \
+		return false; \
+	/* Each run and the output get a slice of at least DATASTORE_VEC_EXTERNAL_BLOCK bytes */ \
+	const size_t min_block = DATASTORE_VEC_EXTERNAL_BLOCK / sizeof(*self->buffer.data); \
+	size_t fan_in = self->buffer.capacity / (min_block ? min_block : 1); \
+	fan_in = fan_in > 3 ? fan_in - 1 : 2; \
+	while (self->runs.size > fan_in) \
+	{ \
+		/* Merges groups of runs into the spare file, which then becomes the run file */ \
+		if (self->spare_fd < 0 && (self->spare_fd = datastore_external_tmpfile(self->dir)) < 0) \
+		{ \
+			self->error = errno; \
+			return false; \
+		} \
+		struct datastore_external_runs merged = { NULL, 0, 0 }; \
+		uint64_t end = 0; \
+		for (size_t first = 0; first < self->runs.size; first += fan_in) \
+		{ \
+			const size_t count = self->runs.size - first < fan_in ? self->runs.size - first : fan_in; \
+			struct datastore_external_run run = { end, 0 }; \
+			for (size_t i = 0; i < count; ++i) \
+				run.size += self->runs.data[first + i].size; \
+			if (!DATASTORE_IDENT(name__, impl_ext_start)(self, self->runs.data + first, count, \
+					self->buffer.capacity / (count + 1)) \
+				|| !DATASTORE_IDENT(name__, impl_ext_drain)(self, self->spare_fd, &end)) \
+			{ \
+				free(merged.data); \
+				return false; \
+			} \
+			if (!datastore_external_runs_push(&merged, run)) \
+			{ \
+				free(merged.data); \
+				self->error = ENOMEM; \
+				return false; \
+			} \
+		} \
+		free(self->runs.data); \
+		self->runs = merged; \
+		const int fd = self->fd; \
+		self->fd = self->spare_fd; \
+		self->spare_fd = fd; \
+		self->end = end; \
+		if (ftruncate(self->spare_fd, 0) != 0) \
+		{ \
+			self->error = errno; \
+			return false; \
+		} \
+	} \
+	return DATASTORE_IDENT(name__, impl_ext_start)(self, self->runs.data, self->runs.size, \
+		self->buffer.capacity / (self->runs.size + 1)); \
+} \
+bool DATASTORE_IDENT(name__, external_next)(struct DATASTORE_IDENT(name__, external) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *value) \
+{ \
+	if (!self->finished || self->error) \
+		return false; \
+	if (self->fd < 0) \
+	{ \
+		if (self->pos == self->buffer.size) \
+			return false; \
+		*value = self->buffer.data[self->pos++]; \
+		return true; \
+	} \
+	return DATASTORE_IDENT(name__, impl_ext_pop)(self, value); \
+} \
+bool DATASTORE_IDENT(name__, external_write_fd)(struct DATASTORE_IDENT(name__, external) *self, int fd) \
+{ \
+	if (!self->finished || self->error) \
+		return false; \
+	if (self->fd >= 0) \
+		return DATASTORE_IDENT(name__, impl_ext_drain)(self, fd, NULL); \
+	const size_t size = self->buffer.size - self->pos; \
+	if (!datastore_external_write(fd, self->buffer.data + self->pos, size * sizeof(*self->buffer.data))) \
+	{ \
+		self->error = errno; \
+		return false; \
+	} \
+	self->pos = self->buffer.size; \
+	return true; \
+}
+
+/** @endgroup VectorExternal */
+
+#endif // DATASTORE_VEC_EXTERNAL_H
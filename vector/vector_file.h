@@ -0,0 +1,387 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_VEC_FILE_H
+#define DATASTORE_VEC_FILE_H
+
+#include "vector.h"
+#include "vector_io.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @file vector_file.h
+ * @defgroup VectorFile DATASTORE_VEC file settings: Persistent vectors backed by a file
+ *
+ * @brief Persistent vectors backed by a file
+ *
+ * @ref DATASTORE_VEC_SETTINGS_FILE stores a vector in a shared mapping of a file, in the format
+ * of @ref VectorIo "vector_io.h": elements are written to the page cache directly, there is no
+ * copy between the heap and the file and no serialization pass. Growing the vector grows the
+ * file with `ftruncate` and maps the new size.
+ *
+ * A vector is bound to a file with `open_file`, which loads the elements already stored there.
+ * Vectors created otherwise (`new`, `clone`, first `push` on an empty vector) live in an
+ * anonymous memory file. The number of elements is only written to the file by `sync`, which
+ * then flushes the dirty ranges with `msync`: elements appended since the last `sync`, and
+ * ranges passed to `mark_dirty` for elements modified in place.
+ *
+ * Two mapping modes are available:
+ * - By default, growing maps the file again, possibly at another address.
+ * - With @ref DATASTORE_VEC_FILE_STABLE, @ref DATASTORE_VEC_FILE_RESERVE bytes of address space
+ *   are reserved up front and the file grows inside them: `data` never moves, and pointers to
+ *   elements stay valid across `push` and `reserve`.
+ *
+ * `free` unmaps the file without syncing, and so does `shrink_to_fit` on an empty vector: the
+ * vector is then detached from its file.
+ *
+ * The checksum of the header is not maintained: files carry @ref DATASTORE_VEC_FILE_UNCHECKED,
+ * and can still be read with `read_fd` and `map_file`.
+ *
+ * Elements are stored bitwise, the vector's type must not own resources. This header needs
+ * `MAP_ANONYMOUS`: define `_GNU_SOURCE` before including any system header.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * DATASTORE_VEC(struct event, log)
+ * DATASTORE_VEC_FILE(EVENT_TRAIT, log)
+ * DATASTORE_VEC_IMPL_S(EVENT_TRAIT, log, DATASTORE_VEC_SETTINGS_FILE)
+ * DATASTORE_VEC_FILE_IMPL(EVENT_TRAIT, log)
+ *
+ * struct log events = log_new(0);
+ * if (log_open_file(&events, "events.bin", 0) != DATASTORE_VEC_IO_OK)
+ * 	fail();
+ * log_push(&events, event); // Appended after the events of previous runs
+ * log_sync(&events);
+ * log_free(&events);
+ * @endcode
+ *
+ * # Exposed methods
+ *
+ * - `enum datastore_vec_io open_file(struct vec *self, const char *path, unsigned flags)`: Binds
+ *   `self` to `path`, created if needed, with the elements stored in the file. `self` must be
+ *   initialized, the vector it held is freed on success and left unchanged on error
+ * - `enum datastore_vec_io sync(struct vec *self)`: Writes the number of elements and flushes
+ *   the dirty ranges to the file
+ * - `void mark_dirty(struct vec *self, size_t begin, size_t end)`: Records that the elements in
+ *   `[begin, end)` were modified in place
+ *
+ * Each method must be prefixed by the name of the vector type + `_`.
+ */
+
+/**
+ * @brief `open_file` flag: keep `data` at the same address while the vector grows
+ */
+#define DATASTORE_VEC_FILE_STABLE 1u
+
+/**
+ * @brief Address space reserved for a vector opened with @ref DATASTORE_VEC_FILE_STABLE, in
+ * bytes
+ *
+ * Growing past this limit aborts.
+ */
+#ifndef DATASTORE_VEC_FILE_RESERVE
+	#define DATASTORE_VEC_FILE_RESERVE ((size_t)64 << 30)
+#endif
+
+/**
+ * @brief State of a file-backed vector
+ *
+ * Stored in an anonymous page mapped right before the file, so it is found from `data`.
+ */
+struct datastore_vec_file
+{
+	int fd;
+	bool stable;
+	/** Bytes of the file mapped, header included */
+	size_t mapped;
+	/** Bytes of address space after the state page */
+	size_t reserved;
+	/** Number of elements written to the header by the last sync */
+	size_t synced;
+	/** Elements modified in place since the last sync */
+	size_t dirty_begin;
+	size_t dirty_end;
+};
+
+static inline size_t datastore_vec_file_page(void)
+{
+	return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * @brief State of the file-backed vector whose elements start at `data`
+ */
+static inline struct datastore_vec_file *datastore_vec_file_state(void *data)
+{
+	return (struct datastore_vec_file *)(void *)((unsigned char *)data - DATASTORE_VEC_FILE_HEADER
+		- datastore_vec_file_page());
+}
+
+/**
+ * @brief Maps `length` bytes of `fd` after a state page
+ *
+ * @returns Pointer to the elements, NULL on failure
+ */
+static inline void *datastore_vec_file_map(int fd, size_t length, bool stable)
+{
+	const size_t page = datastore_vec_file_page();
+	const size_t reserved = stable ? DATASTORE_VEC_FILE_RESERVE : datastore_vec_mmap_round(length);
+	if (length > reserved)
+		return NULL;
+	unsigned char *base = mmap(NULL, page + reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (base == MAP_FAILED)
+		return NULL;
+	if (mprotect(base, page, PROT_READ | PROT_WRITE)
+		|| mmap(base + page, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+	{
+		munmap(base, page + reserved);
+		return NULL;
+	}
+	struct datastore_vec_file *state = (struct datastore_vec_file *)(void *)base;
+	*state = (struct datastore_vec_file){
+		.fd = fd,
+		.stable = stable,
+		.mapped = length,
+		.reserved = reserved,
+		.dirty_begin = SIZE_MAX,
+	};
+	return base + page + DATASTORE_VEC_FILE_HEADER;
+}
+
+/**
+ * @brief Writes a new header for `size` elements of `elem_size` bytes at the start of `fd`
+ */
+static inline bool datastore_vec_file_init(int fd, size_t elem_size)
+{
+	struct datastore_vec_file_header header = datastore_vec_file_header("", elem_size, 0);
+	header.flags |= DATASTORE_VEC_FILE_UNCHECKED;
+	return pwrite(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header);
+}
+
+/**
+ * @brief Creates a vector of `size` bytes in an anonymous memory file
+ */
+static inline void *datastore_vec_file_alloc(size_t size, size_t elem_size)
+{
+#ifdef MFD_CLOEXEC
+	const int fd = memfd_create("datastore-vec", MFD_CLOEXEC);
+#else
+	char path[] = "/tmp/datastore-vec-XXXXXX";
+	const int fd = mkstemp(path);
+	if (fd >= 0)
+		unlink(path);
+#endif
+	if (fd < 0)
+		return NULL;
+	void *data = NULL;
+	if (ftruncate(fd, (off_t)(DATASTORE_VEC_FILE_HEADER + size)) == 0 && datastore_vec_file_init(fd, elem_size))
+		data = datastore_vec_file_map(fd, DATASTORE_VEC_FILE_HEADER + size, false);
+	if (!data)
+		close(fd);
+	return data;
+}
+
+/**
+ * @brief Resizes the file of a vector to hold `size` bytes of elements
+ *
+ * Stable vectors map the new size at the same address, others map the file again.
+ *
+ * @returns Pointer to the elements, NULL on failure
+ */
+static inline void *datastore_vec_file_realloc(void *ptr, size_t size, size_t elem_size)
+{
+	if (!ptr)
+		return datastore_vec_file_alloc(size, elem_size);
+	struct datastore_vec_file *state = datastore_vec_file_state(ptr);
+	const size_t page = datastore_vec_file_page();
+	unsigned char *base = (unsigned char *)state;
+	const size_t length = DATASTORE_VEC_FILE_HEADER + size;
+	if (length > state->reserved && state->stable)
+		return NULL;
+	if (ftruncate(state->fd, (off_t)length) != 0)
+		return NULL;
+	if (!state->stable)
+	{
+		void *data = datastore_vec_file_map(state->fd, length, false);
+		if (!data)
+			return NULL;
+		struct datastore_vec_file *moved = datastore_vec_file_state(data);
+		*moved = *state;
+		moved->mapped = length;
+		moved->reserved = datastore_vec_mmap_round(length);
+		munmap(base, page + state->reserved);
+		return data;
+	}
+	// Pages past the new end go back to the reservation
+	const size_t old_end = datastore_vec_mmap_round(state->mapped);
+	const size_t new_end = datastore_vec_mmap_round(length);
+	if (new_end < old_end
+		&& mmap(base + page + new_end, old_end - new_end, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+			-1, 0) == MAP_FAILED)
+		return NULL;
+	if (mmap(base + page, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, state->fd, 0) == MAP_FAILED)
+		return NULL;
+	state->mapped = length;
+	return ptr;
+}
+
+/**
+ * @brief Unmaps a file-backed vector and closes its file
+ */
+static inline void datastore_vec_file_free(void *ptr)
+{
+	if (!ptr)
+		return;
+	struct datastore_vec_file *state = datastore_vec_file_state(ptr);
+	const int fd = state->fd;
+	munmap(state, datastore_vec_file_page() + state->reserved);
+	close(fd);
+}
+
+/**
+ * @brief Settings for vectors stored in a file
+ *
+ * Capacities are not rounded to pages, so the file keeps the exact size of the vector's buffer.
+ */
+#define DATASTORE_VEC_SETTINGS_FILE(X) \
+	X(NEW, { ptr = datastore_vec_file_alloc(size, sizeof(*ptr)); if (!ptr) abort(); }) \
+	X(REALLOC, { ptr = datastore_vec_file_realloc(ptr, size, sizeof(*ptr)); if (!ptr) abort(); }) \
+	X(FREE, { datastore_vec_file_free(ptr); }) \
+	X(GROW, { new_capacity = datastore_vec_grow_policy(capacity, elem_size); })
+
+/**
+ * @brief File methods declaration
+ *
+ * The vector type must be implemented with @ref DATASTORE_VEC_SETTINGS_FILE.
+ *
+ * @param trait__ Vector type-trait, see @ref trait_type "Trait Type"
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_FILE(trait__, name__) \
+enum datastore_vec_io DATASTORE_IDENT(name__, open_file)(struct name__ *self, const char *path, unsigned flags); \
+enum datastore_vec_io DATASTORE_IDENT(name__, sync)(struct name__ *self); \
+void DATASTORE_IDENT(name__, mark_dirty)(struct name__ *self, size_t begin, size_t end);
+
+/**
+ * @brief File methods implementation
+ *
+ * @param trait__ Vector type-trait, see @ref trait_type "Trait Type"
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_FILE_IMPL(trait__, name__) \
+enum datastore_vec_io DATASTORE_IDENT(name__, open_file)(struct name__ *self, const char *path, unsigned flags) \
+{ \
+	const size_t elem_size = sizeof(trait__(DATASTORE_VEC_TRAIT_TYPE)); \
+	const int fd = open(path, O_RDWR | O_CREAT, 0644); \
+	if (fd < 0) \
+		return DATASTORE_VEC_IO_ERRNO; \
+	struct stat st; \
+	enum datastore_vec_io status = DATASTORE_VEC_IO_OK; \
+	struct datastore_vec_file_header header; \
+	if (fstat(fd, &st) != 0) \
+		status = DATASTORE_VEC_IO_ERRNO; \
+	else if (st.st_size == 0) \
+	{ \
+		if (!datastore_vec_file_init(fd, elem_size) || ftruncate(fd, DATASTORE_VEC_FILE_HEADER) != 0) \
+			status = DATASTORE_VEC_IO_ERRNO; \
+		st.st_size = DATASTORE_VEC_FILE_HEADER; \
+	} \
+	if (status == DATASTORE_VEC_IO_OK) \
+	{ \
+		if (st.st_size < DATASTORE_VEC_FILE_HEADER) \
+			status = DATASTORE_VEC_IO_TRUNCATED; \
+		else if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) \
+			status = DATASTORE_VEC_IO_ERRNO; \
+		else \
+			status = datastore_vec_file_check(&header, elem_size, UINT64_MAX); \
+	} \
+	const size_t length = (size_t)st.st_size; \
+	/* The buffer spans the whole file, the header tells how many elements are in use */ \
+	const size_t capacity = status == DATASTORE_VEC_IO_OK ? (length - DATASTORE_VEC_FILE_HEADER) / elem_size : 0; \
+	if (status == DATASTORE_VEC_IO_OK && header.size > capacity) \
+		status = DATASTORE_VEC_IO_TRUNCATED; \
+	if (status == DATASTORE_VEC_IO_OK && !(header.flags & DATASTORE_VEC_FILE_UNCHECKED)) \
+	{ \
+		header.flags |= DATASTORE_VEC_FILE_UNCHECKED; \
+		if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) \
+			status = DATASTORE_VEC_IO_ERRNO; \
+	} \
+	if (status != DATASTORE_VEC_IO_OK) \
+	{ \
+		close(fd); \
+		return status; \
+	} \
+	void *data = datastore_vec_file_map(fd, length, flags & DATASTORE_VEC_FILE_STABLE); \
+	if (!data) \
+	{ \
+		close(fd); \
+		return DATASTORE_VEC_IO_ERRNO; \
+	} \
+	datastore_vec_file_state(data)->synced = (size_t)header.size; \
+	DATASTORE_IDENT(name__, free)(self); \
+	self->data = data; \
+	self->capacity = capacity; \
+	self->size = (size_t)header.size; \
+	return DATASTORE_VEC_IO_OK; \
+} \
+enum datastore_vec_io DATASTORE_IDENT(name__, sync)(struct name__ *self) \
+{ \
+	if (!self->data) \
+		return DATASTORE_VEC_IO_OK; \
+	struct datastore_vec_file *state = datastore_vec_file_state(self->data); \
+	const size_t page = datastore_vec_file_page(); \
+	const size_t elem_size = sizeof(*self->data); \
+	const size_t begin = state->synced < state->dirty_begin ? state->synced : state->dirty_begin; \
+	size_t end = self->size > state->dirty_end ? self->size : state->dirty_end; \
+	end = end < self->capacity ? end : self->capacity; \
+	unsigned char *const elements = (unsigned char *)self->data; \
+	/* Elements first, so that the header never counts elements missing from the file */ \
+	if (begin < end) \
+	{ \
+		const uintptr_t from = (uintptr_t)(elements + begin * elem_size) & ~(uintptr_t)(page - 1); \
+		const uintptr_t to = (uintptr_t)(elements + end * elem_size); \
+		if (msync((void *)from, (size_t)(to - from), MS_SYNC) != 0) \
+			return DATASTORE_VEC_IO_ERRNO; \
+	} \
+	struct datastore_vec_file_header *header = (struct datastore_vec_file_header *)(void *)(elements - DATASTORE_VEC_FILE_HEADER); \
+	header->size = self->size; \
+	if (msync(header, sizeof(*header), MS_SYNC) != 0) \
+		return DATASTORE_VEC_IO_ERRNO; \
+	state->synced = self->size; \
+	state->dirty_begin = SIZE_MAX; \
+	state->dirty_end = 0; \
+	return DATASTORE_VEC_IO_OK; \
+} \
+void DATASTORE_IDENT(name__, mark_dirty)(struct name__ *self, size_t begin, size_t end) \
+{ \
+	assert(begin <= end && end <= self->size); \
+	if (begin == end) \
+		return; \
+	struct datastore_vec_file *state = datastore_vec_file_state(self->data); \
+	state->dirty_begin = begin < state->dirty_begin ? begin : state->dirty_begin; \
+	state->dirty_end = end > state->dirty_end ? end : state->dirty_end; \
+}
+
+/** @endgroup VectorFile */
+
+#endif // DATASTORE_VEC_FILE_H
@@ -0,0 +1,536 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_VEC_IO_H
+#define DATASTORE_VEC_IO_H
+
+#include "vector.h"
+#include "vector_mmap.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @file vector_io.h
+ * @defgroup VectorIo DATASTORE_VEC I/O: Binary serialization and mapped views of vectors
+ *
+ * @brief Binary serialization and mapped views of vectors
+ *
+ * Vectors are stored as a 64 bytes header followed by the bytes of the elements:
+ *
+ * | Offset | Size | Field                                                    |
+ * |--------|------|----------------------------------------------------------|
+ * | 0      | 8    | Magic, @ref DATASTORE_VEC_FILE_MAGIC                     |
+ * | 8      | 4    | Format version, @ref DATASTORE_VEC_FILE_VERSION          |
+ * | 12     | 4    | `0x01020304` in the byte order of the writer             |
+ * | 16     | 8    | Size of an element, in bytes                             |
+ * | 24     | 8    | Number of elements                                       |
+ * | 32     | 8    | XXH64 (seed 0) of the element bytes                      |
+ * | 40     | 4    | Flags, see @ref DATASTORE_VEC_FILE_UNCHECKED             |
+ * | 44     | 20   | Reserved, zero                                           |
+ *
+ * Header fields use the byte order of the writer. Files are only read back on machines with
+ * the same byte order, since elements are written bitwise: the vector's type must not own
+ * resources (pointers are meaningless in another process).
+ *
+ * @ref DATASTORE_VEC_IO adds `write_fd` and `read_fd`. @ref DATASTORE_VEC_MAP adds `map_file`,
+ * which maps a file read-only instead of reading it: the vector's elements are the pages of the
+ * file, loaded by the kernel on first access. Mapped vectors must use the
+ * @ref DATASTORE_VEC_SETTINGS_MAPPED settings, whose `FREE` unmaps the file.
+ *
+ * This header needs `MAP_ANONYMOUS`: define `_GNU_SOURCE` before including any system header.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * // Regular vector, serialized with read/write
+ * DATASTORE_VEC(float, vf)
+ * DATASTORE_VEC_IO(FLOAT_TRAIT, vf)
+ * DATASTORE_VEC_IMPL(FLOAT_TRAIT, vf)
+ * DATASTORE_VEC_IO_IMPL(FLOAT_TRAIT, vf)
+ * // Vector type for mapped files
+ * DATASTORE_VEC(float, vf_view)
+ * DATASTORE_VEC_MAP(FLOAT_TRAIT, vf_view)
+ * DATASTORE_VEC_IMPL_S(FLOAT_TRAIT, vf_view, DATASTORE_VEC_SETTINGS_MAPPED)
+ * DATASTORE_VEC_MAP_IMPL(FLOAT_TRAIT, vf_view)
+ *
+ * vf_write_fd(&values, fd);
+ * ...
+ * struct vf_view view;
+ * if (vf_view_map_file(&view, "values.bin", false) != DATASTORE_VEC_IO_OK)
+ * 	fail();
+ * sum(view.data, view.size);
+ * vf_view_free(&view); // Unmaps the file
+ * @endcode
+ *
+ * # Exposed methods
+ *
+ * With @ref DATASTORE_VEC_IO:
+ * - `enum datastore_vec_io write_fd(const struct vec *self, int fd)`: Writes the header and the
+ *   elements at the position of `fd`
+ * - `enum datastore_vec_io read_fd(struct vec *self, int fd)`: Reads a vector at the position of
+ *   `fd` and appends its elements to `self`. The elements of `self` are unchanged on error, but
+ *   its capacity may have grown
+ *
+ * With @ref DATASTORE_VEC_MAP:
+ * - `enum datastore_vec_io map_file(struct vec *self, const char *path, bool verify)`: Maps the
+ *   vector stored in `path` to `self`, checking the checksum when `verify` is true (this reads
+ *   the whole file). `self` is unchanged on error
+ *
+ * Each method must be prefixed by the name of the vector type + `_`.
+ *
+ * Mapped elements are read-only. Growing a mapped vector (`push`, `reserve`) copies it to
+ * anonymous memory, which can then be modified; the file is never written.
+ */
+
+/**
+ * @brief Size of the file header, elements start at this offset
+ */
+#define DATASTORE_VEC_FILE_HEADER 64
+
+/**
+ * @brief First 8 bytes of a vector file
+ */
+#define DATASTORE_VEC_FILE_MAGIC "DSVEC\r\n\x1a"
+
+/**
+ * @brief Current version of the file format
+ */
+#define DATASTORE_VEC_FILE_VERSION 1
+
+/**
+ * @brief Header flag: the checksum is not maintained and must not be verified
+ *
+ * Set by files modified in place, see @ref VectorFile "vector_file.h".
+ */
+#define DATASTORE_VEC_FILE_UNCHECKED 1u
+
+/**
+ * @brief Bytes read before growing the vector further, when `read_fd` reads from a pipe or socket
+ *
+ * The size in the header is not trusted: regular files are checked against their length, other
+ * descriptors only grow the vector as data arrives.
+ */
+#ifndef DATASTORE_VEC_IO_CHUNK
+	#define DATASTORE_VEC_IO_CHUNK ((size_t)1 << 20)
+#endif
+
+/**
+ * @brief Header of a vector file
+ */
+struct datastore_vec_file_header
+{
+	unsigned char magic[8];
+	uint32_t version;
+	uint32_t endian;
+	uint64_t elem_size;
+	uint64_t size;
+	uint64_t checksum;
+	uint32_t flags;
+	unsigned char reserved[20];
+};
+
+typedef char datastore_vec_file_header_size[sizeof(struct datastore_vec_file_header) == DATASTORE_VEC_FILE_HEADER ? 1 : -1];
+
+/**
+ * @brief Result of the I/O methods
+ */
+enum datastore_vec_io
+{
+	/** Success */
+	DATASTORE_VEC_IO_OK = 0,
+	/** A system call failed, see `errno` */
+	DATASTORE_VEC_IO_ERRNO,
+	/** Not a vector file, or an unknown version */
+	DATASTORE_VEC_IO_FORMAT,
+	/** Written on a machine with a different byte order */
+	DATASTORE_VEC_IO_ENDIAN,
+	/** Elements have a different size than the vector's type */
+	DATASTORE_VEC_IO_ELEM_SIZE,
+	/** The file is shorter or longer than its header says */
+	DATASTORE_VEC_IO_TRUNCATED,
+	/** The elements do not match the checksum */
+	DATASTORE_VEC_IO_CHECKSUM,
+};
+
+// {{{ XXH64
+#define DATASTORE_XXH_P1 11400714785074694791ull
+#define DATASTORE_XXH_P2 14029467366897019727ull
+#define DATASTORE_XXH_P3 1609587929392839161ull
+#define DATASTORE_XXH_P4 9650029242287828579ull
+#define DATASTORE_XXH_P5 2870177450012600261ull
+
+static inline uint64_t datastore_xxh_rotl(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t datastore_xxh_round(uint64_t acc, uint64_t input)
+{
+	acc += input * DATASTORE_XXH_P2;
+	return datastore_xxh_rotl(acc, 31) * DATASTORE_XXH_P1;
+}
+
+static inline uint64_t datastore_xxh_merge(uint64_t acc, uint64_t lane)
+{
+	acc ^= datastore_xxh_round(0, lane);
+	return acc * DATASTORE_XXH_P1 + DATASTORE_XXH_P4;
+}
+
+static inline uint64_t datastore_xxh_read64(const unsigned char *p)
+{
+	uint64_t x;
+	memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+/**
+ * @brief XXH64 of `size` bytes with seed 0, reading words in native byte order
+ *
+ * Matches the reference XXH64 on little-endian machines.
+ */
+static inline uint64_t datastore_vec_checksum(const void *data, size_t size)
+{
+	const unsigned char *p = data;
+	const unsigned char *const end = p + size;
+	uint64_t h;
+	if (size >= 32)
+	{
+		uint64_t v1 = DATASTORE_XXH_P1 + DATASTORE_XXH_P2;
+		uint64_t v2 = DATASTORE_XXH_P2;
+		uint64_t v3 = 0;
+		uint64_t v4 = 0 - DATASTORE_XXH_P1;
+		// Four independent lanes keep the multipliers busy
+		for (; end - p >= 32; p += 32)
+		{
+			v1 = datastore_xxh_round(v1, datastore_xxh_read64(p));
+			v2 = datastore_xxh_round(v2, datastore_xxh_read64(p + 8));
+			v3 = datastore_xxh_round(v3, datastore_xxh_read64(p + 16));
+			v4 = datastore_xxh_round(v4, datastore_xxh_read64(p + 24));
+		}
+		h = datastore_xxh_rotl(v1, 1) + datastore_xxh_rotl(v2, 7) + datastore_xxh_rotl(v3, 12)
+			+ datastore_xxh_rotl(v4, 18);
+		h = datastore_xxh_merge(h, v1);
+		h = datastore_xxh_merge(h, v2);
+		h = datastore_xxh_merge(h, v3);
+		h = datastore_xxh_merge(h, v4);
+	}
+	else
+		h = DATASTORE_XXH_P5;
+	h += (uint64_t)size;
+	for (; end - p >= 8; p += 8)
+	{
+		h ^= datastore_xxh_round(0, datastore_xxh_read64(p));
+		h = datastore_xxh_rotl(h, 27) * DATASTORE_XXH_P1 + DATASTORE_XXH_P4;
+	}
+	if (end - p >= 4)
+	{
+		uint32_t x;
+		memcpy(&x, p, sizeof(x));
+		h ^= (uint64_t)x * DATASTORE_XXH_P1;
+		h = datastore_xxh_rotl(h, 23) * DATASTORE_XXH_P2 + DATASTORE_XXH_P3;
+		p += 4;
+	}
+	for (; p < end; ++p)
+	{
+		h ^= *p * DATASTORE_XXH_P5;
+		h = datastore_xxh_rotl(h, 11) * DATASTORE_XXH_P1;
+	}
+	h ^= h >> 33;
+	h *= DATASTORE_XXH_P2;
+	h ^= h >> 29;
+	h *= DATASTORE_XXH_P3;
+	h ^= h >> 32;
+	return h;
+}
+// }}}
+
+/**
+ * @brief Builds the header of `size` elements of `elem_size` bytes stored at `data`
+ */
+static inline struct datastore_vec_file_header datastore_vec_file_header(const void *data, size_t elem_size,
+		size_t size)
+{
+	struct datastore_vec_file_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DATASTORE_VEC_FILE_MAGIC, sizeof(header.magic));
+	header.version = DATASTORE_VEC_FILE_VERSION;
+	header.endian = 0x01020304u;
+	header.elem_size = elem_size;
+	header.size = size;
+	header.checksum = datastore_vec_checksum(data, elem_size * size);
+	return header;
+}
+
+/**
+ * @brief Checks a header against the element size of a vector type
+ *
+ * @param bytes Number of bytes following the header, or `UINT64_MAX` when unknown
+ */
+static inline enum datastore_vec_io datastore_vec_file_check(const struct datastore_vec_file_header *header,
+		size_t elem_size, uint64_t bytes)
+{
+	if (memcmp(header->magic, DATASTORE_VEC_FILE_MAGIC, sizeof(header->magic)))
+		return DATASTORE_VEC_IO_FORMAT;
+	if (header->endian != 0x01020304u)
+		return header->endian == 0x04030201u ? DATASTORE_VEC_IO_ENDIAN : DATASTORE_VEC_IO_FORMAT;
+	if (header->version != DATASTORE_VEC_FILE_VERSION)
+		return DATASTORE_VEC_IO_FORMAT;
+	if (header->elem_size != elem_size)
+		return DATASTORE_VEC_IO_ELEM_SIZE;
+	if (header->size > SIZE_MAX / elem_size)
+		return DATASTORE_VEC_IO_TRUNCATED;
+	if (bytes != UINT64_MAX && bytes != header->size * elem_size)
+		return DATASTORE_VEC_IO_TRUNCATED;
+	return DATASTORE_VEC_IO_OK;
+}
+
+/**
+ * @brief Writes `size` bytes at the position of `fd`, retrying on partial writes
+ */
+static inline bool datastore_vec_io_write(int fd, const void *data, size_t size)
+{
+	const unsigned char *bytes = data;
+	while (size)
+	{
+		const ssize_t written = write(fd, bytes, size);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		bytes += written;
+		size -= (size_t)written;
+	}
+	return true;
+}
+
+/**
+ * @brief Reads up to `size` bytes at the position of `fd`, stopping early only at end of file
+ *
+ * @returns The number of bytes read, `SIZE_MAX` on error
+ */
+static inline size_t datastore_vec_io_read(int fd, void *data, size_t size)
+{
+	unsigned char *bytes = data;
+	size_t total = 0;
+	while (total < size)
+	{
+		const ssize_t got = read(fd, bytes + total, size - total);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got < 0)
+			return SIZE_MAX;
+		if (got == 0)
+			break;
+		total += (size_t)got;
+	}
+	return total;
+}
+
+// {{{ Mapped settings
+/*
+ * Mapped vectors point `DATASTORE_VEC_FILE_HEADER` bytes after the start of their mapping, so
+ * files map with their header and anonymous mappings keep the same layout.
+ */
+
+/**
+ * @brief Allocates `size` bytes after an unused header, in anonymous memory
+ */
+static inline void *datastore_vec_mapped_alloc(size_t size)
+{
+	unsigned char *base = datastore_vec_mmap_alloc(DATASTORE_VEC_FILE_HEADER + size);
+	return base ? base + DATASTORE_VEC_FILE_HEADER : NULL;
+}
+
+/**
+ * @brief Unmaps a mapped vector of `size` bytes, anonymous or file-backed
+ */
+static inline void datastore_vec_mapped_free(void *ptr, size_t size)
+{
+	if (ptr)
+		munmap((unsigned char *)ptr - DATASTORE_VEC_FILE_HEADER, DATASTORE_VEC_FILE_HEADER + size);
+}
+
+/**
+ * @brief Moves a mapped vector to an anonymous mapping of `size` bytes
+ *
+ * Always copies: the old mapping may be a read-only file.
+ */
+static inline void *datastore_vec_mapped_realloc(void *ptr, size_t old_size, size_t size)
+{
+	void *new = datastore_vec_mapped_alloc(size);
+	if (!new)
+		return NULL;
+	if (ptr)
+		memcpy(new, ptr, old_size < size ? old_size : size);
+	datastore_vec_mapped_free(ptr, old_size);
+	return new;
+}
+
+/**
+ * @brief Settings for vectors returned by `map_file`
+ */
+#define DATASTORE_VEC_SETTINGS_MAPPED(X) \
+	X(NEW, { ptr = datastore_vec_mapped_alloc(size); if (!ptr) abort(); }) \
+	X(REALLOC, { ptr = datastore_vec_mapped_realloc(ptr, old_size, size); if (!ptr) abort(); }) \
+	X(FREE, { datastore_vec_mapped_free(ptr, size); }) \
+	X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+// }}}
+
+/**
+ * @brief Serialization methods declaration
+ *
+ * @param trait__ Vector type-trait, see @ref trait_type "Trait Type"
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_IO(trait__, name__) \
+enum datastore_vec_io DATASTORE_IDENT(name__, write_fd)(const struct name__ *self, int fd); \
+enum datastore_vec_io DATASTORE_IDENT(name__, read_fd)(struct name__ *self, int fd);
+
+/**
+ * @brief Serialization methods implementation
+ *
+ * @param trait__ Vector type-trait, see @ref trait_type "Trait Type"
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_IO_IMPL(trait__, name__) \
+enum datastore_vec_io DATASTORE_IDENT(name__, write_fd)(const struct name__ *self, int fd) \
+{ \
+	const size_t elem_size = sizeof(trait__(DATASTORE_VEC_TRAIT_TYPE)); \
+	const struct datastore_vec_file_header header = datastore_vec_file_header(self->data, elem_size, self->size); \
+	if (!datastore_vec_io_write(fd, &header, sizeof(header)) \
+		|| !datastore_vec_io_write(fd, self->data, self->size * elem_size)) \
+		return DATASTORE_VEC_IO_ERRNO; \
+	return DATASTORE_VEC_IO_OK; \
+} \
+enum datastore_vec_io DATASTORE_IDENT(name__, read_fd)(struct name__ *self, int fd) \
+{ \
+	const size_t elem_size = sizeof(trait__(DATASTORE_VEC_TRAIT_TYPE)); \
+	struct datastore_vec_file_header header; \
+	const size_t got = datastore_vec_io_read(fd, &header, sizeof(header)); \
+	if (got == SIZE_MAX) \
+		return DATASTORE_VEC_IO_ERRNO; \
+	if (got != sizeof(header)) \
+		return got ? DATASTORE_VEC_IO_TRUNCATED : DATASTORE_VEC_IO_FORMAT; \
+	const enum datastore_vec_io status = datastore_vec_file_check(&header, elem_size, UINT64_MAX); \
+	if (status != DATASTORE_VEC_IO_OK) \
+		return status; \
+	struct stat st; \
+	if (fstat(fd, &st) != 0) \
+		return DATASTORE_VEC_IO_ERRNO; \
+	/* Reject sizes larger than the rest of the file before allocating */ \
+	size_t chunk = DATASTORE_VEC_IO_CHUNK / elem_size + 1; \
+	if (S_ISREG(st.st_mode)) \
+	{ \
+		const off_t pos = lseek(fd, 0, SEEK_CUR); \
+		if (pos < 0) \
+			return DATASTORE_VEC_IO_ERRNO; \
+		if (pos > st.st_size || header.size > (uint64_t)(st.st_size - pos) / elem_size) \
+			return DATASTORE_VEC_IO_TRUNCATED; \
+		chunk = SIZE_MAX; \
+	} \
+	const size_t size = (size_t)header.size; \
+	if (size > SIZE_MAX / elem_size - self->size) \
+		return DATASTORE_VEC_IO_TRUNCATED; \
+	/* Other descriptors grow the vector geometrically as data arrives */ \
+	for (size_t done = 0; done < size;) \
+	{ \
+		size_t step = done > chunk ? done : chunk; \
+		if (step > size - done) \
+			step = size - done; \
+		DATASTORE_IDENT(name__, reserve)(self, self->size + done + step); \
+		const size_t bytes = datastore_vec_io_read(fd, self->data + self->size + done, step * elem_size); \
+		if (bytes == SIZE_MAX) \
+			return DATASTORE_VEC_IO_ERRNO; \
+		if (bytes != step * elem_size) \
+			return DATASTORE_VEC_IO_TRUNCATED; \
+		done += step; \
+	} \
+	const size_t bytes = size * elem_size; \
+	if (!(header.flags & DATASTORE_VEC_FILE_UNCHECKED) \
+		&& datastore_vec_checksum(self->data + self->size, bytes) != header.checksum) \
+		return DATASTORE_VEC_IO_CHECKSUM; \
+	self->size += size; \
+	return DATASTORE_VEC_IO_OK; \
+}
+
+/**
+ * @brief Mapped view method declaration
+ *
+ * The vector type must be implemented with @ref DATASTORE_VEC_SETTINGS_MAPPED.
+ *
+ * @param trait__ Vector type-trait, see @ref trait_type "Trait Type"
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_MAP(trait__, name__) \
+enum datastore_vec_io DATASTORE_IDENT(name__, map_file)(struct name__ *self, const char *path, bool verify);
+
+/**
+ * @brief Mapped view method implementation
+ *
+ * @param trait__ Vector type-trait, see @ref trait_type "Trait Type"
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_MAP_IMPL(trait__, name__) \
+enum datastore_vec_io DATASTORE_IDENT(name__, map_file)(struct name__ *self, const char *path, bool verify) \
+{ \
+	const size_t elem_size = sizeof(trait__(DATASTORE_VEC_TRAIT_TYPE)); \
+	const int fd = open(path, O_RDONLY); \
+	if (fd < 0) \
+		return DATASTORE_VEC_IO_ERRNO; \
+	struct stat st; \
+	if (fstat(fd, &st) != 0) \
+	{ \
+		close(fd); \
+		return DATASTORE_VEC_IO_ERRNO; \
+	} \
+	if (st.st_size < DATASTORE_VEC_FILE_HEADER) \
+	{ \
+		close(fd); \
+		return st.st_size ? DATASTORE_VEC_IO_TRUNCATED : DATASTORE_VEC_IO_FORMAT; \
+	} \
+	const size_t length = (size_t)st.st_size; \
+	unsigned char *base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0); \
+	close(fd); \
+	if (base == MAP_FAILED) \
+		return DATASTORE_VEC_IO_ERRNO; \
+	struct datastore_vec_file_header header; \
+	memcpy(&header, base, sizeof(header)); \
+	enum datastore_vec_io status = datastore_vec_file_check(&header, elem_size, length - DATASTORE_VEC_FILE_HEADER); \
+	if (status == DATASTORE_VEC_IO_OK && verify && !(header.flags & DATASTORE_VEC_FILE_UNCHECKED) \
+		&& datastore_vec_checksum(base + DATASTORE_VEC_FILE_HEADER, length - DATASTORE_VEC_FILE_HEADER) != header.checksum) \
+		status = DATASTORE_VEC_IO_CHECKSUM; \
+	if (status != DATASTORE_VEC_IO_OK) \
+	{ \
+		munmap(base, length); \
+		return status; \
+	} \
+	self->data = (trait__(DATASTORE_VEC_TRAIT_TYPE) *)(void *)(base + DATASTORE_VEC_FILE_HEADER); \
+	self->capacity = (size_t)header.size; \
+	self->size = (size_t)header.size; \
+	return DATASTORE_VEC_IO_OK; \
+}
+
+/** @endgroup VectorIo */
+
+#endif // DATASTORE_VEC_IO_H
@@ -0,0 +1,271 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_VEC_MMAP_H
+#define DATASTORE_VEC_MMAP_H
+
+#include "vector.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @file vector_mmap.h
+ * @defgroup VectorMmap DATASTORE_VEC mmap settings: Page-backed settings for very large vectors
+ *
+ * @brief Page-backed settings for very large vectors (Linux)
+ *
+ * When a vector grows past a few GB, `realloc` briefly needs both the old and the new buffer and
+ * may copy the whole content. The settings in this file allocate vectors directly from the
+ * kernel instead:
+ *
+ * - @ref DATASTORE_VEC_SETTINGS_MREMAP allocates with `mmap` and grows with
+ *   `mremap(MREMAP_MAYMOVE)`, which moves page table entries instead of copying bytes.
+ * - @ref DATASTORE_VEC_SETTINGS_MMAP_RESERVE reserves @ref DATASTORE_VEC_MMAP_RESERVE bytes of
+ *   address space up front, and grows by committing pages in place. `data` never moves, so
+ *   pointers inside the vector stay valid across `push` and `reserve`.
+ *
+ * In both cases growing is O(pages touched) rather than O(bytes copied), and the peak resident
+ * size stays close to the size of the vector.
+ *
+ * This header needs `mremap` and `MAP_ANONYMOUS`: define `_GNU_SOURCE` before including any
+ * system header. Without `mremap`, @ref DATASTORE_VEC_SETTINGS_MREMAP falls back to
+ * mmap + memcpy + munmap.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define _GNU_SOURCE
+ * #include <vector_mmap.h>
+ *
+ * #define FLOAT_TRAIT(X) \
+ * 	X(TYPE, float) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; })
+ * DATASTORE_VEC(float, huge)
+ * DATASTORE_VEC_IMPL_S(FLOAT_TRAIT, huge, DATASTORE_VEC_SETTINGS_MREMAP)
+ * @endcode
+ *
+ * Define @ref DATASTORE_VEC_MMAP_HUGEPAGE to `1` to request transparent huge pages with
+ * `madvise(MADV_HUGEPAGE)`.
+ */
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+	#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_ANONYMOUS
+	#error "vector_mmap.h requires MAP_ANONYMOUS, define _GNU_SOURCE before including system headers"
+#endif
+#ifndef MAP_NORESERVE
+	#define MAP_NORESERVE 0
+#endif
+
+/**
+ * @brief Address space reserved by @ref DATASTORE_VEC_SETTINGS_MMAP_RESERVE, in bytes
+ *
+ * Only address space is reserved: memory is committed as the vector grows. Growing past this
+ * limit aborts.
+ */
+#ifndef DATASTORE_VEC_MMAP_RESERVE
+	#define DATASTORE_VEC_MMAP_RESERVE ((size_t)64 << 30)
+#endif
+
+/**
+ * @brief Set to `1` to advise the kernel to back mappings with huge pages
+ */
+#ifndef DATASTORE_VEC_MMAP_HUGEPAGE
+	#define DATASTORE_VEC_MMAP_HUGEPAGE 0
+#endif
+
+/**
+ * @brief Rounds `size` up to a multiple of the system page size
+ */
+static inline size_t datastore_vec_mmap_round(size_t size)
+{
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	return (size + page - 1) & ~(page - 1);
+}
+
+/**
+ * @brief Usable size of a mapping holding `size` bytes of elements of `elem_size` bytes
+ *
+ * The whole last page is reported only when the rounded mapping can be recovered from the
+ * resulting capacity, i.e when elements are not larger than a page.
+ */
+static inline size_t datastore_vec_mmap_usable(size_t size, size_t elem_size)
+{
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	return elem_size <= page ? datastore_vec_mmap_round(size) : size;
+}
+
+static inline void datastore_vec_mmap_advise(void *ptr, size_t size)
+{
+#if DATASTORE_VEC_MMAP_HUGEPAGE && defined(MADV_HUGEPAGE)
+	madvise(ptr, size, MADV_HUGEPAGE);
+#else
+	DATASTORE_MAYBE_UNUSED(ptr);
+	DATASTORE_MAYBE_UNUSED(size);
+#endif
+}
+
+/**
+ * @brief Maps `size` bytes of anonymous memory
+ *
+ * @returns The mapping, NULL on failure
+ */
+static inline void *datastore_vec_mmap_alloc(size_t size)
+{
+	size = datastore_vec_mmap_round(size);
+	void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ptr == MAP_FAILED)
+		return NULL;
+	datastore_vec_mmap_advise(ptr, size);
+	return ptr;
+}
+
+/**
+ * @brief Resizes a mapping created by @ref datastore_vec_mmap_alloc
+ *
+ * @param ptr Mapping to resize, may be NULL
+ * @param old_size Size of the mapping, as passed to the previous allocation
+ * @param size New size of the mapping
+ *
+ * @returns The mapping, which may have moved, NULL on failure
+ */
+static inline void *datastore_vec_mmap_realloc(void *ptr, size_t old_size, size_t size)
+{
+	if (!ptr)
+		return datastore_vec_mmap_alloc(size);
+	old_size = datastore_vec_mmap_round(old_size);
+	size = datastore_vec_mmap_round(size);
+	if (old_size == size)
+		return ptr;
+#ifdef MREMAP_MAYMOVE
+	void *new = mremap(ptr, old_size, size, MREMAP_MAYMOVE);
+	if (new == MAP_FAILED)
+		return NULL;
+	if (size > old_size)
+		datastore_vec_mmap_advise(new, size);
+	return new;
+#else
+	void *new = datastore_vec_mmap_alloc(size);
+	if (!new)
+		return NULL;
+	memcpy(new, ptr, old_size < size ? old_size : size);
+	munmap(ptr, old_size);
+	return new;
+#endif
+}
+
+/**
+ * @brief Unmaps a mapping created by @ref datastore_vec_mmap_alloc
+ */
+static inline void datastore_vec_mmap_free(void *ptr, size_t size)
+{
+	if (ptr)
+		munmap(ptr, datastore_vec_mmap_round(size));
+}
+
+/**
+ * @brief Reserves @ref DATASTORE_VEC_MMAP_RESERVE bytes of address space and commits the first
+ * `size` bytes
+ *
+ * @returns The reservation, NULL on failure
+ */
+static inline void *datastore_vec_mmap_reserve(size_t size)
+{
+	void *ptr = mmap(NULL, DATASTORE_VEC_MMAP_RESERVE, PROT_NONE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (ptr == MAP_FAILED)
+		return NULL;
+	datastore_vec_mmap_advise(ptr, DATASTORE_VEC_MMAP_RESERVE);
+	size = datastore_vec_mmap_round(size);
+	if (size > DATASTORE_VEC_MMAP_RESERVE || mprotect(ptr, size, PROT_READ | PROT_WRITE))
+	{
+		munmap(ptr, DATASTORE_VEC_MMAP_RESERVE);
+		return NULL;
+	}
+	return ptr;
+}
+
+/**
+ * @brief Commits or decommits pages of a reservation created by @ref datastore_vec_mmap_reserve
+ *
+ * The address of the reservation never changes.
+ *
+ * @param ptr Reservation, may be NULL
+ * @param old_size Number of committed bytes
+ * @param size Number of bytes to commit
+ *
+ * @returns `ptr`, NULL on failure
+ */
+static inline void *datastore_vec_mmap_commit(void *ptr, size_t old_size, size_t size)
+{
+	if (!ptr)
+		return datastore_vec_mmap_reserve(size);
+	old_size = datastore_vec_mmap_round(old_size);
+	size = datastore_vec_mmap_round(size);
+	if (size > DATASTORE_VEC_MMAP_RESERVE)
+		return NULL;
+	char *base = ptr;
+	if (size > old_size)
+	{
+		if (mprotect(base + old_size, size - old_size, PROT_READ | PROT_WRITE))
+			return NULL;
+	}
+	else if (size < old_size)
+	{
+		madvise(base + size, old_size - size, MADV_DONTNEED);
+		mprotect(base + size, old_size - size, PROT_NONE);
+	}
+	return ptr;
+}
+
+/**
+ * @brief Releases a reservation created by @ref datastore_vec_mmap_reserve
+ */
+static inline void datastore_vec_mmap_release(void *ptr)
+{
+	if (ptr)
+		munmap(ptr, DATASTORE_VEC_MMAP_RESERVE);
+}
+
+/**
+ * @brief Settings for vectors allocated with `mmap` and grown with `mremap`
+ */
+#define DATASTORE_VEC_SETTINGS_MREMAP(X) \
+	X(NEW, { ptr = datastore_vec_mmap_alloc(size); if (!ptr) abort(); usable = datastore_vec_mmap_usable(size, sizeof(*ptr)); }) \
+	X(REALLOC, { ptr = datastore_vec_mmap_realloc(ptr, old_size, size); if (!ptr) abort(); usable = datastore_vec_mmap_usable(size, sizeof(*ptr)); }) \
+	X(FREE, { datastore_vec_mmap_free(ptr, size); }) \
+	X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+/**
+ * @brief Settings for vectors living in a fixed reservation of address space
+ *
+ * `data` is stable for the whole lifetime of the vector, the reservation is only released by
+ * `free` or by `shrink_to_fit` on an empty vector.
+ */
+#define DATASTORE_VEC_SETTINGS_MMAP_RESERVE(X) \
+	X(NEW, { ptr = datastore_vec_mmap_reserve(size); if (!ptr) abort(); usable = datastore_vec_mmap_usable(size, sizeof(*ptr)); }) \
+	X(REALLOC, { ptr = datastore_vec_mmap_commit(ptr, old_size, size); if (!ptr) abort(); usable = datastore_vec_mmap_usable(size, sizeof(*ptr)); }) \
+	X(FREE, { datastore_vec_mmap_release(ptr); }) \
+	X(GROW, { new_capacity = capacity != 0 ? (capacity * 2) : 1; })
+
+/** @endgroup VectorMmap */
+
+#endif // DATASTORE_VEC_MMAP_H
@@ -0,0 +1,283 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_VEC_SEARCH_H
+#define DATASTORE_VEC_SEARCH_H
+
+#include "vector.h"
+
+#include <stdbool.h>
+
+/**
+ * @file vector_search.h
+ * @defgroup VectorSearch DATASTORE_VEC Search: Binary searches on sorted vectors
+ *
+ * @brief Binary searches on sorted vectors
+ *
+ * Vectors whose trait declares a `CMP` (see @ref trait_type "Trait Type") and that are sorted in
+ * ascending order, e.g. with @ref VectorSort "vector_sort.h", can be searched with branchless
+ * binary searches. The loop does not branch on comparisons, so it does not suffer from branch
+ * mispredictions, and the two candidate elements of the next step are prefetched.
+ *
+ * For arrays much larger than the last level cache, the vector can also be copied into an
+ * Eytzinger layout: a binary tree stored in breadth-first order, where the descendants of a node
+ * a few levels down share a cache line and can be prefetched ahead of the search. The layout
+ * is built once from the sorted vector, and holds bitwise copies of its elements: it does not own
+ * them, so the vector must outlive it.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define INT_TRAIT(X) \
+ * 	X(TYPE, int) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; }) \
+ * 	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+ * // In the .h
+ * DATASTORE_VEC(int, vi)
+ * DATASTORE_VEC_SEARCH(INT_TRAIT, vi)
+ * // In the .c
+ * DATASTORE_VEC_IMPL(INT_TRAIT, vi)
+ * DATASTORE_VEC_SEARCH_IMPL(INT_TRAIT, vi)
+ * @endcode
+ *
+ * # Exposed methods
+ *
+ * - `size_t lower_bound(const struct vec *self, type value)`: Index of the first element not
+ *   lower than `value`, `self->size` if there is none
+ * - `size_t upper_bound(const struct vec *self, type value)`: Index of the first element greater
+ *   than `value`, `self->size` if there is none
+ * - `struct datastore_vec_range equal_range(const struct vec *self, type value)`: Range of the
+ *   elements equal to `value`
+ * - `void lower_bound_many(const struct vec *self, const type *values, size_t count, size_t
+ *   *out)`: Stores the lower bound of each value in `out`. Ascending values are searched from the
+ *   previous result with an exponential search, so dense query streams cost much less than
+ *   `count` full searches
+ *
+ * Eytzinger layout, `struct vec_eytzinger`:
+ * - `struct vec_eytzinger eytzinger_build(const struct vec *sorted)`: Builds the layout of a
+ *   sorted vector. On allocation failure, the returned layout has no `data`
+ * - `void eytzinger_free(struct vec_eytzinger *self)`: Releases the layout
+ * - `size_t eytzinger_lower_bound(const struct vec_eytzinger *self, type value)`: Same as
+ *   `lower_bound` on the sorted vector
+ * - `bool eytzinger_contains(const struct vec_eytzinger *self, type value)`: Whether an element is
+ *   equal to `value`
+ *
+ * Each method must be prefixed by the name of the vector type + `_`.
+ */
+
+#if defined(__GNUC__)
+	#define DATASTORE_SEARCH_PREFETCH(ptr) __builtin_prefetch(ptr)
+#else
+	#define DATASTORE_SEARCH_PREFETCH(ptr) ((void)(ptr))
+#endif
+
+/* Alignment of the Eytzinger layout, a cache line */
+#define DATASTORE_EYTZINGER_ALIGN 64
+
+/**
+ * @brief Half-open range of indices
+ */
+struct datastore_vec_range
+{
+	size_t begin;
+	size_t end;
+};
+
+/**
+ * @brief Number of trailing one bits of `x`
+ */
+static inline unsigned datastore_search_trailing_ones(size_t x)
+{
+#if defined(__GNUC__)
+	return ~x ? (unsigned)__builtin_ctzll((unsigned long long)~x) : (unsigned)(sizeof(x) * 8);
+#else
+	unsigned count = 0;
+	for (; x & 1; x >>= 1)
+		++count;
+	return count;
+#endif
+}
+
+/**
+ * @brief Search methods declaration
+ *
+ * @param trait__ Vector type-trait, must declare a `CMP`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_SEARCH(trait__, name__) \
+struct DATASTORE_IDENT(name__, eytzinger) \
+{ \
+	/* Elements in breadth-first order, starting at index 1 */ \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) *data; \
+	/* Index in the sorted vector of each element */ \
+	size_t *ranks; \
+	size_t size; \
+}; \
+size_t DATASTORE_IDENT(name__, lower_bound)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value); \
+size_t DATASTORE_IDENT(name__, upper_bound)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value); \
+struct datastore_vec_range DATASTORE_IDENT(name__, equal_range)(const struct name__ *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value); \
+void DATASTORE_IDENT(name__, lower_bound_many)(const struct name__ *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *values, size_t count, size_t *out); \
+struct DATASTORE_IDENT(name__, eytzinger) DATASTORE_IDENT(name__, eytzinger_build)(const struct name__ *sorted); \
+void DATASTORE_IDENT(name__, eytzinger_free)(struct DATASTORE_IDENT(name__, eytzinger) *self); \
+size_t DATASTORE_IDENT(name__, eytzinger_lower_bound)(const struct DATASTORE_IDENT(name__, eytzinger) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value); \
+bool DATASTORE_IDENT(name__, eytzinger_contains)(const struct DATASTORE_IDENT(name__, eytzinger) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value);
+
+/**
+ * @brief Search methods implementation
+ *
+ * @param trait__ Vector type-trait, must declare a `CMP`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_SEARCH_IMPL(trait__, name__) \
+static inline int DATASTORE_IDENT(name__, impl_search_cmp)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *lhs, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *rhs) \
+{ \
+	int cmp = 0; \
+	trait__(DATASTORE_VEC_TRAIT_CMP) \
+	return cmp; \
+} \
+/* First index of [begin, begin + size) whose element is not lower (or greater if `upper`) than `value` */ \
+static inline size_t DATASTORE_IDENT(name__, impl_search)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *data, \
+	size_t begin, size_t size, trait__(DATASTORE_VEC_TRAIT_TYPE) const *value, bool upper) \
+{ \
+	/* Elements that compare below `limit` are before the bound */ \
+	const int limit = upper ? 1 : 0; \
+	size_t base = begin; \
+	while (size > 1) \
+	{ \
+		const size_t half = size / 2; \
+		DATASTORE_SEARCH_PREFETCH(data + base + half / 2); \
+		DATASTORE_SEARCH_PREFETCH(data + base + half + half / 2); \
+		base = DATASTORE_IDENT(name__, impl_search_cmp)(data + base + half - 1, value) < limit ? base + half : base; \
+		size -= half; \
+	} \
+	return base + (size == 1 && DATASTORE_IDENT(name__, impl_search_cmp)(data + base, value) < limit); \
+} \
+size_t DATASTORE_IDENT(name__, lower_bound)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	return DATASTORE_IDENT(name__, impl_search)(self->data, 0, self->size, &value, false); \
+} \
+size_t DATASTORE_IDENT(name__, upper_bound)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	return DATASTORE_IDENT(name__, impl_search)(self->data, 0, self->size, &value, true); \
+} \
+struct datastore_vec_range DATASTORE_IDENT(name__, equal_range)(const struct name__ *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	const size_t begin = DATASTORE_IDENT(name__, impl_search)(self->data, 0, self->size, &value, false); \
+	const size_t end = DATASTORE_IDENT(name__, impl_search)(self->data, begin, self->size - begin, &value, true); \
+	return (struct datastore_vec_range){ .begin = begin, .end = end }; \
+} \
+void DATASTORE_IDENT(name__, lower_bound_many)(const struct name__ *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *values, size_t count, size_t *out) \
+{ \
+	size_t from = 0; \
+	for (size_t i = 0; i < count; ++i) \
+	{ \
+		/* Out of order values restart from the beginning */ \
+		if (i && DATASTORE_IDENT(name__, impl_search_cmp)(values + i, values + i - 1) < 0) \
+			from = 0; \
+		/* Doubles the window until its last element is not lower than the value */ \
+		size_t step = 1; \
+		while (from + step <= self->size \
+				&& DATASTORE_IDENT(name__, impl_search_cmp)(self->data + from + step - 1, values + i) < 0) \
+		{ \
+			from += step; \
+			step *= 2; \
+		} \
+		const size_t window = from + step <= self->size ? step : self->size - from; \
+		from = DATASTORE_IDENT(name__, impl_search)(self->data, from, window, values + i, false); \
+		out[i] = from; \
+	} \
+} \
+static void DATASTORE_IDENT(name__, impl_eytzinger_fill)(struct DATASTORE_IDENT(name__, eytzinger) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *sorted, size_t *next, size_t k) \
+{ \
+	if (k > self->size) \
+		return; \
+	DATASTORE_IDENT(name__, impl_eytzinger_fill)(self, sorted, next, 2 * k); \
+	memcpy(self->data + k, sorted + *next, sizeof(*sorted)); \
+	self->ranks[k] = (*next)++; \
+	DATASTORE_IDENT(name__, impl_eytzinger_fill)(self, sorted, next, 2 * k + 1); \
+} \
+struct DATASTORE_IDENT(name__, eytzinger) DATASTORE_IDENT(name__, eytzinger_build)(const struct name__ *sorted) \
+{ \
+	struct DATASTORE_IDENT(name__, eytzinger) self = { .data = NULL, .ranks = NULL, .size = sorted->size }; \
+	/* Slot 0 is unused, so that the children of `k` are `2k` and `2k + 1` */ \
+	const size_t data_size = datastore_vec_pad(sizeof(*self.data) * (self.size + 1), sizeof(size_t)); \
+	unsigned char *buffer = datastore_vec_aligned_alloc(DATASTORE_EYTZINGER_ALIGN, \
+		data_size + sizeof(size_t) * (self.size + 1)); \
+	if (!buffer) \
+	{ \
+		self.size = 0; \
+		return self; \
+	} \
+	self.data = (trait__(DATASTORE_VEC_TRAIT_TYPE) *)(void *)buffer; \
+	self.ranks = (size_t *)(void *)(buffer + data_size); \
+	self.ranks[0] = self.size; \
+	size_t next = 0; \
+	DATASTORE_IDENT(name__, impl_eytzinger_fill)(&self, sorted->data, &next, 1); \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, eytzinger_free)(struct DATASTORE_IDENT(name__, eytzinger) *self) \
+{ \
+	datastore_vec_aligned_free(self->data); \
+	self->data = NULL; \
+	self->ranks = NULL; \
+	self->size = 0; \
+} \
+/* Eytzinger index of the lower bound of `value`, 0 if there is none */ \
+static inline size_t DATASTORE_IDENT(name__, impl_eytzinger_search)(const struct DATASTORE_IDENT(name__, eytzinger) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *value) \
+{ \
+	/* Descendants `levels` levels down are contiguous and fit in a cache line */ \
+	unsigned levels = 0; \
+	while (((size_t)2 << levels) * sizeof(*self->data) <= DATASTORE_EYTZINGER_ALIGN) \
+		++levels; \
+	size_t k = 1; \
+	while (k <= self->size) \
+	{ \
+		const size_t ahead = k << levels; \
+		DATASTORE_SEARCH_PREFETCH(self->data + (ahead <= self->size ? ahead : 0)); \
+		k = 2 * k + (DATASTORE_IDENT(name__, impl_search_cmp)(self->data + k, value) < 0); \
+	} \
+	/* Going right then left once: strip the trailing right turns and the last left turn */ \
+	return k >> (datastore_search_trailing_ones(k) + 1); \
+} \
+size_t DATASTORE_IDENT(name__, eytzinger_lower_bound)(const struct DATASTORE_IDENT(name__, eytzinger) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	if (!self->size) \
+		return 0; \
+	return self->ranks[DATASTORE_IDENT(name__, impl_eytzinger_search)(self, &value)]; \
+} \
+bool DATASTORE_IDENT(name__, eytzinger_contains)(const struct DATASTORE_IDENT(name__, eytzinger) *self, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	if (!self->size) \
+		return false; \
+	const size_t k = DATASTORE_IDENT(name__, impl_eytzinger_search)(self, &value); \
+	return k && DATASTORE_IDENT(name__, impl_search_cmp)(self->data + k, &value) == 0; \
+}
+
+/** @endgroup VectorSearch */
+
+#endif // DATASTORE_VEC_SEARCH_H
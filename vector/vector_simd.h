@@ -0,0 +1,616 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_VEC_SIMD_H
+#define DATASTORE_VEC_SIMD_H
+
+#include "vector.h"
+
+#include <limits.h>
+#include <stdbool.h>
+
+/**
+ * @file vector_simd.h
+ * @defgroup VectorSimd DATASTORE_VEC SIMD: Search and reduction kernels for primitive vectors
+ *
+ * @brief Search and reduction kernels for primitive vectors
+ *
+ * Vectors whose trait declares a primitive `KIND` (see @ref trait_type "Trait Type") can be given
+ * search and reduction methods backed by SSE2 and AVX2 kernels. The AVX2 kernels are selected at
+ * runtime when the CPU supports them, and a scalar fallback is used on other architectures or
+ * when `DATASTORE_SIMD_DISABLE` is defined.
+ *
+ * | `KIND`  | Element type | Sum type  |
+ * |---------|--------------|-----------|
+ * | `CHAR`  | `char`       | `int64_t` |
+ * | `INT`   | `int`        | `int64_t` |
+ * | `FLOAT` | `float`      | `float`   |
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define INT_TRAIT(X) \
+ * 	X(TYPE, int) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; }) \
+ * 	X(KIND, INT)
+ * // In the .h
+ * DATASTORE_VEC(int, vi)
+ * DATASTORE_VEC_SIMD(INT_TRAIT, vi)
+ * // In the .c
+ * DATASTORE_VEC_IMPL(INT_TRAIT, vi)
+ * DATASTORE_VEC_SIMD_IMPL(INT_TRAIT, vi)
+ * @endcode
+ *
+ * # Exposed methods
+ *
+ * - `size_t find(const struct vec *self, type value)`: Index of the first element equal to
+ *   `value`, `self->size` if there is none
+ * - `bool contains(const struct vec *self, type value)`: Whether an element is equal to `value`
+ * - `size_t count(const struct vec *self, type value)`: Number of elements equal to `value`
+ * - `type min(const struct vec *self)`: Smallest element, the vector must not be empty
+ * - `type max(const struct vec *self)`: Largest element, the vector must not be empty
+ * - `sum_type sum(const struct vec *self)`: Sum of all elements, `0` for an empty vector
+ * - `bool any_eq(const struct vec *self, const struct vec *other)`: Whether both vectors hold
+ *   the same value at some index, up to the size of the shortest one
+ *
+ * Each method must be prefixed by the name of the vector type + `_`.
+ *
+ * Floats are compared with `==` and `<`: `NaN` never compares equal, and `min`/`max` skip `NaN`
+ * values unless the first element is `NaN`. Float sums are computed in several lanes, so the
+ * result may differ from a sequential sum by rounding.
+ *
+ * The kernels themselves are available as `datastore_simd_<op>_<i8|i32|f32>`, and each ISA
+ * variant as `datastore_simd_<op>_<i8|i32|f32>_<scalar|SSE2|AVX2>`.
+ */
+
+#if !defined(DATASTORE_SIMD_DISABLE) && defined(__GNUC__) && defined(__SSE2__) \
+	&& (defined(__x86_64__) || defined(__i386__)) && INT_MAX == 2147483647
+	#define DATASTORE_SIMD_X86 1
+	#include <immintrin.h>
+#else
+	#define DATASTORE_SIMD_X86 0
+#endif
+
+#define DATASTORE_SIMD_KERNEL_CHAR(op) datastore_simd_##op##_i8
+#define DATASTORE_SIMD_KERNEL_INT(op) datastore_simd_##op##_i32
+#define DATASTORE_SIMD_KERNEL_FLOAT(op) datastore_simd_##op##_f32
+#define DATASTORE_SIMD_SUM_CHAR int64_t
+#define DATASTORE_SIMD_SUM_INT int64_t
+#define DATASTORE_SIMD_SUM_FLOAT float
+
+/**
+ * @brief Kernel implementing `op` for `kind`
+ */
+#define DATASTORE_SIMD_KERNEL(kind__, op__) DATASTORE_CONCAT(DATASTORE_SIMD_KERNEL_, kind__)(op__)
+/**
+ * @brief Type returned by the `sum` kernel of `kind`
+ */
+#define DATASTORE_SIMD_SUM(kind__) DATASTORE_CONCAT(DATASTORE_SIMD_SUM_, kind__)
+
+// {{{ Scalar kernels
+#define DATASTORE_SIMD_SCALAR_KERNELS(suffix__, type__, sum__) \
+static inline size_t datastore_simd_find_##suffix__##_scalar(const type__ *data, size_t n, type__ value) \
+{ \
+	for (size_t i = 0; i < n; ++i) \
+		if (data[i] == value) \
+			return i; \
+	return n; \
+} \
+static inline size_t datastore_simd_count_##suffix__##_scalar(const type__ *data, size_t n, type__ value) \
+{ \
+	size_t count = 0; \
+	for (size_t i = 0; i < n; ++i) \
+		count += data[i] == value; \
+	return count; \
+} \
+static inline bool datastore_simd_any_eq_##suffix__##_scalar(const type__ *a, const type__ *b, size_t n) \
+{ \
+	for (size_t i = 0; i < n; ++i) \
+		if (a[i] == b[i]) \
+			return true; \
+	return false; \
+} \
+static inline type__ datastore_simd_min_##suffix__##_scalar(const type__ *data, size_t n) \
+{ \
+	assert(n != 0); \
+	type__ min = data[0]; \
+	for (size_t i = 1; i < n; ++i) \
+		if (data[i] < min) \
+			min = data[i]; \
+	return min; \
+} \
+static inline type__ datastore_simd_max_##suffix__##_scalar(const type__ *data, size_t n) \
+{ \
+	assert(n != 0); \
+	type__ max = data[0]; \
+	for (size_t i = 1; i < n; ++i) \
+		if (data[i] > max) \
+			max = data[i]; \
+	return max; \
+} \
+static inline sum__ datastore_simd_sum_##suffix__##_scalar(const type__ *data, size_t n) \
+{ \
+	sum__ sum = 0; \
+	for (size_t i = 0; i < n; ++i) \
+		sum += (sum__)data[i]; \
+	return sum; \
+}
+
+DATASTORE_SIMD_SCALAR_KERNELS(i8, char, int64_t)
+DATASTORE_SIMD_SCALAR_KERNELS(i32, int, int64_t)
+DATASTORE_SIMD_SCALAR_KERNELS(f32, float, float)
+// }}}
+
+#if DATASTORE_SIMD_X86
+#define DATASTORE_SIMD_TARGET_SSE2
+#define DATASTORE_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+
+static inline unsigned datastore_simd_ctz(unsigned x)
+{
+	return (unsigned)__builtin_ctz(x);
+}
+
+/**
+ * @brief Returns whether the AVX2 kernels can be used
+ */
+static inline bool datastore_simd_has_avx2(void)
+{
+	static int supported = -1;
+	if (supported < 0)
+	{
+		__builtin_cpu_init();
+		supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return supported != 0;
+}
+
+// {{{ Lane operations
+#define DATASTORE_SIMD_LOAD_SSE2(ptr) _mm_loadu_si128((const __m128i *)(const void *)(ptr))
+#define DATASTORE_SIMD_LOAD_AVX2(ptr) _mm256_loadu_si256((const __m256i *)(const void *)(ptr))
+#define DATASTORE_SIMD_STORE_SSE2(ptr, v) _mm_storeu_si128((__m128i *)(void *)(ptr), v)
+#define DATASTORE_SIMD_STORE_AVX2(ptr, v) _mm256_storeu_si256((__m256i *)(void *)(ptr), v)
+
+static inline unsigned datastore_simd_eq_i8_SSE2(const char *a, const char *b)
+{
+	return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(DATASTORE_SIMD_LOAD_SSE2(a), DATASTORE_SIMD_LOAD_SSE2(b)));
+}
+static inline unsigned datastore_simd_eq_i32_SSE2(const int *a, const int *b)
+{
+	return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi32(DATASTORE_SIMD_LOAD_SSE2(a), DATASTORE_SIMD_LOAD_SSE2(b)));
+}
+static inline unsigned datastore_simd_eq_f32_SSE2(const float *a, const float *b)
+{
+	return (unsigned)_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline unsigned datastore_simd_eq_i8_AVX2(const char *a, const char *b)
+{
+	return (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(DATASTORE_SIMD_LOAD_AVX2(a), DATASTORE_SIMD_LOAD_AVX2(b)));
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline unsigned datastore_simd_eq_i32_AVX2(const int *a, const int *b)
+{
+	return (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi32(DATASTORE_SIMD_LOAD_AVX2(a), DATASTORE_SIMD_LOAD_AVX2(b)));
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline unsigned datastore_simd_eq_f32_AVX2(const float *a, const float *b)
+{
+	return (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a), _mm256_loadu_ps(b), _CMP_EQ_OQ));
+}
+// }}}
+
+// {{{ Equality kernels
+/*
+ * `eq` compares `lanes__` elements of two arrays and returns a mask with `bits__` bits per lane.
+ * Values searched for are broadcast into a small array, so the same lane comparison is used by
+ * find and any_eq.
+ */
+#define DATASTORE_SIMD_EQ_KERNELS(suffix__, type__, isa__, lanes__, bits__) \
+DATASTORE_SIMD_TARGET_##isa__ static inline size_t \
+datastore_simd_find_##suffix__##_##isa__(const type__ *data, size_t n, type__ value) \
+{ \
+	type__ splat[lanes__]; \
+	for (size_t j = 0; j < lanes__; ++j) \
+		splat[j] = value; \
+	size_t i = 0; \
+	for (; i + 4 * lanes__ <= n; i += 4 * lanes__) \
+	{ \
+		const unsigned m0 = datastore_simd_eq_##suffix__##_##isa__(data + i, splat); \
+		const unsigned m1 = datastore_simd_eq_##suffix__##_##isa__(data + i + lanes__, splat); \
+		const unsigned m2 = datastore_simd_eq_##suffix__##_##isa__(data + i + 2 * lanes__, splat); \
+		const unsigned m3 = datastore_simd_eq_##suffix__##_##isa__(data + i + 3 * lanes__, splat); \
+		if (m0 | m1 | m2 | m3) \
+		{ \
+			if (m0) return i + datastore_simd_ctz(m0) / bits__; \
+			if (m1) return i + lanes__ + datastore_simd_ctz(m1) / bits__; \
+			if (m2) return i + 2 * lanes__ + datastore_simd_ctz(m2) / bits__; \
+			return i + 3 * lanes__ + datastore_simd_ctz(m3) / bits__; \
+		} \
+	} \
+	for (; i + lanes__ <= n; i += lanes__) \
+	{ \
+		const unsigned m = datastore_simd_eq_##suffix__##_##isa__(data + i, splat); \
+		if (m) \
+			return i + datastore_simd_ctz(m) / bits__; \
+	} \
+	return i + datastore_simd_find_##suffix__##_scalar(data + i, n - i, value); \
+} \
+DATASTORE_SIMD_TARGET_##isa__ static inline bool \
+datastore_simd_any_eq_##suffix__##_##isa__(const type__ *a, const type__ *b, size_t n) \
+{ \
+	size_t i = 0; \
+	for (; i + 4 * lanes__ <= n; i += 4 * lanes__) \
+	{ \
+		if (datastore_simd_eq_##suffix__##_##isa__(a + i, b + i) \
+				| datastore_simd_eq_##suffix__##_##isa__(a + i + lanes__, b + i + lanes__) \
+				| datastore_simd_eq_##suffix__##_##isa__(a + i + 2 * lanes__, b + i + 2 * lanes__) \
+				| datastore_simd_eq_##suffix__##_##isa__(a + i + 3 * lanes__, b + i + 3 * lanes__)) \
+			return true; \
+	} \
+	return datastore_simd_any_eq_##suffix__##_scalar(a + i, b + i, n - i); \
+}
+
+DATASTORE_SIMD_EQ_KERNELS(i8, char, SSE2, 16, 1)
+DATASTORE_SIMD_EQ_KERNELS(i32, int, SSE2, 4, 4)
+DATASTORE_SIMD_EQ_KERNELS(f32, float, SSE2, 4, 1)
+DATASTORE_SIMD_EQ_KERNELS(i8, char, AVX2, 32, 1)
+DATASTORE_SIMD_EQ_KERNELS(i32, int, AVX2, 8, 4)
+DATASTORE_SIMD_EQ_KERNELS(f32, float, AVX2, 8, 1)
+// }}}
+
+// {{{ Count kernels
+#define DATASTORE_SIMD_VEC_SSE2 __m128i
+#define DATASTORE_SIMD_ZERO_SSE2() _mm_setzero_si128()
+#define DATASTORE_SIMD_SUB8_SSE2(a, b) _mm_sub_epi8(a, b)
+#define DATASTORE_SIMD_SUB32_SSE2(a, b) _mm_sub_epi32(a, b)
+#define DATASTORE_SIMD_ADD64_SSE2(a, b) _mm_add_epi64(a, b)
+#define DATASTORE_SIMD_SAD_SSE2(a) _mm_sad_epu8(a, _mm_setzero_si128())
+#define DATASTORE_SIMD_EQ8_SSE2(a, b) _mm_cmpeq_epi8(a, b)
+#define DATASTORE_SIMD_EQ32_SSE2(a, b) _mm_cmpeq_epi32(a, b)
+#define DATASTORE_SIMD_EQF_SSE2(a, b) _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)))
+#define DATASTORE_SIMD_VEC_AVX2 __m256i
+#define DATASTORE_SIMD_ZERO_AVX2() _mm256_setzero_si256()
+#define DATASTORE_SIMD_SUB8_AVX2(a, b) _mm256_sub_epi8(a, b)
+#define DATASTORE_SIMD_SUB32_AVX2(a, b) _mm256_sub_epi32(a, b)
+#define DATASTORE_SIMD_ADD64_AVX2(a, b) _mm256_add_epi64(a, b)
+#define DATASTORE_SIMD_SAD_AVX2(a) _mm256_sad_epu8(a, _mm256_setzero_si256())
+#define DATASTORE_SIMD_EQ8_AVX2(a, b) _mm256_cmpeq_epi8(a, b)
+#define DATASTORE_SIMD_EQ32_AVX2(a, b) _mm256_cmpeq_epi32(a, b)
+#define DATASTORE_SIMD_EQF_AVX2(a, b) \
+	_mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ))
+
+/*
+ * Matching lanes compare to all ones, so subtracting the comparison counts matches per lane.
+ * Byte counters are flushed into 64-bit sums every 255 iterations, before they can wrap around,
+ * and 32-bit counters every 2^31 iterations.
+ */
+#define DATASTORE_SIMD_COUNT_KERNEL(suffix__, type__, isa__, lanes__, width__, eq__, flush__) \
+DATASTORE_SIMD_TARGET_##isa__ static inline size_t \
+datastore_simd_count_##suffix__##_##isa__(const type__ *data, size_t n, type__ value) \
+{ \
+	type__ splat[lanes__]; \
+	for (size_t j = 0; j < lanes__; ++j) \
+		splat[j] = value; \
+	const DATASTORE_SIMD_VEC_##isa__ v = DATASTORE_SIMD_LOAD_##isa__(splat); \
+	size_t count = 0; \
+	size_t i = 0; \
+	while (i + lanes__ <= n) \
+	{ \
+		DATASTORE_SIMD_VEC_##isa__ acc = DATASTORE_SIMD_ZERO_##isa__(); \
+		size_t end = i + (size_t)(flush__) * lanes__; \
+		if (end > n || end < i) \
+			end = n; \
+		for (; i + lanes__ <= end; i += lanes__) \
+			acc = DATASTORE_SIMD_SUB##width__##_##isa__(acc, eq__##_##isa__(DATASTORE_SIMD_LOAD_##isa__(data + i), v)); \
+		uint##width__##_t counters[lanes__]; \
+		DATASTORE_SIMD_STORE_##isa__(counters, acc); \
+		for (size_t j = 0; j < lanes__; ++j) \
+			count += counters[j]; \
+	} \
+	return count + datastore_simd_count_##suffix__##_scalar(data + i, n - i, value); \
+}
+
+DATASTORE_SIMD_COUNT_KERNEL(i8, char, SSE2, 16, 8, DATASTORE_SIMD_EQ8, 255)
+DATASTORE_SIMD_COUNT_KERNEL(i32, int, SSE2, 4, 32, DATASTORE_SIMD_EQ32, 1u << 31)
+DATASTORE_SIMD_COUNT_KERNEL(f32, float, SSE2, 4, 32, DATASTORE_SIMD_EQF, 1u << 31)
+DATASTORE_SIMD_COUNT_KERNEL(i8, char, AVX2, 32, 8, DATASTORE_SIMD_EQ8, 255)
+DATASTORE_SIMD_COUNT_KERNEL(i32, int, AVX2, 8, 32, DATASTORE_SIMD_EQ32, 1u << 31)
+DATASTORE_SIMD_COUNT_KERNEL(f32, float, AVX2, 8, 32, DATASTORE_SIMD_EQF, 1u << 31)
+// }}}
+
+// {{{ Min/max kernels
+/* Bias turning signed chars into unsigned bytes, so that SSE2's unsigned byte min/max apply */
+#if CHAR_MIN < 0
+	#define DATASTORE_SIMD_CHAR_BIAS 0x80
+#else
+	#define DATASTORE_SIMD_CHAR_BIAS 0
+#endif
+
+static inline __m128i datastore_simd_vmin_i8_SSE2(__m128i a, __m128i b)
+{
+	const __m128i bias = _mm_set1_epi8((char)DATASTORE_SIMD_CHAR_BIAS);
+	return _mm_xor_si128(_mm_min_epu8(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), bias);
+}
+static inline __m128i datastore_simd_vmax_i8_SSE2(__m128i a, __m128i b)
+{
+	const __m128i bias = _mm_set1_epi8((char)DATASTORE_SIMD_CHAR_BIAS);
+	return _mm_xor_si128(_mm_max_epu8(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), bias);
+}
+static inline __m128i datastore_simd_vmin_i32_SSE2(__m128i a, __m128i b)
+{
+	const __m128i gt = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+static inline __m128i datastore_simd_vmax_i32_SSE2(__m128i a, __m128i b)
+{
+	const __m128i gt = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+static inline __m128i datastore_simd_vmin_f32_SSE2(__m128i a, __m128i b)
+{
+	return _mm_castps_si128(_mm_min_ps(_mm_castsi128_ps(b), _mm_castsi128_ps(a)));
+}
+static inline __m128i datastore_simd_vmax_f32_SSE2(__m128i a, __m128i b)
+{
+	return _mm_castps_si128(_mm_max_ps(_mm_castsi128_ps(b), _mm_castsi128_ps(a)));
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline __m256i datastore_simd_vmin_i8_AVX2(__m256i a, __m256i b)
+{
+#if CHAR_MIN < 0
+	return _mm256_min_epi8(a, b);
+#else
+	return _mm256_min_epu8(a, b);
+#endif
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline __m256i datastore_simd_vmax_i8_AVX2(__m256i a, __m256i b)
+{
+#if CHAR_MIN < 0
+	return _mm256_max_epi8(a, b);
+#else
+	return _mm256_max_epu8(a, b);
+#endif
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline __m256i datastore_simd_vmin_i32_AVX2(__m256i a, __m256i b)
+{
+	return _mm256_min_epi32(a, b);
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline __m256i datastore_simd_vmax_i32_AVX2(__m256i a, __m256i b)
+{
+	return _mm256_max_epi32(a, b);
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline __m256i datastore_simd_vmin_f32_AVX2(__m256i a, __m256i b)
+{
+	return _mm256_castps_si256(_mm256_min_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a)));
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline __m256i datastore_simd_vmax_f32_AVX2(__m256i a, __m256i b)
+{
+	return _mm256_castps_si256(_mm256_max_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a)));
+}
+
+/*
+ * `vop(acc, x)` keeps `acc` when `x` is NaN, and every lane starts from the first element, which
+ * matches the scalar kernels. Lanes are reduced through the scalar kernel, which also handles the
+ * tail.
+ */
+#define DATASTORE_SIMD_MINMAX_KERNEL(op__, suffix__, type__, isa__, vec__, lanes__, load__, store__) \
+DATASTORE_SIMD_TARGET_##isa__ static inline type__ \
+datastore_simd_##op__##_##suffix__##_##isa__(const type__ *data, size_t n) \
+{ \
+	assert(n != 0); \
+	if (n < 2 * lanes__) \
+		return datastore_simd_##op__##_##suffix__##_scalar(data, n); \
+	type__ first[lanes__]; \
+	for (size_t j = 0; j < lanes__; ++j) \
+		first[j] = data[0]; \
+	vec__ acc0 = load__(first); \
+	vec__ acc1 = acc0; \
+	size_t i = 0; \
+	for (; i + 2 * lanes__ <= n; i += 2 * lanes__) \
+	{ \
+		acc0 = datastore_simd_v##op__##_##suffix__##_##isa__(acc0, load__(data + i)); \
+		acc1 = datastore_simd_v##op__##_##suffix__##_##isa__(acc1, load__(data + i + lanes__)); \
+	} \
+	acc0 = datastore_simd_v##op__##_##suffix__##_##isa__(acc0, acc1); \
+	type__ lanes[lanes__ + 1]; \
+	store__(lanes, acc0); \
+	lanes[lanes__] = datastore_simd_##op__##_##suffix__##_scalar(i < n ? data + i : data, i < n ? n - i : 1); \
+	return datastore_simd_##op__##_##suffix__##_scalar(lanes, lanes__ + 1); \
+}
+
+DATASTORE_SIMD_MINMAX_KERNEL(min, i8, char, SSE2, __m128i, 16, DATASTORE_SIMD_LOAD_SSE2, DATASTORE_SIMD_STORE_SSE2)
+DATASTORE_SIMD_MINMAX_KERNEL(max, i8, char, SSE2, __m128i, 16, DATASTORE_SIMD_LOAD_SSE2, DATASTORE_SIMD_STORE_SSE2)
+DATASTORE_SIMD_MINMAX_KERNEL(min, i32, int, SSE2, __m128i, 4, DATASTORE_SIMD_LOAD_SSE2, DATASTORE_SIMD_STORE_SSE2)
+DATASTORE_SIMD_MINMAX_KERNEL(max, i32, int, SSE2, __m128i, 4, DATASTORE_SIMD_LOAD_SSE2, DATASTORE_SIMD_STORE_SSE2)
+DATASTORE_SIMD_MINMAX_KERNEL(min, f32, float, SSE2, __m128i, 4, DATASTORE_SIMD_LOAD_SSE2, DATASTORE_SIMD_STORE_SSE2)
+DATASTORE_SIMD_MINMAX_KERNEL(max, f32, float, SSE2, __m128i, 4, DATASTORE_SIMD_LOAD_SSE2, DATASTORE_SIMD_STORE_SSE2)
+DATASTORE_SIMD_MINMAX_KERNEL(min, i8, char, AVX2, __m256i, 32, DATASTORE_SIMD_LOAD_AVX2, DATASTORE_SIMD_STORE_AVX2)
+DATASTORE_SIMD_MINMAX_KERNEL(max, i8, char, AVX2, __m256i, 32, DATASTORE_SIMD_LOAD_AVX2, DATASTORE_SIMD_STORE_AVX2)
+DATASTORE_SIMD_MINMAX_KERNEL(min, i32, int, AVX2, __m256i, 8, DATASTORE_SIMD_LOAD_AVX2, DATASTORE_SIMD_STORE_AVX2)
+DATASTORE_SIMD_MINMAX_KERNEL(max, i32, int, AVX2, __m256i, 8, DATASTORE_SIMD_LOAD_AVX2, DATASTORE_SIMD_STORE_AVX2)
+DATASTORE_SIMD_MINMAX_KERNEL(min, f32, float, AVX2, __m256i, 8, DATASTORE_SIMD_LOAD_AVX2, DATASTORE_SIMD_STORE_AVX2)
+DATASTORE_SIMD_MINMAX_KERNEL(max, f32, float, AVX2, __m256i, 8, DATASTORE_SIMD_LOAD_AVX2, DATASTORE_SIMD_STORE_AVX2)
+// }}}
+
+// {{{ Sum kernels
+static inline int64_t datastore_simd_sum_i8_SSE2(const char *data, size_t n)
+{
+	// Bytes are biased to unsigned, summed 8 at a time with psadbw, and unbiased at the end
+	const __m128i bias = _mm_set1_epi8((char)DATASTORE_SIMD_CHAR_BIAS);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = zero;
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_xor_si128(DATASTORE_SIMD_LOAD_SSE2(data + i), bias), zero));
+	int64_t lanes[2];
+	DATASTORE_SIMD_STORE_SSE2(lanes, acc);
+	return lanes[0] + lanes[1] - (int64_t)i * DATASTORE_SIMD_CHAR_BIAS
+		+ datastore_simd_sum_i8_scalar(data + i, n - i);
+}
+static inline int64_t datastore_simd_sum_i32_SSE2(const int *data, size_t n)
+{
+	// Lanes are sign-extended to 64 bits before being accumulated
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc0 = zero, acc1 = zero;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128i x = DATASTORE_SIMD_LOAD_SSE2(data + i);
+		const __m128i sign = _mm_cmpgt_epi32(zero, x);
+		acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(x, sign));
+		acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(x, sign));
+	}
+	int64_t lanes[2];
+	DATASTORE_SIMD_STORE_SSE2(lanes, _mm_add_epi64(acc0, acc1));
+	return lanes[0] + lanes[1] + datastore_simd_sum_i32_scalar(data + i, n - i);
+}
+static inline float datastore_simd_sum_f32_SSE2(const float *data, size_t n)
+{
+	__m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		acc0 = _mm_add_ps(acc0, _mm_loadu_ps(data + i));
+		acc1 = _mm_add_ps(acc1, _mm_loadu_ps(data + i + 4));
+	}
+	float lanes[4];
+	_mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + datastore_simd_sum_f32_scalar(data + i, n - i);
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline int64_t datastore_simd_sum_i8_AVX2(const char *data, size_t n)
+{
+	const __m256i bias = _mm256_set1_epi8((char)DATASTORE_SIMD_CHAR_BIAS);
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc = zero;
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32)
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_xor_si256(DATASTORE_SIMD_LOAD_AVX2(data + i), bias), zero));
+	int64_t lanes[4];
+	DATASTORE_SIMD_STORE_AVX2(lanes, acc);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] - (int64_t)i * DATASTORE_SIMD_CHAR_BIAS
+		+ datastore_simd_sum_i8_scalar(data + i, n - i);
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline int64_t datastore_simd_sum_i32_AVX2(const int *data, size_t n)
+{
+	__m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const __m256i x = DATASTORE_SIMD_LOAD_AVX2(data + i);
+		acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+		acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+	}
+	int64_t lanes[4];
+	DATASTORE_SIMD_STORE_AVX2(lanes, _mm256_add_epi64(acc0, acc1));
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + datastore_simd_sum_i32_scalar(data + i, n - i);
+}
+DATASTORE_SIMD_TARGET_AVX2 static inline float datastore_simd_sum_f32_AVX2(const float *data, size_t n)
+{
+	__m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+		acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(data + i + 8));
+	}
+	float lanes[8];
+	_mm256_storeu_ps(lanes, _mm256_add_ps(acc0, acc1));
+	return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]))
+		+ datastore_simd_sum_f32_scalar(data + i, n - i);
+}
+// }}}
+
+#define DATASTORE_SIMD_DISPATCH(ret__, op__, suffix__, params__, args__) \
+static inline ret__ datastore_simd_##op__##_##suffix__ params__ \
+{ \
+	if (datastore_simd_has_avx2()) \
+		return datastore_simd_##op__##_##suffix__##_AVX2 args__; \
+	return datastore_simd_##op__##_##suffix__##_SSE2 args__; \
+}
+#else
+#define DATASTORE_SIMD_DISPATCH(ret__, op__, suffix__, params__, args__) \
+static inline ret__ datastore_simd_##op__##_##suffix__ params__ \
+{ \
+	return datastore_simd_##op__##_##suffix__##_scalar args__; \
+}
+#endif // DATASTORE_SIMD_X86
+
+#define DATASTORE_SIMD_DISPATCH_KERNELS(suffix__, type__, sum__) \
+DATASTORE_SIMD_DISPATCH(size_t, find, suffix__, (const type__ *data, size_t n, type__ value), (data, n, value)) \
+DATASTORE_SIMD_DISPATCH(size_t, count, suffix__, (const type__ *data, size_t n, type__ value), (data, n, value)) \
+DATASTORE_SIMD_DISPATCH(bool, any_eq, suffix__, (const type__ *a, const type__ *b, size_t n), (a, b, n)) \
+DATASTORE_SIMD_DISPATCH(type__, min, suffix__, (const type__ *data, size_t n), (data, n)) \
+DATASTORE_SIMD_DISPATCH(type__, max, suffix__, (const type__ *data, size_t n), (data, n)) \
+DATASTORE_SIMD_DISPATCH(sum__, sum, suffix__, (const type__ *data, size_t n), (data, n))
+
+DATASTORE_SIMD_DISPATCH_KERNELS(i8, char, int64_t)
+DATASTORE_SIMD_DISPATCH_KERNELS(i32, int, int64_t)
+DATASTORE_SIMD_DISPATCH_KERNELS(f32, float, float)
+
+/**
+ * @brief SIMD methods declaration
+ *
+ * @param trait__ Vector type-trait, must declare a `KIND`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_SIMD(trait__, name__) \
+size_t DATASTORE_IDENT(name__, find)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value); \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value); \
+size_t DATASTORE_IDENT(name__, count)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value); \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, min)(const struct name__ *self); \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, max)(const struct name__ *self); \
+DATASTORE_SIMD_SUM(trait__(DATASTORE_VEC_TRAIT_KIND)) DATASTORE_IDENT(name__, sum)(const struct name__ *self); \
+bool DATASTORE_IDENT(name__, any_eq)(const struct name__ *self, const struct name__ *other);
+
+/**
+ * @brief SIMD methods implementation
+ *
+ * @param trait__ Vector type-trait, must declare a `KIND`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_SIMD_IMPL(trait__, name__) \
+size_t DATASTORE_IDENT(name__, find)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	return DATASTORE_SIMD_KERNEL(trait__(DATASTORE_VEC_TRAIT_KIND), find)(self->data, self->size, value); \
+} \
+bool DATASTORE_IDENT(name__, contains)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	return DATASTORE_SIMD_KERNEL(trait__(DATASTORE_VEC_TRAIT_KIND), find)(self->data, self->size, value) != self->size; \
+} \
+size_t DATASTORE_IDENT(name__, count)(const struct name__ *self, trait__(DATASTORE_VEC_TRAIT_TYPE) value) \
+{ \
+	return DATASTORE_SIMD_KERNEL(trait__(DATASTORE_VEC_TRAIT_KIND), count)(self->data, self->size, value); \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, min)(const struct name__ *self) \
+{ \
+	assert(self->size != 0); \
+	return DATASTORE_SIMD_KERNEL(trait__(DATASTORE_VEC_TRAIT_KIND), min)(self->data, self->size); \
+} \
+trait__(DATASTORE_VEC_TRAIT_TYPE) DATASTORE_IDENT(name__, max)(const struct name__ *self) \
+{ \
+	assert(self->size != 0); \
+	return DATASTORE_SIMD_KERNEL(trait__(DATASTORE_VEC_TRAIT_KIND), max)(self->data, self->size); \
+} \
+DATASTORE_SIMD_SUM(trait__(DATASTORE_VEC_TRAIT_KIND)) DATASTORE_IDENT(name__, sum)(const struct name__ *self) \
+{ \
+	return DATASTORE_SIMD_KERNEL(trait__(DATASTORE_VEC_TRAIT_KIND), sum)(self->data, self->size); \
+} \
+bool DATASTORE_IDENT(name__, any_eq)(const struct name__ *self, const struct name__ *other) \
+{ \
+	const size_t n = self->size < other->size ? self->size : other->size; \
+	return DATASTORE_SIMD_KERNEL(trait__(DATASTORE_VEC_TRAIT_KIND), any_eq)(self->data, other->data, n); \
+}
+
+/** @endgroup VectorSimd */
+
+#endif // DATASTORE_VEC_SIMD_H
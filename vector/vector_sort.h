@@ -0,0 +1,613 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#ifndef DATASTORE_VEC_SORT_H
+#define DATASTORE_VEC_SORT_H
+
+#include "vector.h"
+
+#include <limits.h>
+#include <stdbool.h>
+
+/**
+ * @file vector_sort.h
+ * @defgroup VectorSort DATASTORE_VEC Sort: Comparison, radix and key sorts
+ *
+ * @brief Comparison, radix and key sorts
+ *
+ * Vectors whose trait declares a `CMP` (see @ref trait_type "Trait Type") can be sorted with an
+ * inlined pattern-defeating quicksort, which calls the comparison directly instead of through a
+ * function pointer like `qsort`. It runs in `O(n log n)` in the worst case, and in linear time on
+ * sorted, reversed or constant inputs. The sort is not stable.
+ *
+ * Vectors whose trait declares a `KIND` can also use an LSD radix sort, which makes at most 4
+ * passes over the data for `INT` and `FLOAT` and a single one for `CHAR`. Digits shared by every
+ * element are skipped. Floats are ordered by their sign and magnitude: `-0.0` before `0.0`, and
+ * `NaN` values at either end depending on their sign bit.
+ *
+ * Records can be sorted with a key function returning an unsigned 64-bit key, see
+ * @ref datastore_sort_key_i64 and @ref datastore_sort_key_f64 for signed and floating keys. Keys
+ * are extracted once per element and radix sorted with the record indices, then records are
+ * moved to their place. This sort is stable.
+ *
+ * Radix and key sorts need a scratch buffer, which can be kept in a
+ * @ref datastore_sort_scratch and reused across calls to avoid reallocating it for every sort.
+ * Passing `NULL` uses a temporary buffer instead. The scratch buffer is allocated with `malloc`,
+ * not with the vector's settings.
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * #define INT_TRAIT(X) \
+ * 	X(TYPE, int) \
+ * 	X(FREE, {}) \
+ * 	X(CLONE, { *new = *val; }) \
+ * 	X(KIND, INT) \
+ * 	X(CMP, { cmp = (*lhs > *rhs) - (*lhs < *rhs); })
+ * // In the .h
+ * DATASTORE_VEC(int, vi)
+ * DATASTORE_VEC_SORT(INT_TRAIT, vi)
+ * DATASTORE_VEC_RADIX_SORT(INT_TRAIT, vi)
+ * // In the .c
+ * DATASTORE_VEC_IMPL(INT_TRAIT, vi)
+ * DATASTORE_VEC_SORT_IMPL(INT_TRAIT, vi)
+ * DATASTORE_VEC_RADIX_SORT_IMPL(INT_TRAIT, vi)
+ * @endcode
+ *
+ * # Exposed methods
+ *
+ * With @ref DATASTORE_VEC_SORT:
+ * - `void sort(struct vec *self)`: Sorts the vector in ascending order according to `CMP`
+ * - `bool is_sorted(const struct vec *self)`: Whether the vector is in ascending order
+ * - `bool sort_by_key(struct vec *self, uint64_t (*key)(const type *value), struct
+ *   datastore_sort_scratch *scratch)`: Stable sort by ascending `key`. Returns false, leaving the
+ *   vector unchanged, if the scratch buffer could not be allocated
+ *
+ * With @ref DATASTORE_VEC_RADIX_SORT:
+ * - `bool radix_sort(struct vec *self, struct datastore_sort_scratch *scratch)`: Sorts the vector
+ *   in ascending order. Returns false, leaving the vector unchanged, if the scratch buffer could
+ *   not be allocated
+ *
+ * Each method must be prefixed by the name of the vector type + `_`.
+ *
+ * The quicksort is also available for any array through @ref DATASTORE_PDQSORT.
+ */
+
+/**
+ * @brief Reusable scratch buffer for radix and key sorts
+ *
+ * Zero-initialize it before use, and release it with @ref datastore_sort_scratch_free.
+ */
+struct datastore_sort_scratch
+{
+	unsigned char *data;
+	size_t size;
+};
+
+/**
+ * @brief Ensures the scratch buffer holds at least `size` bytes
+ *
+ * @returns The buffer, or `NULL` if it could not be grown
+ */
+static inline unsigned char *datastore_sort_scratch_reserve(struct datastore_sort_scratch *scratch, size_t size)
+{
+	if (scratch->size >= size)
+		return scratch->data;
+	unsigned char *data = realloc(scratch->data, size);
+	if (!data)
+		return NULL;
+	scratch->data = data;
+	scratch->size = size;
+	return data;
+}
+
+/**
+ * @brief Releases the scratch buffer
+ */
+static inline void datastore_sort_scratch_free(struct datastore_sort_scratch *scratch)
+{
+	free(scratch->data);
+	scratch->data = NULL;
+	scratch->size = 0;
+}
+
+/**
+ * @brief Maps a signed key to an unsigned key with the same order
+ */
+static inline uint64_t datastore_sort_key_i64(int64_t key)
+{
+	return (uint64_t)key ^ ((uint64_t)1 << 63);
+}
+
+/**
+ * @brief Maps a floating key to an unsigned key with the same order
+ */
+static inline uint64_t datastore_sort_key_f64(double key)
+{
+	uint64_t bits;
+	memcpy(&bits, &key, sizeof(bits));
+	return bits & ((uint64_t)1 << 63) ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+// {{{ Pattern-defeating quicksort
+/* Partitions smaller than this are insertion sorted */
+#define DATASTORE_PDQSORT_INSERTION 24
+/* Partitions larger than this use a pseudo-median of nine as pivot */
+#define DATASTORE_PDQSORT_NINTHER 128
+/* Maximum number of elements moved by a partial insertion sort before it gives up */
+#define DATASTORE_PDQSORT_PARTIAL 8
+
+/**
+ * @brief Defines a pattern-defeating quicksort
+ *
+ * Defines `static inline void prefix(type *data, size_t size)`, and helper functions prefixed by
+ * `prefix_`.
+ *
+ * @param prefix__ Name of the sort function
+ * @param type__ Type of the elements
+ * @param less__ Function or macro taking two `const type *` and returning whether the first
+ * element is strictly lower than the second
+ */
+#define DATASTORE_PDQSORT(prefix__, type__, less__) \
+static inline void DATASTORE_IDENT(prefix__, swap)(type__ *a, type__ *b) \
+{ \
+	type__ const tmp = *a; \
+	*a = *b; \
+	*b = tmp; \
+} \
+static inline void DATASTORE_IDENT(prefix__, sort2)(type__ *a, type__ *b) \
+{ \
+	if (less__(b, a)) \
+		DATASTORE_IDENT(prefix__, swap)(a, b); \
+} \
+static inline void DATASTORE_IDENT(prefix__, sort3)(type__ *a, type__ *b, type__ *c) \
+{ \
+	DATASTORE_IDENT(prefix__, sort2)(a, b); \
+	DATASTORE_IDENT(prefix__, sort2)(b, c); \
+	DATASTORE_IDENT(prefix__, sort2)(a, b); \
+} \
+/* Insertion sort, `guarded` is false when an element not greater than any in the range precedes it */ \
+static inline void DATASTORE_IDENT(prefix__, insertion)(type__ *begin, type__ *end, bool guarded) \
+{ \
+	if (begin == end) \
+		return; \
+	for (type__ *cur = begin + 1; cur != end; ++cur) \
+	{ \
+		type__ *sift = cur; \
+		type__ *sift_1 = cur - 1; \
+		if (less__(sift, sift_1)) \
+		{ \
+			type__ const tmp = *sift; \
+			do \
+				*sift-- = *sift_1; \
+			while ((!guarded || sift != begin) && less__(&tmp, --sift_1)); \
+			*sift = tmp; \
+		} \
+	} \
+} \
+/* Insertion sort giving up after moving too many elements, returns whether the range is sorted */ \
+static inline bool DATASTORE_IDENT(prefix__, partial_insertion)(type__ *begin, type__ *end) \
+{ \
+	if (begin == end) \
+		return true; \
+	size_t moved = 0; \
+	for (type__ *cur = begin + 1; cur != end; ++cur) \
+	{ \
+		type__ *sift = cur; \
+		type__ *sift_1 = cur - 1; \
+		if (less__(sift, sift_1)) \
+		{ \
+			type__ const tmp = *sift; \
+			do \
+				*sift-- = *sift_1; \
+			while (sift != begin && less__(&tmp, --sift_1)); \
+			*sift = tmp; \
+			moved += (size_t)(cur - sift); \
+			if (moved > DATASTORE_PDQSORT_PARTIAL) \
+				return false; \
+		} \
+	} \
+	return true; \
+} \
+static inline void DATASTORE_IDENT(prefix__, heapsort)(type__ *begin, type__ *end) \
+{ \
+	const size_t size = (size_t)(end - begin); \
+	for (size_t i = size / 2; i-- > 0;) \
+	{ \
+		for (size_t root = i, child; (child = 2 * root + 1) < size; root = child) \
+		{ \
+			if (child + 1 < size && less__(begin + child, begin + child + 1)) \
+				++child; \
+			if (!less__(begin + root, begin + child)) \
+				break; \
+			DATASTORE_IDENT(prefix__, swap)(begin + root, begin + child); \
+		} \
+	} \
+	for (size_t last = size; last-- > 1;) \
+	{ \
+		DATASTORE_IDENT(prefix__, swap)(begin, begin + last); \
+		for (size_t root = 0, child; (child = 2 * root + 1) < last; root = child) \
+		{ \
+			if (child + 1 < last && less__(begin + child, begin + child + 1)) \
+				++child; \
+			if (!less__(begin + root, begin + child)) \
+				break; \
+			DATASTORE_IDENT(prefix__, swap)(begin + root, begin + child); \
+		} \
+	} \
+} \
+/* Partitions around `*begin`, elements equal to the pivot go to the right */ \
+static inline type__ *DATASTORE_IDENT(prefix__, partition_right)(type__ *begin, type__ *end, bool *partitioned) \
+{ \
+	type__ const pivot = *begin; \
+	type__ *first = begin; \
+	type__ *last = end; \
+	while (less__(++first, &pivot)) \
+		; \
+	if (first - 1 == begin) \
+		while (first < last && !less__(--last, &pivot)) \
+			; \
+	else \
+		while (!less__(--last, &pivot)) \
+			; \
+	*partitioned = first >= last; \
+	while (first < last) \
+	{ \
+		DATASTORE_IDENT(prefix__, swap)(first, last); \
+		while (less__(++first, &pivot)) \
+			; \
+		while (!less__(--last, &pivot)) \
+			; \
+	} \
+	type__ *pivot_pos = first - 1; \
+	*begin = *pivot_pos; \
+	*pivot_pos = pivot; \
+	return pivot_pos; \
+} \
+/* Partitions around `*begin`, elements equal to the pivot go to the left */ \
+static inline type__ *DATASTORE_IDENT(prefix__, partition_left)(type__ *begin, type__ *end) \
+{ \
+	type__ const pivot = *begin; \
+	type__ *first = begin; \
+	type__ *last = end; \
+	while (less__(&pivot, --last)) \
+		; \
+	if (last + 1 == end) \
+		while (first < last && !less__(&pivot, ++first)) \
+			; \
+	else \
+		while (!less__(&pivot, ++first)) \
+			; \
+	while (first < last) \
+	{ \
+		DATASTORE_IDENT(prefix__, swap)(first, last); \
+		while (less__(&pivot, --last)) \
+			; \
+		while (!less__(&pivot, ++first)) \
+			; \
+	} \
+	*begin = *last; \
+	*last = pivot; \
+	return last; \
+} \
+static inline void DATASTORE_IDENT(prefix__, loop)(type__ *begin, type__ *end, unsigned bad_allowed, bool leftmost) \
+{ \
+	for (;;) \
+	{ \
+		const size_t size = (size_t)(end - begin); \
+		if (size < DATASTORE_PDQSORT_INSERTION) \
+		{ \
+			DATASTORE_IDENT(prefix__, insertion)(begin, end, leftmost); \
+			return; \
+		} \
+		const size_t half = size / 2; \
+		if (size > DATASTORE_PDQSORT_NINTHER) \
+		{ \
+			DATASTORE_IDENT(prefix__, sort3)(begin, begin + half, end - 1); \
+			DATASTORE_IDENT(prefix__, sort3)(begin + 1, begin + (half - 1), end - 2); \
+			DATASTORE_IDENT(prefix__, sort3)(begin + 2, begin + (half + 1), end - 3); \
+			DATASTORE_IDENT(prefix__, sort3)(begin + (half - 1), begin + half, begin + (half + 1)); \
+			DATASTORE_IDENT(prefix__, swap)(begin, begin + half); \
+		} \
+		else \
+			DATASTORE_IDENT(prefix__, sort3)(begin + half, begin, end - 1); \
+		/* The pivot equals the element preceding the range: put every equal element left */ \
+		if (!leftmost && !less__(begin - 1, begin)) \
+		{ \
+			begin = DATASTORE_IDENT(prefix__, partition_left)(begin, end) + 1; \
+			continue; \
+		} \
+		bool partitioned; \
+		type__ *pivot = DATASTORE_IDENT(prefix__, partition_right)(begin, end, &partitioned); \
+		const size_t left = (size_t)(pivot - begin); \
+		const size_t right = (size_t)(end - (pivot + 1)); \
+		if (left < size / 8 || right < size / 8) \
+		{ \
+			/* Bad partition: fall back to heapsort after too many, otherwise shuffle some elements */ \
+			if (--bad_allowed == 0) \
+			{ \
+				DATASTORE_IDENT(prefix__, heapsort)(begin, end); \
+				return; \
+			} \
+			if (left >= DATASTORE_PDQSORT_INSERTION) \
+			{ \
+				DATASTORE_IDENT(prefix__, swap)(begin, begin + left / 4); \
+				DATASTORE_IDENT(prefix__, swap)(pivot - 1, pivot - left / 4); \
+				if (left > DATASTORE_PDQSORT_NINTHER) \
+				{ \
+					DATASTORE_IDENT(prefix__, swap)(begin + 1, begin + (left / 4 + 1)); \
+					DATASTORE_IDENT(prefix__, swap)(begin + 2, begin + (left / 4 + 2)); \
+					DATASTORE_IDENT(prefix__, swap)(pivot - 2, pivot - (left / 4 + 1)); \
+					DATASTORE_IDENT(prefix__, swap)(pivot - 3, pivot - (left / 4 + 2)); \
+				} \
+			} \
+			if (right >= DATASTORE_PDQSORT_INSERTION) \
+			{ \
+				DATASTORE_IDENT(prefix__, swap)(pivot + 1, pivot + (1 + right / 4)); \
+				DATASTORE_IDENT(prefix__, swap)(end - 1, end - right / 4); \
+				if (right > DATASTORE_PDQSORT_NINTHER) \
+				{ \
+					DATASTORE_IDENT(prefix__, swap)(pivot + 2, pivot + (2 + right / 4)); \
+					DATASTORE_IDENT(prefix__, swap)(pivot + 3, pivot + (3 + right / 4)); \
+					DATASTORE_IDENT(prefix__, swap)(end - 2, end - (1 + right / 4)); \
+					DATASTORE_IDENT(prefix__, swap)(end - 3, end - (2 + right / 4)); \
+				} \
+			} \
+		} \
+		/* Already partitioned input is likely sorted, try to finish with insertion sorts */ \
+		else if (partitioned && DATASTORE_IDENT(prefix__, partial_insertion)(begin, pivot) \
+				&& DATASTORE_IDENT(prefix__, partial_insertion)(pivot + 1, end)) \
+			return; \
+		DATASTORE_IDENT(prefix__, loop)(begin, pivot, bad_allowed, leftmost); \
+		begin = pivot + 1; \
+		leftmost = false; \
+	} \
+} \
+static inline void prefix__(type__ *data, size_t size) \
+{ \
+	if (size < 2) \
+		return; \
+	unsigned bad_allowed = 0; \
+	for (size_t n = size; n > 1; n >>= 1) \
+		++bad_allowed; \
+	DATASTORE_IDENT(prefix__, loop)(data, data + size, bad_allowed, true); \
+}
+// }}}
+
+// {{{ Radix sort
+/*
+ * 32-bit elements are encoded into order-preserving unsigned keys while building the histograms,
+ * sorted 8 bits at a time between two key buffers, and decoded back in the last pass.
+ */
+#define DATASTORE_RADIX_SORT_32(suffix__, type__, encode__, decode__) \
+static inline bool datastore_radix_sort_##suffix__(type__ *data, size_t size, struct datastore_sort_scratch *scratch) \
+{ \
+	if (size < 2) \
+		return true; \
+	struct datastore_sort_scratch local = { NULL, 0 }; \
+	uint32_t *keys = (uint32_t *)(void *)datastore_sort_scratch_reserve(scratch ? scratch : &local, \
+		size * 2 * sizeof(uint32_t)); \
+	if (!keys) \
+		return false; \
+	uint32_t *tmp = keys + size; \
+	size_t counts[4][256] = { { 0 } }; \
+	for (size_t i = 0; i < size; ++i) \
+	{ \
+		uint32_t bits; \
+		memcpy(&bits, data + i, sizeof(bits)); \
+		const uint32_t key = encode__(bits); \
+		keys[i] = key; \
+		++counts[0][key & 0xFF]; \
+		++counts[1][(key >> 8) & 0xFF]; \
+		++counts[2][(key >> 16) & 0xFF]; \
+		++counts[3][key >> 24]; \
+	} \
+	for (unsigned pass = 0; pass < 4; ++pass) \
+	{ \
+		const unsigned shift = pass * 8; \
+		if (counts[pass][(keys[0] >> shift) & 0xFF] == size) \
+			continue; \
+		size_t offset = 0; \
+		for (size_t digit = 0; digit < 256; ++digit) \
+		{ \
+			const size_t count = counts[pass][digit]; \
+			counts[pass][digit] = offset; \
+			offset += count; \
+		} \
+		for (size_t i = 0; i < size; ++i) \
+			tmp[counts[pass][(keys[i] >> shift) & 0xFF]++] = keys[i]; \
+		uint32_t *const swap = keys; \
+		keys = tmp; \
+		tmp = swap; \
+	} \
+	for (size_t i = 0; i < size; ++i) \
+	{ \
+		const uint32_t bits = decode__(keys[i]); \
+		memcpy(data + i, &bits, sizeof(bits)); \
+	} \
+	datastore_sort_scratch_free(&local); \
+	return true; \
+}
+
+#define DATASTORE_RADIX_ENCODE_I32(bits) ((bits) ^ 0x80000000u)
+#define DATASTORE_RADIX_DECODE_I32(key) ((key) ^ 0x80000000u)
+#define DATASTORE_RADIX_ENCODE_F32(bits) ((bits) & 0x80000000u ? ~(bits) : (bits) | 0x80000000u)
+#define DATASTORE_RADIX_DECODE_F32(key) ((key) & 0x80000000u ? (key) & 0x7FFFFFFFu : ~(key))
+
+#if INT_MAX == 2147483647
+DATASTORE_RADIX_SORT_32(i32, int, DATASTORE_RADIX_ENCODE_I32, DATASTORE_RADIX_DECODE_I32)
+#endif
+DATASTORE_RADIX_SORT_32(f32, float, DATASTORE_RADIX_ENCODE_F32, DATASTORE_RADIX_DECODE_F32)
+
+/* Chars are counted, so no scratch buffer is needed */
+static inline bool datastore_radix_sort_i8(char *data, size_t size, struct datastore_sort_scratch *scratch)
+{
+	(void)scratch;
+	size_t counts[256] = { 0 };
+	for (size_t i = 0; i < size; ++i)
+		++counts[(unsigned char)data[i]];
+	size_t i = 0;
+	for (int c = CHAR_MIN; c <= CHAR_MAX; ++c)
+	{
+		const size_t count = counts[(unsigned char)c];
+		memset(data + i, c, count);
+		i += count;
+	}
+	return true;
+}
+
+#define DATASTORE_RADIX_SORT_CHAR datastore_radix_sort_i8
+#define DATASTORE_RADIX_SORT_INT datastore_radix_sort_i32
+#define DATASTORE_RADIX_SORT_FLOAT datastore_radix_sort_f32
+
+/* Key sort element: the key and the index of the record it was extracted from */
+struct datastore_sort_keyed
+{
+	uint64_t key;
+	size_t index;
+};
+
+/**
+ * @brief Stable radix sort of keyed indices
+ *
+ * @param keyed Elements to sort
+ * @param tmp Buffer of the same size as `keyed`
+ * @param size Number of elements
+ *
+ * @returns `keyed` or `tmp`, whichever holds the sorted elements
+ */
+static inline struct datastore_sort_keyed *datastore_sort_keyed(struct datastore_sort_keyed *keyed,
+		struct datastore_sort_keyed *tmp, size_t size)
+{
+	static const size_t passes = sizeof(uint64_t);
+	size_t counts[sizeof(uint64_t)][256] = { { 0 } };
+	for (size_t i = 0; i < size; ++i)
+		for (size_t pass = 0; pass < passes; ++pass)
+			++counts[pass][(keyed[i].key >> (pass * 8)) & 0xFF];
+	for (size_t pass = 0; pass < passes; ++pass)
+	{
+		const unsigned shift = (unsigned)pass * 8;
+		if (counts[pass][(keyed[0].key >> shift) & 0xFF] == size)
+			continue;
+		size_t offset = 0;
+		for (size_t digit = 0; digit < 256; ++digit)
+		{
+			const size_t count = counts[pass][digit];
+			counts[pass][digit] = offset;
+			offset += count;
+		}
+		for (size_t i = 0; i < size; ++i)
+			tmp[counts[pass][(keyed[i].key >> shift) & 0xFF]++] = keyed[i];
+		struct datastore_sort_keyed *const swap = keyed;
+		keyed = tmp;
+		tmp = swap;
+	}
+	return keyed;
+}
+// }}}
+
+/**
+ * @brief Comparison sort methods declaration
+ *
+ * @param trait__ Vector type-trait, must declare a `CMP`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_SORT(trait__, name__) \
+void DATASTORE_IDENT(name__, sort)(struct name__ *self); \
+bool DATASTORE_IDENT(name__, is_sorted)(const struct name__ *self); \
+bool DATASTORE_IDENT(name__, sort_by_key)(struct name__ *self, \
+	uint64_t (*key)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *value), struct datastore_sort_scratch *scratch);
+
+/**
+ * @brief Comparison sort methods implementation
+ *
+ * @param trait__ Vector type-trait, must declare a `CMP`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_SORT_IMPL(trait__, name__) \
+static inline bool DATASTORE_IDENT(name__, impl_less)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *lhs, \
+	trait__(DATASTORE_VEC_TRAIT_TYPE) const *rhs) \
+{ \
+	int cmp = 0; \
+	trait__(DATASTORE_VEC_TRAIT_CMP) \
+	return cmp < 0; \
+} \
+DATASTORE_PDQSORT(DATASTORE_IDENT(name__, impl_pdqsort), trait__(DATASTORE_VEC_TRAIT_TYPE), \
+	DATASTORE_IDENT(name__, impl_less)) \
+void DATASTORE_IDENT(name__, sort)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(name__, impl_pdqsort)(self->data, self->size); \
+} \
+bool DATASTORE_IDENT(name__, is_sorted)(const struct name__ *self) \
+{ \
+	for (size_t i = 1; i < self->size; ++i) \
+		if (DATASTORE_IDENT(name__, impl_less)(self->data + i, self->data + i - 1)) \
+			return false; \
+	return true; \
+} \
+bool DATASTORE_IDENT(name__, sort_by_key)(struct name__ *self, \
+	uint64_t (*key)(trait__(DATASTORE_VEC_TRAIT_TYPE) const *value), struct datastore_sort_scratch *scratch) \
+{ \
+	const size_t size = self->size; \
+	if (size < 2) \
+		return true; \
+	const size_t elem_size = sizeof(trait__(DATASTORE_VEC_TRAIT_TYPE)); \
+	/* `datastore_vec_pad` needs a power of two, 16 covers the alignment of the keyed pairs */ \
+	const size_t keyed_offset = datastore_vec_pad(size * elem_size, 16); \
+	struct datastore_sort_scratch local = { NULL, 0 }; \
+	unsigned char *buffer = datastore_sort_scratch_reserve(scratch ? scratch : &local, \
+		keyed_offset + 2 * size * sizeof(struct datastore_sort_keyed)); \
+	if (!buffer) \
+		return false; \
+	struct datastore_sort_keyed *keyed = (struct datastore_sort_keyed *)(void *)(buffer + keyed_offset); \
+	for (size_t i = 0; i < size; ++i) \
+	{ \
+		keyed[i].key = key(self->data + i); \
+		keyed[i].index = i; \
+	} \
+	keyed = datastore_sort_keyed(keyed, keyed + size, size); \
+	/* Records are moved bitwise, ownership follows them */ \
+	for (size_t i = 0; i < size; ++i) \
+		memcpy(buffer + i * elem_size, self->data + keyed[i].index, elem_size); \
+	memcpy(self->data, buffer, size * elem_size); \
+	datastore_sort_scratch_free(&local); \
+	return true; \
+}
+
+/**
+ * @brief Radix sort method declaration
+ *
+ * @param trait__ Vector type-trait, must declare a `KIND`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_RADIX_SORT(trait__, name__) \
+bool DATASTORE_IDENT(name__, radix_sort)(struct name__ *self, struct datastore_sort_scratch *scratch);
+
+/**
+ * @brief Radix sort method implementation
+ *
+ * @param trait__ Vector type-trait, must declare a `KIND`
+ * @param name__ Name of the vector type
+ */
+#define DATASTORE_VEC_RADIX_SORT_IMPL(trait__, name__) \
+bool DATASTORE_IDENT(name__, radix_sort)(struct name__ *self, struct datastore_sort_scratch *scratch) \
+{ \
+	return DATASTORE_CONCAT(DATASTORE_RADIX_SORT_, trait__(DATASTORE_VEC_TRAIT_KIND))(self->data, self->size, scratch); \
+}
+
+/** @endgroup VectorSort */
+
+#endif // DATASTORE_VEC_SORT_H
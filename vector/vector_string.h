@@ -0,0 +1,638 @@
+/* Copyright © 2026 Lino Gamba
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the “Software”), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef DATASTORE_VEC_STRING_H
+#define DATASTORE_VEC_STRING_H
+
+#include "vector.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file vector_string.h
+ * @defgroup VectorString DATASTORE_VEC String: String builder and small strings
+ *
+ * @brief String builder on char vectors, and a string type with a small string optimization
+ *
+ * Building a string with one `push` per character pays a capacity check for every byte. The
+ * builder methods append a whole run of bytes after a single check, and format integers and
+ * floating point numbers directly into the vector, without `snprintf`. They are declared on a
+ * vector of `char`, so the builder keeps every vector method, and the content is never
+ * copied once built: `into_cstr` hands the buffer over to the caller.
+ *
+ * The string type, declared with @ref DATASTORE_STR, fits in 24 bytes and stores up to
+ * @ref DATASTORE_STR_INLINE bytes inline, without allocating. Longer strings move to the heap,
+ * and heap strings grow geometrically. Both representations are always null-terminated.
+ *
+ * Numbers are formatted as follows:
+ * - `append_u64`, `append_i64`: decimal digits, with a leading `-` for negative values
+ * - `append_f64`: fixed-point with `precision` decimals (clamped to
+ *   @ref DATASTORE_STR_F64_PRECISION), like `"%.*f"`, for magnitudes below `1e15`. Larger
+ *   magnitudes use scientific notation, e.g. `1.500e+20`, and non-finite values are written
+ *   `nan`, `inf` or `-inf`. The last decimal is rounded half up from the binary value, so it
+ *   may differ from `printf` by one unit on exact ties
+ *
+ * # Usage
+ *
+ * @code{.c}
+ * // In the .h
+ * DATASTORE_VEC(char, sbuf)
+ * DATASTORE_VEC_STRING(sbuf)
+ * DATASTORE_STR(str)
+ * // In the .c
+ * DATASTORE_VEC_IMPL(DATASTORE_VEC_STRING_TRAIT, sbuf)
+ * DATASTORE_VEC_STRING_IMPL(sbuf)
+ * DATASTORE_STR_IMPL(str)
+ *
+ * char *log_line(const char *key, uint64_t count, double ratio)
+ * {
+ * 	struct sbuf sb = sbuf_new(64);
+ * 	sbuf_append_cstr(&sb, key);
+ * 	sbuf_append_char(&sb, '=');
+ * 	sbuf_append_u64(&sb, count);
+ * 	sbuf_append_char(&sb, ' ');
+ * 	sbuf_append_f64(&sb, ratio, 3);
+ * 	// Freed with `free`
+ * 	return sbuf_into_cstr(&sb);
+ * }
+ * @endcode
+ *
+ * # Exposed methods
+ *
+ * Builder, on a vector of `char`:
+ * - `void append_bytes(struct vec *self, const char *bytes, size_t size)`: Appends `size` bytes
+ * - `void append_cstr(struct vec *self, const char *cstr)`: Appends a null-terminated string
+ * - `void append_char(struct vec *self, char c)`: Appends one byte
+ * - `void append_u64(struct vec *self, uint64_t value)`: Appends the decimal digits of `value`
+ * - `void append_i64(struct vec *self, int64_t value)`: Appends the decimal digits of `value`
+ * - `void append_f64(struct vec *self, double value, unsigned precision)`: Appends `value` with
+ *   `precision` decimals
+ * - `char *cstr(struct vec *self)`: Null-terminates the content, past `size`, and returns it
+ * - `char *into_cstr(struct vec *self)`: Null-terminates the content and returns it, leaving the
+ *   vector empty. The string is owned by the caller, and released with the `FREE` setting of
+ *   the vector (`free` by default)
+ *
+ * Appends grow the vector geometrically, and keep room for the terminator, so reserving the
+ * final size plus one byte once with `reserve` avoids any reallocation.
+ *
+ * String, `struct str`:
+ * - `struct str new(void)`: Empty string
+ * - `struct str from(const char *bytes, size_t size)`: String holding a copy of `size` bytes
+ * - `void free(struct str *self)`: Releases the string, which becomes empty
+ * - `struct str clone(const struct str *self)`: Copy of a string
+ * - `size_t size(const struct str *self)`: Number of bytes
+ * - `const char *cstr(const struct str *self)`: Null-terminated content
+ * - `bool is_inline(const struct str *self)`: Whether the content is stored inline
+ * - `int compare(const struct str *lhs, const struct str *rhs)`: Three-way lexicographic
+ *   comparison of the bytes
+ * - `void reserve(struct str *self, size_t capacity)`: Makes room for `capacity` bytes
+ * - `void clear(struct str *self)`: Empties the string, keeping its storage
+ * - `append_bytes`, `append_cstr`, `append_char`, `append_u64`, `append_i64`, `append_f64`: Same
+ *   as the builder methods
+ * - `char *into_cstr(struct str *self)`: Returns the content, leaving the string empty. A heap
+ *   string hands over its buffer, an inline string is copied to a new allocation. The string is
+ *   owned by the caller, and released with the `FREE` setting of the string type
+ *
+ * Each method must be prefixed by the name of the vector (or string) type + `_`.
+ */
+
+/**
+ * @brief Trait for the vectors of `char` used as string builders
+ */
+#define DATASTORE_VEC_STRING_TRAIT(X) \
+	X(TYPE, char) \
+	X(FREE, {}) \
+	X(CLONE, { *new = *val; })
+
+/**
+ * @brief Number of bytes a @ref DATASTORE_STR string stores inline
+ */
+#define DATASTORE_STR_INLINE 22
+
+/**
+ * @brief Maximum number of decimals of `append_f64`
+ */
+#define DATASTORE_STR_F64_PRECISION 9
+
+/**
+ * @brief Bytes needed to format any `uint64_t` or `int64_t`
+ */
+#define DATASTORE_STR_I64_MAX 20
+
+/**
+ * @brief Bytes needed to format any `double`, at any allowed precision
+ */
+#define DATASTORE_STR_F64_MAX 32
+
+/* Tag of heap strings, inline strings store their size in the tag */
+#define DATASTORE_STR_HEAP 0xFF
+
+// {{{ Formatting
+static const uint64_t datastore_str_pow10[20] = {
+	1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+	1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+	100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+	1000000000000000000ull, 10000000000000000000ull,
+};
+
+/* Two digits of each number in [0, 100) */
+static const char datastore_str_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/**
+ * @brief Number of decimal digits of `value`
+ */
+static inline unsigned datastore_str_u64_digits(uint64_t value)
+{
+#if defined(__GNUC__)
+	/* Approximates the digits from the bit width, `1233 / 4096` being close to `log10(2)` */
+	const unsigned approx = ((64u - (unsigned)__builtin_clzll(value | 1)) * 1233u) >> 12;
+	return approx + 1 - ((value | 1) < datastore_str_pow10[approx]);
+#else
+	unsigned digits = 1;
+	while (digits < 20 && value >= datastore_str_pow10[digits])
+		++digits;
+	return digits;
+#endif
+}
+
+/**
+ * @brief Writes the digits of `value` backwards, the last one before `end`
+ */
+static inline void datastore_str_write_u64(char *end, uint64_t value)
+{
+	while (value >= 100)
+	{
+		const size_t pair = (size_t)(value % 100) * 2;
+		value /= 100;
+		*--end = datastore_str_pairs[pair + 1];
+		*--end = datastore_str_pairs[pair];
+	}
+	if (value >= 10)
+	{
+		*--end = datastore_str_pairs[value * 2 + 1];
+		*--end = datastore_str_pairs[value * 2];
+	}
+	else
+		*--end = (char)('0' + value);
+}
+
+/**
+ * @brief Formats `value` in `out`, which must hold @ref DATASTORE_STR_I64_MAX bytes
+ *
+ * @returns The number of bytes written, without terminator
+ */
+static inline size_t datastore_str_format_u64(char *out, uint64_t value)
+{
+	const unsigned digits = datastore_str_u64_digits(value);
+	datastore_str_write_u64(out + digits, value);
+	return digits;
+}
+
+/**
+ * @brief Formats `value` in `out`, which must hold @ref DATASTORE_STR_I64_MAX bytes
+ *
+ * @returns The number of bytes written, without terminator
+ */
+static inline size_t datastore_str_format_i64(char *out, int64_t value)
+{
+	if (value >= 0)
+		return datastore_str_format_u64(out, (uint64_t)value);
+	*out = '-';
+	return 1 + datastore_str_format_u64(out + 1, (uint64_t)0 - (uint64_t)value);
+}
+
+/**
+ * @brief Formats `value` with `precision` decimals in `out`, which must hold
+ * @ref DATASTORE_STR_F64_MAX bytes
+ *
+ * `precision` is clamped to @ref DATASTORE_STR_F64_PRECISION.
+ *
+ * @returns The number of bytes written, without terminator
+ */
+static inline size_t datastore_str_format_f64(char *out, double value, unsigned precision)
+{
+	/* Powers of ten `1e(2^i)`, to scale large magnitudes in [1, 10) */
+	static const double scales[9] = { 1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256 };
+
+	if (precision > DATASTORE_STR_F64_PRECISION)
+		precision = DATASTORE_STR_F64_PRECISION;
+	char *p = out;
+	if (isnan(value))
+	{
+		memcpy(p, "nan", 3);
+		return 3;
+	}
+	if (signbit(value))
+	{
+		*p++ = '-';
+		value = -value;
+	}
+	if (isinf(value))
+	{
+		memcpy(p, "inf", 3);
+		return (size_t)(p - out) + 3;
+	}
+
+	unsigned exponent = 0;
+	const bool scientific = value >= 1e15;
+	if (scientific)
+		for (unsigned i = 9; i-- > 0;)
+			if (value >= scales[i])
+			{
+				value /= scales[i];
+				exponent += 1u << i;
+			}
+
+	/* Below `1e15`, the integer part and the scaled fraction are exact in a `uint64_t` */
+	const uint64_t scale = datastore_str_pow10[precision];
+	uint64_t integer = (uint64_t)value;
+	uint64_t fraction = (uint64_t)((value - (double)integer) * (double)scale + 0.5);
+	if (fraction >= scale)
+	{
+		fraction -= scale;
+		++integer;
+	}
+	if (scientific && integer == 10)
+	{
+		integer = 1;
+		++exponent;
+	}
+
+	p += datastore_str_format_u64(p, integer);
+	if (precision)
+	{
+		*p++ = '.';
+		memset(p, '0', precision);
+		datastore_str_write_u64(p + precision, fraction);
+		p += precision;
+	}
+	if (scientific)
+	{
+		*p++ = 'e';
+		*p++ = '+';
+		p += datastore_str_format_u64(p, exponent);
+	}
+	return (size_t)(p - out);
+}
+// }}}
+
+// {{{ Builder
+/**
+ * @brief String builder methods declaration
+ *
+ * @param name__ Name of a vector of `char`
+ */
+#define DATASTORE_VEC_STRING(name__) \
+void DATASTORE_IDENT(name__, append_bytes)(struct name__ *self, const char *bytes, size_t size); \
+void DATASTORE_IDENT(name__, append_cstr)(struct name__ *self, const char *cstr); \
+void DATASTORE_IDENT(name__, append_char)(struct name__ *self, char c); \
+void DATASTORE_IDENT(name__, append_u64)(struct name__ *self, uint64_t value); \
+void DATASTORE_IDENT(name__, append_i64)(struct name__ *self, int64_t value); \
+void DATASTORE_IDENT(name__, append_f64)(struct name__ *self, double value, unsigned precision); \
+char *DATASTORE_IDENT(name__, cstr)(struct name__ *self); \
+char *DATASTORE_IDENT(name__, into_cstr)(struct name__ *self);
+
+/**
+ * @brief String builder methods implementation
+ *
+ * @param name__ Name of a vector of `char`, implemented with any trait and settings
+ */
+#define DATASTORE_VEC_STRING_IMPL(name__) \
+/* Makes room for `size` more bytes and a terminator, returns where to write them */ \
+static inline char *DATASTORE_IDENT(name__, impl_string_grow)(struct name__ *self, size_t size) \
+{ \
+	assert(self->size <= self->capacity); \
+	const size_t needed = self->size + size + 1; \
+	if (needed > self->capacity) \
+		DATASTORE_IDENT(name__, reserve)(self, needed < 2 * self->capacity ? 2 * self->capacity : needed); \
+	return self->data + self->size; \
+} \
+void DATASTORE_IDENT(name__, append_bytes)(struct name__ *self, const char *bytes, size_t size) \
+{ \
+	if (!size) \
+		return; \
+	memcpy(DATASTORE_IDENT(name__, impl_string_grow)(self, size), bytes, size); \
+	self->size += size; \
+} \
+void DATASTORE_IDENT(name__, append_cstr)(struct name__ *self, const char *cstr) \
+{ \
+	DATASTORE_IDENT(name__, append_bytes)(self, cstr, strlen(cstr)); \
+} \
+void DATASTORE_IDENT(name__, append_char)(struct name__ *self, char c) \
+{ \
+	*DATASTORE_IDENT(name__, impl_string_grow)(self, 1) = c; \
+	++self->size; \
+} \
+void DATASTORE_IDENT(name__, append_u64)(struct name__ *self, uint64_t value) \
+{ \
+	const unsigned digits = datastore_str_u64_digits(value); \
+	datastore_str_write_u64(DATASTORE_IDENT(name__, impl_string_grow)(self, digits) + digits, value); \
+	self->size += digits; \
+} \
+void DATASTORE_IDENT(name__, append_i64)(struct name__ *self, int64_t value) \
+{ \
+	if (value < 0) \
+	{ \
+		DATASTORE_IDENT(name__, append_char)(self, '-'); \
+		DATASTORE_IDENT(name__, append_u64)(self, (uint64_t)0 - (uint64_t)value); \
+	} \
+	else \
+		DATASTORE_IDENT(name__, append_u64)(self, (uint64_t)value); \
+} \
+void DATASTORE_IDENT(name__, append_f64)(struct name__ *self, double value, unsigned precision) \
+{ \
+	char buf[DATASTORE_STR_F64_MAX]; \
+	const size_t size = datastore_str_format_f64(buf, value, precision); \
+	DATASTORE_IDENT(name__, append_bytes)(self, buf, size); \
+} \
+char *DATASTORE_IDENT(name__, cstr)(struct name__ *self) \
+{ \
+	*DATASTORE_IDENT(name__, impl_string_grow)(self, 0) = '\0'; \
+	return self->data; \
+} \
+char *DATASTORE_IDENT(name__, into_cstr)(struct name__ *self) \
+{ \
+	char *cstr = DATASTORE_IDENT(name__, cstr)(self); \
+	self->data = NULL; \
+	self->capacity = 0; \
+	self->size = 0; \
+	return cstr; \
+}
+// }}}
+
+// {{{ Small string
+/**
+ * @brief String type declaration
+ *
+ * The string fits in 24 bytes on 64-bit targets. Heap strings hold less than 4 GiB.
+ *
+ * @param name__ Name of the string type
+ */
+#define DATASTORE_STR(name__) \
+struct name__ \
+{ \
+	union \
+	{ \
+		struct \
+		{ \
+			char *data; \
+			size_t size; \
+			/* Bytes allocated for `data`, terminator included */ \
+			uint32_t capacity; \
+			/* Places `tag` after the inline bytes */ \
+			unsigned char reserved[DATASTORE_STR_INLINE + 1 - sizeof(char *) - sizeof(size_t) - sizeof(uint32_t)]; \
+			/* Inline size, or @ref DATASTORE_STR_HEAP */ \
+			uint8_t tag; \
+		} heap; \
+		/* Inline bytes and their terminator */ \
+		char small[DATASTORE_STR_INLINE + 1]; \
+	} u; \
+}; \
+typedef char DATASTORE_IDENT(name__, impl_tag_offset)[offsetof(struct name__, u.heap.tag) == DATASTORE_STR_INLINE + 1 ? 1 : -1]; \
+struct name__ DATASTORE_IDENT(name__, new)(void); \
+struct name__ DATASTORE_IDENT(name__, from)(const char *bytes, size_t size); \
+void DATASTORE_IDENT(name__, free)(struct name__ *self); \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self); \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self); \
+const char *DATASTORE_IDENT(name__, cstr)(const struct name__ *self); \
+bool DATASTORE_IDENT(name__, is_inline)(const struct name__ *self); \
+int DATASTORE_IDENT(name__, compare)(const struct name__ *lhs, const struct name__ *rhs); \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t capacity); \
+void DATASTORE_IDENT(name__, clear)(struct name__ *self); \
+void DATASTORE_IDENT(name__, append_bytes)(struct name__ *self, const char *bytes, size_t size); \
+void DATASTORE_IDENT(name__, append_cstr)(struct name__ *self, const char *cstr); \
+void DATASTORE_IDENT(name__, append_char)(struct name__ *self, char c); \
+void DATASTORE_IDENT(name__, append_u64)(struct name__ *self, uint64_t value); \
+void DATASTORE_IDENT(name__, append_i64)(struct name__ *self, int64_t value); \
+void DATASTORE_IDENT(name__, append_f64)(struct name__ *self, double value, unsigned precision); \
+char *DATASTORE_IDENT(name__, into_cstr)(struct name__ *self);
+
+/**
+ * @brief String methods implementation
+ *
+ * @param name__ Name of the string type
+ * @param settings__ Allocation settings, see @ref advanced_usage "Advanced Usage". The `GROW`
+ * setting is not used
+ */
+#define DATASTORE_STR_IMPL_S(name__, settings__) \
+static inline bool DATASTORE_IDENT(name__, impl_is_heap)(const struct name__ *self) \
+{ \
+	return self->u.heap.tag == DATASTORE_STR_HEAP; \
+} \
+static inline size_t DATASTORE_IDENT(name__, impl_small_size)(const struct name__ *self) \
+{ \
+	return self->u.heap.tag; \
+} \
+static inline void DATASTORE_IDENT(name__, impl_set_size)(struct name__ *self, size_t size) \
+{ \
+	if (DATASTORE_IDENT(name__, impl_is_heap)(self)) \
+	{ \
+		self->u.heap.size = size; \
+		self->u.heap.data[size] = '\0'; \
+	} \
+	else \
+	{ \
+		self->u.heap.tag = (uint8_t)size; \
+		self->u.small[size] = '\0'; \
+	} \
+} \
+/* Allocates room for `capacity` bytes and a terminator */ \
+static inline char *DATASTORE_IDENT(name__, impl_alloc)(size_t capacity, uint32_t *allocated) \
+{ \
+	assert(capacity < UINT32_MAX); \
+	char *ptr; \
+	const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+	const size_t size = datastore_vec_pad(capacity + 1, align); \
+	size_t usable = size; \
+	settings__(DATASTORE_VEC_SETTINGS_NEW) \
+	assert(usable >= size); \
+	*allocated = usable < UINT32_MAX ? (uint32_t)usable : UINT32_MAX; \
+	return ptr; \
+} \
+/* Makes room for `extra` more bytes and a terminator, returns where to write them */ \
+static inline char *DATASTORE_IDENT(name__, impl_grow)(struct name__ *self, size_t extra) \
+{ \
+	if (!DATASTORE_IDENT(name__, impl_is_heap)(self)) \
+	{ \
+		const size_t old = DATASTORE_IDENT(name__, impl_small_size)(self); \
+		if (old + extra <= DATASTORE_STR_INLINE) \
+			return self->u.small + old; \
+		size_t capacity = old + extra; \
+		if (capacity < 2 * DATASTORE_STR_INLINE) \
+			capacity = 2 * DATASTORE_STR_INLINE; \
+		uint32_t allocated; \
+		char *data = DATASTORE_IDENT(name__, impl_alloc)(capacity, &allocated); \
+		memcpy(data, self->u.small, old + 1); \
+		self->u.heap.data = data; \
+		self->u.heap.size = old; \
+		self->u.heap.capacity = allocated; \
+		self->u.heap.tag = DATASTORE_STR_HEAP; \
+		return data + old; \
+	} \
+	const size_t needed = self->u.heap.size + extra + 1; \
+	if (needed > self->u.heap.capacity) \
+	{ \
+		char *ptr = self->u.heap.data; \
+		const size_t old_size = self->u.heap.capacity; \
+		const size_t align = DATASTORE_VEC_SETTINGS_ALIGNMENT(settings__); \
+		const size_t size = datastore_vec_pad(needed < 2 * old_size ? 2 * old_size : needed, align); \
+		size_t usable = size; \
+		assert(size < UINT32_MAX); \
+		DATASTORE_MAYBE_UNUSED(old_size); \
+		settings__(DATASTORE_VEC_SETTINGS_REALLOC) \
+		assert(usable >= size); \
+		self->u.heap.data = ptr; \
+		self->u.heap.capacity = usable < UINT32_MAX ? (uint32_t)usable : UINT32_MAX; \
+	} \
+	return self->u.heap.data + self->u.heap.size; \
+} \
+struct name__ DATASTORE_IDENT(name__, new)(void) \
+{ \
+	struct name__ self; \
+	memset(&self, 0, sizeof(self)); \
+	return self; \
+} \
+struct name__ DATASTORE_IDENT(name__, from)(const char *bytes, size_t size) \
+{ \
+	struct name__ self = DATASTORE_IDENT(name__, new)(); \
+	DATASTORE_IDENT(name__, append_bytes)(&self, bytes, size); \
+	return self; \
+} \
+void DATASTORE_IDENT(name__, free)(struct name__ *self) \
+{ \
+	if (DATASTORE_IDENT(name__, impl_is_heap)(self)) \
+	{ \
+		char *ptr = self->u.heap.data; \
+		const size_t size = self->u.heap.capacity; \
+		DATASTORE_MAYBE_UNUSED(size); \
+		settings__(DATASTORE_VEC_SETTINGS_FREE) \
+	} \
+	memset(self, 0, sizeof(*self)); \
+} \
+struct name__ DATASTORE_IDENT(name__, clone)(const struct name__ *self) \
+{ \
+	if (!DATASTORE_IDENT(name__, impl_is_heap)(self)) \
+		return *self; \
+	return DATASTORE_IDENT(name__, from)(self->u.heap.data, self->u.heap.size); \
+} \
+size_t DATASTORE_IDENT(name__, size)(const struct name__ *self) \
+{ \
+	return DATASTORE_IDENT(name__, impl_is_heap)(self) ? self->u.heap.size \
+		: DATASTORE_IDENT(name__, impl_small_size)(self); \
+} \
+const char *DATASTORE_IDENT(name__, cstr)(const struct name__ *self) \
+{ \
+	return DATASTORE_IDENT(name__, impl_is_heap)(self) ? self->u.heap.data : self->u.small; \
+} \
+bool DATASTORE_IDENT(name__, is_inline)(const struct name__ *self) \
+{ \
+	return !DATASTORE_IDENT(name__, impl_is_heap)(self); \
+} \
+int DATASTORE_IDENT(name__, compare)(const struct name__ *lhs, const struct name__ *rhs) \
+{ \
+	const size_t lsize = DATASTORE_IDENT(name__, size)(lhs); \
+	const size_t rsize = DATASTORE_IDENT(name__, size)(rhs); \
+	const int cmp = memcmp(DATASTORE_IDENT(name__, cstr)(lhs), DATASTORE_IDENT(name__, cstr)(rhs), \
+		lsize < rsize ? lsize : rsize); \
+	return cmp ? cmp : (lsize > rsize) - (lsize < rsize); \
+} \
+void DATASTORE_IDENT(name__, reserve)(struct name__ *self, size_t capacity) \
+{ \
+	const size_t size = DATASTORE_IDENT(name__, size)(self); \
+	if (capacity > size) \
+		DATASTORE_IDENT(name__, impl_grow)(self, capacity - size); \
+} \
+void DATASTORE_IDENT(name__, clear)(struct name__ *self) \
+{ \
+	DATASTORE_IDENT(name__, impl_set_size)(self, 0); \
+} \
+void DATASTORE_IDENT(name__, append_bytes)(struct name__ *self, const char *bytes, size_t size) \
+{ \
+	if (!size) \
+		return; \
+	memcpy(DATASTORE_IDENT(name__, impl_grow)(self, size), bytes, size); \
+	DATASTORE_IDENT(name__, impl_set_size)(self, DATASTORE_IDENT(name__, size)(self) + size); \
+} \
+void DATASTORE_IDENT(name__, append_cstr)(struct name__ *self, const char *cstr) \
+{ \
+	DATASTORE_IDENT(name__, append_bytes)(self, cstr, strlen(cstr)); \
+} \
+void DATASTORE_IDENT(name__, append_char)(struct name__ *self, char c) \
+{ \
+	*DATASTORE_IDENT(name__, impl_grow)(self, 1) = c; \
+	DATASTORE_IDENT(name__, impl_set_size)(self, DATASTORE_IDENT(name__, size)(self) + 1); \
+} \
+void DATASTORE_IDENT(name__, append_u64)(struct name__ *self, uint64_t value) \
+{ \
+	const unsigned digits = datastore_str_u64_digits(value); \
+	datastore_str_write_u64(DATASTORE_IDENT(name__, impl_grow)(self, digits) + digits, value); \
+	DATASTORE_IDENT(name__, impl_set_size)(self, DATASTORE_IDENT(name__, size)(self) + digits); \
+} \
+void DATASTORE_IDENT(name__, append_i64)(struct name__ *self, int64_t value) \
+{ \
+	char buf[DATASTORE_STR_I64_MAX]; \
+	const size_t size = datastore_str_format_i64(buf, value); \
+	DATASTORE_IDENT(name__, append_bytes)(self, buf, size); \
+} \
+void DATASTORE_IDENT(name__, append_f64)(struct name__ *self, double value, unsigned precision) \
+{ \
+	char buf[DATASTORE_STR_F64_MAX]; \
+	const size_t size = datastore_str_format_f64(buf, value, precision); \
+	DATASTORE_IDENT(name__, append_bytes)(self, buf, size); \
+} \
+char *DATASTORE_IDENT(name__, into_cstr)(struct name__ *self) \
+{ \
+	char *cstr; \
+	if (DATASTORE_IDENT(name__, impl_is_heap)(self)) \
+		cstr = self->u.heap.data; \
+	else \
+	{ \
+		uint32_t allocated; \
+		const size_t size = DATASTORE_IDENT(name__, impl_small_size)(self); \
+		cstr = DATASTORE_IDENT(name__, impl_alloc)(size, &allocated); \
+		memcpy(cstr, self->u.small, size + 1); \
+	} \
+	memset(self, 0, sizeof(*self)); \
+	return cstr; \
+}
+
+/**
+ * @brief String methods implementation
+ *
+ * Calls @ref DATASTORE_STR_IMPL_S with @ref DATASTORE_VEC_SETTINGS_DEFAULT
+ *
+ * @param name__ Name of the string type
+ */
+#define DATASTORE_STR_IMPL(name__) \
+	DATASTORE_STR_IMPL_S(name__, DATASTORE_VEC_SETTINGS_DEFAULT)
+// }}}
+
+/** @endgroup VectorString */
+
+#endif // DATASTORE_VEC_STRING_H